@@ -94,6 +94,9 @@ class MESH_MT_attribute_context_menu(Menu):
         layout = self.layout
 
         layout.operator("geometry.attribute_convert")
+        layout.separator()
+        layout.operator_menu_enum("geometry.attribute_compress", "type")
+        layout.operator("geometry.attribute_decompress_all")
 
 
 class MESH_UL_vgroups(UIList):
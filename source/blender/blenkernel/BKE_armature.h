@@ -12,6 +12,7 @@ extern "C" {
 #endif
 
 struct AnimationEvalContext;
+struct ArmatureWeightCache;
 struct BMEditMesh;
 struct Bone;
 struct Depsgraph;
@@ -668,6 +669,12 @@ void BKE_armature_deform_coords_with_editmesh(const struct Object *ob_arm,
                                               const char *defgrp_name,
                                               struct BMEditMesh *em_target);
 
+/**
+ * Release a reference to the vertex group weights that #BKE_armature_deform_coords_with_mesh
+ * caches on copy-on-write meshes, freeing them when it was the last one.
+ */
+void BKE_armature_weight_cache_release(struct ArmatureWeightCache *cache);
+
 /** \} */
 
 #ifdef __cplusplus
@@ -86,6 +86,20 @@ bool BKE_id_attribute_rename(struct ID *id,
                              const char *new_name,
                              struct ReportList *reports);
 
+/**
+ * Store a generic attribute with reduced precision to save memory, see #CD_MASK_PROP_COMPRESSED.
+ * Built-in attributes and UV maps are never compressed, and all values have to be representable
+ * by the compressed type. Not supported in edit mode.
+ */
+bool BKE_id_attribute_compress(struct ID *id,
+                               const char *name,
+                               eCustomDataType compressed_type,
+                               struct ReportList *reports);
+/** Store a compressed attribute with full precision again. */
+bool BKE_id_attribute_decompress(struct ID *id, const char *name, struct ReportList *reports);
+/** \return The number of attributes that were decompressed. */
+int BKE_id_attributes_decompress_all(struct ID *id);
+
 int BKE_id_attributes_length(const struct ID *id,
                              eAttrDomainMask domain_mask,
                              eCustomDataMask mask);
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bke
+ *
+ * Generic attributes can optionally be stored with reduced precision to save memory (see
+ * #CD_MASK_PROP_COMPRESSED). The attribute API gives access to them as virtual arrays of the
+ * attribute type they store, so most code doesn't have to know about the compression. Code that
+ * needs spans (e.g. with `.span()` on an attribute) gets a copy of the decoded values.
+ */
+
+#include "BLI_generic_virtual_array.hh"
+#include "BLI_string_ref.hh"
+
+#include "DNA_customdata_types.h"
+
+namespace blender::bke {
+
+/** Whether the type stores values of another attribute type with reduced precision. */
+bool custom_data_type_is_compressed(eCustomDataType type);
+
+/**
+ * The attribute type that values of a compressed type are accessed with. Other types are
+ * returned unchanged.
+ */
+eCustomDataType custom_data_type_decompressed(eCustomDataType type);
+
+/** Virtual arrays that decode the values of a compressed layer, see #CD_MASK_PROP_COMPRESSED. */
+GVArray compressed_layer_to_varray(eCustomDataType type, const void *data, int64_t size);
+GVMutableArray compressed_layer_to_varray_for_write(eCustomDataType type,
+                                                    void *data,
+                                                    int64_t size);
+
+/**
+ * Replace the generic attribute layer with the given name by a compressed layer. The values have
+ * to be representable by the compressed type: 2D vectors have to be in the [0, 1] range, normals
+ * have to be normalized and half floats can't be larger than 65504. Mesh UV maps and built-in
+ * attributes must not be compressed, #BKE_id_attribute_compress checks that.
+ *
+ * \return False if the layer doesn't exist, has a type that doesn't correspond to the compressed
+ * type, or has values that can't be stored in the compressed type. The layer is not changed then.
+ */
+bool compress_attribute(CustomData &custom_data,
+                        StringRef name,
+                        eCustomDataType compressed_type,
+                        int element_num);
+
+/**
+ * Replace a compressed layer with a layer that stores the decoded values with full precision.
+ * \return False if there is no compressed layer with the given name.
+ */
+bool decompress_attribute(CustomData &custom_data, StringRef name, int element_num);
+
+}  // namespace blender::bke
@@ -10,6 +10,7 @@
 #include "BLI_threads.h"
 
 #ifdef __cplusplus
+#  include <memory>
 #  include <mutex>
 
 #  include "BLI_bit_vector.hh"
@@ -268,3 +269,21 @@ void bvhcache_free(struct BVHCache *bvh_cache);
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef __cplusplus
+
+/**
+ * Storage for BVH trees of meshes that share the same topology. Trees which only depend on the
+ * positions and the topology are moved to the pool when a mesh's cache is freed, e.g. because the
+ * positions changed or the mesh was freed. Building the same tree type again takes the tree from
+ * the pool and refits it to the new positions instead of building a new tree.
+ */
+struct BVHTreePool;
+
+std::shared_ptr<BVHTreePool> bvhtree_pool_new();
+/**
+ * Frees a BVH-cache like #bvhcache_free(), but moves the trees that can be refit to the pool.
+ */
+void bvhcache_free_to_pool(struct BVHCache *bvh_cache, BVHTreePool &pool);
+
+#endif
@@ -80,7 +80,10 @@ typedef enum eCDAllocType {
   CD_SET_DEFAULT = 2,
   /** Use data pointers, set layer flag NOFREE. */
   CD_REFERENCE = 3,
-  /** Do a full copy of all layers, only allowed if source has same number of elements. */
+  /**
+   * Copy all layers, only allowed if source has same number of elements. Layer data is implicitly
+   * shared with the source when possible and only copied when it is accessed for writing.
+   */
   CD_DUPLICATE = 4,
   /**
    * Default construct new layer values. Does nothing for trivial types. This should be used
@@ -184,7 +187,7 @@ bool CustomData_merge(const struct CustomData *source,
 /**
  * Reallocate custom data to a new element count. If the new size is larger, the new values use
  * the #CD_CONSTRUCT behavior, so trivial types must be initialized by the caller. After being
- * resized, the #CustomData does not contain any referenced layers.
+ * resized, the #CustomData does not contain any referenced or shared layers.
  */
 void CustomData_realloc(struct CustomData *data, int old_size, int new_size);
 
@@ -298,9 +301,24 @@ int CustomData_number_of_layers_typemask(const struct CustomData *data, eCustomD
 
 /**
  * Duplicate all the layers with flag NOFREE, and remove the flag from duplicated layers.
+ * Layers with data that is shared with other layers are duplicated as well.
  */
 void CustomData_duplicate_referenced_layers(CustomData *data, int totelem);
 
+/**
+ * Make sure the layer's data is not referenced or shared with other layers, so it can be
+ * modified. This is done by the `*_for_write` accessors already, it's only necessary when
+ * accessing #CustomDataLayer.data directly.
+ */
+void CustomData_ensure_data_is_mutable(struct CustomDataLayer *layer, int totelem);
+
+/**
+ * Take ownership of the layer's data array, copying it first if it isn't owned by the layer
+ * exclusively. Afterwards the layer has no data. The returned array must be freed with
+ * #MEM_freeN.
+ */
+void *CustomData_layer_steal_data(struct CustomDataLayer *layer, int totelem);
+
 /**
  * Set the #CD_FLAG_NOCOPY flag in custom data layers where the mask is
  * zero for the layer type, so only layer types specified by the mask will be copied
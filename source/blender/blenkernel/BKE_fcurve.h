@@ -568,6 +568,15 @@ bool BKE_fcurve_is_empty(const struct FCurve *fcu);
 float calculate_fcurve(struct PathResolvedRNA *anim_rna,
                        struct FCurve *fcu,
                        const struct AnimationEvalContext *anim_eval_context);
+/**
+ * Calculate the values of many F-Curves at the same frame, like #calculate_fcurve does for each
+ * of them. Meant for evaluating all curves of an action at once, large batches are evaluated in
+ * parallel. The curves must not have drivers.
+ */
+void calculate_fcurves_batch(struct FCurve **fcurves,
+                             int fcurves_num,
+                             const struct AnimationEvalContext *anim_eval_context,
+                             float *r_values);
 
 /* ************* F-Curve Samples API ******************** */
 
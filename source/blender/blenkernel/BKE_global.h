@@ -239,6 +239,11 @@ enum {
    * As users/developers may not want their paths exposed in publicly distributed files.
    */
   G_FILE_RECOVER_WRITE = (1 << 24),
+  /**
+   * On read, don't load the contents of packed files until they are accessed,
+   * see #BLO_READ_DEFER_PACKED_DATA.
+   */
+  G_FILE_DEFER_PACKED_DATA = (1 << 25),
   /** BMesh option to save as older mesh format */
   /* #define G_FILE_MESH_COMPAT       (1 << 26) */
   /* #define G_FILE_GLSL_NO_ENV_LIGHTING (1 << 28) */ /* deprecated */
@@ -248,7 +253,8 @@ enum {
  * Run-time only #G.fileflags which are never read or written to/from Blend files.
  * This means we can change the values without worrying about do-versions.
  */
-#define G_FILE_FLAG_ALL_RUNTIME (G_FILE_NO_UI | G_FILE_RECOVER_READ | G_FILE_RECOVER_WRITE)
+#define G_FILE_FLAG_ALL_RUNTIME \
+  (G_FILE_NO_UI | G_FILE_RECOVER_READ | G_FILE_RECOVER_WRITE | G_FILE_DEFER_PACKED_DATA)
 
 /** #Global.moving, signals drawing in (3d) window to denote transform */
 enum {
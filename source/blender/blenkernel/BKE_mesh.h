@@ -156,6 +156,20 @@ void BKE_mesh_eval_delete(struct Mesh *mesh_eval);
  */
 struct Mesh *BKE_mesh_copy_for_eval(const struct Mesh *source, bool reference);
 
+/**
+ * Check whether the copy-on-write mesh only differs from the original in data which is updated by
+ * #BKE_mesh_update_geometry_on_write, so that a full copy of the data-block can be avoided when
+ * only the geometry of the mesh is tagged for update.
+ */
+bool BKE_mesh_can_avoid_full_copy_on_write(const struct Mesh *mesh_orig,
+                                           const struct Mesh *mesh_cow);
+/**
+ * Copy the geometry and other settings without ID references from the original mesh to its
+ * copy-on-write version, keeping materials, shape keys, animation data and custom properties of
+ * the copy as they are.
+ */
+void BKE_mesh_update_geometry_on_write(const struct Mesh *mesh_orig, struct Mesh *mesh_cow);
+
 /**
  * These functions construct a new Mesh,
  * contrary to #BKE_mesh_to_curve_nurblist which modifies ob itself.
@@ -6,6 +6,8 @@
  * \ingroup bke
  */
 
+#include "BLI_index_mask.hh"
+
 #include "BKE_mesh.h"
 
 namespace blender::bke::mesh {
@@ -36,6 +38,16 @@ void looptris_calc_with_normals(Span<float3> vert_positions,
                                 Span<int> corner_verts,
                                 Span<float3> poly_normals,
                                 MutableSpan<MLoopTri> looptris);
+/**
+ * Recalculate the triangulation of the selected polygons only, leaving the triangles of other
+ * polygons unchanged. \a poly_normals is optional, like for #looptris_calc_with_normals.
+ */
+void looptris_calc_partial(Span<float3> vert_positions,
+                           Span<MPoly> polys,
+                           Span<int> corner_verts,
+                           Span<float3> poly_normals,
+                           IndexMask poly_mask,
+                           MutableSpan<MLoopTri> looptris);
 
 /** Calculate the average position of the vertices in the polygon. */
 float3 poly_center_calc(Span<float3> vert_positions, Span<int> poly_verts);
@@ -66,7 +78,9 @@ void normals_calc_polys(Span<float3> vert_positions,
                         MutableSpan<float3> poly_normals);
 
 /**
- * Calculate face and vertex normals directly into result arrays.
+ * Calculate face and vertex normals directly into result arrays. Vertex normals are gathered from
+ * the surrounding faces using the vertex to face corner map (see #Mesh::vert_to_loop_map()), so
+ * the result is deterministic.
  *
  * \note Usually #Mesh::vert_normals() is the preferred way to access vertex normals,
  * since they may already be calculated and cached on the mesh.
@@ -74,9 +88,27 @@ void normals_calc_polys(Span<float3> vert_positions,
 void normals_calc_poly_vert(Span<float3> vert_positions,
                             Span<MPoly> polys,
                             Span<int> corner_verts,
+                            const TopologyMap &vert_to_loop_map,
+                            const TopologyMap &vert_to_poly_map,
                             MutableSpan<float3> poly_normals,
                             MutableSpan<float3> vert_normals);
 
+/**
+ * Recalculate the normals of the selected polygons and vertices, leaving the rest of the arrays
+ * unchanged. Every vertex normal is gathered from all of the polygons using the vertex, so the
+ * normals of unselected polygons around the selected vertices must be valid. Typically the vertex
+ * selection contains all vertices of the selected polygons.
+ */
+void normals_calc_poly_vert_partial(Span<float3> vert_positions,
+                                    Span<MPoly> polys,
+                                    Span<int> corner_verts,
+                                    const TopologyMap &vert_to_loop_map,
+                                    const TopologyMap &vert_to_poly_map,
+                                    IndexMask poly_mask,
+                                    IndexMask vert_mask,
+                                    MutableSpan<float3> poly_normals,
+                                    MutableSpan<float3> vert_normals);
+
 /**
  * Compute split normals, i.e. vertex normals associated with each poly (hence 'loop normals').
  * Useful to materialize sharp edges (or non-smooth faces) without actually modifying the geometry
@@ -210,6 +242,20 @@ inline int edge_other_vert(const MEdge &edge, const int vert)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Partial Updates
+ * \{ */
+
+/**
+ * Call after changing the positions of only some vertices, instead of
+ * #BKE_mesh_tag_positions_changed. Rather than being invalidated, the cached normals and
+ * triangulation are updated for the polygons using the changed vertices and for all vertices of
+ * those polygons. Other caches that depend on positions are tagged dirty as usual.
+ */
+void tag_positions_changed_partial(Mesh &mesh, IndexMask changed_verts);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Inline Mesh Data Access
  * \{ */
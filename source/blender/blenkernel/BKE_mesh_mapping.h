@@ -348,6 +348,8 @@ int *BKE_mesh_calc_smoothgroups(int totedge,
 
 #  include "DNA_meshdata_types.h" /* MPoly */
 
+#  include "BKE_mesh_types.h" /* TopologyMap */
+
 namespace blender::bke::mesh_topology {
 
 Array<int> build_loop_to_poly_map(Span<MPoly> polys, int loops_num);
@@ -363,5 +365,21 @@ Array<Vector<int, 2>> build_edge_to_poly_map(Span<MPoly> polys,
                                              int edges_num);
 Vector<Vector<int>> build_edge_to_loop_map_resizable(Span<int> corner_edges, int edges_num);
 
+/**
+ * Compressed versions of the maps above, stored in a #TopologyMap. Usually these shouldn't be
+ * called directly, since the maps are cached on the mesh, see #Mesh::vert_to_poly_map().
+ */
+TopologyMap build_vert_to_edge_topology_map(Span<MEdge> edges, int verts_num);
+TopologyMap build_vert_to_loop_topology_map(Span<int> corner_verts, int verts_num);
+/** Reuses the offsets of the vertex to face corner map, since the groups have the same sizes. */
+TopologyMap build_vert_to_poly_topology_map(const TopologyMap &vert_to_loop_map,
+                                            Span<MPoly> polys);
+
+/**
+ * Copy a cached #TopologyMap to the legacy #MeshElemMap format, for code that still uses it.
+ * The result is the same as building it with e.g. #BKE_mesh_vert_poly_map_create.
+ */
+void topology_map_to_elem_map(const TopologyMap &map, MeshElemMap **r_map, int **r_mem);
+
 }  // namespace blender::bke::mesh_topology
 #endif
@@ -14,9 +14,11 @@
 extern "C" {
 #endif
 
+struct ArmatureWeightCache;
 struct CustomData_MeshMasks;
 struct Depsgraph;
 struct KeyBlock;
+struct MDeformVert;
 struct MLoopTri;
 struct MVertTri;
 struct Mesh;
@@ -58,6 +60,20 @@ void BKE_mesh_runtime_clear_geometry(struct Mesh *mesh);
  */
 void BKE_mesh_runtime_clear_cache(struct Mesh *mesh);
 
+/**
+ * Lock the armature weight cache of the mesh and return a pointer to it for reading or replacing
+ * it, see #BKE_armature_weight_cache_release. The cache is cleared when the mesh's deform vertex
+ * data changed since it was stored, and freed with the other geometry caches.
+ * Every call that doesn't return null must be followed by
+ * #BKE_mesh_runtime_armature_weight_cache_unlock.
+ *
+ * \param dverts: The weights to build the cache from, null is returned when they aren't the
+ * deform vertex data of the mesh, or when changes to that data can't be detected.
+ */
+struct ArmatureWeightCache **BKE_mesh_runtime_armature_weight_cache_lock(
+    const struct Mesh *mesh, const struct MDeformVert *dverts);
+void BKE_mesh_runtime_armature_weight_cache_unlock(const struct Mesh *mesh);
+
 /**
  * Convert triangles encoded as face corner indices to triangles encoded as vertex indices.
  */
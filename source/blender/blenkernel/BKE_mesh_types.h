@@ -9,6 +9,7 @@
 
 #ifdef __cplusplus
 
+#  include <memory>
 #  include <mutex>
 
 #  include "MEM_guardedalloc.h"
@@ -17,6 +18,7 @@
 #  include "BLI_bit_vector.hh"
 #  include "BLI_bounds_types.hh"
 #  include "BLI_math_vector_types.hh"
+#  include "BLI_offset_indices.hh"
 #  include "BLI_shared_cache.hh"
 #  include "BLI_span.hh"
 #  include "BLI_vector.hh"
@@ -24,7 +26,9 @@
 #  include "DNA_customdata_types.h"
 #  include "DNA_meshdata_types.h"
 
+struct ArmatureWeightCache;
 struct BVHCache;
+struct BVHTreePool;
 struct EditMeshData;
 struct Mesh;
 struct MLoopTri;
@@ -82,6 +86,34 @@ struct LooseEdgeCache {
   int count = -1;
 };
 
+/**
+ * A map from every element of one mesh domain to the connected elements of another domain, like
+ * the polygons that use each vertex. The connected indices of all elements are stored in a single
+ * array, sliced by offsets the same way as the face corners of polygons. Within each group, the
+ * indices are sorted.
+ */
+struct TopologyMap {
+  /** Offsets into #indices, with one more value than the number of source elements. */
+  Array<int> offset_data;
+  Array<int> indices;
+
+  OffsetIndices<int> offsets() const
+  {
+    return offset_data.as_span();
+  }
+
+  /** The number of source elements in the map. */
+  int64_t size() const
+  {
+    return offset_data.size() - 1;
+  }
+
+  Span<int> operator[](const int64_t index) const
+  {
+    return indices.as_span().slice(this->offsets()[index]);
+  }
+};
+
 struct MeshRuntime {
   /* Evaluated mesh for objects which do not have effective modifiers.
    * This mesh is used as a result of modifier stack evaluation.
@@ -116,10 +148,28 @@ struct MeshRuntime {
 
   /** Cache for BVH trees generated for the mesh. Defined in 'BKE_bvhutil.c' */
   BVHCache *bvh_cache = nullptr;
+  /**
+   * BVH trees of meshes with the same topology that can be refit to new positions. Shared with
+   * copies of the mesh and replaced when the topology changes, see #bvhcache_free_to_pool().
+   */
+  std::shared_ptr<BVHTreePool> bvh_tree_pool;
 
   /** Cache of non-manifold boundary data for Shrink-wrap Target Project. */
   ShrinkwrapBoundaryData *shrinkwrap_data = nullptr;
 
+  /**
+   * Vertex group weights compiled for armature deformation, see `armature_deform.c`. Stored on
+   * the copy-on-write mesh, whose weights are shared with the copies deformed on every evaluation.
+   * Access is protected by #armature_weight_cache_mutex.
+   */
+  ArmatureWeightCache *armature_weight_cache = nullptr;
+  /**
+   * Sharing info of the deform vertex layer the cache was built for. The cache holds a user of
+   * it, so changing the weights always copies or replaces the layer data, which invalidates it.
+   */
+  const ImplicitSharingInfo *armature_weight_cache_sharing_info = nullptr;
+  std::mutex armature_weight_cache_mutex;
+
   /** Needed in case we need to lazily initialize the mesh. */
   CustomData_MeshMasks cd_mask_extra = {};
 
@@ -168,6 +218,15 @@ struct MeshRuntime {
    */
   SharedCache<LooseEdgeCache> loose_edges_cache;
 
+  /**
+   * Adjacency maps between mesh domains, shared with other data-blocks with unchanged topology.
+   * Accessed with #Mesh::vert_to_edge_map(), #Mesh::vert_to_poly_map() and
+   * #Mesh::vert_to_loop_map(). Changing positions doesn't affect them.
+   */
+  SharedCache<TopologyMap> vert_to_edge_map_cache;
+  SharedCache<TopologyMap> vert_to_poly_map_cache;
+  SharedCache<TopologyMap> vert_to_loop_map_cache;
+
   /**
    * A bit vector the size of the number of vertices, set to true for the center vertices of
    * subdivided polygons. The values are set by the subdivision surface modifier and used by
@@ -182,7 +241,7 @@ struct MeshRuntime {
    */
   BitVector<> subsurf_optimal_display_edges;
 
-  MeshRuntime() = default;
+  MeshRuntime();
   ~MeshRuntime();
 
   MEM_CXX_CLASS_ALLOC_FUNCS("MeshRuntime")
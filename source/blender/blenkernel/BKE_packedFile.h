@@ -41,6 +41,15 @@ enum ePF_FileStatus {
   PF_ASK = 10,
 };
 
+/**
+ * Read the data of a packed file whose loading was deferred (see #BLO_READ_DEFER_PACKED_DATA),
+ * does nothing when the data is already available. Must be called before accessing `pf->data`.
+ * Thread-safe.
+ *
+ * \return False when the data could not be read, `pf->data` is zero filled then.
+ */
+bool BKE_packedfile_ensure_data(struct PackedFile *pf);
+
 /* Pack. */
 
 struct PackedFile *BKE_packedfile_duplicate(const struct PackedFile *pf_src);
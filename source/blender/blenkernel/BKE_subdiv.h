@@ -168,6 +168,9 @@ typedef struct Subdiv {
   struct SubdivDisplacement *displacement_evaluator;
   /* Statistics for debugging. */
   SubdivStats stats;
+  /* Hash of the mesh data which affects the topology refiner, used to skip the comparison of
+   * the topology when it did not change. Zero if the descriptor was not created from a mesh. */
+  uint64_t topology_hash;
 
   /* Cached values, are not supposed to be accessed directly. */
   struct {
@@ -244,6 +247,10 @@ Subdiv *BKE_subdiv_new_from_mesh(const SubdivSettings *settings, const struct Me
 Subdiv *BKE_subdiv_update_from_converter(Subdiv *subdiv,
                                          const SubdivSettings *settings,
                                          struct OpenSubdiv_Converter *converter);
+/* Same as above, but the mesh topology is first compared with a hash of the mesh data the
+ * descriptor was created from. That avoids creating a converter when the topology did not
+ * change, for example during playback of a deforming mesh. The evaluator (and its stencil
+ * tables) stays alive in that case, so only the coarse positions have to be updated. */
 Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
                                     const SubdivSettings *settings,
                                     const struct Mesh *mesh);
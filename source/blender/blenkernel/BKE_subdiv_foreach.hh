@@ -96,14 +96,15 @@ struct SubdivForeachContext {
    */
   SubdivForeachTopologyInformationCb topology_info;
   /* These callbacks are called from every ptex which shares "emitting"
-   * vertex or edge.
+   * vertex or edge. They are called from multiple threads, but all calls for
+   * the same vertex or edge happen from a single thread, so they can be used
+   * to accumulate values.
    */
   SubdivForeachVertexFromCornerCb vertex_every_corner;
   SubdivForeachVertexFromEdgeCb vertex_every_edge;
-  /* Those callbacks are run once per subdivision vertex, ptex is undefined
-   * as in it will be whatever first ptex face happened to be traversed in
-   * the multi-threaded environment and which shares "emitting" vertex or
-   * edge.
+  /* Those callbacks are run once per subdivision vertex, after all the
+   * callbacks above. The ptex is the one of the first face corner which uses
+   * the "emitting" vertex or edge.
    */
   SubdivForeachVertexFromCornerCb vertex_corner;
   SubdivForeachVertexFromEdgeCb vertex_edge;
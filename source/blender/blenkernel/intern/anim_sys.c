@@ -15,6 +15,7 @@
 
 #include "BLI_alloca.h"
 #include "BLI_blenlib.h"
+#include "BLI_buffer.h"
 #include "BLI_dynstr.h"
 #include "BLI_listbase.h"
 #include "BLI_math_rotation.h"
@@ -590,7 +591,37 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr,
                                      const AnimationEvalContext *anim_eval_context,
                                      bool flush_to_original)
 {
-  /* Calculate then execute each curve. */
+  if (BLI_listbase_is_empty(list)) {
+    return;
+  }
+
+  /* Calculate the values of all curves without drivers in one batch first. They don't depend on
+   * the values written below, drivers however might, so those are still calculated in order.
+   * Curves with paths that can't be resolved aren't evaluated at all. Most animated data-blocks
+   * only have a few curves, so the buffers only allocate memory for larger actions. */
+  BLI_buffer_declare_static(FCurve *, batch_fcurves, BLI_BUFFER_NOP, 32);
+  BLI_buffer_declare_static(PathResolvedRNA, batch_rna, BLI_BUFFER_NOP, 32);
+  BLI_buffer_declare_static(float, batch_values, BLI_BUFFER_NOP, 32);
+  LISTBASE_FOREACH (FCurve *, fcu, list) {
+    if (fcu->driver != NULL || !is_fcurve_evaluatable(fcu)) {
+      continue;
+    }
+    PathResolvedRNA anim_rna;
+    if (BKE_animsys_rna_path_resolve(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
+      BLI_buffer_append(&batch_fcurves, FCurve *, fcu);
+      BLI_buffer_append(&batch_rna, PathResolvedRNA, anim_rna);
+    }
+  }
+  const int batch_fcurves_num = (int)batch_fcurves.count;
+  FCurve **batch_fcurves_data = (FCurve **)batch_fcurves.data;
+  const PathResolvedRNA *batch_rna_data = (const PathResolvedRNA *)batch_rna.data;
+  BLI_buffer_resize(&batch_values, batch_fcurves.count);
+  float *batch_values_data = (float *)batch_values.data;
+  calculate_fcurves_batch(
+      batch_fcurves_data, batch_fcurves_num, anim_eval_context, batch_values_data);
+
+  /* Execute each curve. */
+  int batch_index = 0;
   LISTBASE_FOREACH (FCurve *, fcu, list) {
 
     if (!is_fcurve_evaluatable(fcu)) {
@@ -598,14 +629,33 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr,
     }
 
     PathResolvedRNA anim_rna;
-    if (BKE_animsys_rna_path_resolve(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
-      const float curval = calculate_fcurve(&anim_rna, fcu, anim_eval_context);
-      BKE_animsys_write_to_rna_path(&anim_rna, curval);
-      if (flush_to_original) {
-        animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
+    float curval;
+    if (fcu->driver == NULL) {
+      /* The batch is in the order of the list, without the curves that couldn't be resolved. */
+      if (batch_index == batch_fcurves_num || batch_fcurves_data[batch_index] != fcu) {
+        continue;
+      }
+      anim_rna = batch_rna_data[batch_index];
+      curval = batch_values_data[batch_index];
+      batch_index++;
+    }
+    else {
+      if (!BKE_animsys_rna_path_resolve(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
+        continue;
       }
+      curval = calculate_fcurve(&anim_rna, fcu, anim_eval_context);
+    }
+
+    BKE_animsys_write_to_rna_path(&anim_rna, curval);
+    if (flush_to_original) {
+      animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
     }
   }
+  BLI_assert(batch_index == batch_fcurves_num);
+
+  BLI_buffer_free(&batch_fcurves);
+  BLI_buffer_free(&batch_rna);
+  BLI_buffer_free(&batch_values);
 }
 
 /* This function assumes that the quaternion is fully keyed, and is stored in array index order. */
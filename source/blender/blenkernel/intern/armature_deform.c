@@ -36,11 +36,14 @@
 #include "BKE_editmesh.h"
 #include "BKE_lattice.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
 
 #include "DEG_depsgraph_build.h"
 
 #include "CLG_log.h"
 
+#include "atomic_ops.h"
+
 static CLG_LogRef LOG = {"bke.armature_deform"};
 
 /* -------------------------------------------------------------------- */
@@ -222,46 +225,318 @@ static void pchan_bone_deform(const bPoseChannel *pchan,
  * #BKE_armature_deform_coords and related functions.
  * \{ */
 
+/**
+ * The influence of one deforming bone on a vertex, see #ArmatureWeightTable.
+ */
+typedef struct ArmatureDeformWeight {
+  /** Vertex group index rather than pose channel, so cached tables survive pose rebuilds. */
+  int def_nr;
+  float weight;
+} ArmatureDeformWeight;
+
+/**
+ * Vertex group weights of all vertices compiled into a compact table before the deformation,
+ * so that the per-vertex loop doesn't have to walk the #MDeformVert lists or skip groups that
+ * don't belong to deforming bones. The weights of vertex `i` are `weights[offsets[i]]` to
+ * `weights[offsets[i + 1] - 1]`.
+ *
+ * Weights of zero are skipped. A vertex that only has zero weights for deforming bones still gets
+ * one (zero) weight though, because such vertices must not fall back to envelope deformation.
+ */
+typedef struct ArmatureWeightTable {
+  /** Null when vertex groups aren't used for the deformation. */
+  int *offsets;
+  ArmatureDeformWeight *weights;
+  /** Weight of the vertex group that limits the armature influence, null when there is none. */
+  float *armature_weights;
+} ArmatureWeightTable;
+
+typedef struct ArmatureWeightTableBuildData {
+  const MDeformVert *dverts;
+  int dverts_len;
+
+  /** Used instead of `dverts` for edit-meshes, requires the vertex table. */
+  BMesh *bm;
+  int cd_dvert_offset;
+
+  bPoseChannel **pchan_from_defbase;
+  int defbase_len;
+
+  int armature_def_nr;
+  bool invert_vgroup;
+
+  ArmatureWeightTable *table;
+} ArmatureWeightTableBuildData;
+
+static const MDeformVert *armature_weight_table_dvert_get(const ArmatureWeightTableBuildData *data,
+                                                          const int i)
+{
+  if (data->bm) {
+    return BM_ELEM_CD_GET_VOID_P(BM_vert_at_index(data->bm, i), data->cd_dvert_offset);
+  }
+  if (i < data->dverts_len) {
+    return &data->dverts[i];
+  }
+  return NULL;
+}
+
+/** Count the weights of each vertex and store it in the offsets, before accumulating them. */
+static void armature_weight_table_count_task(void *__restrict userdata,
+                                             const int i,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArmatureWeightTableBuildData *data = userdata;
+  ArmatureWeightTable *table = data->table;
+  const MDeformVert *dvert = armature_weight_table_dvert_get(data, i);
+
+  if (table->armature_weights) {
+    /* Vertices without weights are fully deformed, even with an inverted vertex group. */
+    float armature_weight = 1.0f;
+    if (dvert) {
+      armature_weight = BKE_defvert_find_weight(dvert, data->armature_def_nr);
+      if (data->invert_vgroup) {
+        armature_weight = 1.0f - armature_weight;
+      }
+    }
+    table->armature_weights[i] = armature_weight;
+  }
+
+  if (table->offsets == NULL) {
+    return;
+  }
+
+  int count = 0;
+  bool has_bone_weights = false;
+  if (dvert) {
+    for (int j = 0; j < dvert->totweight; j++) {
+      const uint index = dvert->dw[j].def_nr;
+      if (index < data->defbase_len && data->pchan_from_defbase[index]) {
+        has_bone_weights = true;
+        if (dvert->dw[j].weight != 0.0f) {
+          count++;
+        }
+      }
+    }
+  }
+  table->offsets[i] = (has_bone_weights && count == 0) ? 1 : count;
+}
+
+static void armature_weight_table_fill_task(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArmatureWeightTableBuildData *data = userdata;
+  ArmatureWeightTable *table = data->table;
+  const int start = table->offsets[i];
+  const int end = table->offsets[i + 1];
+  if (start == end) {
+    return;
+  }
+
+  const MDeformVert *dvert = armature_weight_table_dvert_get(data, i);
+  ArmatureDeformWeight *weight = &table->weights[start];
+  int first_def_nr = -1;
+  for (int j = 0; j < dvert->totweight; j++) {
+    const uint index = dvert->dw[j].def_nr;
+    if (index < data->defbase_len && data->pchan_from_defbase[index]) {
+      if (first_def_nr == -1) {
+        first_def_nr = (int)index;
+      }
+      if (dvert->dw[j].weight != 0.0f) {
+        weight->def_nr = (int)index;
+        weight->weight = dvert->dw[j].weight;
+        weight++;
+      }
+    }
+  }
+  if (weight == &table->weights[start]) {
+    weight->def_nr = first_def_nr;
+    weight->weight = 0.0f;
+    weight++;
+  }
+  BLI_assert(weight == &table->weights[end]);
+}
+
+static void armature_weight_table_build(ArmatureWeightTableBuildData *data,
+                                        const int vert_coords_len,
+                                        const bool use_dverts)
+{
+  ArmatureWeightTable *table = data->table;
+  const bool has_dverts = data->dverts || data->bm;
+
+  if (data->armature_def_nr != -1 && has_dverts) {
+    table->armature_weights = MEM_malloc_arrayN(
+        vert_coords_len, sizeof(*table->armature_weights), __func__);
+  }
+  if (use_dverts && has_dverts) {
+    table->offsets = MEM_malloc_arrayN(vert_coords_len + 1, sizeof(*table->offsets), __func__);
+  }
+  if (table->armature_weights == NULL && table->offsets == NULL) {
+    return;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, vert_coords_len, data, armature_weight_table_count_task, &settings);
+
+  if (table->offsets == NULL) {
+    return;
+  }
+
+  int offset = 0;
+  for (int i = 0; i < vert_coords_len; i++) {
+    const int count = table->offsets[i];
+    table->offsets[i] = offset;
+    offset += count;
+  }
+  table->offsets[vert_coords_len] = offset;
+
+  table->weights = MEM_malloc_arrayN(offset, sizeof(*table->weights), __func__);
+  BLI_task_parallel_range(0, vert_coords_len, data, armature_weight_table_fill_task, &settings);
+}
+
+static void armature_weight_table_free(ArmatureWeightTable *table)
+{
+  MEM_SAFE_FREE(table->offsets);
+  MEM_SAFE_FREE(table->weights);
+  MEM_SAFE_FREE(table->armature_weights);
+}
+
+/**
+ * A weight table stored on the copy-on-write mesh of the deformed object, so that it isn't rebuilt
+ * on every evaluation when only the pose changes. The meshes that are deformed are copied from it
+ * on every evaluation, but share its vertex group data. The table is reused as long as that data
+ * and the settings it was built from stay the same, see
+ * #BKE_mesh_runtime_armature_weight_cache_lock for how changes to the weights are detected.
+ */
+typedef struct ArmatureWeightCache {
+  ArmatureWeightTable table;
+  /** The mesh storing the cache and every deformation using the table hold a user. */
+  int32_t users;
+
+  /* The data and settings the table was built from. */
+  const MDeformVert *dverts;
+  int dverts_len;
+  int vert_coords_len;
+  bool use_dverts;
+  int armature_def_nr;
+  bool invert_vgroup;
+  /** Whether each vertex group belongs to a deforming bone, only used with `use_dverts`. */
+  bool *defbase_deform;
+  int defbase_len;
+} ArmatureWeightCache;
+
+static bool armature_weight_cache_matches(const ArmatureWeightCache *cache,
+                                          const ArmatureWeightTableBuildData *data,
+                                          const int vert_coords_len,
+                                          const bool use_dverts)
+{
+  if (cache->dverts != data->dverts || cache->dverts_len != data->dverts_len ||
+      cache->vert_coords_len != vert_coords_len || cache->use_dverts != use_dverts ||
+      cache->armature_def_nr != data->armature_def_nr ||
+      cache->invert_vgroup != data->invert_vgroup || cache->defbase_len != data->defbase_len) {
+    return false;
+  }
+  if (use_dverts) {
+    for (int i = 0; i < data->defbase_len; i++) {
+      if (cache->defbase_deform[i] != (data->pchan_from_defbase[i] != NULL)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static ArmatureWeightCache *armature_weight_cache_create(ArmatureWeightTableBuildData *data,
+                                                         const int vert_coords_len,
+                                                         const bool use_dverts)
+{
+  ArmatureWeightCache *cache = MEM_callocN(sizeof(*cache), __func__);
+  cache->users = 1;
+  cache->dverts = data->dverts;
+  cache->dverts_len = data->dverts_len;
+  cache->vert_coords_len = vert_coords_len;
+  cache->use_dverts = use_dverts;
+  cache->armature_def_nr = data->armature_def_nr;
+  cache->invert_vgroup = data->invert_vgroup;
+  cache->defbase_len = data->defbase_len;
+  if (use_dverts && data->defbase_len > 0) {
+    cache->defbase_deform = MEM_malloc_arrayN(
+        data->defbase_len, sizeof(*cache->defbase_deform), __func__);
+    for (int i = 0; i < data->defbase_len; i++) {
+      cache->defbase_deform[i] = data->pchan_from_defbase[i] != NULL;
+    }
+  }
+
+  data->table = &cache->table;
+  armature_weight_table_build(data, vert_coords_len, use_dverts);
+  return cache;
+}
+
+void BKE_armature_weight_cache_release(ArmatureWeightCache *cache)
+{
+  if (atomic_sub_and_fetch_int32(&cache->users, 1) == 0) {
+    armature_weight_table_free(&cache->table);
+    MEM_SAFE_FREE(cache->defbase_deform);
+    MEM_freeN(cache);
+  }
+}
+
+/**
+ * Get the weight table cached on the mesh, replacing it when it was built from different data.
+ * The returned cache must be released with #BKE_armature_weight_cache_release. Returns null when
+ * the weights can't be cached on the mesh.
+ */
+static ArmatureWeightCache *armature_weight_cache_acquire(const Mesh *mesh,
+                                                          ArmatureWeightTableBuildData *data,
+                                                          const int vert_coords_len,
+                                                          const bool use_dverts)
+{
+  ArmatureWeightCache **cache_p = BKE_mesh_runtime_armature_weight_cache_lock(mesh, data->dverts);
+  if (cache_p == NULL) {
+    return NULL;
+  }
+  if (*cache_p == NULL ||
+      !armature_weight_cache_matches(*cache_p, data, vert_coords_len, use_dverts)) {
+    if (*cache_p) {
+      BKE_armature_weight_cache_release(*cache_p);
+    }
+    *cache_p = armature_weight_cache_create(data, vert_coords_len, use_dverts);
+  }
+  ArmatureWeightCache *cache = *cache_p;
+  atomic_add_and_fetch_int32(&cache->users, 1);
+  BKE_mesh_runtime_armature_weight_cache_unlock(mesh);
+  return cache;
+}
+
 typedef struct ArmatureUserdata {
   const Object *ob_arm;
-  const Mesh *me_target;
   float (*vert_coords)[3];
   float (*vert_deform_mats)[3][3];
   float (*vert_coords_prev)[3];
 
   bool use_envelope;
   bool use_quaternion;
-  bool invert_vgroup;
-  bool use_dverts;
-
-  int armature_def_nr;
-
-  const MDeformVert *dverts;
-  int dverts_len;
 
+  const ArmatureWeightTable *weight_table;
   bPoseChannel **pchan_from_defbase;
-  int defbase_len;
 
   float premat[4][4];
   float postmat[4][4];
-
-  /** Specific data types. */
-  struct {
-    int cd_dvert_offset;
-  } bmesh;
 } ArmatureUserdata;
 
-static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
-                                          const int i,
-                                          const MDeformVert *dvert)
+static void armature_vert_task(void *__restrict userdata,
+                               const int i,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
 {
+  const ArmatureUserdata *data = userdata;
   float(*const vert_coords)[3] = data->vert_coords;
   float(*const vert_deform_mats)[3][3] = data->vert_deform_mats;
   float(*const vert_coords_prev)[3] = data->vert_coords_prev;
   const bool use_envelope = data->use_envelope;
   const bool use_quaternion = data->use_quaternion;
-  const bool use_dverts = data->use_dverts;
-  const int armature_def_nr = data->armature_def_nr;
+  const ArmatureWeightTable *weight_table = data->weight_table;
 
   DualQuat sumdq, *dq = NULL;
   const bPoseChannel *pchan;
@@ -286,12 +561,8 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
     }
   }
 
-  if (armature_def_nr != -1 && dvert) {
-    armature_weight = BKE_defvert_find_weight(dvert, armature_def_nr);
-
-    if (data->invert_vgroup) {
-      armature_weight = 1.0f - armature_weight;
-    }
+  if (weight_table->armature_weights) {
+    armature_weight = weight_table->armature_weights[i];
 
     /* hackish: the blending factor can be used for blending with vert_coords_prev too */
     if (vert_coords_prev) {
@@ -323,33 +594,21 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
   /* Apply the object's matrix */
   mul_m4_v3(data->premat, co);
 
-  if (use_dverts && dvert && dvert->totweight) { /* use weight groups ? */
-    const MDeformWeight *dw = dvert->dw;
-    int deformed = 0;
-    uint j;
-    for (j = dvert->totweight; j != 0; j--, dw++) {
-      const uint index = dw->def_nr;
-      if (index < data->defbase_len && (pchan = data->pchan_from_defbase[index])) {
-        float weight = dw->weight;
-        const Bone *bone = pchan->bone;
-
-        deformed = 1;
-
-        if (bone && bone->flag & BONE_MULT_VG_ENV) {
-          weight *= distfactor_to_bone(
-              co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
-        }
-
-        pchan_bone_deform(pchan, weight, vec, dq, smat, co, &contrib);
-      }
-    }
-    /* If there are vertex-groups but not groups with bones (like for soft-body groups). */
-    if (deformed == 0 && use_envelope) {
-      for (pchan = data->ob_arm->pose->chanbase.first; pchan; pchan = pchan->next) {
-        if (!(pchan->bone->flag & BONE_NO_DEFORM)) {
-          contrib += dist_bone_deform(pchan, vec, dq, smat, co);
-        }
+  /* Use weight groups? Vertices without weights for deforming bones (like vertices that are only
+   * in soft-body groups) use the envelopes instead. */
+  if (weight_table->offsets && weight_table->offsets[i] != weight_table->offsets[i + 1]) {
+    const ArmatureDeformWeight *weights = weight_table->weights;
+    for (int j = weight_table->offsets[i]; j < weight_table->offsets[i + 1]; j++) {
+      float weight = weights[j].weight;
+      pchan = data->pchan_from_defbase[weights[j].def_nr];
+      const Bone *bone = pchan->bone;
+
+      if (bone && bone->flag & BONE_MULT_VG_ENV) {
+        weight *= distfactor_to_bone(
+            co, bone->arm_head, bone->arm_tail, bone->rad_head, bone->rad_tail, bone->dist);
       }
+
+      pchan_bone_deform(pchan, weight, vec, dq, smat, co, &contrib);
     }
   }
   else if (use_envelope) {
@@ -410,55 +669,6 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
   }
 }
 
-static void armature_vert_task(void *__restrict userdata,
-                               const int i,
-                               const TaskParallelTLS *__restrict UNUSED(tls))
-{
-  const ArmatureUserdata *data = userdata;
-  const MDeformVert *dvert;
-  if (data->use_dverts || data->armature_def_nr != -1) {
-    if (data->me_target) {
-      BLI_assert(i < data->me_target->totvert);
-      if (data->dverts != NULL) {
-        dvert = data->dverts + i;
-      }
-      else {
-        dvert = NULL;
-      }
-    }
-    else if (data->dverts && i < data->dverts_len) {
-      dvert = data->dverts + i;
-    }
-    else {
-      dvert = NULL;
-    }
-  }
-  else {
-    dvert = NULL;
-  }
-
-  armature_vert_task_with_dvert(data, i, dvert);
-}
-
-static void armature_vert_task_editmesh(void *__restrict userdata,
-                                        MempoolIterData *iter,
-                                        const TaskParallelTLS *__restrict UNUSED(tls))
-{
-  const ArmatureUserdata *data = userdata;
-  BMVert *v = (BMVert *)iter;
-  const MDeformVert *dvert = BM_ELEM_CD_GET_VOID_P(v, data->bmesh.cd_dvert_offset);
-  armature_vert_task_with_dvert(data, BM_elem_index_get(v), dvert);
-}
-
-static void armature_vert_task_editmesh_no_dvert(void *__restrict userdata,
-                                                 MempoolIterData *iter,
-                                                 const TaskParallelTLS *__restrict UNUSED(tls))
-{
-  const ArmatureUserdata *data = userdata;
-  BMVert *v = (BMVert *)iter;
-  armature_vert_task_with_dvert(data, BM_elem_index_get(v), NULL);
-}
-
 static void armature_deform_coords_impl(const Object *ob_arm,
                                         const Object *ob_target,
                                         float (*vert_coords)[3],
@@ -474,6 +684,8 @@ static void armature_deform_coords_impl(const Object *ob_arm,
   const bArmature *arm = ob_arm->data;
   bPoseChannel **pchan_from_defbase = NULL;
   const MDeformVert *dverts = NULL;
+  /* Mesh that the weight table is cached on, see #ArmatureWeightCache. */
+  const Mesh *me_cache = NULL;
   const bool use_envelope = (deformflag & ARM_DEF_ENVELOPE) != 0;
   const bool use_quaternion = (deformflag & ARM_DEF_QUATERNION) != 0;
   const bool invert_vgroup = (deformflag & ARM_DEF_INVERT_VGROUP) != 0;
@@ -504,6 +716,7 @@ static void armature_deform_coords_impl(const Object *ob_arm,
         dverts = BKE_mesh_deform_verts(me);
         if (dverts) {
           dverts_len = me->totvert;
+          me_cache = (const Mesh *)ob_target->data;
         }
       }
     }
@@ -562,25 +775,50 @@ static void armature_deform_coords_impl(const Object *ob_arm,
     }
   }
 
+  ArmatureWeightTable weight_table = {NULL};
+  ArmatureWeightCache *weight_cache = NULL;
+  ArmatureWeightTableBuildData build_data = {
+      .dverts = dverts,
+      .dverts_len = dverts_len,
+      .bm = NULL,
+      .cd_dvert_offset = cd_dvert_offset,
+      .pchan_from_defbase = pchan_from_defbase,
+      .defbase_len = defbase_len,
+      .armature_def_nr = armature_def_nr,
+      .invert_vgroup = invert_vgroup,
+      .table = &weight_table,
+  };
+
+  if (em_target != NULL) {
+    /* While this could cause an extra loop over mesh data, in most cases this will
+     * have already been properly set. */
+    BM_mesh_elem_index_ensure(em_target->bm, BM_VERT);
+    BLI_assert(vert_coords_len == em_target->bm->totvert);
+
+    /* Weights of edit-meshes are only used together with the vertex groups option. */
+    if (use_dverts) {
+      BM_mesh_elem_table_ensure(em_target->bm, BM_VERT);
+      build_data.bm = em_target->bm;
+    }
+  }
+
+  if (me_cache) {
+    weight_cache = armature_weight_cache_acquire(
+        me_cache, &build_data, vert_coords_len, use_dverts);
+  }
+  if (weight_cache == NULL) {
+    armature_weight_table_build(&build_data, vert_coords_len, use_dverts);
+  }
+
   ArmatureUserdata data = {
       .ob_arm = ob_arm,
-      .me_target = me_target,
       .vert_coords = vert_coords,
       .vert_deform_mats = vert_deform_mats,
       .vert_coords_prev = vert_coords_prev,
       .use_envelope = use_envelope,
       .use_quaternion = use_quaternion,
-      .invert_vgroup = invert_vgroup,
-      .use_dverts = use_dverts,
-      .armature_def_nr = armature_def_nr,
-      .dverts = dverts,
-      .dverts_len = dverts_len,
+      .weight_table = weight_cache ? &weight_cache->table : &weight_table,
       .pchan_from_defbase = pchan_from_defbase,
-      .defbase_len = defbase_len,
-      .bmesh =
-          {
-              .cd_dvert_offset = cd_dvert_offset,
-          },
   };
 
   float obinv[4][4];
@@ -589,28 +827,16 @@ static void armature_deform_coords_impl(const Object *ob_arm,
   mul_m4_m4m4(data.postmat, obinv, ob_arm->object_to_world);
   invert_m4_m4(data.premat, data.postmat);
 
-  if (em_target != NULL) {
-    /* While this could cause an extra loop over mesh data, in most cases this will
-     * have already been properly set. */
-    BM_mesh_elem_index_ensure(em_target->bm, BM_VERT);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 32;
+  BLI_task_parallel_range(0, vert_coords_len, &data, armature_vert_task, &settings);
 
-    TaskParallelSettings settings;
-    BLI_parallel_mempool_settings_defaults(&settings);
-
-    if (use_dverts) {
-      BLI_task_parallel_mempool(
-          em_target->bm->vpool, &data, armature_vert_task_editmesh, &settings);
-    }
-    else {
-      BLI_task_parallel_mempool(
-          em_target->bm->vpool, &data, armature_vert_task_editmesh_no_dvert, &settings);
-    }
+  if (weight_cache) {
+    BKE_armature_weight_cache_release(weight_cache);
   }
   else {
-    TaskParallelSettings settings;
-    BLI_parallel_range_settings_defaults(&settings);
-    settings.min_iter_per_thread = 32;
-    BLI_task_parallel_range(0, vert_coords_len, &data, armature_vert_task, &settings);
+    armature_weight_table_free(&weight_table);
   }
 
   if (pchan_from_defbase) {
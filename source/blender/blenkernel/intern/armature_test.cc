@@ -1,12 +1,31 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later
  * Copyright 2020 Blender Foundation. All rights reserved. */
 
-#include "BKE_armature.hh"
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
 
+#include "BKE_action.h"
+#include "BKE_armature.hh"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.hh"
+#include "BKE_mesh_runtime.h"
+#include "BKE_mesh_types.h"
+#include "BKE_object.h"
+#include "BKE_object_deform.h"
+
+#include "BLI_array.hh"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_math_vector_types.hh"
 
-#include "DNA_armature_types.h"
+#include "MEM_guardedalloc.h"
 
 #include "testing/testing.h"
 
@@ -423,4 +442,108 @@ TEST_F(BKE_armature_find_selected_bones_test, all_bones_selected)
   EXPECT_FALSE(result.no_bones_selected);
 }
 
+class BKE_armature_deform_weight_cache_test : public testing::Test {
+ protected:
+  /* Weights of the vertices for the only bone, which moves them by one along Z. */
+  static constexpr float weights[4] = {1.0f, 0.5f, 0.0f, 0.25f};
+
+  Main *bmain;
+  Bone bone = {nullptr};
+  Object *ob_arm;
+  Object *ob_target;
+  Mesh *mesh;
+
+  void SetUp() override
+  {
+    BKE_idtype_init();
+    bmain = BKE_main_new();
+
+    ob_arm = BKE_object_add_only_object(bmain, OB_ARMATURE, "Armature");
+    ob_arm->data = BKE_armature_add(bmain, "Armature");
+    ob_arm->pose = MEM_cnew<bPose>(__func__);
+    bone.segments = 1;
+    bPoseChannel *pchan = BKE_pose_channel_ensure(ob_arm->pose, "Bone");
+    pchan->bone = &bone;
+    unit_m4(pchan->chan_mat);
+    pchan->chan_mat[3][2] = 1.0f;
+
+    /* The original mesh doesn't need to be in #Main, like copy-on-write meshes. */
+    mesh = BKE_mesh_new_nomain(4, 0, 0, 0);
+    mesh->vert_positions_for_write().fill(float3(0.0f));
+    ob_target = BKE_object_add_only_object(bmain, OB_MESH, "Target");
+    ob_target->data = mesh;
+    BKE_object_defgroup_add_name(ob_target, "Bone");
+    MDeformVert *dverts = BKE_mesh_deform_verts_for_write(mesh);
+    for (const int i : IndexRange(4)) {
+      BKE_defvert_add_index_notest(&dverts[i], 0, weights[i]);
+    }
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(nullptr, mesh);
+    ob_target->data = nullptr;
+    BKE_main_free(bmain);
+  }
+
+  /** Deform the vertex positions of `mesh_eval`, which is freed. */
+  Array<float3> deform(Mesh *mesh_eval)
+  {
+    Array<float3> positions(mesh_eval->vert_positions());
+    BKE_armature_deform_coords_with_mesh(ob_arm,
+                                         ob_target,
+                                         reinterpret_cast<float(*)[3]>(positions.data()),
+                                         nullptr,
+                                         int(positions.size()),
+                                         ARM_DEF_VGROUP,
+                                         nullptr,
+                                         nullptr,
+                                         mesh_eval);
+    BKE_id_free(nullptr, mesh_eval);
+    return positions;
+  }
+
+  /** Deform a copy of the mesh, like the evaluation of an armature modifier does. */
+  Array<float3> deform_evaluated_copy()
+  {
+    return this->deform(BKE_mesh_copy_for_eval(mesh, true));
+  }
+};
+
+TEST_F(BKE_armature_deform_weight_cache_test, reused_for_evaluated_copies)
+{
+  const Array<float3> positions_first = this->deform_evaluated_copy();
+  const ArmatureWeightCache *cache = mesh->runtime->armature_weight_cache;
+  ASSERT_NE(cache, nullptr);
+
+  const Array<float3> positions_second = this->deform_evaluated_copy();
+  EXPECT_EQ(mesh->runtime->armature_weight_cache, cache);
+
+  /* Weights that aren't shared with the original mesh don't use the cache. */
+  Mesh *mesh_unshared = BKE_mesh_copy_for_eval(mesh, true);
+  BKE_mesh_deform_verts_for_write(mesh_unshared);
+  const Array<float3> positions_unshared = this->deform(mesh_unshared);
+  EXPECT_EQ(mesh->runtime->armature_weight_cache, cache);
+
+  for (const int i : IndexRange(4)) {
+    EXPECT_EQ(positions_first[i], float3(0.0f, 0.0f, weights[i]));
+    EXPECT_EQ(positions_second[i], positions_first[i]);
+    EXPECT_EQ(positions_unshared[i], positions_first[i]);
+  }
+}
+
+TEST_F(BKE_armature_deform_weight_cache_test, weights_changed)
+{
+  this->deform_evaluated_copy();
+  ASSERT_NE(mesh->runtime->armature_weight_cache, nullptr);
+
+  /* Changing weights copies the data shared with the cache. */
+  MDeformVert *dverts = BKE_mesh_deform_verts_for_write(mesh);
+  dverts[2].dw[0].weight = 1.0f;
+
+  const Array<float3> positions = this->deform_evaluated_copy();
+  EXPECT_EQ(positions[2], float3(0.0f, 0.0f, 1.0f));
+  EXPECT_EQ(positions[3], float3(0.0f, 0.0f, 0.25f));
+}
+
 }  // namespace blender::bke::tests
@@ -20,6 +20,7 @@
 #include "DNA_pointcloud_types.h"
 
 #include "BLI_index_range.hh"
+#include "BLI_span.hh"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
 #include "BLI_string_utils.h"
@@ -28,6 +29,7 @@
 
 #include "BKE_attribute.h"
 #include "BKE_attribute.hh"
+#include "BKE_attribute_compression.hh"
 #include "BKE_curves.hh"
 #include "BKE_customdata.h"
 #include "BKE_editmesh.h"
@@ -498,6 +500,114 @@ bool BKE_id_attribute_remove(ID *id, const char *name, ReportList *reports)
   return attributes->remove(name);
 }
 
+bool BKE_id_attribute_compress(ID *id,
+                               const char *name,
+                               const eCustomDataType compressed_type,
+                               ReportList *reports)
+{
+  using namespace blender;
+  using namespace blender::bke;
+  if (!custom_data_type_is_compressed(compressed_type)) {
+    BKE_report(reports, RPT_ERROR, "Type is not a compressed attribute type");
+    return false;
+  }
+  if (GS(id->name) == ID_ME && reinterpret_cast<Mesh *>(id)->edit_mesh) {
+    BKE_report(reports, RPT_ERROR, "Attributes can't be compressed in edit mode");
+    return false;
+  }
+
+  std::optional<MutableAttributeAccessor> attributes = get_attribute_accessor_for_write(*id);
+  if (!attributes) {
+    return false;
+  }
+  const std::optional<AttributeMetaData> metadata = attributes->lookup_meta_data(name);
+  if (!metadata) {
+    BKE_report(reports, RPT_ERROR, "Attribute is not part of this geometry");
+    return false;
+  }
+  if (attributes->is_builtin(name)) {
+    BKE_report(reports, RPT_ERROR, "Built-in attributes can't be compressed");
+    return false;
+  }
+  /* UV maps are accessed directly as #CD_PROP_FLOAT2 layers by drawing, rendering and editing
+   * code, which doesn't decode compressed layers. */
+  if (GS(id->name) == ID_ME && metadata->domain == ATTR_DOMAIN_CORNER &&
+      metadata->data_type == CD_PROP_FLOAT2)
+  {
+    BKE_report(reports, RPT_ERROR, "UV maps can't be compressed");
+    return false;
+  }
+  if (metadata->data_type != custom_data_type_decompressed(compressed_type)) {
+    BKE_report(reports, RPT_ERROR, "Attribute type doesn't match the compressed type");
+    return false;
+  }
+
+  DomainInfo info[ATTR_DOMAIN_NUM];
+  get_domains(id, info);
+  const DomainInfo &domain_info = info[metadata->domain];
+  if (!compress_attribute(*domain_info.customdata, name, compressed_type, domain_info.length)) {
+    BKE_report(reports, RPT_ERROR, "Attribute values are out of range of the compressed type");
+    return false;
+  }
+  return true;
+}
+
+bool BKE_id_attribute_decompress(ID *id, const char *name, ReportList *reports)
+{
+  using namespace blender::bke;
+  if (GS(id->name) == ID_ME && reinterpret_cast<Mesh *>(id)->edit_mesh) {
+    BKE_report(reports, RPT_ERROR, "Attributes can't be decompressed in edit mode");
+    return false;
+  }
+
+  DomainInfo info[ATTR_DOMAIN_NUM];
+  get_domains(id, info);
+  for (const int domain : IndexRange(ATTR_DOMAIN_NUM)) {
+    if (CustomData *data = info[domain].customdata) {
+      if (decompress_attribute(*data, name, info[domain].length)) {
+        return true;
+      }
+    }
+  }
+  BKE_report(reports, RPT_ERROR, "No compressed attribute with this name");
+  return false;
+}
+
+int BKE_id_attributes_decompress_all(ID *id)
+{
+  using namespace blender::bke;
+  if (GS(id->name) == ID_ME && reinterpret_cast<Mesh *>(id)->edit_mesh) {
+    return 0;
+  }
+
+  int decompressed_num = 0;
+  DomainInfo info[ATTR_DOMAIN_NUM];
+  get_domains(id, info);
+  for (const int domain : IndexRange(ATTR_DOMAIN_NUM)) {
+    CustomData *data = info[domain].customdata;
+    if (data == nullptr) {
+      continue;
+    }
+    /* Decompressing replaces the layer, so look up the next compressed layer every time. */
+    while (true) {
+      const CustomDataLayer *layer = nullptr;
+      for (const CustomDataLayer &iter : blender::Span(data->layers, data->totlayer)) {
+        if (custom_data_type_is_compressed(eCustomDataType(iter.type))) {
+          layer = &iter;
+          break;
+        }
+      }
+      if (layer == nullptr) {
+        break;
+      }
+      const std::string name = layer->name;
+      decompress_attribute(*data, name, info[domain].length);
+      decompressed_num++;
+    }
+  }
+  return decompressed_num;
+}
+
 CustomDataLayer *BKE_id_attribute_find(const ID *id,
                                        const char *name,
                                        const int type,
@@ -2,6 +2,7 @@
 
 #include <utility>
 
+#include "BKE_attribute_compression.hh"
 #include "BKE_attribute_math.hh"
 #include "BKE_customdata.h"
 #include "BKE_deform.h"
@@ -456,6 +457,10 @@ GAttributeReader CustomDataAttributeProvider::try_get_for_read(
     if (!custom_data_layer_matches_attribute_id(layer, attribute_id)) {
       continue;
     }
+    if (custom_data_type_is_compressed((eCustomDataType)layer.type)) {
+      return {compressed_layer_to_varray((eCustomDataType)layer.type, layer.data, element_num),
+              domain_};
+    }
     const CPPType *type = custom_data_type_to_cpp_type((eCustomDataType)layer.type);
     if (type == nullptr) {
       continue;
@@ -480,6 +485,11 @@ GAttributeWriter CustomDataAttributeProvider::try_get_for_write(
     }
     CustomData_get_layer_named_for_write(custom_data, layer.type, layer.name, element_num);
 
+    if (custom_data_type_is_compressed((eCustomDataType)layer.type)) {
+      return {compressed_layer_to_varray_for_write(
+                  (eCustomDataType)layer.type, layer.data, element_num),
+              domain_};
+    }
     const CPPType *type = custom_data_type_to_cpp_type((eCustomDataType)layer.type);
     if (type == nullptr) {
       continue;
@@ -518,7 +528,7 @@ bool CustomDataAttributeProvider::try_create(void *owner,
   if (domain_ != domain) {
     return false;
   }
-  if (!this->type_is_supported(data_type)) {
+  if (!this->type_is_supported(data_type) || custom_data_type_is_compressed(data_type)) {
     return false;
   }
   CustomData *custom_data = custom_data_access_.get_custom_data(owner);
@@ -546,7 +556,7 @@ bool CustomDataAttributeProvider::foreach_attribute(const void *owner,
   for (const CustomDataLayer &layer : Span(custom_data->layers, custom_data->totlayer)) {
     const eCustomDataType data_type = (eCustomDataType)layer.type;
     if (this->type_is_supported(data_type)) {
-      AttributeMetaData meta_data{domain_, data_type};
+      AttributeMetaData meta_data{domain_, custom_data_type_decompressed(data_type)};
       const AttributeIDRef attribute_id = attribute_id_from_custom_data_layer(layer);
       if (!callback(attribute_id, meta_data)) {
         return false;
@@ -640,6 +650,7 @@ std::optional<GMutableSpan> CustomDataAttributes::get_for_write(const AttributeI
     if (custom_data_layer_matches_attribute_id(layer, attribute_id)) {
       const CPPType *cpp_type = custom_data_type_to_cpp_type((eCustomDataType)layer.type);
       BLI_assert(cpp_type != nullptr);
+      CustomData_ensure_data_is_mutable(&layer, size_);
       return GMutableSpan(*cpp_type, layer.data, size_);
     }
   }
@@ -125,7 +125,8 @@ class DynamicAttributesProvider {
  */
 class CustomDataAttributeProvider final : public DynamicAttributesProvider {
  private:
-  static constexpr uint64_t supported_types_mask = CD_MASK_PROP_ALL;
+  /* Compressed layers are accessed with their decompressed type, they can't be created here. */
+  static constexpr uint64_t supported_types_mask = CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED;
   const eAttrDomain domain_;
   const CustomDataAccessInfo custom_data_access_;
 
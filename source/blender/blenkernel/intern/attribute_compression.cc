@@ -0,0 +1,212 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_quantize.hh"
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "BKE_attribute_compression.hh"
+#include "BKE_customdata.h"
+
+namespace blender::bke {
+
+bool custom_data_type_is_compressed(const eCustomDataType type)
+{
+  return ELEM(type, CD_PROP_FLOAT3_HALF, CD_PROP_FLOAT2_UNORM16, CD_PROP_NORMAL_OCT);
+}
+
+eCustomDataType custom_data_type_decompressed(const eCustomDataType type)
+{
+  switch (type) {
+    case CD_PROP_FLOAT3_HALF:
+    case CD_PROP_NORMAL_OCT:
+      return CD_PROP_FLOAT3;
+    case CD_PROP_FLOAT2_UNORM16:
+      return CD_PROP_FLOAT2;
+    default:
+      return type;
+  }
+}
+
+static float3 get_half3(const ushort3 &value)
+{
+  return math::half_to_float(value);
+}
+static void set_half3(ushort3 &value, float3 new_value)
+{
+  value = math::float_to_half(new_value);
+}
+static float2 get_unorm16_2(const ushort2 &value)
+{
+  return math::unorm16_to_float(value);
+}
+static void set_unorm16_2(ushort2 &value, float2 new_value)
+{
+  value = math::float_to_unorm16(new_value);
+}
+static float3 get_normal_oct(const short2 &value)
+{
+  return math::octahedral_to_normal(value);
+}
+static void set_normal_oct(short2 &value, float3 new_value)
+{
+  value = math::normal_to_octahedral(new_value);
+}
+
+GVArray compressed_layer_to_varray(const eCustomDataType type,
+                                   const void *data,
+                                   const int64_t size)
+{
+  switch (type) {
+    case CD_PROP_FLOAT3_HALF:
+      return VArray<float3>::ForDerivedSpan<ushort3, get_half3>(
+          {static_cast<const ushort3 *>(data), size});
+    case CD_PROP_FLOAT2_UNORM16:
+      return VArray<float2>::ForDerivedSpan<ushort2, get_unorm16_2>(
+          {static_cast<const ushort2 *>(data), size});
+    case CD_PROP_NORMAL_OCT:
+      return VArray<float3>::ForDerivedSpan<short2, get_normal_oct>(
+          {static_cast<const short2 *>(data), size});
+    default:
+      BLI_assert_unreachable();
+      return {};
+  }
+}
+
+GVMutableArray compressed_layer_to_varray_for_write(const eCustomDataType type,
+                                                    void *data,
+                                                    const int64_t size)
+{
+  switch (type) {
+    case CD_PROP_FLOAT3_HALF:
+      return VMutableArray<float3>::ForDerivedSpan<ushort3, get_half3, set_half3>(
+          {static_cast<ushort3 *>(data), size});
+    case CD_PROP_FLOAT2_UNORM16:
+      return VMutableArray<float2>::ForDerivedSpan<ushort2, get_unorm16_2, set_unorm16_2>(
+          {static_cast<ushort2 *>(data), size});
+    case CD_PROP_NORMAL_OCT:
+      return VMutableArray<float3>::ForDerivedSpan<short2, get_normal_oct, set_normal_oct>(
+          {static_cast<short2 *>(data), size});
+    default:
+      BLI_assert_unreachable();
+      return {};
+  }
+}
+
+static int find_named_layer(const CustomData &custom_data,
+                            const StringRef name,
+                            const FunctionRef<bool(eCustomDataType)> type_fn)
+{
+  for (const int i : IndexRange(custom_data.totlayer)) {
+    const CustomDataLayer &layer = custom_data.layers[i];
+    if (layer.anonymous_id == nullptr && layer.name == name &&
+        type_fn(eCustomDataType(layer.type))) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static bool values_can_be_compressed(const eCustomDataType compressed_type,
+                                     const void *data,
+                                     const int element_num)
+{
+  switch (compressed_type) {
+    case CD_PROP_FLOAT3_HALF: {
+      const Span<float3> values(static_cast<const float3 *>(data), element_num);
+      return std::all_of(values.begin(), values.end(), [](const float3 &value) {
+        const float3 value_abs = math::abs(value);
+        return std::max({value_abs.x, value_abs.y, value_abs.z}) <= 65504.0f;
+      });
+    }
+    case CD_PROP_FLOAT2_UNORM16: {
+      const Span<float2> values(static_cast<const float2 *>(data), element_num);
+      return std::all_of(values.begin(), values.end(), [](const float2 &value) {
+        return value.x >= 0.0f && value.x <= 1.0f && value.y >= 0.0f && value.y <= 1.0f;
+      });
+    }
+    case CD_PROP_NORMAL_OCT: {
+      const Span<float3> values(static_cast<const float3 *>(data), element_num);
+      return std::all_of(values.begin(), values.end(), [](const float3 &value) {
+        return std::abs(math::length_squared(value) - 1.0f) < 1e-3f;
+      });
+    }
+    default:
+      BLI_assert_unreachable();
+      return false;
+  }
+}
+
+/**
+ * Replace the layer with a new layer of the given type with the same name. The old layer's values
+ * are read with a virtual array and written to the new layer's virtual array.
+ */
+static void replace_layer(CustomData &custom_data,
+                          const int layer_index,
+                          const eCustomDataType new_type,
+                          const GVArray &src,
+                          const int element_num)
+{
+  void *new_data = MEM_malloc_arrayN(
+      size_t(element_num), size_t(CustomData_sizeof(new_type)), __func__);
+  GVMutableArray dst = custom_data_type_is_compressed(new_type) ?
+                           compressed_layer_to_varray_for_write(new_type, new_data, element_num) :
+                           GVMutableArray::ForSpan(
+                               {*custom_data_type_to_cpp_type(new_type), new_data, element_num});
+  threading::parallel_for(IndexRange(element_num), 4096, [&](const IndexRange range) {
+    BUFFER_FOR_CPP_TYPE_VALUE(src.type(), buffer);
+    for (const int64_t i : range) {
+      src.get_to_uninitialized(i, buffer);
+      dst.set_by_relocate(i, buffer);
+    }
+  });
+
+  CustomDataLayer &layer = custom_data.layers[layer_index];
+  char name[MAX_CUSTOMDATA_LAYER_NAME];
+  STRNCPY(name, layer.name);
+  CustomData_free_layer(&custom_data, layer.type, element_num, layer_index);
+  CustomData_add_layer_named_with_data(&custom_data, new_type, new_data, element_num, name);
+}
+
+bool compress_attribute(CustomData &custom_data,
+                        const StringRef name,
+                        const eCustomDataType compressed_type,
+                        const int element_num)
+{
+  BLI_assert(custom_data_type_is_compressed(compressed_type));
+  const eCustomDataType decompressed_type = custom_data_type_decompressed(compressed_type);
+  const int layer_index = find_named_layer(
+      custom_data, name, [&](const eCustomDataType type) { return type == decompressed_type; });
+  if (layer_index == -1) {
+    return false;
+  }
+  const CustomDataLayer &layer = custom_data.layers[layer_index];
+  if (!values_can_be_compressed(compressed_type, layer.data, element_num)) {
+    return false;
+  }
+  const GVArray src = GVArray::ForSpan(
+      {*custom_data_type_to_cpp_type(decompressed_type), layer.data, element_num});
+  replace_layer(custom_data, layer_index, compressed_type, src, element_num);
+  return true;
+}
+
+bool decompress_attribute(CustomData &custom_data, const StringRef name, const int element_num)
+{
+  const int layer_index = find_named_layer(custom_data, name, custom_data_type_is_compressed);
+  if (layer_index == -1) {
+    return false;
+  }
+  const CustomDataLayer &layer = custom_data.layers[layer_index];
+  const eCustomDataType compressed_type = eCustomDataType(layer.type);
+  const GVArray src = compressed_layer_to_varray(compressed_type, layer.data, element_num);
+  replace_layer(
+      custom_data, layer_index, custom_data_type_decompressed(compressed_type), src, element_num);
+  return true;
+}
+
+}  // namespace blender::bke
@@ -0,0 +1,130 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_math_vector.hh"
+
+#include "DNA_mesh_types.h"
+
+#include "BKE_attribute.h"
+#include "BKE_attribute.hh"
+#include "BKE_attribute_compression.hh"
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+namespace blender::bke::tests {
+
+TEST(attribute_compression, CompressHalfFloat3)
+{
+  CustomData data;
+  CustomData_reset(&data);
+  float3 *values = static_cast<float3 *>(
+      CustomData_add_layer_named(&data, CD_PROP_FLOAT3, CD_SET_DEFAULT, 3, "value"));
+  values[0] = float3(1.0f, 2.0f, 3.0f);
+  values[1] = float3(-0.1f, 100.0f, 0.0f);
+  values[2] = float3(0.5f);
+
+  EXPECT_TRUE(compress_attribute(data, "value", CD_PROP_FLOAT3_HALF, 3));
+  EXPECT_FALSE(CustomData_has_layer(&data, CD_PROP_FLOAT3));
+  const void *compressed = CustomData_get_layer_named(&data, CD_PROP_FLOAT3_HALF, "value");
+  ASSERT_NE(compressed, nullptr);
+
+  const VArray<float3> varray = compressed_layer_to_varray(CD_PROP_FLOAT3_HALF, compressed, 3)
+                                    .typed<float3>();
+  EXPECT_EQ(varray[0], float3(1.0f, 2.0f, 3.0f));
+  EXPECT_V3_NEAR(varray[1], float3(-0.1f, 100.0f, 0.0f), 0.05f);
+
+  void *compressed_for_write = CustomData_get_layer_named_for_write(
+      &data, CD_PROP_FLOAT3_HALF, "value", 3);
+  VMutableArray<float3> varray_for_write =
+      compressed_layer_to_varray_for_write(CD_PROP_FLOAT3_HALF, compressed_for_write, 3)
+          .typed<float3>();
+  varray_for_write.set(2, float3(4.0f));
+
+  EXPECT_TRUE(decompress_attribute(data, "value", 3));
+  const float3 *decompressed = static_cast<const float3 *>(
+      CustomData_get_layer_named(&data, CD_PROP_FLOAT3, "value"));
+  ASSERT_NE(decompressed, nullptr);
+  EXPECT_EQ(decompressed[0], float3(1.0f, 2.0f, 3.0f));
+  EXPECT_EQ(decompressed[2], float3(4.0f));
+
+  CustomData_free(&data, 3);
+}
+
+TEST(attribute_compression, UVOutOfRange)
+{
+  CustomData data;
+  CustomData_reset(&data);
+  float2 *values = static_cast<float2 *>(
+      CustomData_add_layer_named(&data, CD_PROP_FLOAT2, CD_SET_DEFAULT, 2, "uv"));
+  values[0] = float2(0.25f, 0.5f);
+  values[1] = float2(1.5f, 0.5f);
+
+  /* Values outside of the unit square can't be stored, the layer isn't changed. */
+  EXPECT_FALSE(compress_attribute(data, "uv", CD_PROP_FLOAT2_UNORM16, 2));
+  EXPECT_EQ(CustomData_get_layer_named(&data, CD_PROP_FLOAT2, "uv"), values);
+
+  values[1] = float2(1.0f, 0.5f);
+  EXPECT_TRUE(compress_attribute(data, "uv", CD_PROP_FLOAT2_UNORM16, 2));
+  const void *compressed = CustomData_get_layer_named(&data, CD_PROP_FLOAT2_UNORM16, "uv");
+  const VArray<float2> varray = compressed_layer_to_varray(CD_PROP_FLOAT2_UNORM16, compressed, 2)
+                                    .typed<float2>();
+  EXPECT_V2_NEAR(varray[0], float2(0.25f, 0.5f), 1e-4f);
+  EXPECT_V2_NEAR(varray[1], float2(1.0f, 0.5f), 1e-4f);
+
+  CustomData_free(&data, 2);
+}
+
+TEST(attribute_compression, OctahedralNormals)
+{
+  CustomData data;
+  CustomData_reset(&data);
+  float3 *values = static_cast<float3 *>(
+      CustomData_add_layer_named(&data, CD_PROP_FLOAT3, CD_SET_DEFAULT, 2, "normal"));
+  values[0] = math::normalize(float3(1.0f, -2.0f, 0.5f));
+  values[1] = float3(2.0f, 0.0f, 0.0f);
+
+  /* Only normalized vectors can be stored. */
+  EXPECT_FALSE(compress_attribute(data, "normal", CD_PROP_NORMAL_OCT, 2));
+
+  values[1] = float3(0.0f, 0.0f, -1.0f);
+  EXPECT_TRUE(compress_attribute(data, "normal", CD_PROP_NORMAL_OCT, 2));
+  const void *compressed = CustomData_get_layer_named(&data, CD_PROP_NORMAL_OCT, "normal");
+  const VArray<float3> varray = compressed_layer_to_varray(CD_PROP_NORMAL_OCT, compressed, 2)
+                                    .typed<float3>();
+  EXPECT_V3_NEAR(varray[0], math::normalize(float3(1.0f, -2.0f, 0.5f)), 1e-4f);
+  EXPECT_V3_NEAR(varray[1], float3(0.0f, 0.0f, -1.0f), 1e-6f);
+
+  CustomData_free(&data, 2);
+}
+
+TEST(attribute_compression, MeshAttributeOptIn)
+{
+  BKE_idtype_init();
+  Mesh *mesh = BKE_mesh_new_nomain(4, 0, 4, 1);
+  MutableAttributeAccessor attributes = mesh->attributes_for_write();
+  attributes.add("uv", ATTR_DOMAIN_CORNER, CD_PROP_FLOAT2, AttributeInitDefaultValue());
+  attributes.add("offset", ATTR_DOMAIN_POINT, CD_PROP_FLOAT2, AttributeInitDefaultValue());
+
+  /* UV maps and built-in attributes are accessed directly by code that doesn't decode them. */
+  EXPECT_FALSE(BKE_id_attribute_compress(&mesh->id, "uv", CD_PROP_FLOAT2_UNORM16, nullptr));
+  EXPECT_NE(CustomData_get_layer_named(&mesh->ldata, CD_PROP_FLOAT2, "uv"), nullptr);
+  EXPECT_FALSE(BKE_id_attribute_compress(&mesh->id, "position", CD_PROP_FLOAT3_HALF, nullptr));
+  EXPECT_FALSE(BKE_id_attribute_compress(&mesh->id, "offset", CD_PROP_FLOAT3_HALF, nullptr));
+
+  EXPECT_TRUE(BKE_id_attribute_compress(&mesh->id, "offset", CD_PROP_FLOAT2_UNORM16, nullptr));
+  EXPECT_NE(CustomData_get_layer_named(&mesh->vdata, CD_PROP_FLOAT2_UNORM16, "offset"),
+            nullptr);
+  EXPECT_EQ(BKE_id_attributes_decompress_all(&mesh->id), 1);
+  EXPECT_NE(CustomData_get_layer_named(&mesh->vdata, CD_PROP_FLOAT2, "offset"), nullptr);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
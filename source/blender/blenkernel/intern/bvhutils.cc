@@ -151,6 +151,62 @@ void bvhcache_free(BVHCache *bvh_cache)
   MEM_freeN(bvh_cache);
 }
 
+struct BVHTreePool {
+  std::mutex mutex;
+  BVHTree *trees[BVHTREE_MAX_ITEM] = {};
+
+  ~BVHTreePool()
+  {
+    for (BVHTree *tree : trees) {
+      BLI_bvhtree_free(tree);
+    }
+  }
+};
+
+/**
+ * Whether the tree type only depends on the vertex positions and the topology, so that it can be
+ * refit when the positions change. The masks of other types depend on attributes or on data that
+ * is more expensive to compare.
+ */
+static bool bvhcache_type_is_refittable(const BVHCacheType type)
+{
+  return ELEM(type,
+              BVHTREE_FROM_VERTS,
+              BVHTREE_FROM_EDGES,
+              BVHTREE_FROM_LOOPTRI,
+              BVHTREE_FROM_LOOSEEDGES);
+}
+
+std::shared_ptr<BVHTreePool> bvhtree_pool_new()
+{
+  return std::make_shared<BVHTreePool>();
+}
+
+void bvhcache_free_to_pool(BVHCache *bvh_cache, BVHTreePool &pool)
+{
+  {
+    std::lock_guard lock{pool.mutex};
+    for (int index = 0; index < BVHTREE_MAX_ITEM; index++) {
+      BVHCacheItem *item = &bvh_cache->items[index];
+      if (item->tree == nullptr || pool.trees[index] != nullptr ||
+          !bvhcache_type_is_refittable(BVHCacheType(index))) {
+        continue;
+      }
+      pool.trees[index] = item->tree;
+      item->tree = nullptr;
+    }
+  }
+  bvhcache_free(bvh_cache);
+}
+
+static BVHTree *bvhtree_pool_pop(BVHTreePool &pool, const BVHCacheType type)
+{
+  std::lock_guard lock{pool.mutex};
+  BVHTree *tree = pool.trees[type];
+  pool.trees[type] = nullptr;
+  return tree;
+}
+
 /**
  * BVH-tree balancing inside a mutex lock must be run in isolation. Balancing
  * is multithreaded, and we do not want the current thread to start another task
@@ -170,6 +226,61 @@ static void bvhtree_balance(BVHTree *tree, const bool isolate)
     else {
       BLI_bvhtree_balance(tree);
     }
+    /* These trees are mostly used for ray-casts and nearest point queries. */
+    BLI_bvhtree_wide_nodes_ensure(tree);
+  }
+}
+
+struct BVHTreeRefitData {
+  BVHTree *tree;
+  BVHCacheType type;
+  const float (*positions)[3];
+  const MEdge *edges;
+  const int *corner_verts;
+  const MLoopTri *looptris;
+};
+
+static int bvhtree_refit_leaf_cb(void *userdata,
+                                 const int index,
+                                 float r_co[BVH_REFIT_POINTS_MAX][3])
+{
+  const BVHTreeRefitData *data = static_cast<const BVHTreeRefitData *>(userdata);
+  switch (data->type) {
+    case BVHTREE_FROM_VERTS:
+      copy_v3_v3(r_co[0], data->positions[index]);
+      return 1;
+    case BVHTREE_FROM_EDGES:
+    case BVHTREE_FROM_LOOSEEDGES:
+      copy_v3_v3(r_co[0], data->positions[data->edges[index].v1]);
+      copy_v3_v3(r_co[1], data->positions[data->edges[index].v2]);
+      return 2;
+    case BVHTREE_FROM_LOOPTRI: {
+      const MLoopTri &lt = data->looptris[index];
+      copy_v3_v3(r_co[0], data->positions[data->corner_verts[lt.tri[0]]]);
+      copy_v3_v3(r_co[1], data->positions[data->corner_verts[lt.tri[1]]]);
+      copy_v3_v3(r_co[2], data->positions[data->corner_verts[lt.tri[2]]]);
+      return 3;
+    }
+    default:
+      BLI_assert_unreachable();
+      return 0;
+  }
+}
+
+/** Similar to #bvhtree_balance_isolated, refitting is multithreaded too. */
+static void bvhtree_refit_isolated(void *userdata)
+{
+  BVHTreeRefitData *data = static_cast<BVHTreeRefitData *>(userdata);
+  BLI_bvhtree_refit(data->tree, bvhtree_refit_leaf_cb, data);
+}
+
+static void bvhtree_refit(BVHTreeRefitData *data, const bool isolate)
+{
+  if (isolate) {
+    BLI_task_isolate(bvhtree_refit_isolated, data);
+  }
+  else {
+    BLI_bvhtree_refit(data->tree, bvhtree_refit_leaf_cb, data);
   }
 }
 
@@ -1205,6 +1316,59 @@ static BitVector<> looptri_no_hidden_map_get(const Span<MPoly> polys,
   return looptri_mask;
 }
 
+/**
+ * Take a tree of the given type from the mesh's #BVHTreePool and refit it to the mesh's positions.
+ * \return The refit tree, or null if there is no tree that matches the mesh.
+ */
+static BVHTree *bvhtree_from_mesh_pool_refit(const Mesh &mesh,
+                                             const BVHCacheType bvh_cache_type,
+                                             const int tree_type,
+                                             const bool isolate)
+{
+  BVHTree *tree = bvhtree_pool_pop(*mesh.runtime->bvh_tree_pool, bvh_cache_type);
+  if (tree == nullptr) {
+    return nullptr;
+  }
+
+  BVHTreeRefitData refit_data{};
+  refit_data.tree = tree;
+  refit_data.type = bvh_cache_type;
+  refit_data.positions = reinterpret_cast<const float(*)[3]>(mesh.vert_positions().data());
+  refit_data.edges = mesh.edges().data();
+  int leafs_num = 0;
+  switch (bvh_cache_type) {
+    case BVHTREE_FROM_VERTS:
+      leafs_num = mesh.totvert;
+      break;
+    case BVHTREE_FROM_EDGES:
+      leafs_num = mesh.totedge;
+      break;
+    case BVHTREE_FROM_LOOSEEDGES:
+      leafs_num = mesh.loose_edges().count;
+      break;
+    case BVHTREE_FROM_LOOPTRI: {
+      const Span<MLoopTri> looptris = mesh.looptris();
+      refit_data.corner_verts = mesh.corner_verts().data();
+      refit_data.looptris = looptris.data();
+      leafs_num = int(looptris.size());
+      break;
+    }
+    default:
+      BLI_assert_unreachable();
+      break;
+  }
+
+  /* The topology should be the same, but check the basics anyway since the tree would be
+   * invalid otherwise. */
+  if (BLI_bvhtree_get_tree_type(tree) != tree_type || BLI_bvhtree_get_len(tree) != leafs_num) {
+    BLI_bvhtree_free(tree);
+    return nullptr;
+  }
+
+  bvhtree_refit(&refit_data, isolate);
+  return tree;
+}
+
 BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
                                    const struct Mesh *mesh,
                                    const BVHCacheType bvh_cache_type,
@@ -1241,6 +1405,18 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
     return data->tree;
   }
 
+  /* Refit a tree of a mesh with the same topology if possible, which is much faster than
+   * building a new tree. */
+  if (bvhcache_type_is_refittable(bvh_cache_type)) {
+    data->tree = bvhtree_from_mesh_pool_refit(*mesh, bvh_cache_type, tree_type, lock_started);
+    if (data->tree) {
+      data->cached = true;
+      bvhcache_insert(*bvh_cache_p, data->tree, bvh_cache_type);
+      bvhcache_unlock(*bvh_cache_p, lock_started);
+      return data->tree;
+    }
+  }
+
   /* Create BVHTree. */
   BitVector<> mask;
   int mask_bits_act_len = -1;
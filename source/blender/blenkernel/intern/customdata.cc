@@ -20,9 +20,11 @@
 #include "BLI_bitmap.h"
 #include "BLI_color.hh"
 #include "BLI_endian_switch.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_index_range.hh"
 #include "BLI_math.h"
 #include "BLI_math_color_blend.h"
+#include "BLI_math_quantize.hh"
 #include "BLI_math_vector.hh"
 #include "BLI_mempool.h"
 #include "BLI_path_util.h"
@@ -59,10 +61,15 @@
 #include "data_transfer_intern.h"
 
 using blender::float2;
+using blender::float3;
+using blender::ImplicitSharingInfo;
 using blender::IndexRange;
 using blender::Set;
 using blender::Span;
 using blender::StringRef;
+using blender::short2;
+using blender::ushort2;
+using blender::ushort3;
 using blender::Vector;
 
 /* number of layers to add when growing a CustomData object */
@@ -1575,6 +1582,59 @@ static void layerInterp_propbool(const void **sources,
   *(bool *)dest = result;
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Callbacks for compressed attributes (#CD_MASK_PROP_COMPRESSED)
+ *
+ * Values are decoded, interpolated with full precision and encoded again.
+ * \{ */
+
+static void layerInterp_propfloat3_half(const void **sources,
+                                        const float *weights,
+                                        const float * /*sub_weights*/,
+                                        int count,
+                                        void *dest)
+{
+  float3 result(0.0f);
+  for (int i = 0; i < count; i++) {
+    result += blender::math::half_to_float(*static_cast<const ushort3 *>(sources[i])) *
+              weights[i];
+  }
+  *static_cast<ushort3 *>(dest) = blender::math::float_to_half(result);
+}
+
+static void layerInterp_propfloat2_unorm16(const void **sources,
+                                           const float *weights,
+                                           const float * /*sub_weights*/,
+                                           int count,
+                                           void *dest)
+{
+  float2 result(0.0f);
+  for (int i = 0; i < count; i++) {
+    result += blender::math::unorm16_to_float(*static_cast<const ushort2 *>(sources[i])) *
+              weights[i];
+  }
+  *static_cast<ushort2 *>(dest) = blender::math::float_to_unorm16(result);
+}
+
+static void layerInterp_propnormal_oct(const void **sources,
+                                       const float *weights,
+                                       const float * /*sub_weights*/,
+                                       int count,
+                                       void *dest)
+{
+  float3 result(0.0f);
+  for (int i = 0; i < count; i++) {
+    result += blender::math::octahedral_to_normal(*static_cast<const short2 *>(sources[i])) *
+              weights[i];
+  }
+  *static_cast<short2 *>(dest) = blender::math::normal_to_octahedral(
+      blender::math::normalize(result));
+}
+
+/** \} */
+
 static const LayerTypeInfo LAYERTYPEINFO[CD_NUMTYPES] = {
     /* 0: CD_MVERT */ /* DEPRECATED */
     {sizeof(MVert), "MVert", 1, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr},
@@ -1966,6 +2026,36 @@ static const LayerTypeInfo LAYERTYPEINFO[CD_NUMTYPES] = {
      nullptr},
     /* 51: CD_HAIRLENGTH */
     {sizeof(float), "float", 1, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr},
+    /* 52: CD_PROP_FLOAT2_UNORM16 */
+    {sizeof(ushort2),
+     "",
+     0,
+     N_("Float2 UNorm16"),
+     nullptr,
+     nullptr,
+     layerInterp_propfloat2_unorm16,
+     nullptr,
+     nullptr},
+    /* 53: CD_PROP_NORMAL_OCT */
+    {sizeof(short2),
+     "",
+     0,
+     N_("Normal Octahedral"),
+     nullptr,
+     nullptr,
+     layerInterp_propnormal_oct,
+     nullptr,
+     nullptr},
+    /* 54: CD_PROP_FLOAT3_HALF */
+    {sizeof(ushort3),
+     "",
+     0,
+     N_("Float3 Half"),
+     nullptr,
+     nullptr,
+     layerInterp_propfloat3_half,
+     nullptr,
+     nullptr},
 };
 
 static const char *LAYERTYPENAMES[CD_NUMTYPES] = {
@@ -2023,6 +2113,9 @@ static const char *LAYERTYPENAMES[CD_NUMTYPES] = {
     "CDPropFloat2",
     "CDPropBoolean",
     "CDHairLength",
+    /* 52-54 */ "CDPropFloat2UNorm16",
+    "CDPropNormalOct",
+    "CDPropFloat3Half",
 };
 
 const CustomData_MeshMasks CD_MASK_BAREMESH = {
@@ -2041,57 +2134,67 @@ const CustomData_MeshMasks CD_MASK_BAREMESH_ORIGINDEX = {
 };
 const CustomData_MeshMasks CD_MASK_MESH = {
     /*vmask*/ (CD_MASK_PROP_FLOAT3 | CD_MASK_MDEFORMVERT | CD_MASK_MVERT_SKIN |
-               CD_MASK_PAINT_MASK | CD_MASK_PROP_ALL | CD_MASK_CREASE | CD_MASK_BWEIGHT),
+               CD_MASK_PAINT_MASK | CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED | CD_MASK_CREASE |
+               CD_MASK_BWEIGHT),
     /*emask*/
-    (CD_MASK_MEDGE | CD_MASK_FREESTYLE_EDGE | CD_MASK_PROP_ALL | CD_MASK_BWEIGHT | CD_MASK_CREASE),
+    (CD_MASK_MEDGE | CD_MASK_FREESTYLE_EDGE | CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED |
+     CD_MASK_BWEIGHT | CD_MASK_CREASE),
     /*fmask*/ 0,
     /*pmask*/
-    (CD_MASK_MPOLY | CD_MASK_FACEMAP | CD_MASK_FREESTYLE_FACE | CD_MASK_PROP_ALL),
+    (CD_MASK_MPOLY | CD_MASK_FACEMAP | CD_MASK_FREESTYLE_FACE | CD_MASK_PROP_ALL |
+     CD_MASK_PROP_COMPRESSED),
     /*lmask*/
-    (CD_MASK_MDISPS | CD_MASK_CUSTOMLOOPNORMAL | CD_MASK_GRID_PAINT_MASK | CD_MASK_PROP_ALL),
+    (CD_MASK_MDISPS | CD_MASK_CUSTOMLOOPNORMAL | CD_MASK_GRID_PAINT_MASK | CD_MASK_PROP_ALL |
+     CD_MASK_PROP_COMPRESSED),
 };
 const CustomData_MeshMasks CD_MASK_DERIVEDMESH = {
     /*vmask*/ (CD_MASK_ORIGINDEX | CD_MASK_MDEFORMVERT | CD_MASK_SHAPEKEY | CD_MASK_MVERT_SKIN |
                CD_MASK_PAINT_MASK | CD_MASK_ORCO | CD_MASK_CLOTH_ORCO | CD_MASK_PROP_ALL |
-               CD_MASK_CREASE | CD_MASK_BWEIGHT),
+               CD_MASK_PROP_COMPRESSED | CD_MASK_CREASE | CD_MASK_BWEIGHT),
     /*emask*/
     (CD_MASK_ORIGINDEX | CD_MASK_FREESTYLE_EDGE | CD_MASK_BWEIGHT | CD_MASK_PROP_ALL |
-     CD_MASK_CREASE),
+     CD_MASK_PROP_COMPRESSED | CD_MASK_CREASE),
     /*fmask*/ (CD_MASK_ORIGINDEX | CD_MASK_ORIGSPACE | CD_MASK_PREVIEW_MCOL | CD_MASK_TANGENT),
     /*pmask*/
-    (CD_MASK_ORIGINDEX | CD_MASK_FREESTYLE_FACE | CD_MASK_FACEMAP | CD_MASK_PROP_ALL),
+    (CD_MASK_ORIGINDEX | CD_MASK_FREESTYLE_FACE | CD_MASK_FACEMAP | CD_MASK_PROP_ALL |
+     CD_MASK_PROP_COMPRESSED),
     /*lmask*/
     (CD_MASK_CUSTOMLOOPNORMAL | CD_MASK_PREVIEW_MLOOPCOL | CD_MASK_ORIGSPACE_MLOOP |
-     CD_MASK_PROP_ALL), /* XXX: MISSING #CD_MASK_MLOOPTANGENT ? */
+     CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED), /* XXX: MISSING #CD_MASK_MLOOPTANGENT ? */
 };
 const CustomData_MeshMasks CD_MASK_BMESH = {
     /*vmask*/ (CD_MASK_MDEFORMVERT | CD_MASK_BWEIGHT | CD_MASK_MVERT_SKIN | CD_MASK_SHAPEKEY |
-               CD_MASK_SHAPE_KEYINDEX | CD_MASK_PAINT_MASK | CD_MASK_PROP_ALL | CD_MASK_CREASE),
-    /*emask*/ (CD_MASK_BWEIGHT | CD_MASK_CREASE | CD_MASK_FREESTYLE_EDGE | CD_MASK_PROP_ALL),
+               CD_MASK_SHAPE_KEYINDEX | CD_MASK_PAINT_MASK | CD_MASK_PROP_ALL |
+               CD_MASK_PROP_COMPRESSED | CD_MASK_CREASE),
+    /*emask*/
+    (CD_MASK_BWEIGHT | CD_MASK_CREASE | CD_MASK_FREESTYLE_EDGE | CD_MASK_PROP_ALL |
+     CD_MASK_PROP_COMPRESSED),
     /*fmask*/ 0,
     /*pmask*/
-    (CD_MASK_FREESTYLE_FACE | CD_MASK_FACEMAP | CD_MASK_PROP_ALL),
+    (CD_MASK_FREESTYLE_FACE | CD_MASK_FACEMAP | CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED),
     /*lmask*/
-    (CD_MASK_MDISPS | CD_MASK_CUSTOMLOOPNORMAL | CD_MASK_GRID_PAINT_MASK | CD_MASK_PROP_ALL),
+    (CD_MASK_MDISPS | CD_MASK_CUSTOMLOOPNORMAL | CD_MASK_GRID_PAINT_MASK | CD_MASK_PROP_ALL |
+     CD_MASK_PROP_COMPRESSED),
 };
 const CustomData_MeshMasks CD_MASK_EVERYTHING = {
     /*vmask*/ (CD_MASK_BM_ELEM_PYPTR | CD_MASK_ORIGINDEX | CD_MASK_MDEFORMVERT | CD_MASK_BWEIGHT |
                CD_MASK_MVERT_SKIN | CD_MASK_ORCO | CD_MASK_CLOTH_ORCO | CD_MASK_SHAPEKEY |
-               CD_MASK_SHAPE_KEYINDEX | CD_MASK_PAINT_MASK | CD_MASK_PROP_ALL | CD_MASK_CREASE),
+               CD_MASK_SHAPE_KEYINDEX | CD_MASK_PAINT_MASK | CD_MASK_PROP_ALL |
+               CD_MASK_PROP_COMPRESSED | CD_MASK_CREASE),
     /*emask*/
     (CD_MASK_MEDGE | CD_MASK_BM_ELEM_PYPTR | CD_MASK_ORIGINDEX | CD_MASK_BWEIGHT | CD_MASK_CREASE |
-     CD_MASK_FREESTYLE_EDGE | CD_MASK_PROP_ALL),
+     CD_MASK_FREESTYLE_EDGE | CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED),
     /*fmask*/
     (CD_MASK_MFACE | CD_MASK_ORIGINDEX | CD_MASK_NORMAL | CD_MASK_MTFACE | CD_MASK_MCOL |
      CD_MASK_ORIGSPACE | CD_MASK_TANGENT | CD_MASK_TESSLOOPNORMAL | CD_MASK_PREVIEW_MCOL |
-     CD_MASK_PROP_ALL),
+     CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED),
     /*pmask*/
     (CD_MASK_MPOLY | CD_MASK_BM_ELEM_PYPTR | CD_MASK_ORIGINDEX | CD_MASK_FACEMAP |
-     CD_MASK_FREESTYLE_FACE | CD_MASK_PROP_ALL),
+     CD_MASK_FREESTYLE_FACE | CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED),
     /*lmask*/
     (CD_MASK_BM_ELEM_PYPTR | CD_MASK_MDISPS | CD_MASK_NORMAL | CD_MASK_CUSTOMLOOPNORMAL |
      CD_MASK_MLOOPTANGENT | CD_MASK_PREVIEW_MLOOPCOL | CD_MASK_ORIGSPACE_MLOOP |
-     CD_MASK_GRID_PAINT_MASK | CD_MASK_PROP_ALL),
+     CD_MASK_GRID_PAINT_MASK | CD_MASK_PROP_ALL | CD_MASK_PROP_COMPRESSED),
 };
 
 static const LayerTypeInfo *layerType_getInfo(int type)
@@ -2158,12 +2261,107 @@ void customData_mask_layers__print(const CustomData_MeshMasks *mask)
 
 static void customData_update_offsets(CustomData *data);
 
-static CustomDataLayer *customData_add_layer__internal(CustomData *data,
-                                                       int type,
-                                                       eCDAllocType alloctype,
-                                                       void *layerdata,
-                                                       int totelem,
-                                                       const char *name);
+static void free_layer_data(const eCustomDataType type, const void *data, const int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+  if (typeInfo->free) {
+    typeInfo->free(const_cast<void *>(data), totelem, typeInfo->size);
+  }
+  MEM_freeN(const_cast<void *>(data));
+}
+
+static void *copy_layer_data(const eCustomDataType type, const void *data, const int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+  void *new_data = MEM_malloc_arrayN(size_t(totelem), typeInfo->size, layerType_getName(type));
+  if (typeInfo->copy) {
+    typeInfo->copy(data, new_data, totelem);
+  }
+  else {
+    BLI_assert(data != nullptr);
+    memcpy(new_data, data, size_t(totelem) * typeInfo->size);
+  }
+  return new_data;
+}
+
+/**
+ * Owns the data array of layers that share it. The layer type's free callback has to be used when
+ * the last user is removed, because the array may reference more allocated data (e.g. the weights
+ * in #MDeformVert).
+ */
+class CustomDataLayerImplicitSharing : public ImplicitSharingInfo {
+ private:
+  const void *data_;
+  int totelem_;
+  eCustomDataType type_;
+
+ public:
+  CustomDataLayerImplicitSharing(const void *data, const int totelem, const eCustomDataType type)
+      : ImplicitSharingInfo(1), data_(data), totelem_(totelem), type_(type)
+  {
+  }
+
+ private:
+  void delete_self_with_data() override
+  {
+    free_layer_data(type_, data_, totelem_);
+    MEM_delete(this);
+  }
+};
+
+static const ImplicitSharingInfo *make_implicit_sharing_info_for_layer(const eCustomDataType type,
+                                                                       const void *data,
+                                                                       const int totelem)
+{
+  return MEM_new<CustomDataLayerImplicitSharing>(__func__, data, totelem, type);
+}
+
+/**
+ * Make sure the layer owns its data array exclusively, so that it can be modified. Referenced and
+ * shared data is copied.
+ */
+static void ensure_layer_data_is_mutable(CustomDataLayer &layer, const int totelem)
+{
+  if (layer.data == nullptr || totelem <= 0) {
+    return;
+  }
+  if (layer.flag & CD_FLAG_NOFREE) {
+    layer.data = copy_layer_data(eCustomDataType(layer.type), layer.data, totelem);
+    layer.sharing_info = make_implicit_sharing_info_for_layer(
+        eCustomDataType(layer.type), layer.data, totelem);
+    layer.flag &= ~CD_FLAG_NOFREE;
+  }
+  else if (layer.sharing_info != nullptr && layer.sharing_info->is_shared()) {
+    layer.data = copy_layer_data(eCustomDataType(layer.type), layer.data, totelem);
+    layer.sharing_info->user_remove();
+    layer.sharing_info = make_implicit_sharing_info_for_layer(
+        eCustomDataType(layer.type), layer.data, totelem);
+  }
+}
+
+/**
+ * Copy shared data before single elements of the layer are written, for functions that don't know
+ * the size of the layer. Shared arrays are always allocated with `MEM_*`, so their size is known.
+ * Referenced data is written to directly as before.
+ */
+static void ensure_layer_data_is_unshared_for_elem_write(CustomDataLayer &layer)
+{
+  if (layer.data == nullptr || layer.sharing_info == nullptr || !layer.sharing_info->is_shared()) {
+    return;
+  }
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer.type);
+  const int totelem = int(MEM_allocN_len(layer.data) / typeInfo->size);
+  ensure_layer_data_is_mutable(layer, totelem);
+}
+
+static CustomDataLayer *customData_add_layer__internal(
+    CustomData *data,
+    int type,
+    eCDAllocType alloctype,
+    void *layer_data_to_assign,
+    const ImplicitSharingInfo *sharing_info_to_assign,
+    int totelem,
+    const char *name);
 
 void CustomData_update_typemap(CustomData *data)
 {
@@ -2238,23 +2436,27 @@ bool CustomData_merge(const CustomData *source,
     }
 
     void *data;
+    const ImplicitSharingInfo *sharing_info;
     switch (alloctype) {
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
         data = layer->data;
+        sharing_info = layer->sharing_info;
         break;
       default:
         data = nullptr;
+        sharing_info = nullptr;
         break;
     }
 
     if ((alloctype == CD_ASSIGN) && (flag & CD_FLAG_NOFREE)) {
       newlayer = customData_add_layer__internal(
-          dest, type, CD_REFERENCE, data, totelem, layer->name);
+          dest, type, CD_REFERENCE, data, nullptr, totelem, layer->name);
     }
     else {
-      newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
+      newlayer = customData_add_layer__internal(
+          dest, type, alloctype, data, sharing_info, totelem, layer->name);
     }
 
     if (newlayer) {
@@ -2278,6 +2480,7 @@ bool CustomData_merge(const CustomData *source,
       }
       if (alloctype == CD_ASSIGN) {
         layer->data = nullptr;
+        layer->sharing_info = nullptr;
       }
     }
   }
@@ -2320,7 +2523,10 @@ void CustomData_realloc(CustomData *data, const int old_size, const int new_size
 
     const int64_t old_size_in_bytes = int64_t(old_size) * typeInfo->size;
     const int64_t new_size_in_bytes = int64_t(new_size) * typeInfo->size;
-    if (layer->flag & CD_FLAG_NOFREE) {
+    if ((layer->flag & CD_FLAG_NOFREE) ||
+        (layer->sharing_info != nullptr && layer->sharing_info->is_shared())) {
+      /* The old data is either not owned by this layer or it is used by other layers as well, so
+       * it is copied into a new array instead of being reallocated. */
       const void *old_data = layer->data;
       layer->data = MEM_malloc_arrayN(new_size, typeInfo->size, __func__);
       if (typeInfo->copy) {
@@ -2329,9 +2535,17 @@ void CustomData_realloc(CustomData *data, const int old_size, const int new_size
       else {
         std::memcpy(layer->data, old_data, std::min(old_size_in_bytes, new_size_in_bytes));
       }
+      if (layer->sharing_info != nullptr) {
+        layer->sharing_info->user_remove();
+      }
       layer->flag &= ~CD_FLAG_NOFREE;
     }
     else {
+      if (layer->sharing_info != nullptr) {
+        /* The layer is the only user, so the sharing info can be freed without freeing the data,
+         * a new one is created for the reallocated array below. */
+        MEM_delete(layer->sharing_info);
+      }
       layer->data = MEM_reallocN(layer->data, new_size_in_bytes);
     }
 
@@ -2342,6 +2556,11 @@ void CustomData_realloc(CustomData *data, const int old_size, const int new_size
         typeInfo->construct(POINTER_OFFSET(layer->data, old_size_in_bytes), new_elements_num);
       }
     }
+
+    layer->sharing_info = (layer->data && new_size > 0) ?
+                              make_implicit_sharing_info_for_layer(
+                                  eCustomDataType(layer->type), layer->data, new_size) :
+                              nullptr;
   }
 }
 
@@ -2362,22 +2581,17 @@ void CustomData_copy(const CustomData *source,
 
 static void customData_free_layer__internal(CustomDataLayer *layer, const int totelem)
 {
-  const LayerTypeInfo *typeInfo;
-
   if (layer->anonymous_id != nullptr) {
     layer->anonymous_id->user_remove();
     layer->anonymous_id = nullptr;
   }
-  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
-    typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->free) {
-      typeInfo->free(layer->data, totelem, typeInfo->size);
-    }
-
-    if (layer->data) {
-      MEM_freeN(layer->data);
-    }
+  if (layer->sharing_info != nullptr) {
+    /* The data is freed together with the sharing info when this was the last user. */
+    layer->sharing_info->user_remove();
+    layer->sharing_info = nullptr;
+  }
+  else if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
+    free_layer_data(eCustomDataType(layer->type), layer->data, totelem);
   }
 }
 
@@ -2744,14 +2958,17 @@ static bool customData_resize(CustomData *data, const int amount)
   return true;
 }
 
-static CustomDataLayer *customData_add_layer__internal(CustomData *data,
-                                                       const int type,
-                                                       const eCDAllocType alloctype,
-                                                       void *layerdata,
-                                                       const int totelem,
-                                                       const char *name)
+static CustomDataLayer *customData_add_layer__internal(
+    CustomData *data,
+    const int type,
+    const eCDAllocType alloctype,
+    void *layer_data_to_assign,
+    const ImplicitSharingInfo *sharing_info_to_assign,
+    const int totelem,
+    const char *name)
 {
   const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+  void *layerdata = layer_data_to_assign;
   int flag = 0;
 
   /* Some layer types only support a single layer. */
@@ -2762,7 +2979,15 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
     return &data->layers[CustomData_get_layer_index(data, type)];
   }
 
+  int index = data->totlayer;
+  if (index >= data->maxlayer) {
+    if (!customData_resize(data, CUSTOMDATA_GROW)) {
+      return nullptr;
+    }
+  }
+
   void *newlayerdata = nullptr;
+  const ImplicitSharingInfo *new_sharing_info = nullptr;
   switch (alloctype) {
     case CD_SET_DEFAULT:
       if (totelem > 0) {
@@ -2787,6 +3012,11 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
       if (totelem > 0) {
         BLI_assert(layerdata != nullptr);
         newlayerdata = layerdata;
+        /* Ownership of the sharing info is transferred to the new layer. */
+        new_sharing_info = sharing_info_to_assign;
+      }
+      else if (sharing_info_to_assign != nullptr) {
+        sharing_info_to_assign->user_remove();
       }
       else {
         MEM_SAFE_FREE(layerdata);
@@ -2801,27 +3031,23 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
       break;
     case CD_DUPLICATE:
       if (totelem > 0) {
-        newlayerdata = MEM_malloc_arrayN(totelem, typeInfo->size, layerType_getName(type));
-        if (typeInfo->copy) {
-          typeInfo->copy(layerdata, newlayerdata, totelem);
+        if (sharing_info_to_assign != nullptr) {
+          /* Share the data instead of copying it. It is copied when it is modified, see
+           * #ensure_layer_data_is_mutable. */
+          newlayerdata = layerdata;
+          new_sharing_info = sharing_info_to_assign;
+          new_sharing_info->user_add();
         }
         else {
-          BLI_assert(layerdata != nullptr);
-          BLI_assert(newlayerdata != nullptr);
-          memcpy(newlayerdata, layerdata, totelem * typeInfo->size);
+          newlayerdata = copy_layer_data(eCustomDataType(type), layerdata, totelem);
         }
       }
       break;
   }
 
-  int index = data->totlayer;
-  if (index >= data->maxlayer) {
-    if (!customData_resize(data, CUSTOMDATA_GROW)) {
-      if (newlayerdata != layerdata) {
-        MEM_freeN(newlayerdata);
-      }
-      return nullptr;
-    }
+  if (newlayerdata != nullptr && new_sharing_info == nullptr && !(flag & CD_FLAG_NOFREE)) {
+    new_sharing_info = make_implicit_sharing_info_for_layer(
+        eCustomDataType(type), newlayerdata, totelem);
   }
 
   data->totlayer++;
@@ -2841,6 +3067,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   new_layer.type = type;
   new_layer.flag = flag;
   new_layer.data = newlayerdata;
+  new_layer.sharing_info = new_sharing_info;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2881,7 +3108,7 @@ static void *customdata_add_layer(
   const LayerTypeInfo *typeInfo = layerType_getInfo(type);
 
   CustomDataLayer *layer = customData_add_layer__internal(
-      data, type, alloctype, layerdata, totelem, typeInfo->defaultname);
+      data, type, alloctype, layerdata, nullptr, totelem, typeInfo->defaultname);
   CustomData_update_typemap(data);
 
   if (layer) {
@@ -2915,7 +3142,7 @@ static void *customdata_add_layer_named(CustomData *data,
                                         const char *name)
 {
   CustomDataLayer *layer = customData_add_layer__internal(
-      data, type, alloctype, layerdata, totelem, name);
+      data, type, alloctype, layerdata, nullptr, totelem, name);
   CustomData_update_typemap(data);
 
   if (layer) {
@@ -2949,7 +3176,7 @@ void *CustomData_add_layer_anonymous(CustomData *data,
 {
   const char *name = anonymous_id->name().c_str();
   CustomDataLayer *layer = customData_add_layer__internal(
-      data, type, alloctype, layerdata, totelem, name);
+      data, type, alloctype, layerdata, nullptr, totelem, name);
   CustomData_update_typemap(data);
 
   if (layer == nullptr) {
@@ -3094,37 +3321,34 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
     return nullptr;
   }
 
-  CustomDataLayer *layer = &data->layers[layer_index];
-
-  if (layer->flag & CD_FLAG_NOFREE) {
-    /* MEM_dupallocN won't work in case of complex layers, like e.g.
-     * CD_MDEFORMVERT, which has pointers to allocated data...
-     * So in case a custom copy function is defined, use it!
-     */
-    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->copy) {
-      void *dst_data = MEM_malloc_arrayN(
-          size_t(totelem), typeInfo->size, "CD duplicate ref layer");
-      typeInfo->copy(layer->data, dst_data, totelem);
-      layer->data = dst_data;
-    }
-    else {
-      layer->data = MEM_dupallocN(layer->data);
-    }
+  CustomDataLayer &layer = data->layers[layer_index];
+  ensure_layer_data_is_mutable(layer, totelem);
+  return layer.data;
+}
 
-    layer->flag &= ~CD_FLAG_NOFREE;
+void CustomData_duplicate_referenced_layers(CustomData *data, const int totelem)
+{
+  for (int i = 0; i < data->totlayer; i++) {
+    ensure_layer_data_is_mutable(data->layers[i], totelem);
   }
+}
 
-  return layer->data;
+void CustomData_ensure_data_is_mutable(CustomDataLayer *layer, const int totelem)
+{
+  ensure_layer_data_is_mutable(*layer, totelem);
 }
 
-void CustomData_duplicate_referenced_layers(CustomData *data, const int totelem)
+void *CustomData_layer_steal_data(CustomDataLayer *layer, const int totelem)
 {
-  for (int i = 0; i < data->totlayer; i++) {
-    CustomDataLayer *layer = &data->layers[i];
-    layer->data = customData_duplicate_referenced_layer_index(data, i, totelem);
+  ensure_layer_data_is_mutable(*layer, totelem);
+  void *data = layer->data;
+  if (layer->sharing_info != nullptr) {
+    /* The layer is the only user, so the sharing info can be freed without freeing the data. */
+    MEM_delete(layer->sharing_info);
+    layer->sharing_info = nullptr;
   }
+  layer->data = nullptr;
+  return data;
 }
 
 void CustomData_free_temporary(CustomData *data, const int totelem)
@@ -3193,6 +3417,9 @@ void CustomData_copy_data_layer(const CustomData *source,
 {
   const LayerTypeInfo *typeInfo;
 
+  if (count > 0) {
+    ensure_layer_data_is_unshared_for_elem_write(dest->layers[dst_layer_index]);
+  }
   const void *src_data = source->layers[src_layer_index].data;
   void *dst_data = dest->layers[dst_layer_index].data;
 
@@ -3310,6 +3537,7 @@ void CustomData_free_elem(CustomData *data, const int index, const int count)
       if (typeInfo->free) {
         size_t offset = size_t(index) * typeInfo->size;
 
+        ensure_layer_data_is_unshared_for_elem_write(data->layers[i]);
         typeInfo->free(POINTER_OFFSET(data->layers[i].data, offset), count, typeInfo->size);
       }
     }
@@ -3378,6 +3606,7 @@ void CustomData_interp(const CustomData *source,
         sources[j] = POINTER_OFFSET(src_data, size_t(src_indices[j]) * typeInfo->size);
       }
 
+      ensure_layer_data_is_unshared_for_elem_write(dest->layers[dest_i]);
       typeInfo->interp(
           sources,
           weights,
@@ -3409,6 +3638,7 @@ void CustomData_swap_corners(CustomData *data, const int index, const int *corne
     if (typeInfo->swap) {
       const size_t offset = size_t(index) * typeInfo->size;
 
+      ensure_layer_data_is_unshared_for_elem_write(data->layers[i]);
       typeInfo->swap(POINTER_OFFSET(data->layers[i].data, offset), corner_indices);
     }
   }
@@ -3428,6 +3658,7 @@ void CustomData_swap(CustomData *data, const int index_a, const int index_b)
     const size_t offset_a = size * index_a;
     const size_t offset_b = size * index_b;
 
+    ensure_layer_data_is_unshared_for_elem_write(data->layers[i]);
     void *buff = size <= sizeof(buff_static) ? buff_static : MEM_mallocN(size, __func__);
     memcpy(buff, POINTER_OFFSET(data->layers[i].data, offset_a), size);
     memcpy(POINTER_OFFSET(data->layers[i].data, offset_a),
@@ -3962,7 +4193,11 @@ bool CustomData_has_interp(const CustomData *data)
 bool CustomData_has_referenced(const CustomData *data)
 {
   for (int i = 0; i < data->totlayer; i++) {
-    if (data->layers[i].flag & CD_FLAG_NOFREE) {
+    const CustomDataLayer &layer = data->layers[i];
+    if (layer.flag & CD_FLAG_NOFREE) {
+      return true;
+    }
+    if (layer.sharing_info != nullptr && layer.sharing_info->is_shared()) {
       return true;
     }
   }
@@ -4176,6 +4411,8 @@ void CustomData_blend_write_prepare(CustomData &data,
       continue;
     }
     layers_to_write.append(layer);
+    /* Run-time data, also avoids detecting changes in undo steps because of the pointer. */
+    layers_to_write.last().sharing_info = nullptr;
   }
   data.totlayer = layers_to_write.size();
   data.maxlayer = data.totlayer;
@@ -4346,7 +4583,11 @@ bool CustomData_verify_versions(CustomData *data, const int index)
                    CD_FACEMAP,
                    CD_MTEXPOLY,
                    CD_SCULPT_FACE_SETS,
-                   CD_CREASE)) {
+                   CD_CREASE,
+                   /* Compressed attributes are written as raw arrays. */
+                   CD_PROP_FLOAT3_HALF,
+                   CD_PROP_FLOAT2_UNORM16,
+                   CD_PROP_NORMAL_OCT)) {
       keeplayer = false;
       CLOG_WARN(&LOG, ".blend file read: removing a data layer that should not have been written");
     }
@@ -4503,6 +4744,7 @@ void CustomData_external_read(CustomData *data, ID *id, eCustomDataMask mask, co
 
       if (blay) {
         if (cdf_read_layer(cdf, blay)) {
+          ensure_layer_data_is_mutable(*layer, totelem);
           if (typeInfo->read(cdf, layer->data, totelem)) {
             /* pass */
           }
@@ -5055,6 +5297,11 @@ void CustomData_blend_write(BlendWriter *writer,
       case CD_CREASE:
         BLO_write_raw(writer, sizeof(float) * count, static_cast<const float *>(layer.data));
         break;
+      case CD_PROP_FLOAT3_HALF:
+      case CD_PROP_FLOAT2_UNORM16:
+      case CD_PROP_NORMAL_OCT:
+        BLO_write_raw(writer, size_t(CustomData_sizeof(layer.type)) * count, layer.data);
+        break;
       default: {
         const char *structname;
         int structnum;
@@ -5145,6 +5392,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing_info = nullptr;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
@@ -5167,6 +5415,10 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int
       else if (layer->type == CD_MDEFORMVERT) {
         BKE_defvert_blend_read(reader, count, static_cast<MDeformVert *>(layer->data));
       }
+      if (layer->data != nullptr && count > 0) {
+        layer->sharing_info = make_implicit_sharing_info_for_layer(
+            eCustomDataType(layer->type), layer->data, count);
+      }
       i++;
     }
   }
@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_implicit_sharing.hh"
+
+#include "BKE_customdata.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+static const CustomDataLayer &first_layer(const CustomData &data)
+{
+  return data.layers[0];
+}
+
+TEST(customdata, CopySharesLayerData)
+{
+  CustomData data_a;
+  CustomData_reset(&data_a);
+  int *values_a = static_cast<int *>(
+      CustomData_add_layer_named(&data_a, CD_PROP_INT32, CD_SET_DEFAULT, 100, "value"));
+  values_a[10] = 5;
+
+  CustomData data_b;
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_ALL, CD_DUPLICATE, 100);
+  const int *values_b = static_cast<const int *>(
+      CustomData_get_layer_named(&data_b, CD_PROP_INT32, "value"));
+  EXPECT_EQ(values_a, values_b);
+  EXPECT_TRUE(first_layer(data_a).sharing_info->is_shared());
+
+  /* Writing to the copy un-shares the data, the original isn't changed. */
+  int *values_b_mutable = static_cast<int *>(
+      CustomData_get_layer_named_for_write(&data_b, CD_PROP_INT32, "value", 100));
+  EXPECT_NE(values_a, values_b_mutable);
+  values_b_mutable[10] = 6;
+  EXPECT_EQ(values_a[10], 5);
+  EXPECT_TRUE(first_layer(data_a).sharing_info->is_mutable());
+  EXPECT_TRUE(first_layer(data_b).sharing_info->is_mutable());
+
+  /* Data that isn't shared anymore isn't copied again. */
+  EXPECT_EQ(CustomData_get_layer_named_for_write(&data_a, CD_PROP_INT32, "value", 100), values_a);
+
+  CustomData_free(&data_a, 100);
+  CustomData_free(&data_b, 100);
+}
+
+TEST(customdata, SharedDataOutlivesSource)
+{
+  CustomData data_a;
+  CustomData_reset(&data_a);
+  float *values_a = static_cast<float *>(
+      CustomData_add_layer_named(&data_a, CD_PROP_FLOAT, CD_SET_DEFAULT, 10, "value"));
+  values_a[0] = 1.0f;
+
+  CustomData data_b;
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_ALL, CD_DUPLICATE, 10);
+  CustomData_free(&data_a, 10);
+
+  EXPECT_TRUE(first_layer(data_b).sharing_info->is_mutable());
+  const float *values_b = static_cast<const float *>(
+      CustomData_get_layer_named(&data_b, CD_PROP_FLOAT, "value"));
+  EXPECT_EQ(values_b[0], 1.0f);
+  CustomData_free(&data_b, 10);
+}
+
+TEST(customdata, DeformVertSharing)
+{
+  CustomData data_a;
+  CustomData_reset(&data_a);
+  MDeformVert *dverts_a = static_cast<MDeformVert *>(
+      CustomData_add_layer(&data_a, CD_MDEFORMVERT, CD_SET_DEFAULT, 2));
+  dverts_a[1].dw = MEM_cnew<MDeformWeight>(__func__);
+  dverts_a[1].dw->weight = 0.5f;
+  dverts_a[1].totweight = 1;
+
+  CustomData data_b;
+  CustomData_copy(&data_a, &data_b, CD_MASK_MDEFORMVERT, CD_DUPLICATE, 2);
+  MDeformVert *dverts_b = static_cast<MDeformVert *>(
+      CustomData_get_layer_for_write(&data_b, CD_MDEFORMVERT, 2));
+  /* Copying the layer when un-sharing it copies the weights as well. */
+  EXPECT_NE(dverts_a[1].dw, dverts_b[1].dw);
+  EXPECT_EQ(dverts_b[1].dw->weight, 0.5f);
+
+  CustomData_free(&data_a, 2);
+  CustomData_free(&data_b, 2);
+}
+
+TEST(customdata, StealData)
+{
+  CustomData data_a;
+  CustomData_reset(&data_a);
+  CustomData_add_layer_named(&data_a, CD_PROP_INT32, CD_SET_DEFAULT, 10, "value");
+
+  CustomData data_b;
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_ALL, CD_DUPLICATE, 10);
+
+  /* Stealing shared data gives a copy, so the other user isn't affected. */
+  int *stolen = static_cast<int *>(CustomData_layer_steal_data(&data_b.layers[0], 10));
+  EXPECT_NE(stolen, first_layer(data_a).data);
+  EXPECT_EQ(first_layer(data_b).data, nullptr);
+  EXPECT_EQ(first_layer(data_b).sharing_info, nullptr);
+  EXPECT_TRUE(first_layer(data_a).sharing_info->is_mutable());
+  MEM_freeN(stolen);
+
+  CustomData_free(&data_a, 10);
+  CustomData_free(&data_b, 10);
+}
+
+TEST(customdata, ElementWritesUnshareData)
+{
+  CustomData data_a;
+  CustomData_reset(&data_a);
+  int *values_a = static_cast<int *>(
+      CustomData_add_layer_named(&data_a, CD_PROP_INT32, CD_SET_DEFAULT, 10, "value"));
+  for (int i = 0; i < 10; i++) {
+    values_a[i] = i;
+  }
+
+  /* Compact the copy in place, like mesh validation does. */
+  CustomData data_b;
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_ALL, CD_DUPLICATE, 10);
+  CustomData_copy_data(&data_b, &data_b, 5, 0, 5);
+  CustomData_swap(&data_b, 8, 9);
+  const float weights[2] = {0.5f, 0.5f};
+  const int src_indices[2] = {6, 8};
+  CustomData_interp(&data_a, &data_b, src_indices, weights, nullptr, 2, 7);
+
+  const int *values_b = static_cast<const int *>(
+      CustomData_get_layer_named(&data_b, CD_PROP_INT32, "value"));
+  EXPECT_NE(values_a, values_b);
+  EXPECT_EQ(values_b[0], 5);
+  EXPECT_EQ(values_b[7], 7);
+  EXPECT_EQ(values_b[8], 9);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(values_a[i], i);
+  }
+  EXPECT_TRUE(first_layer(data_a).sharing_info->is_mutable());
+
+  CustomData_free(&data_a, 10);
+  CustomData_free(&data_b, 10);
+}
+
+TEST(customdata, Realloc)
+{
+  CustomData data_a;
+  CustomData_reset(&data_a);
+  int *values_a = static_cast<int *>(
+      CustomData_add_layer_named(&data_a, CD_PROP_INT32, CD_SET_DEFAULT, 10, "value"));
+  values_a[9] = 5;
+
+  CustomData data_b;
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_ALL, CD_DUPLICATE, 10);
+
+  /* Shared data is copied, the other user keeps the old array. */
+  CustomData_realloc(&data_b, 10, 20);
+  const int *values_b = static_cast<const int *>(
+      CustomData_get_layer_named(&data_b, CD_PROP_INT32, "value"));
+  EXPECT_NE(values_b, values_a);
+  EXPECT_EQ(values_b[9], 5);
+  EXPECT_TRUE(first_layer(data_a).sharing_info->is_mutable());
+  EXPECT_TRUE(first_layer(data_b).sharing_info->is_mutable());
+
+  /* Data that isn't shared is reallocated and gets a new sharing info for the new array. */
+  CustomData_realloc(&data_a, 10, 5);
+  values_a = static_cast<int *>(
+      CustomData_get_layer_named_for_write(&data_a, CD_PROP_INT32, "value", 5));
+  values_a[4] = 3;
+  EXPECT_TRUE(first_layer(data_a).sharing_info->is_mutable());
+  EXPECT_EQ(values_b[4], 0);
+
+  CustomData_free(&data_a, 5);
+  CustomData_free(&data_b, 20);
+}
+
+}  // namespace blender::bke::tests
@@ -22,6 +22,7 @@
 #include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_sort_utils.h"
+#include "BLI_task.h"
 
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -39,6 +40,8 @@
 #include "RNA_access.h"
 #include "RNA_path.h"
 
+#include "atomic_ops.h"
+
 #include "CLG_log.h"
 
 #define SMALL -1.0e-10
@@ -1902,19 +1905,17 @@ static float fcurve_eval_keyframes_extrapolate(
   return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
-static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
+/**
+ * Find the keyframe that ends the segment containing `evaltime`, with the same result as the
+ * binary search in #BKE_fcurve_bezt_binarysearch_index_ex. The segment that was found last is
+ * tried first, since consecutive evaluations usually happen in the same or the next segment.
+ */
+static uint fcurve_eval_keyframes_segment_find(const FCurve *fcu,
                                                const BezTriple *bezts,
-                                               float evaltime)
+                                               const float evaltime,
+                                               bool *r_exact)
 {
-  const float eps = 1.e-8f;
-  uint a;
-
-  /* Evaltime occurs somewhere in the middle of the curve. */
-  bool exact = false;
-
-  /* Use binary search to find appropriate keyframes...
-   *
-   * The threshold here has the following constraints:
+  /* The threshold here has the following constraints:
    * - 0.001 is too coarse:
    *   We get artifacts with 2cm driver movements at 1BU = 1m (see #40332).
    *
@@ -1922,7 +1923,48 @@ static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
    *   Weird errors, like selecting the wrong keyframe range (see #39207), occur.
    *   This lower bound was established in b888a32eee8147b028464336ad2404d8155c64dd.
    */
-  a = BKE_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+  const float threshold = 0.0001f;
+
+  /* The hint is shared by all users of the F-Curve, which may evaluate it from different threads
+   * (e.g. objects sharing an action). It is only used as a starting point that is checked against
+   * the keyframes, so concurrent updates don't have to be ordered. */
+  int32_t *hint_p = (int32_t *)&fcu->eval_segment_hint;
+  const int hint = atomic_load_int32(hint_p);
+  for (int a = hint; a <= hint + 1; a++) {
+    if (a < 1 || a >= (int)fcu->totvert) {
+      continue;
+    }
+    const float prev_frame = bezts[a - 1].vec[1][0];
+    const float frame = bezts[a].vec[1][0];
+    /* Only use segments that contain the time without being within the threshold of one of their
+     * keyframes, for those the binary search doesn't necessarily find the same keyframe. */
+    if (prev_frame < evaltime && evaltime < frame && !IS_EQT(evaltime, prev_frame, threshold) &&
+        !IS_EQT(evaltime, frame, threshold)) {
+      if (a != hint) {
+        atomic_store_int32(hint_p, a);
+      }
+      *r_exact = false;
+      return (uint)a;
+    }
+  }
+
+  const int a = BKE_fcurve_bezt_binarysearch_index_ex(
+      bezts, evaltime, fcu->totvert, threshold, r_exact);
+  if (!*r_exact) {
+    atomic_store_int32(hint_p, a);
+  }
+  return (uint)a;
+}
+
+static float fcurve_eval_keyframes_interpolate(const FCurve *fcu,
+                                               const BezTriple *bezts,
+                                               float evaltime)
+{
+  const float eps = 1.e-8f;
+
+  /* Evaltime occurs somewhere in the middle of the curve. */
+  bool exact = false;
+  const uint a = fcurve_eval_keyframes_segment_find(fcu, bezts, evaltime, &exact);
   const BezTriple *bezt = bezts + a;
 
   if (exact) {
@@ -2350,6 +2392,48 @@ float calculate_fcurve(PathResolvedRNA *anim_rna,
   return curval;
 }
 
+typedef struct FCurveBatchData {
+  FCurve **fcurves;
+  float evaltime;
+  float *r_values;
+} FCurveBatchData;
+
+static void calculate_fcurves_batch_task(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const FCurveBatchData *data = userdata;
+  FCurve *fcu = data->fcurves[i];
+  BLI_assert(fcu->driver == NULL);
+
+  if (BKE_fcurve_is_empty(fcu)) {
+    data->r_values[i] = 0.0f;
+    return;
+  }
+
+  const float curval = evaluate_fcurve(fcu, data->evaltime);
+  fcu->curval = curval; /* Debug display only, not thread safe! */
+  data->r_values[i] = curval;
+}
+
+void calculate_fcurves_batch(FCurve **fcurves,
+                             const int fcurves_num,
+                             const AnimationEvalContext *anim_eval_context,
+                             float *r_values)
+{
+  FCurveBatchData data = {
+      .fcurves = fcurves,
+      .evaltime = anim_eval_context->eval_time,
+      .r_values = r_values,
+  };
+
+  /* Evaluating a single curve is cheap, only use threads for actions with many curves. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, fcurves_num, &data, calculate_fcurves_batch_task, &settings);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -4,6 +4,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BKE_animsys.h"
 #include "BKE_fcurve.h"
 
 #include "ED_keyframing.h"
@@ -196,6 +197,63 @@ TEST(evaluate_fcurve, ExtrapolationBezierKeys)
   BKE_fcurve_free(fcu);
 }
 
+TEST(evaluate_fcurve, SegmentHint)
+{
+  FCurve *fcu = BKE_fcurve_create();
+
+  for (int i = 0; i < 5; i++) {
+    insert_vert_fcurve(fcu, float(i), i * 10.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+    fcu->bezt[i].ipo = BEZT_IPO_LIN;
+  }
+
+  /* Forward, backward and jumping between segments all use the right segment. */
+  EXPECT_NEAR(evaluate_fcurve(fcu, 0.5f), 5.0f, EPSILON);
+  EXPECT_NEAR(evaluate_fcurve(fcu, 1.5f), 15.0f, EPSILON);
+  EXPECT_NEAR(evaluate_fcurve(fcu, 1.75f), 17.5f, EPSILON);
+  EXPECT_NEAR(evaluate_fcurve(fcu, 2.5f), 25.0f, EPSILON);
+  EXPECT_NEAR(evaluate_fcurve(fcu, 0.25f), 2.5f, EPSILON);
+  EXPECT_NEAR(evaluate_fcurve(fcu, 3.5f), 35.0f, EPSILON);
+
+  /* Times within the threshold of a keyframe of the hinted segment use the keyframe's value. */
+  EXPECT_NEAR(evaluate_fcurve(fcu, 3.5f), 35.0f, EPSILON);
+  EXPECT_NEAR(evaluate_fcurve(fcu, 4.0f - 0.00008f), 40.0f, EPSILON);
+  EXPECT_NEAR(evaluate_fcurve(fcu, 3.0f + 0.00008f), 30.0f, EPSILON);
+
+  /* A hint that is out of range after removing keyframes is ignored. */
+  EXPECT_NEAR(evaluate_fcurve(fcu, 3.5f), 35.0f, EPSILON);
+  BKE_fcurve_delete_key(fcu, 4);
+  BKE_fcurve_delete_key(fcu, 3);
+  EXPECT_NEAR(evaluate_fcurve(fcu, 1.5f), 15.0f, EPSILON);
+
+  BKE_fcurve_free(fcu);
+}
+
+TEST(evaluate_fcurve, CalculateBatch)
+{
+  FCurve *fcurves[3];
+  for (int i = 0; i < 2; i++) {
+    fcurves[i] = BKE_fcurve_create();
+    insert_vert_fcurve(fcurves[i], 1.0f, 0.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+    insert_vert_fcurve(
+        fcurves[i], 2.0f, (i + 1) * 10.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+    fcurves[i]->bezt[0].ipo = BEZT_IPO_LIN;
+  }
+  /* Empty curves have a value of zero. */
+  fcurves[2] = BKE_fcurve_create();
+
+  AnimationEvalContext anim_eval_context = {nullptr, 1.5f};
+  float values[3];
+  calculate_fcurves_batch(fcurves, 3, &anim_eval_context, values);
+  EXPECT_NEAR(values[0], 5.0f, EPSILON);
+  EXPECT_NEAR(values[1], 10.0f, EPSILON);
+  EXPECT_EQ(values[2], 0.0f);
+  EXPECT_NEAR(fcurves[1]->curval, 10.0f, EPSILON);
+
+  for (FCurve *fcu : fcurves) {
+    BKE_fcurve_free(fcu);
+  }
+}
+
 TEST(fcurve_subdivide, BKE_fcurve_bezt_subdivide_handles)
 {
   FCurve *fcu = BKE_fcurve_create();
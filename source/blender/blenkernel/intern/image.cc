@@ -4110,6 +4110,7 @@ static ImBuf *load_image_single(Image *ima,
     LISTBASE_FOREACH (ImagePackedFile *, imapf, &ima->packedfiles) {
       if (imapf->view == view_id && imapf->tile_number == tile_number) {
         if (imapf->packedfile) {
+          BKE_packedfile_ensure_data(imapf->packedfile);
           ibuf = IMB_ibImageFromMemory((uchar *)imapf->packedfile->data,
                                        imapf->packedfile->size,
                                        flag,
@@ -44,6 +44,7 @@
 #include "BKE_deform.h"
 #include "BKE_editmesh.h"
 #include "BKE_global.h"
+#include "BKE_idprop.h"
 #include "BKE_idtype.h"
 #include "BKE_key.h"
 #include "BKE_lib_id.h"
@@ -131,7 +132,11 @@ static void mesh_copy_data(Main *bmain, ID *id_dst, const ID *id_src, const int
    * Caches will be "un-shared" as necessary later on. */
   mesh_dst->runtime->bounds_cache = mesh_src->runtime->bounds_cache;
   mesh_dst->runtime->loose_edges_cache = mesh_src->runtime->loose_edges_cache;
+  mesh_dst->runtime->vert_to_edge_map_cache = mesh_src->runtime->vert_to_edge_map_cache;
+  mesh_dst->runtime->vert_to_poly_map_cache = mesh_src->runtime->vert_to_poly_map_cache;
+  mesh_dst->runtime->vert_to_loop_map_cache = mesh_src->runtime->vert_to_loop_map_cache;
   mesh_dst->runtime->looptris_cache = mesh_src->runtime->looptris_cache;
+  mesh_dst->runtime->bvh_tree_pool = mesh_src->runtime->bvh_tree_pool;
 
   /* Only do tessface if we have no polys. */
   const bool do_tessface = ((mesh_src->totface != 0) && (mesh_src->totpoly == 0));
@@ -220,6 +225,34 @@ static void mesh_foreach_path(ID *id, BPathForeachPathData *bpath_data)
   }
 }
 
+/**
+ * The legacy format converters write flags into the edge and face arrays. The temporary copy of
+ * the mesh that is written still uses the layers of the original mesh, whose data is usually
+ * shared with evaluated meshes. Give the copy its own layer array that references a temporary copy
+ * of the array of the given type, so that saving doesn't un-share (or modify) the original data.
+ */
+template<typename T>
+static void mesh_layer_copy_for_legacy_write(CustomData &data,
+                                             const eCustomDataType type,
+                                             const int totelem,
+                                             blender::ResourceScope &scope)
+{
+  using namespace blender;
+  const int layer_index = CustomData_get_layer_index(&data, type);
+  if (layer_index == -1) {
+    return;
+  }
+  MutableSpan<CustomDataLayer> layers = scope.construct<Array<CustomDataLayer>>(
+      Span<CustomDataLayer>(data.layers, data.totlayer));
+  CustomDataLayer &layer = layers[layer_index];
+  layer.data = scope.construct<Array<T>>(Span<T>(static_cast<const T *>(layer.data), totelem))
+                   .data();
+  layer.sharing_info = nullptr;
+  layer.flag &= ~CD_FLAG_NOFREE;
+  data.layers = layers.data();
+  data.maxlayer = data.totlayer;
+}
+
 static void mesh_blend_write(BlendWriter *writer, ID *id, const void *id_address)
 {
   using namespace blender;
@@ -269,6 +302,10 @@ static void mesh_blend_write(BlendWriter *writer, ID *id, const void *id_address
                                       "sharp_face",
                                       "sharp_edge"});
 
+      mesh_layer_copy_for_legacy_write<MEdge>(
+          mesh->edata, CD_MEDGE, mesh->totedge, temp_arrays_for_legacy_format);
+      mesh_layer_copy_for_legacy_write<MPoly>(
+          mesh->pdata, CD_MPOLY, mesh->totpoly, temp_arrays_for_legacy_format);
       mesh->mvert = BKE_mesh_legacy_convert_positions_to_verts(
           mesh, temp_arrays_for_legacy_format, vert_layers);
       mesh->mloop = BKE_mesh_legacy_convert_corners_to_loops(
@@ -1120,6 +1157,134 @@ Mesh *BKE_mesh_copy_for_eval(const Mesh *source, bool reference)
   return result;
 }
 
+/** The original of an ID referenced by a copy-on-write data-block. */
+static const ID *id_orig_get(const ID *id)
+{
+  if (id != nullptr && (id->tag & LIB_TAG_COPIED_ON_WRITE)) {
+    return id->orig_id;
+  }
+  return id;
+}
+
+static bool optional_strings_equal(const char *a, const char *b)
+{
+  if (a == nullptr || b == nullptr) {
+    return a == b;
+  }
+  return STREQ(a, b);
+}
+
+bool BKE_mesh_can_avoid_full_copy_on_write(const Mesh *mesh_orig, const Mesh *mesh_cow)
+{
+  if (mesh_orig->edit_mesh != nullptr) {
+    return false;
+  }
+  if (id_orig_get(reinterpret_cast<const ID *>(mesh_cow->key)) !=
+          reinterpret_cast<const ID *>(mesh_orig->key) ||
+      id_orig_get(reinterpret_cast<const ID *>(mesh_cow->texcomesh)) !=
+          reinterpret_cast<const ID *>(mesh_orig->texcomesh)) {
+    return false;
+  }
+  if (mesh_orig->totcol != mesh_cow->totcol) {
+    return false;
+  }
+  if (!IDP_EqualsProperties(mesh_orig->id.properties, mesh_cow->id.properties)) {
+    return false;
+  }
+  for (int i = 0; i < mesh_orig->totcol; i++) {
+    if (id_orig_get(reinterpret_cast<const ID *>(mesh_cow->mat[i])) !=
+        reinterpret_cast<const ID *>(mesh_orig->mat[i])) {
+      return false;
+    }
+  }
+  if (!optional_strings_equal(mesh_orig->active_color_attribute,
+                              mesh_cow->active_color_attribute) ||
+      !optional_strings_equal(mesh_orig->default_color_attribute,
+                              mesh_cow->default_color_attribute)) {
+    return false;
+  }
+  const bDeformGroup *group_orig = static_cast<const bDeformGroup *>(
+      mesh_orig->vertex_group_names.first);
+  const bDeformGroup *group_cow = static_cast<const bDeformGroup *>(
+      mesh_cow->vertex_group_names.first);
+  for (; group_orig && group_cow; group_orig = group_orig->next, group_cow = group_cow->next) {
+    if (!STREQ(group_orig->name, group_cow->name)) {
+      return false;
+    }
+  }
+  return group_orig == nullptr && group_cow == nullptr;
+}
+
+void BKE_mesh_update_geometry_on_write(const Mesh *mesh_orig, Mesh *mesh_cow)
+{
+  BLI_assert(BKE_mesh_can_avoid_full_copy_on_write(mesh_orig, mesh_cow));
+
+  CustomData_free(&mesh_cow->vdata, mesh_cow->totvert);
+  CustomData_free(&mesh_cow->edata, mesh_cow->totedge);
+  CustomData_free(&mesh_cow->ldata, mesh_cow->totloop);
+  CustomData_free(&mesh_cow->pdata, mesh_cow->totpoly);
+  CustomData_free(&mesh_cow->fdata, mesh_cow->totface);
+
+  mesh_cow->totvert = mesh_orig->totvert;
+  mesh_cow->totedge = mesh_orig->totedge;
+  mesh_cow->totloop = mesh_orig->totloop;
+  mesh_cow->totpoly = mesh_orig->totpoly;
+  mesh_cow->totface = mesh_orig->totface;
+
+  /* Arrays are shared with the original mesh, same as when copying the whole mesh. */
+  const CustomData_MeshMasks &mask = CD_MASK_MESH;
+  CustomData_copy(
+      &mesh_orig->vdata, &mesh_cow->vdata, mask.vmask, CD_DUPLICATE, mesh_cow->totvert);
+  CustomData_copy(
+      &mesh_orig->edata, &mesh_cow->edata, mask.emask, CD_DUPLICATE, mesh_cow->totedge);
+  CustomData_copy(
+      &mesh_orig->ldata, &mesh_cow->ldata, mask.lmask, CD_DUPLICATE, mesh_cow->totloop);
+  CustomData_copy(
+      &mesh_orig->pdata, &mesh_cow->pdata, mask.pmask, CD_DUPLICATE, mesh_cow->totpoly);
+  if (mesh_orig->totface != 0 && mesh_orig->totpoly == 0) {
+    CustomData_copy(
+        &mesh_orig->fdata, &mesh_cow->fdata, mask.fmask, CD_DUPLICATE, mesh_cow->totface);
+  }
+  else {
+    mesh_tessface_clear_intern(mesh_cow, false);
+  }
+
+  MEM_SAFE_FREE(mesh_cow->mselect);
+  mesh_cow->mselect = static_cast<MSelect *>(MEM_dupallocN(mesh_orig->mselect));
+  mesh_cow->totselect = mesh_orig->totselect;
+  mesh_cow->act_face = mesh_orig->act_face;
+
+  mesh_cow->vertex_group_active_index = mesh_orig->vertex_group_active_index;
+  mesh_cow->attributes_active_index = mesh_orig->attributes_active_index;
+  copy_v3_v3(mesh_cow->texspace_location, mesh_orig->texspace_location);
+  copy_v3_v3(mesh_cow->texspace_size, mesh_orig->texspace_size);
+  mesh_cow->texspace_flag = mesh_orig->texspace_flag;
+  mesh_cow->editflag = mesh_orig->editflag;
+  mesh_cow->flag = mesh_orig->flag;
+  mesh_cow->smoothresh = mesh_orig->smoothresh;
+  mesh_cow->remesh_voxel_size = mesh_orig->remesh_voxel_size;
+  mesh_cow->remesh_voxel_adaptivity = mesh_orig->remesh_voxel_adaptivity;
+  mesh_cow->face_sets_color_seed = mesh_orig->face_sets_color_seed;
+  mesh_cow->face_sets_color_default = mesh_orig->face_sets_color_default;
+  mesh_cow->symmetry = mesh_orig->symmetry;
+  mesh_cow->remesh_mode = mesh_orig->remesh_mode;
+
+  /* Free the same run-time data as freeing the whole copy would, then share the derived caches
+   * with the original like #mesh_copy_data. */
+  BKE_mesh_runtime_clear_cache(mesh_cow);
+  mesh_cow->runtime->deformed_only = true;
+  mesh_cow->runtime->subsurf_face_dot_tags = mesh_orig->runtime->subsurf_face_dot_tags;
+  mesh_cow->runtime->subsurf_optimal_display_edges =
+      mesh_orig->runtime->subsurf_optimal_display_edges;
+  mesh_cow->runtime->bounds_cache = mesh_orig->runtime->bounds_cache;
+  mesh_cow->runtime->loose_edges_cache = mesh_orig->runtime->loose_edges_cache;
+  mesh_cow->runtime->vert_to_edge_map_cache = mesh_orig->runtime->vert_to_edge_map_cache;
+  mesh_cow->runtime->vert_to_poly_map_cache = mesh_orig->runtime->vert_to_poly_map_cache;
+  mesh_cow->runtime->vert_to_loop_map_cache = mesh_orig->runtime->vert_to_loop_map_cache;
+  mesh_cow->runtime->looptris_cache = mesh_orig->runtime->looptris_cache;
+  mesh_cow->runtime->bvh_tree_pool = mesh_orig->runtime->bvh_tree_pool;
+}
+
 BMesh *BKE_mesh_to_bmesh_ex(const Mesh *me,
                             const struct BMeshCreateParams *create_params,
                             const struct BMeshFromMeshParams *convert_params)
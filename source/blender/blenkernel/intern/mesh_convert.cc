@@ -1095,8 +1095,7 @@ static void move_shapekey_layers_to_keyblocks(const Mesh &mesh,
       mesh.attributes().lookup<float3>("position").materialize(kb_coords);
     }
     else {
-      kb->data = layer.data;
-      layer.data = nullptr;
+      kb->data = CustomData_layer_steal_data(&layer, mesh.totvert);
     }
   }
 
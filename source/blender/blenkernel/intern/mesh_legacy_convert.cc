@@ -1302,8 +1302,7 @@ void BKE_mesh_legacy_face_set_to_generic(Mesh *mesh)
   void *faceset_data = nullptr;
   for (const int i : IndexRange(mesh->pdata.totlayer)) {
     if (mesh->pdata.layers[i].type == CD_SCULPT_FACE_SETS) {
-      faceset_data = mesh->pdata.layers[i].data;
-      mesh->pdata.layers[i].data = nullptr;
+      faceset_data = CustomData_layer_steal_data(&mesh->pdata.layers[i], mesh->totpoly);
       CustomData_free_layer(&mesh->pdata, CD_SCULPT_FACE_SETS, mesh->totpoly, i);
       break;
     }
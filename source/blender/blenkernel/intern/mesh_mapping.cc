@@ -9,6 +9,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "DNA_meshdata_types.h"
 #include "DNA_vec_types.h"
 
@@ -17,11 +19,13 @@
 #include "BLI_buffer.h"
 #include "BLI_function_ref.hh"
 #include "BLI_math.h"
+#include "BLI_offset_indices.hh"
 #include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh_mapping.h"
+#include "BKE_mesh_types.h"
 #include "BLI_memarena.h"
 
 #include "BLI_strict_flags.h"
@@ -622,6 +626,107 @@ Vector<Vector<int>> build_edge_to_loop_map_resizable(const Span<int> corner_edge
   return map;
 }
 
+/**
+ * Fill the indices of a #TopologyMap in parallel. The position of every index within its group is
+ * found with an atomic counter, so the groups are sorted afterwards to give a deterministic result.
+ */
+static void fill_topology_map_indices(TopologyMap &map,
+                                      const int64_t items_num,
+                                      const FunctionRef<int(int64_t item, int i)> get_group,
+                                      const int groups_per_item)
+{
+  const OffsetIndices<int> offsets = map.offsets();
+  map.indices.reinitialize(offsets.total_size());
+  Array<int> counts(offsets.size(), 0);
+  threading::parallel_for(IndexRange(items_num), 1024, [&](const IndexRange range) {
+    for (const int64_t item : range) {
+      for (int i = 0; i < groups_per_item; i++) {
+        const int group = get_group(item, i);
+        const int index_in_group = atomic_fetch_and_add_int32(&counts[group], 1);
+        map.indices[offsets[group][index_in_group]] = int(item);
+      }
+    }
+  });
+  threading::parallel_for(offsets.index_range(), 1024, [&](const IndexRange range) {
+    for (const int64_t group : range) {
+      MutableSpan<int> indices = map.indices.as_mutable_span().slice(offsets[group]);
+      std::sort(indices.begin(), indices.end());
+    }
+  });
+}
+
+TopologyMap build_vert_to_edge_topology_map(const Span<MEdge> edges, const int verts_num)
+{
+  TopologyMap map;
+  map.offset_data.reinitialize(verts_num + 1);
+  map.offset_data.fill(0);
+  for (const MEdge &edge : edges) {
+    map.offset_data[int(edge.v1)]++;
+    map.offset_data[int(edge.v2)]++;
+  }
+  offset_indices::accumulate_counts_to_offsets(map.offset_data);
+  fill_topology_map_indices(
+      map,
+      edges.size(),
+      [&](const int64_t edge, const int i) {
+        return int(i == 0 ? edges[edge].v1 : edges[edge].v2);
+      },
+      2);
+  return map;
+}
+
+TopologyMap build_vert_to_loop_topology_map(const Span<int> corner_verts, const int verts_num)
+{
+  TopologyMap map;
+  map.offset_data.reinitialize(verts_num + 1);
+  map.offset_data.fill(0);
+  for (const int vert : corner_verts) {
+    map.offset_data[vert]++;
+  }
+  offset_indices::accumulate_counts_to_offsets(map.offset_data);
+  fill_topology_map_indices(
+      map,
+      corner_verts.size(),
+      [&](const int64_t loop, const int /*i*/) { return corner_verts[loop]; },
+      1);
+  return map;
+}
+
+TopologyMap build_vert_to_poly_topology_map(const TopologyMap &vert_to_loop_map,
+                                            const Span<MPoly> polys)
+{
+  const Array<int> loop_to_poly = build_loop_to_poly_map(polys,
+                                                         int(vert_to_loop_map.indices.size()));
+  TopologyMap map;
+  map.offset_data = vert_to_loop_map.offset_data;
+  map.indices.reinitialize(vert_to_loop_map.indices.size());
+  threading::parallel_for(map.indices.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      map.indices[i] = loop_to_poly[vert_to_loop_map.indices[i]];
+    }
+  });
+  return map;
+}
+
+void topology_map_to_elem_map(const TopologyMap &map, MeshElemMap **r_map, int **r_mem)
+{
+  const OffsetIndices<int> offsets = map.offsets();
+  MeshElemMap *elem_map = static_cast<MeshElemMap *>(
+      MEM_malloc_arrayN(size_t(offsets.size()), sizeof(MeshElemMap), __func__));
+  int *indices = static_cast<int *>(
+      MEM_malloc_arrayN(size_t(map.indices.size()), sizeof(int), __func__));
+  threading::parallel_for(offsets.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const IndexRange group = offsets[i];
+      elem_map[i].indices = indices + group.start();
+      elem_map[i].count = int(group.size());
+      std::copy_n(map.indices.data() + group.start(), group.size(), elem_map[i].indices);
+    }
+  });
+  *r_map = elem_map;
+  *r_mem = indices;
+}
+
 }  // namespace blender::bke::mesh_topology
 
 /** \} */
@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_mesh_mapping.h"
+
+namespace blender::bke::tests {
+
+static MEdge create_edge(const int v1, const int v2)
+{
+  MEdge edge{};
+  edge.v1 = v1;
+  edge.v2 = v2;
+  return edge;
+}
+
+TEST(mesh_topology, VertToEdgeMap)
+{
+  const Array<MEdge> edges = {create_edge(0, 1), create_edge(1, 2), create_edge(2, 0)};
+  const TopologyMap map = mesh_topology::build_vert_to_edge_topology_map(edges, 4);
+  EXPECT_EQ(map.size(), 4);
+  EXPECT_EQ(map[0], Span<int>({0, 2}));
+  EXPECT_EQ(map[1], Span<int>({0, 1}));
+  EXPECT_EQ(map[2], Span<int>({1, 2}));
+  EXPECT_TRUE(map[3].is_empty());
+}
+
+TEST(mesh_topology, VertToLoopAndPolyMap)
+{
+  /* Two triangles sharing the edge between vertices 1 and 2. */
+  const Array<int> corner_verts = {0, 1, 2, 2, 1, 3};
+  Array<MPoly> polys(2);
+  polys[0].loopstart = 0;
+  polys[0].totloop = 3;
+  polys[1].loopstart = 3;
+  polys[1].totloop = 3;
+
+  const TopologyMap vert_to_loop = mesh_topology::build_vert_to_loop_topology_map(corner_verts,
+                                                                                  4);
+  EXPECT_EQ(vert_to_loop[0], Span<int>({0}));
+  EXPECT_EQ(vert_to_loop[1], Span<int>({1, 4}));
+  EXPECT_EQ(vert_to_loop[2], Span<int>({2, 3}));
+  EXPECT_EQ(vert_to_loop[3], Span<int>({5}));
+
+  const TopologyMap vert_to_poly = mesh_topology::build_vert_to_poly_topology_map(vert_to_loop,
+                                                                                  polys);
+  EXPECT_EQ(vert_to_poly[0], Span<int>({0}));
+  EXPECT_EQ(vert_to_poly[1], Span<int>({0, 1}));
+  EXPECT_EQ(vert_to_poly[2], Span<int>({0, 1}));
+  EXPECT_EQ(vert_to_poly[3], Span<int>({1}));
+}
+
+TEST(mesh_topology, TopologyMapToElemMap)
+{
+  /* A quad and a triangle sharing the edge between vertices 1 and 2, vertex 4 is loose. */
+  const Array<int> corner_verts = {0, 1, 2, 3, 2, 1, 5};
+  Array<MPoly> polys(2);
+  polys[0].loopstart = 0;
+  polys[0].totloop = 4;
+  polys[1].loopstart = 4;
+  polys[1].totloop = 3;
+
+  const TopologyMap vert_to_loop = mesh_topology::build_vert_to_loop_topology_map(corner_verts,
+                                                                                  6);
+  const TopologyMap vert_to_poly = mesh_topology::build_vert_to_poly_topology_map(vert_to_loop,
+                                                                                  polys);
+
+  /* The copy matches the map built with the legacy function. */
+  MeshElemMap *map, *map_legacy;
+  int *mem, *mem_legacy;
+  mesh_topology::topology_map_to_elem_map(vert_to_poly, &map, &mem);
+  BKE_mesh_vert_poly_map_create(
+      &map_legacy, &mem_legacy, polys.data(), corner_verts.data(), 6, 2, 7);
+  for (const int vert : IndexRange(6)) {
+    EXPECT_EQ(Span<int>(map[vert].indices, map[vert].count),
+              Span<int>(map_legacy[vert].indices, map_legacy[vert].count));
+  }
+  EXPECT_EQ(map[4].count, 0);
+
+  MEM_freeN(map);
+  MEM_freeN(mem);
+  MEM_freeN(map_legacy);
+  MEM_freeN(mem_legacy);
+}
+
+}  // namespace blender::bke::tests
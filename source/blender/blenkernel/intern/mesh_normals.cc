@@ -17,6 +17,7 @@
 #include "DNA_meshdata_types.h"
 
 #include "BLI_alloca.h"
+#include "BLI_array.hh"
 #include "BLI_bit_vector.hh"
 #include "BLI_linklist.h"
 #include "BLI_linklist_stack.h"
@@ -37,8 +38,6 @@
 #include "BKE_mesh.hh"
 #include "BKE_mesh_mapping.h"
 
-#include "atomic_ops.h"
-
 using blender::BitVector;
 using blender::float3;
 using blender::int2;
@@ -54,46 +53,6 @@ using blender::VArray;
 #  include "BLI_timeit.hh"
 #endif
 
-/* -------------------------------------------------------------------- */
-/** \name Private Utility Functions
- * \{ */
-
-/**
- * A thread-safe version of #add_v3_v3 that uses a spin-lock.
- *
- * \note Avoid using this when the chance of contention is high.
- */
-static void add_v3_v3_atomic(float r[3], const float a[3])
-{
-#define FLT_EQ_NONAN(_fa, _fb) (*((const uint32_t *)&_fa) == *((const uint32_t *)&_fb))
-
-  float virtual_lock = r[0];
-  while (true) {
-    /* This loops until following conditions are met:
-     * - `r[0]` has same value as virtual_lock (i.e. it did not change since last try).
-     * - `r[0]` was not `FLT_MAX`, i.e. it was not locked by another thread. */
-    const float test_lock = atomic_cas_float(&r[0], virtual_lock, FLT_MAX);
-    if (_ATOMIC_LIKELY(FLT_EQ_NONAN(test_lock, virtual_lock) && (test_lock != FLT_MAX))) {
-      break;
-    }
-    virtual_lock = test_lock;
-  }
-  virtual_lock += a[0];
-  r[1] += a[1];
-  r[2] += a[2];
-
-  /* Second atomic operation to 'release'
-   * our lock on that vector and set its first scalar value. */
-  /* Note that we do not need to loop here, since we 'locked' `r[0]`,
-   * nobody should have changed it in the mean time. */
-  virtual_lock = atomic_cas_float(&r[0], FLT_MAX, virtual_lock);
-  BLI_assert(virtual_lock == FLT_MAX);
-
-#undef FLT_EQ_NONAN
-}
-
-/** \} */
-
 /* -------------------------------------------------------------------- */
 /** \name Public Utility Functions
  *
@@ -227,97 +186,152 @@ void normals_calc_polys(const Span<float3> positions,
 /* -------------------------------------------------------------------- */
 /** \name Mesh Normal Calculation (Polygons & Vertices)
  *
- * Take care making optimizations to this function as improvements to low-poly
+ * Take care making optimizations to these functions as improvements to low-poly
  * meshes can slow down high-poly meshes. For details on performance, see D11993.
+ *
+ * Vertex normals are gathered from the normals of the surrounding polygons rather than
+ * accumulated with atomics, which avoids contention on high valence vertices and gives results
+ * that are the same regardless of the number of threads.
  * \{ */
 
+/**
+ * Calculate the normal of a polygon and the angle at each of its corners, used to weight the
+ * polygon's contribution to the vertex normals. Each edge direction is only normalized once.
+ * Triangles and quads are handled with fixed size arrays so the loops can be unrolled.
+ */
+template<int Size>
+BLI_INLINE void poly_normal_and_angles_calc(const Span<float3> positions,
+                                            const Span<int> poly_verts,
+                                            float3 &r_normal,
+                                            MutableSpan<float> r_angles)
+{
+  float3 edge_dirs[Size];
+  for (int i = 0; i < Size; i++) {
+    const int i_next = (i == Size - 1) ? 0 : i + 1;
+    edge_dirs[i] = math::normalize(positions[poly_verts[i_next]] - positions[poly_verts[i]]);
+  }
+  for (int i = 0; i < Size; i++) {
+    const int i_prev = (i == 0) ? Size - 1 : i - 1;
+    r_angles[i] = saacos(-math::dot(edge_dirs[i_prev], edge_dirs[i]));
+  }
+  r_normal = poly_normal_calc(positions, poly_verts);
+}
+
+static void ngon_normal_and_angles_calc(const Span<float3> positions,
+                                        const Span<int> poly_verts,
+                                        float3 &r_normal,
+                                        MutableSpan<float> r_angles)
+{
+  const int i_end = int(poly_verts.size()) - 1;
+  float3 dir_prev = math::normalize(positions[poly_verts[0]] - positions[poly_verts[i_end]]);
+  const float3 dir_end = dir_prev;
+  for (const int i : poly_verts.index_range()) {
+    const float3 dir_next = (i == i_end) ? dir_end :
+                                           math::normalize(positions[poly_verts[i + 1]] -
+                                                           positions[poly_verts[i]]);
+    r_angles[i] = saacos(-math::dot(dir_prev, dir_next));
+    dir_prev = dir_next;
+  }
+  r_normal = poly_normal_calc(positions, poly_verts);
+}
+
 void normals_calc_poly_vert(const Span<float3> positions,
                             const Span<MPoly> polys,
                             const Span<int> corner_verts,
+                            const TopologyMap &vert_to_loop_map,
+                            const TopologyMap &vert_to_poly_map,
                             MutableSpan<float3> poly_normals,
                             MutableSpan<float3> vert_normals)
 {
+  /* Compute poly normals and the angle at every corner. */
+  Array<float> corner_angles(corner_verts.size());
+  threading::parallel_for(polys.index_range(), 1024, [&](const IndexRange range) {
+    for (const int poly_i : range) {
+      const MPoly &poly = polys[poly_i];
+      const IndexRange poly_range(poly.loopstart, poly.totloop);
+      const Span<int> poly_verts = corner_verts.slice(poly_range);
+      MutableSpan<float> angles = corner_angles.as_mutable_span().slice(poly_range);
+      switch (poly.totloop) {
+        case 3:
+          poly_normal_and_angles_calc<3>(positions, poly_verts, poly_normals[poly_i], angles);
+          break;
+        case 4:
+          poly_normal_and_angles_calc<4>(positions, poly_verts, poly_normals[poly_i], angles);
+          break;
+        default:
+          ngon_normal_and_angles_calc(positions, poly_verts, poly_normals[poly_i], angles);
+          break;
+      }
+    }
+  });
 
-  /* Zero the vertex normal array for accumulation. */
-  {
-    memset(vert_normals.data(), 0, vert_normals.as_span().size_in_bytes());
-  }
-
-  /* Compute poly normals, accumulating them into vertex normals. */
-  {
-    threading::parallel_for(polys.index_range(), 1024, [&](const IndexRange range) {
-      for (const int poly_i : range) {
-        const MPoly &poly = polys[poly_i];
-        const Span<int> poly_verts = corner_verts.slice(poly.loopstart, poly.totloop);
-
-        float3 &pnor = poly_normals[poly_i];
-
-        const int i_end = poly.totloop - 1;
-
-        /* Polygon Normal and edge-vector. */
-        /* Inline version of #poly_normal_calc, also does edge-vectors. */
-        {
-          zero_v3(pnor);
-          /* Newell's Method */
-          const float *v_curr = positions[poly_verts[i_end]];
-          for (int i_next = 0; i_next <= i_end; i_next++) {
-            const float *v_next = positions[poly_verts[i_next]];
-            add_newell_cross_v3_v3v3(pnor, v_curr, v_next);
-            v_curr = v_next;
-          }
-          if (UNLIKELY(normalize_v3(pnor) == 0.0f)) {
-            pnor[2] = 1.0f; /* Other axes set to zero. */
-          }
-        }
+  /* Gather the angle weighted normals of the polygons around every vertex. Since the corners of
+   * each vertex are always summed in the same order, the result doesn't depend on threading. */
+  const OffsetIndices<int> offsets = vert_to_loop_map.offsets();
+  const Span<int> loop_indices = vert_to_loop_map.indices;
+  const Span<int> poly_indices = vert_to_poly_map.indices;
+  threading::parallel_for(positions.index_range(), 1024, [&](const IndexRange range) {
+    for (const int vert_i : range) {
+      float3 normal(0);
+      for (const int i : offsets[vert_i]) {
+        normal += poly_normals[poly_indices[i]] * corner_angles[loop_indices[i]];
+      }
 
-        /* Accumulate angle weighted face normal into the vertex normal. */
-        /* Inline version of #accumulate_vertex_normals_poly_v3. */
-        {
-          float edvec_prev[3], edvec_next[3], edvec_end[3];
-          const float *v_curr = positions[poly_verts[i_end]];
-          sub_v3_v3v3(edvec_prev, positions[poly_verts[i_end - 1]], v_curr);
-          normalize_v3(edvec_prev);
-          copy_v3_v3(edvec_end, edvec_prev);
-
-          for (int i_next = 0, i_curr = i_end; i_next <= i_end; i_curr = i_next++) {
-            const float *v_next = positions[poly_verts[i_next]];
-
-            /* Skip an extra normalization by reusing the first calculated edge. */
-            if (i_next != i_end) {
-              sub_v3_v3v3(edvec_next, v_curr, v_next);
-              normalize_v3(edvec_next);
-            }
-            else {
-              copy_v3_v3(edvec_next, edvec_end);
-            }
-
-            /* Calculate angle between the two poly edges incident on this vertex. */
-            const float fac = saacos(-dot_v3v3(edvec_prev, edvec_next));
-            const float vnor_add[3] = {pnor[0] * fac, pnor[1] * fac, pnor[2] * fac};
-
-            float *vnor = vert_normals[poly_verts[i_curr]];
-            add_v3_v3_atomic(vnor, vnor_add);
-            v_curr = v_next;
-            copy_v3_v3(edvec_prev, edvec_next);
-          }
-        }
+      if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
+        /* Following Mesh convention; we use vertex coordinate itself for normal in this case. */
+        normalize_v3_v3(normal, positions[vert_i]);
       }
-    });
-  }
+      vert_normals[vert_i] = normal;
+    }
+  });
+}
 
-  /* Normalize and validate computed vertex normals. */
-  {
-    threading::parallel_for(positions.index_range(), 1024, [&](const IndexRange range) {
-      for (const int vert_i : range) {
-        float *no = vert_normals[vert_i];
+void normals_calc_poly_vert_partial(const Span<float3> positions,
+                                    const Span<MPoly> polys,
+                                    const Span<int> corner_verts,
+                                    const TopologyMap &vert_to_loop_map,
+                                    const TopologyMap &vert_to_poly_map,
+                                    const IndexMask poly_mask,
+                                    const IndexMask vert_mask,
+                                    MutableSpan<float3> poly_normals,
+                                    MutableSpan<float3> vert_normals)
+{
+  threading::parallel_for(poly_mask.index_range(), 1024, [&](const IndexRange range) {
+    for (const int64_t poly_i : poly_mask.slice(range)) {
+      const MPoly &poly = polys[poly_i];
+      poly_normals[poly_i] = poly_normal_calc(positions,
+                                              corner_verts.slice(poly.loopstart, poly.totloop));
+    }
+  });
 
-        if (UNLIKELY(normalize_v3(no) == 0.0f)) {
-          /* Following Mesh convention; we use vertex coordinate itself for normal in this case. */
-          normalize_v3_v3(no, positions[vert_i]);
-        }
+  /* Gather the angle weighted normals of the polygons around every selected vertex, like
+   * #normals_calc_poly_vert. The corner angles are calculated here, since only the angles at the
+   * selected vertices are needed. */
+  threading::parallel_for(vert_mask.index_range(), 1024, [&](const IndexRange range) {
+    for (const int64_t vert_i : vert_mask.slice(range)) {
+      const Span<int> vert_loops = vert_to_loop_map[vert_i];
+      const Span<int> vert_polys = vert_to_poly_map[vert_i];
+      const float3 &position = positions[vert_i];
+
+      float3 normal(0);
+      for (const int i : vert_loops.index_range()) {
+        const MPoly &poly = polys[vert_polys[i]];
+        const int loop = vert_loops[i];
+        const float3 &prev = positions[corner_verts[poly_corner_prev(poly, loop)]];
+        const float3 &next = positions[corner_verts[poly_corner_next(poly, loop)]];
+        const float3 dir_prev = math::normalize(prev - position);
+        const float3 dir_next = math::normalize(next - position);
+        const float factor = saacos(math::dot(dir_prev, dir_next));
+        normal += poly_normals[vert_polys[i]] * factor;
       }
-    });
-  }
+
+      if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
+        /* Following Mesh convention; we use vertex coordinate itself for normal in this case. */
+        normalize_v3_v3(normal, position);
+      }
+      vert_normals[vert_i] = normal;
+    }
+  });
 }
 
 }  // namespace blender::bke::mesh
@@ -349,8 +363,13 @@ blender::Span<blender::float3> Mesh::vert_normals() const
 
     this->runtime->vert_normals.reinitialize(positions.size());
     this->runtime->poly_normals.reinitialize(polys.size());
-    blender::bke::mesh::normals_calc_poly_vert(
-        positions, polys, corner_verts, this->runtime->poly_normals, this->runtime->vert_normals);
+    blender::bke::mesh::normals_calc_poly_vert(positions,
+                                               polys,
+                                               corner_verts,
+                                               this->vert_to_loop_map(),
+                                               this->vert_to_poly_map(),
+                                               this->runtime->poly_normals,
+                                               this->runtime->vert_normals);
 
     this->runtime->vert_normals_dirty = false;
     this->runtime->poly_normals_dirty = false;
@@ -0,0 +1,225 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "testing/testing.h"
+
+#ifdef WITH_TBB
+#  include <tbb/task_arena.h>
+#endif
+
+#include "BLI_array.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_vector.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.hh"
+#include "BKE_mesh_mapping.h"
+
+namespace blender::bke::tests {
+
+/** A grid of quads with some randomness in the vertical positions, stored as arrays. */
+struct GridData {
+  Array<float3> positions;
+  Array<MPoly> polys;
+  Array<int> corner_verts;
+
+  GridData(const int size) : positions(size * size), polys((size - 1) * (size - 1))
+  {
+    for (const int y : IndexRange(size)) {
+      for (const int x : IndexRange(size)) {
+        positions[y * size + x] = float3(x, y, float((x * 7 + y * 13) % 5) * 0.1f);
+      }
+    }
+    corner_verts.reinitialize(polys.size() * 4);
+    for (const int y : IndexRange(size - 1)) {
+      for (const int x : IndexRange(size - 1)) {
+        const int poly_i = y * (size - 1) + x;
+        polys[poly_i].loopstart = poly_i * 4;
+        polys[poly_i].totloop = 4;
+        MutableSpan<int> poly_verts = corner_verts.as_mutable_span().slice(poly_i * 4, 4);
+        poly_verts[0] = y * size + x;
+        poly_verts[1] = y * size + x + 1;
+        poly_verts[2] = (y + 1) * size + x + 1;
+        poly_verts[3] = (y + 1) * size + x;
+      }
+    }
+  }
+};
+
+TEST(mesh_normals, PartialUpdateMatchesFull)
+{
+  GridData grid(6);
+  const TopologyMap vert_to_loop = mesh_topology::build_vert_to_loop_topology_map(
+      grid.corner_verts, grid.positions.size());
+  const TopologyMap vert_to_poly = mesh_topology::build_vert_to_poly_topology_map(vert_to_loop,
+                                                                                  grid.polys);
+  Array<float3> poly_normals(grid.polys.size());
+  Array<float3> vert_normals(grid.positions.size());
+  mesh::normals_calc_poly_vert(grid.positions,
+                               grid.polys,
+                               grid.corner_verts,
+                               vert_to_loop,
+                               vert_to_poly,
+                               poly_normals,
+                               vert_normals);
+
+  const int moved_vert = 14;
+  grid.positions[moved_vert].z += 1.0f;
+
+  Vector<int64_t> poly_indices;
+  Vector<int64_t> vert_indices;
+  for (const int poly_i : vert_to_poly[moved_vert]) {
+    poly_indices.append(poly_i);
+    const MPoly &poly = grid.polys[poly_i];
+    for (const int vert : grid.corner_verts.as_span().slice(poly.loopstart, poly.totloop)) {
+      if (!vert_indices.contains(vert)) {
+        vert_indices.append(vert);
+      }
+    }
+  }
+  std::sort(vert_indices.begin(), vert_indices.end());
+  mesh::normals_calc_poly_vert_partial(grid.positions,
+                                       grid.polys,
+                                       grid.corner_verts,
+                                       vert_to_loop,
+                                       vert_to_poly,
+                                       poly_indices.as_span(),
+                                       vert_indices.as_span(),
+                                       poly_normals,
+                                       vert_normals);
+
+  Array<float3> expected_poly_normals(grid.polys.size());
+  Array<float3> expected_vert_normals(grid.positions.size());
+  mesh::normals_calc_poly_vert(grid.positions,
+                               grid.polys,
+                               grid.corner_verts,
+                               vert_to_loop,
+                               vert_to_poly,
+                               expected_poly_normals,
+                               expected_vert_normals);
+  EXPECT_EQ(poly_normals.as_span(), expected_poly_normals.as_span());
+  EXPECT_EQ(vert_normals.as_span(), expected_vert_normals.as_span());
+}
+
+TEST(mesh_normals, VertNormalsDeterministic)
+{
+  GridData grid(200);
+  const TopologyMap vert_to_loop = mesh_topology::build_vert_to_loop_topology_map(
+      grid.corner_verts, grid.positions.size());
+  const TopologyMap vert_to_poly = mesh_topology::build_vert_to_poly_topology_map(vert_to_loop,
+                                                                                  grid.polys);
+  Array<float3> poly_normals(grid.polys.size());
+  Array<float3> vert_normals_a(grid.positions.size());
+  Array<float3> vert_normals_b(grid.positions.size());
+  mesh::normals_calc_poly_vert(grid.positions,
+                               grid.polys,
+                               grid.corner_verts,
+                               vert_to_loop,
+                               vert_to_poly,
+                               poly_normals,
+                               vert_normals_a);
+  mesh::normals_calc_poly_vert(grid.positions,
+                               grid.polys,
+                               grid.corner_verts,
+                               vert_to_loop,
+                               vert_to_poly,
+                               poly_normals,
+                               vert_normals_b);
+  EXPECT_EQ(vert_normals_a.as_span(), vert_normals_b.as_span());
+  for (const float3 &normal : vert_normals_a) {
+    EXPECT_NEAR(math::length(normal), 1.0f, 1e-5f);
+  }
+}
+
+/** Calculate the vertex normals of a new mesh, which has no topology maps cached yet. */
+static Array<float3> grid_mesh_vert_normals(const GridData &grid)
+{
+  Mesh *mesh = BKE_mesh_new_nomain(
+      grid.positions.size(), 0, grid.corner_verts.size(), grid.polys.size());
+  mesh->vert_positions_for_write().copy_from(grid.positions);
+  mesh->polys_for_write().copy_from(grid.polys);
+  mesh->corner_verts_for_write().copy_from(grid.corner_verts);
+  Array<float3> vert_normals(mesh->vert_normals());
+  BKE_id_free(nullptr, mesh);
+  return vert_normals;
+}
+
+TEST(mesh_normals, VertNormalsIndependentOfThreadCount)
+{
+  BKE_idtype_init();
+  GridData grid(200);
+  /* A high valence vertex, whose normal is summed from many polygons. */
+  grid.positions[grid.positions.size() / 2].z = 10.0f;
+
+  const Array<float3> vert_normals = grid_mesh_vert_normals(grid);
+#ifdef WITH_TBB
+  for (const int threads_num : {1, 3}) {
+    tbb::task_arena arena(threads_num);
+    arena.execute([&]() {
+      const Array<float3> vert_normals_arena = grid_mesh_vert_normals(grid);
+      EXPECT_EQ(vert_normals.as_span(), vert_normals_arena.as_span());
+    });
+  }
+#endif
+}
+
+TEST(mesh_normals, TagPositionsChangedPartial)
+{
+  BKE_idtype_init();
+  GridData grid(10);
+  Mesh *mesh = BKE_mesh_new_nomain(
+      grid.positions.size(), 0, grid.corner_verts.size(), grid.polys.size());
+  mesh->vert_positions_for_write().copy_from(grid.positions);
+  mesh->polys_for_write().copy_from(grid.polys);
+  mesh->corner_verts_for_write().copy_from(grid.corner_verts);
+  mesh->vert_normals();
+  mesh->looptris();
+
+  const int moved_vert = 44;
+  mesh->vert_positions_for_write()[moved_vert].z += 1.0f;
+  mesh::tag_positions_changed_partial(*mesh, IndexMask(IndexRange(moved_vert, 1)));
+  const Array<float3> poly_normals(mesh->poly_normals());
+  const Array<float3> vert_normals(mesh->vert_normals());
+  const Array<MLoopTri> looptris(mesh->looptris());
+
+  BKE_mesh_tag_positions_changed(mesh);
+  EXPECT_EQ(poly_normals.as_span(), mesh->poly_normals());
+  EXPECT_EQ(vert_normals.as_span(), mesh->vert_normals());
+  const Span<MLoopTri> expected_looptris = mesh->looptris();
+  for (const int i : looptris.index_range()) {
+    EXPECT_EQ(looptris[i].poly, expected_looptris[i].poly);
+    for (const int j : IndexRange(3)) {
+      EXPECT_EQ(looptris[i].tri[j], expected_looptris[i].tri[j]);
+    }
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST(mesh_normals, PartialLooptrisMatchFull)
+{
+  GridData grid(4);
+  Array<MLoopTri> looptris(poly_to_tri_count(int(grid.polys.size()),
+                                             int(grid.corner_verts.size())));
+  mesh::looptris_calc(grid.positions, grid.polys, grid.corner_verts, looptris);
+
+  /* Move a vertex of the first quad out of its plane, which can change the split diagonal. */
+  grid.positions[0].z = 2.0f;
+  mesh::looptris_calc_partial(grid.positions, grid.polys, grid.corner_verts, {}, {0}, looptris);
+
+  Array<MLoopTri> expected(looptris.size());
+  mesh::looptris_calc(grid.positions, grid.polys, grid.corner_verts, expected);
+  for (const int i : looptris.index_range()) {
+    EXPECT_EQ(looptris[i].poly, expected[i].poly);
+    for (const int j : IndexRange(3)) {
+      EXPECT_EQ(looptris[i].tri[j], expected[i].tri[j]);
+    }
+  }
+}
+
+}  // namespace blender::bke::tests
@@ -13,14 +13,18 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_implicit_sharing.hh"
 #include "BLI_math_geom.h"
 #include "BLI_task.hh"
 #include "BLI_timeit.hh"
 
+#include "BKE_armature.h"
 #include "BKE_bvhutils.h"
+#include "BKE_customdata.h"
 #include "BKE_editmesh_cache.h"
 #include "BKE_lib_id.h"
 #include "BKE_mesh.hh"
+#include "BKE_mesh_mapping.h"
 #include "BKE_mesh_runtime.h"
 #include "BKE_shrinkwrap.h"
 #include "BKE_subdiv_ccg.h"
@@ -71,11 +75,22 @@ static void free_subdiv_ccg(MeshRuntime &mesh_runtime)
 }
 
 static void free_bvh_cache(MeshRuntime &mesh_runtime)
+{
+  if (mesh_runtime.bvh_cache) {
+    /* The topology didn't change, so the trees can be refit to new positions later. */
+    bvhcache_free_to_pool(mesh_runtime.bvh_cache, *mesh_runtime.bvh_tree_pool);
+    mesh_runtime.bvh_cache = nullptr;
+  }
+}
+
+static void free_bvh_cache_topology_changed(MeshRuntime &mesh_runtime)
 {
   if (mesh_runtime.bvh_cache) {
     bvhcache_free(mesh_runtime.bvh_cache);
     mesh_runtime.bvh_cache = nullptr;
   }
+  /* Other meshes sharing the pool still have the old topology. */
+  mesh_runtime.bvh_tree_pool = bvhtree_pool_new();
 }
 
 static void reset_normals(MeshRuntime &mesh_runtime)
@@ -86,6 +101,24 @@ static void reset_normals(MeshRuntime &mesh_runtime)
   mesh_runtime.poly_normals_dirty = true;
 }
 
+static void free_armature_weight_cache_locked(MeshRuntime &mesh_runtime)
+{
+  if (mesh_runtime.armature_weight_cache) {
+    BKE_armature_weight_cache_release(mesh_runtime.armature_weight_cache);
+    mesh_runtime.armature_weight_cache = nullptr;
+  }
+  if (mesh_runtime.armature_weight_cache_sharing_info) {
+    mesh_runtime.armature_weight_cache_sharing_info->user_remove();
+    mesh_runtime.armature_weight_cache_sharing_info = nullptr;
+  }
+}
+
+static void free_armature_weight_cache(MeshRuntime &mesh_runtime)
+{
+  std::lock_guard lock{mesh_runtime.armature_weight_cache_mutex};
+  free_armature_weight_cache_locked(mesh_runtime);
+}
+
 static void free_batch_cache(MeshRuntime &mesh_runtime)
 {
   if (mesh_runtime.batch_cache) {
@@ -94,6 +127,8 @@ static void free_batch_cache(MeshRuntime &mesh_runtime)
   }
 }
 
+MeshRuntime::MeshRuntime() : bvh_tree_pool(bvhtree_pool_new()) {}
+
 MeshRuntime::~MeshRuntime()
 {
   free_mesh_eval(*this);
@@ -101,6 +136,7 @@ MeshRuntime::~MeshRuntime()
   free_bvh_cache(*this);
   free_edit_data(*this);
   free_batch_cache(*this);
+  free_armature_weight_cache(*this);
   if (this->shrinkwrap_data) {
     BKE_shrinkwrap_boundary_data_free(this->shrinkwrap_data);
   }
@@ -141,6 +177,34 @@ void Mesh::loose_edges_tag_none() const
   });
 }
 
+const blender::bke::TopologyMap &Mesh::vert_to_edge_map() const
+{
+  using namespace blender::bke;
+  this->runtime->vert_to_edge_map_cache.ensure([&](TopologyMap &r_data) {
+    r_data = mesh_topology::build_vert_to_edge_topology_map(this->edges(), this->totvert);
+  });
+  return this->runtime->vert_to_edge_map_cache.data();
+}
+
+const blender::bke::TopologyMap &Mesh::vert_to_loop_map() const
+{
+  using namespace blender::bke;
+  this->runtime->vert_to_loop_map_cache.ensure([&](TopologyMap &r_data) {
+    r_data = mesh_topology::build_vert_to_loop_topology_map(this->corner_verts(), this->totvert);
+  });
+  return this->runtime->vert_to_loop_map_cache.data();
+}
+
+const blender::bke::TopologyMap &Mesh::vert_to_poly_map() const
+{
+  using namespace blender::bke;
+  this->runtime->vert_to_poly_map_cache.ensure([&](TopologyMap &r_data) {
+    r_data = mesh_topology::build_vert_to_poly_topology_map(this->vert_to_loop_map(),
+                                                            this->polys());
+  });
+  return this->runtime->vert_to_poly_map_cache.data();
+}
+
 blender::Span<MLoopTri> Mesh::looptris() const
 {
   this->runtime->looptris_cache.ensure([&](blender::Array<MLoopTri> &r_data) {
@@ -214,28 +278,62 @@ void BKE_mesh_runtime_clear_cache(Mesh *mesh)
 void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
 {
   /* Tagging shared caches dirty will free the allocated data if there is only one user. */
-  free_bvh_cache(*mesh->runtime);
+  free_bvh_cache_topology_changed(*mesh->runtime);
   reset_normals(*mesh->runtime);
   free_subdiv_ccg(*mesh->runtime);
   mesh->runtime->bounds_cache.tag_dirty();
   mesh->runtime->loose_edges_cache.tag_dirty();
   mesh->runtime->looptris_cache.tag_dirty();
+  mesh->runtime->vert_to_edge_map_cache.tag_dirty();
+  mesh->runtime->vert_to_poly_map_cache.tag_dirty();
+  mesh->runtime->vert_to_loop_map_cache.tag_dirty();
   mesh->runtime->subsurf_face_dot_tags.clear_and_shrink();
   mesh->runtime->subsurf_optimal_display_edges.clear_and_shrink();
+  free_armature_weight_cache(*mesh->runtime);
   if (mesh->runtime->shrinkwrap_data) {
     BKE_shrinkwrap_boundary_data_free(mesh->runtime->shrinkwrap_data);
   }
 }
 
+ArmatureWeightCache **BKE_mesh_runtime_armature_weight_cache_lock(const Mesh *mesh,
+                                                                  const MDeformVert *dverts)
+{
+  const int layer_index = CustomData_get_layer_index(&mesh->vdata, CD_MDEFORMVERT);
+  if (layer_index == -1) {
+    return nullptr;
+  }
+  const CustomDataLayer &layer = mesh->vdata.layers[layer_index];
+  if (layer.data != dverts || layer.sharing_info == nullptr) {
+    /* Without sharing info, the weights could be changed in place. */
+    return nullptr;
+  }
+
+  blender::bke::MeshRuntime &runtime = *mesh->runtime;
+  runtime.armature_weight_cache_mutex.lock();
+  if (runtime.armature_weight_cache_sharing_info != layer.sharing_info) {
+    blender::bke::free_armature_weight_cache_locked(runtime);
+    layer.sharing_info->user_add();
+    runtime.armature_weight_cache_sharing_info = layer.sharing_info;
+  }
+  return &runtime.armature_weight_cache;
+}
+
+void BKE_mesh_runtime_armature_weight_cache_unlock(const Mesh *mesh)
+{
+  mesh->runtime->armature_weight_cache_mutex.unlock();
+}
+
 void BKE_mesh_tag_edges_split(struct Mesh *mesh)
 {
   /* Triangulation didn't change because vertex positions and loop vertex indices didn't change.
+   * For the same reason, the vertex to face and face corner maps are still valid.
    * Face normals didn't change either, but tag those anyway, since there is no API function to
    * only tag vertex normals dirty. */
-  free_bvh_cache(*mesh->runtime);
+  free_bvh_cache_topology_changed(*mesh->runtime);
   reset_normals(*mesh->runtime);
   free_subdiv_ccg(*mesh->runtime);
   mesh->runtime->loose_edges_cache.tag_dirty();
+  mesh->runtime->vert_to_edge_map_cache.tag_dirty();
   mesh->runtime->subsurf_face_dot_tags.clear_and_shrink();
   mesh->runtime->subsurf_optimal_display_edges.clear_and_shrink();
   if (mesh->runtime->shrinkwrap_data) {
@@ -252,6 +350,97 @@ void BKE_mesh_tag_positions_changed(Mesh *mesh)
   mesh->runtime->bounds_cache.tag_dirty();
 }
 
+namespace blender::bke::mesh {
+
+/** Collect the sorted unique indices of the elements connected to any of the selected ones. */
+static Vector<int64_t> gather_connected_indices(const TopologyMap &map, const IndexMask mask)
+{
+  Vector<int64_t> indices;
+  for (const int64_t i : mask) {
+    for (const int index : map[i]) {
+      indices.append(index);
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+  indices.resize(std::unique(indices.begin(), indices.end()) - indices.begin());
+  return indices;
+}
+
+void tag_positions_changed_partial(Mesh &mesh, const IndexMask changed_verts)
+{
+  MeshRuntime &runtime = *mesh.runtime;
+  const bool update_poly_normals = !runtime.poly_normals_dirty;
+  const bool update_vert_normals = !runtime.vert_normals_dirty;
+  const bool update_looptris = runtime.looptris_cache.is_cached();
+  if (!update_poly_normals && !update_vert_normals && !update_looptris) {
+    BKE_mesh_tag_positions_changed(&mesh);
+    return;
+  }
+  /* Vertex normals are gathered from the surrounding face normals, which must be valid. */
+  if (update_vert_normals && !update_poly_normals) {
+    BKE_mesh_tag_positions_changed(&mesh);
+    return;
+  }
+  /* Updating a large part of the mesh is slower than recalculating everything at once. */
+  if (changed_verts.size() > mesh.totvert / 4) {
+    BKE_mesh_tag_positions_changed(&mesh);
+    return;
+  }
+
+  const Span<float3> positions = mesh.vert_positions();
+  const Span<MPoly> polys = mesh.polys();
+  const Span<int> corner_verts = mesh.corner_verts();
+  const Vector<int64_t> poly_indices = gather_connected_indices(mesh.vert_to_poly_map(),
+                                                                changed_verts);
+  const IndexMask poly_mask(poly_indices);
+
+  if (update_vert_normals) {
+    /* The normals of all vertices of the changed polygons may change, not just the normals of the
+     * vertices that were moved. */
+    Vector<int64_t> vert_indices;
+    for (const int64_t poly_i : poly_mask) {
+      const MPoly &poly = polys[poly_i];
+      for (const int vert : corner_verts.slice(poly.loopstart, poly.totloop)) {
+        vert_indices.append(vert);
+      }
+    }
+    std::sort(vert_indices.begin(), vert_indices.end());
+    vert_indices.resize(std::unique(vert_indices.begin(), vert_indices.end()) -
+                        vert_indices.begin());
+    normals_calc_poly_vert_partial(positions,
+                                   polys,
+                                   corner_verts,
+                                   mesh.vert_to_loop_map(),
+                                   mesh.vert_to_poly_map(),
+                                   poly_mask,
+                                   vert_indices.as_span(),
+                                   runtime.poly_normals,
+                                   runtime.vert_normals);
+  }
+  else if (update_poly_normals) {
+    threading::parallel_for(poly_mask.index_range(), 1024, [&](const IndexRange range) {
+      for (const int64_t poly_i : poly_mask.slice(range)) {
+        const MPoly &poly = polys[poly_i];
+        runtime.poly_normals[poly_i] = poly_normal_calc(
+            positions, corner_verts.slice(poly.loopstart, poly.totloop));
+      }
+    });
+  }
+
+  if (update_looptris) {
+    const Span<float3> poly_normals = update_poly_normals ? runtime.poly_normals.as_span() :
+                                                            Span<float3>();
+    runtime.looptris_cache.update([&](Array<MLoopTri> &looptris) {
+      looptris_calc_partial(positions, polys, corner_verts, poly_normals, poly_mask, looptris);
+    });
+  }
+
+  free_bvh_cache(runtime);
+  runtime.bounds_cache.tag_dirty();
+}
+
+}  // namespace blender::bke::mesh
+
 void BKE_mesh_tag_positions_changed_uniformly(Mesh *mesh)
 {
   /* The normals and triangulation didn't change, since all verts moved by the same amount. */
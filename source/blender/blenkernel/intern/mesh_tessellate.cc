@@ -15,6 +15,7 @@
 #include "BLI_memarena.h"
 #include "BLI_polyfill_2d.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 
 #include "BKE_mesh.hh"
 
@@ -323,6 +324,49 @@ void looptris_calc_with_normals(const Span<float3> vert_positions,
   looptris_calc_all(vert_positions, polys, corner_verts, poly_normals, looptris);
 }
 
+void looptris_calc_partial(const Span<float3> vert_positions,
+                           const Span<MPoly> polys,
+                           const Span<int> corner_verts,
+                           const Span<float3> poly_normals,
+                           const IndexMask poly_mask,
+                           MutableSpan<MLoopTri> looptris)
+{
+  threading::EnumerableThreadSpecific<MemArena *> pf_arenas;
+  threading::parallel_for(poly_mask.index_range(), 1024, [&](const IndexRange range) {
+    MemArena *&pf_arena = pf_arenas.local();
+    for (const int64_t poly_i : poly_mask.slice(range)) {
+      const MPoly &poly = polys[poly_i];
+      if (poly.totloop == 3) {
+        /* The triangulation of triangles doesn't depend on positions. */
+        continue;
+      }
+      const int tri_index = poly_to_tri_count(int(poly_i), poly.loopstart);
+      if (poly_normals.is_empty()) {
+        mesh_calc_tessellation_for_face(corner_verts,
+                                        polys,
+                                        vert_positions,
+                                        uint(poly_i),
+                                        &looptris[tri_index],
+                                        &pf_arena);
+      }
+      else {
+        mesh_calc_tessellation_for_face_with_normal(corner_verts,
+                                                    polys,
+                                                    vert_positions,
+                                                    uint(poly_i),
+                                                    &looptris[tri_index],
+                                                    &pf_arena,
+                                                    poly_normals[poly_i]);
+      }
+    }
+  });
+  for (MemArena *pf_arena : pf_arenas) {
+    if (pf_arena) {
+      BLI_memarena_free(pf_arena);
+    }
+  }
+}
+
 }  // namespace blender::bke::mesh
 
 void BKE_mesh_recalc_looptri(const int *corner_verts,
@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_string.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idprop.hh"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_material.h"
+#include "BKE_mesh.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::bke::tests {
+
+struct MeshCopyOnWriteTestContext {
+  Main *bmain = nullptr;
+  Mesh *mesh = nullptr;
+  Material *material = nullptr;
+
+  MeshCopyOnWriteTestContext()
+  {
+    BKE_idtype_init();
+    bmain = BKE_main_new();
+    mesh = BKE_mesh_add(bmain, "Mesh");
+    material = BKE_material_add(bmain, "Material");
+    BKE_id_material_append(bmain, &mesh->id, material);
+
+    bDeformGroup *group = MEM_cnew<bDeformGroup>(__func__);
+    STRNCPY(group->name, "Group");
+    BLI_addtail(&mesh->vertex_group_names, group);
+
+    IDP_AddToGroup(IDP_GetProperties(&mesh->id, true), idprop::create("prop", 1).release());
+
+    set_positions({float3(0.0f), float3(1.0f)});
+  }
+  ~MeshCopyOnWriteTestContext()
+  {
+    BKE_main_free(bmain);
+  }
+
+  void set_positions(Span<float3> positions)
+  {
+    CustomData_free(&mesh->vdata, mesh->totvert);
+    mesh->totvert = int(positions.size());
+    float3 *data = static_cast<float3 *>(CustomData_add_layer_named(
+        &mesh->vdata, CD_PROP_FLOAT3, CD_CONSTRUCT, mesh->totvert, "position"));
+    std::copy(positions.begin(), positions.end(), data);
+    BKE_mesh_tag_topology_changed(mesh);
+  }
+};
+
+static Mesh *copy_for_copy_on_write(const Mesh *mesh)
+{
+  const int flags = LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT |
+                    LIB_ID_COPY_SET_COPIED_ON_WRITE;
+  return reinterpret_cast<Mesh *>(BKE_id_copy_ex(nullptr, &mesh->id, nullptr, flags));
+}
+
+static void expect_meshes_equal(const Mesh *a, const Mesh *b)
+{
+  EXPECT_EQ(a->totvert, b->totvert);
+  EXPECT_EQ(a->vert_positions(), b->vert_positions());
+  EXPECT_EQ(CustomData_number_of_layers(&a->vdata, CD_PROP_FLOAT3),
+            CustomData_number_of_layers(&b->vdata, CD_PROP_FLOAT3));
+  EXPECT_EQ(a->totcol, b->totcol);
+  for (int i = 0; i < std::min(a->totcol, b->totcol); i++) {
+    EXPECT_EQ(a->mat[i], b->mat[i]);
+  }
+  EXPECT_EQ(BLI_listbase_count(&a->vertex_group_names),
+            BLI_listbase_count(&b->vertex_group_names));
+  EXPECT_TRUE(IDP_EqualsProperties(a->id.properties, b->id.properties));
+}
+
+TEST(mesh_copy_on_write, UpdateGeometryMatchesFullCopy)
+{
+  MeshCopyOnWriteTestContext ctx;
+  Mesh *mesh_cow = copy_for_copy_on_write(ctx.mesh);
+
+  ctx.set_positions({float3(2.0f), float3(3.0f), float3(4.0f)});
+  ASSERT_TRUE(BKE_mesh_can_avoid_full_copy_on_write(ctx.mesh, mesh_cow));
+  BKE_mesh_update_geometry_on_write(ctx.mesh, mesh_cow);
+
+  Mesh *mesh_full_copy = copy_for_copy_on_write(ctx.mesh);
+  expect_meshes_equal(mesh_cow, mesh_full_copy);
+  EXPECT_EQ(mesh_cow->vert_positions()[2], float3(4.0f));
+  /* Trees built for the copy can be reused by the original and other copies. */
+  EXPECT_EQ(mesh_cow->runtime->bvh_tree_pool, ctx.mesh->runtime->bvh_tree_pool);
+
+  BKE_id_free(nullptr, mesh_cow);
+  BKE_id_free(nullptr, mesh_full_copy);
+}
+
+TEST(mesh_copy_on_write, ChangesOutsideGeometryNeedFullCopy)
+{
+  MeshCopyOnWriteTestContext ctx;
+  Mesh *mesh_cow = copy_for_copy_on_write(ctx.mesh);
+  EXPECT_TRUE(BKE_mesh_can_avoid_full_copy_on_write(ctx.mesh, mesh_cow));
+
+  IDP_Int(IDP_GetPropertyFromGroup(ctx.mesh->id.properties, "prop")) = 2;
+  EXPECT_FALSE(BKE_mesh_can_avoid_full_copy_on_write(ctx.mesh, mesh_cow));
+  IDP_Int(IDP_GetPropertyFromGroup(ctx.mesh->id.properties, "prop")) = 1;
+
+  STRNCPY(static_cast<bDeformGroup *>(ctx.mesh->vertex_group_names.first)->name, "Other");
+  EXPECT_FALSE(BKE_mesh_can_avoid_full_copy_on_write(ctx.mesh, mesh_cow));
+  STRNCPY(static_cast<bDeformGroup *>(ctx.mesh->vertex_group_names.first)->name, "Group");
+
+  BKE_id_material_append(ctx.bmain, &ctx.mesh->id, ctx.material);
+  EXPECT_FALSE(BKE_mesh_can_avoid_full_copy_on_write(ctx.mesh, mesh_cow));
+
+  BKE_id_free(nullptr, mesh_cow);
+}
+
+}  // namespace blender::bke::tests
@@ -1113,6 +1113,7 @@ bool BKE_mesh_validate(Mesh *me, const bool do_verbose, const bool cddata_check_
       &changed);
 
   if (changed) {
+    BKE_mesh_tag_topology_changed(me);
     DEG_id_tag_update(&me->id, ID_RECALC_GEOMETRY_ALL_MODES);
     return true;
   }
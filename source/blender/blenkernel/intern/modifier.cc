@@ -38,6 +38,7 @@
 #include "BLI_session_uuid.h"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
+#include "BLI_trace.hh"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -1003,6 +1004,7 @@ struct Mesh *BKE_modifier_modify_mesh(ModifierData *md,
   if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
+  SCOPED_TRACE_EVENT("modifier", md->name);
   return mti->modifyMesh(md, ctx, me);
 }
 
@@ -1016,7 +1018,10 @@ void BKE_modifier_deform_verts(ModifierData *md,
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
-  mti->deformVerts(md, ctx, me, vertexCos, numVerts);
+  {
+    SCOPED_TRACE_EVENT("modifier", md->name);
+    mti->deformVerts(md, ctx, me, vertexCos, numVerts);
+  }
   if (me) {
     BKE_mesh_tag_positions_changed(me);
   }
@@ -1033,6 +1038,7 @@ void BKE_modifier_deform_vertsEM(ModifierData *md,
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
+  SCOPED_TRACE_EVENT("modifier", md->name);
   mti->deformVertsEM(md, ctx, em, me, vertexCos, numVerts);
 }
 
@@ -72,13 +72,8 @@ void multires_reshape_apply_base_refit_base_mesh(MultiresReshapeContext *reshape
   reshape_context->base_positions = base_positions;
   MeshElemMap *pmap;
   int *pmap_mem;
-  BKE_mesh_vert_poly_map_create(&pmap,
-                                &pmap_mem,
-                                reshape_context->base_polys.data(),
-                                reshape_context->base_corner_verts.data(),
-                                base_mesh->totvert,
-                                base_mesh->totpoly,
-                                base_mesh->totloop);
+  blender::bke::mesh_topology::topology_map_to_elem_map(
+      base_mesh->vert_to_poly_map(), &pmap, &pmap_mem);
 
   float(*origco)[3] = static_cast<float(*)[3]>(
       MEM_calloc_arrayN(base_mesh->totvert, sizeof(float[3]), __func__));
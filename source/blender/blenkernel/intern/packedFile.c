@@ -25,6 +25,7 @@
 #include "DNA_volume_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_image.h"
@@ -41,6 +42,37 @@
 
 #include "BLO_read_write.h"
 
+#include "atomic_ops.h"
+
+/** Protects loading the data of packed files that were read with deferred data. */
+static ThreadMutex packedfile_deferred_mutex = BLI_MUTEX_INITIALIZER;
+
+bool BKE_packedfile_ensure_data(PackedFile *pf)
+{
+  /* Once the data is set it never changes back, the acquire load makes sure its contents are
+   * visible when it was just read by another thread. */
+  if (atomic_load_ptr(&pf->data) != NULL) {
+    return true;
+  }
+
+  bool success = true;
+  BLI_mutex_lock(&packedfile_deferred_mutex);
+  if (pf->data == NULL) {
+    BLI_assert(pf->deferred_data != NULL);
+    void *data = MEM_mallocN(pf->size, "PackedFile deferred data");
+    if (!BLO_read_deferred_data(pf->deferred_data, data)) {
+      memset(data, 0, pf->size);
+      success = false;
+    }
+    BLO_deferred_data_free(pf->deferred_data);
+    pf->deferred_data = NULL;
+    atomic_store_ptr(&pf->data, data);
+  }
+  BLI_mutex_unlock(&packedfile_deferred_mutex);
+
+  return success;
+}
+
 int BKE_packedfile_seek(PackedFile *pf, int offset, int whence)
 {
   int oldseek = -1, seek = 0;
@@ -86,6 +118,7 @@ int BKE_packedfile_read(PackedFile *pf, void *data, int size)
     }
 
     if (size > 0) {
+      BKE_packedfile_ensure_data(pf);
       memcpy(data, ((char *)pf->data) + pf->seek, size);
     }
     else {
@@ -140,9 +173,12 @@ int BKE_packedfile_count_all(Main *bmain)
 void BKE_packedfile_free(PackedFile *pf)
 {
   if (pf) {
-    BLI_assert(pf->data != NULL);
+    BLI_assert(pf->data != NULL || pf->deferred_data != NULL);
 
     MEM_SAFE_FREE(pf->data);
+    if (pf->deferred_data) {
+      BLO_deferred_data_free(pf->deferred_data);
+    }
     MEM_freeN(pf);
   }
   else {
@@ -153,12 +189,19 @@ void BKE_packedfile_free(PackedFile *pf)
 PackedFile *BKE_packedfile_duplicate(const PackedFile *pf_src)
 {
   BLI_assert(pf_src != NULL);
-  BLI_assert(pf_src->data != NULL);
+  BLI_assert(pf_src->data != NULL || pf_src->deferred_data != NULL);
 
   PackedFile *pf_dst;
 
+  /* Copies (e.g. for evaluation) don't need the data to be loaded,
+   * they can read it from the file on their own when needed. */
+  BLI_mutex_lock(&packedfile_deferred_mutex);
   pf_dst = MEM_dupallocN(pf_src);
   pf_dst->data = MEM_dupallocN(pf_src->data);
+  if (pf_dst->deferred_data) {
+    BLO_deferred_data_user_add(pf_dst->deferred_data);
+  }
+  BLI_mutex_unlock(&packedfile_deferred_mutex);
 
   return pf_dst;
 }
@@ -323,6 +366,7 @@ int BKE_packedfile_write_to_file(ReportList *reports,
     ret_value = RET_ERROR;
   }
   else {
+    BKE_packedfile_ensure_data(pf);
     if (write(file, pf->data, pf->size) != pf->size) {
       BKE_reportf(reports, RPT_ERROR, "Error writing file '%s'", name);
       ret_value = RET_ERROR;
@@ -385,6 +429,7 @@ enum ePF_FileCompare BKE_packedfile_compare_to_file(const char *ref_file_name,
     else {
       ret_val = PF_CMP_EQUAL;
 
+      BKE_packedfile_ensure_data(pf);
       for (int i = 0; i < pf->size; i += sizeof(buf)) {
         int len = pf->size - i;
         if (len > sizeof(buf)) {
@@ -503,7 +548,8 @@ static void unpack_generate_paths(const char *name,
       Image *ima = (Image *)id;
       ImagePackedFile *imapf = ima->packedfiles.last;
       if (imapf != NULL && imapf->packedfile != NULL) {
-        const PackedFile *pf = imapf->packedfile;
+        PackedFile *pf = imapf->packedfile;
+        BKE_packedfile_ensure_data(pf);
         enum eImbFileType ftype = IMB_ispic_type_from_memory((const uchar *)pf->data, pf->size);
         if (ima->source == IMA_SRC_TILED) {
           char tile_number[6];
@@ -863,8 +909,39 @@ void BKE_packedfile_blend_write(BlendWriter *writer, PackedFile *pf)
   if (pf == NULL) {
     return;
   }
-  BLO_write_struct(writer, PackedFile, pf);
-  BLO_write_raw(writer, pf->size, pf->data);
+  PackedFile pf_write = *pf;
+  pf_write.deferred_data = NULL;
+
+  BLI_mutex_lock(&packedfile_deferred_mutex);
+  if (pf->data != NULL) {
+    BLI_mutex_unlock(&packedfile_deferred_mutex);
+    BLO_write_struct_at_address(writer, PackedFile, pf, &pf_write);
+    BLO_write_raw(writer, pf->size, pf->data);
+    return;
+  }
+
+  BLODeferredData *deferred = pf->deferred_data;
+  if (BLO_write_is_undo(writer)) {
+    /* Undo steps only store where the data is, and keep it available until they are freed. */
+    pf_write.deferred_data = deferred;
+    BLO_write_struct_at_address(writer, PackedFile, pf, &pf_write);
+    BLO_write_deferred_data(writer, deferred);
+    BLI_mutex_unlock(&packedfile_deferred_mutex);
+    return;
+  }
+  BLO_deferred_data_user_add(deferred);
+  BLI_mutex_unlock(&packedfile_deferred_mutex);
+
+  /* Write a temporary copy of the data, loading it for the packed file isn't necessary. */
+  void *data = MEM_mallocN(pf->size, __func__);
+  if (!BLO_read_deferred_data(deferred, data)) {
+    memset(data, 0, pf->size);
+  }
+  BLO_deferred_data_free(deferred);
+  pf_write.data = data;
+  BLO_write_struct_at_address(writer, PackedFile, pf, &pf_write);
+  BLO_write_raw(writer, pf->size, data);
+  MEM_freeN(data);
 }
 
 void BKE_packedfile_blend_read(BlendDataReader *reader, PackedFile **pf_p)
@@ -875,6 +952,20 @@ void BKE_packedfile_blend_read(BlendDataReader *reader, PackedFile **pf_p)
     return;
   }
 
+  if (pf->data == NULL && pf->deferred_data != NULL) {
+    /* Written for undo while the data wasn't loaded yet. */
+    BLO_read_deferred_data_address(reader, &pf->deferred_data);
+    if (pf->deferred_data != NULL) {
+      return;
+    }
+  }
+
+  pf->deferred_data = BLO_read_data_defer(reader, pf->data);
+  if (pf->deferred_data != NULL) {
+    pf->data = NULL;
+    return;
+  }
+
   BLO_read_packed_address(reader, &pf->data);
   if (pf->data == NULL) {
     /* We cannot allow a PackedFile with a NULL data field,
@@ -1763,13 +1763,8 @@ static void sculpt_update_object(
   sculpt_update_persistent_base(ob);
 
   if (need_pmap && ob->type == OB_MESH && !ss->pmap) {
-    BKE_mesh_vert_poly_map_create(&ss->pmap,
-                                  &ss->pmap_mem,
-                                  me->polys().data(),
-                                  me->corner_verts().data(),
-                                  me->totvert,
-                                  me->totpoly,
-                                  me->totloop);
+    blender::bke::mesh_topology::topology_map_to_elem_map(
+        me->vert_to_poly_map(), &ss->pmap, &ss->pmap_mem);
 
     if (ss->pbvh) {
       BKE_pbvh_pmap_set(ss->pbvh, ss->pmap);
@@ -2584,6 +2579,8 @@ static bool sculpt_attr_update(Object *ob, SculptAttribute *attr)
         attr->bmesh_cd_offset = cdata->layers[layer_index].offset;
       }
       else {
+        /* Sculpt writes to the attribute through this pointer, the data must not be shared. */
+        CustomData_ensure_data_is_mutable(&cdata->layers[layer_index], elem_num);
         attr->data = cdata->layers[layer_index].data;
       }
     }
@@ -2700,6 +2697,8 @@ SculptAttribute *BKE_sculpt_attribute_get(struct Object *ob,
       attr->used = true;
       attr->domain = domain;
       attr->proptype = proptype;
+      /* Sculpt writes to the attribute through this pointer, the data must not be shared. */
+      CustomData_ensure_data_is_mutable(&cdata->layers[index], totelem);
       attr->data = cdata->layers[index].data;
       attr->bmesh_cd_offset = cdata->layers[index].offset;
       attr->elem_num = totelem;
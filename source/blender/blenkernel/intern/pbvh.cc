@@ -1646,6 +1646,10 @@ bool BKE_pbvh_get_color_layer(const Mesh *me, CustomDataLayer **r_layer, eAttrDo
     return false;
   }
 
+  /* The layer is modified directly when painting, so its data must not be shared. */
+  CustomData_ensure_data_is_mutable(layer,
+                                    BKE_id_attribute_data_length(const_cast<ID *>(&me->id), layer));
+
   *r_layer = layer;
   *r_attr = domain;
 
@@ -556,6 +556,7 @@ static void sound_load_audio(Main *bmain, bSound *sound, bool free_waveform)
 
     /* but we need a packed file then */
     if (pf) {
+      BKE_packedfile_ensure_data(pf);
       sound->handle = AUD_Sound_bufferFile((uchar *)pf->data, pf->size);
     }
     else {
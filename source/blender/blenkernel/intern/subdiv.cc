@@ -11,8 +11,13 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
 
+#include "BLI_array.hh"
+#include "BLI_hash_mm2a.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
+#include "BKE_customdata.h"
+#include "BKE_mesh.hh"
 #include "BKE_modifier.h"
 #include "BKE_subdiv_modifier.h"
 
@@ -168,14 +173,101 @@ Subdiv *BKE_subdiv_update_from_converter(Subdiv *subdiv,
   return BKE_subdiv_new_from_converter(settings, converter);
 }
 
+static uint64_t topology_hash_combine(const uint64_t hash, const uint64_t value)
+{
+  /* 64 bit FNV prime, so that the order of the combined values matters. */
+  return (hash ^ value) * 1099511628211ULL;
+}
+
+/**
+ * Hash the data in fixed size chunks in parallel. Chunk hashes are combined in order, so the
+ * result does not depend on the number of threads.
+ */
+static uint64_t topology_hash_add_data(const uint64_t hash,
+                                       const void *data,
+                                       const int64_t size_in_bytes)
+{
+  using namespace blender;
+  if (size_in_bytes == 0) {
+    return topology_hash_combine(hash, 0);
+  }
+  constexpr int64_t chunk_size = 1 << 16;
+  const int64_t chunks_num = (size_in_bytes + chunk_size - 1) / chunk_size;
+  Array<uint64_t> chunk_hashes(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 4, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      const int64_t offset = chunk * chunk_size;
+      const size_t size = size_t(std::min(chunk_size, size_in_bytes - offset));
+      const uchar *chunk_data = static_cast<const uchar *>(data) + offset;
+      /* Two 32 bit hashes with different seeds, to make collisions unlikely. */
+      chunk_hashes[chunk] = (uint64_t(BLI_hash_mm2(chunk_data, size, 0)) << 32) |
+                            uint64_t(BLI_hash_mm2(chunk_data, size, 1));
+    }
+  });
+  uint64_t result = topology_hash_combine(hash, uint64_t(size_in_bytes));
+  for (const uint64_t chunk_hash : chunk_hashes) {
+    result = topology_hash_combine(result, chunk_hash);
+  }
+  return result;
+}
+
+template<typename T>
+static uint64_t topology_hash_add_span(const uint64_t hash, const blender::Span<T> data)
+{
+  return topology_hash_add_data(hash, data.data(), data.size_in_bytes());
+}
+
+/**
+ * Hash everything that is read by the mesh converter (see `subdiv_converter_mesh.cc`), except for
+ * vertex positions. Settings are compared separately. Edges and faces are hashed including their
+ * legacy fields, changes to those only cause an unnecessary topology comparison.
+ */
+static uint64_t topology_hash_from_mesh(const SubdivSettings *settings, const Mesh *mesh)
+{
+  using namespace blender;
+  uint64_t hash = 0;
+  hash = topology_hash_combine(hash, uint64_t(mesh->totvert));
+  hash = topology_hash_add_span(hash, mesh->edges());
+  hash = topology_hash_add_span(hash, mesh->polys());
+  hash = topology_hash_add_span(hash, mesh->corner_verts());
+  hash = topology_hash_add_span(hash, mesh->corner_edges());
+  hash = topology_hash_combine(hash, uint64_t(settings->use_creases));
+  if (settings->use_creases) {
+    const float *vert_creases = static_cast<const float *>(
+        CustomData_get_layer(&mesh->vdata, CD_CREASE));
+    const float *edge_creases = static_cast<const float *>(
+        CustomData_get_layer(&mesh->edata, CD_CREASE));
+    hash = topology_hash_add_data(
+        hash, vert_creases, vert_creases ? sizeof(float) * mesh->totvert : 0);
+    hash = topology_hash_add_data(
+        hash, edge_creases, edge_creases ? sizeof(float) * mesh->totedge : 0);
+  }
+  /* UV coordinates define the face-varying topology. */
+  const int uv_layers_num = CustomData_number_of_layers(&mesh->ldata, CD_PROP_FLOAT2);
+  hash = topology_hash_combine(hash, uint64_t(uv_layers_num));
+  for (const int i : IndexRange(uv_layers_num)) {
+    const void *uv_map = CustomData_get_layer_n(&mesh->ldata, CD_PROP_FLOAT2, i);
+    hash = topology_hash_add_data(hash, uv_map, sizeof(float2) * mesh->totloop);
+  }
+  /* Zero means that the hash is unknown. */
+  return std::max<uint64_t>(hash, 1);
+}
+
 Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
                                     const SubdivSettings *settings,
                                     const Mesh *mesh)
 {
+  const uint64_t topology_hash = topology_hash_from_mesh(settings, mesh);
+  if (subdiv != nullptr && subdiv->topology_refiner != nullptr &&
+      subdiv->topology_hash == topology_hash &&
+      BKE_subdiv_settings_equal(&subdiv->settings, settings)) {
+    return subdiv;
+  }
   OpenSubdiv_Converter converter;
   BKE_subdiv_converter_init_for_mesh(&converter, settings, mesh);
   subdiv = BKE_subdiv_update_from_converter(subdiv, settings, &converter);
   BKE_subdiv_converter_free(&converter);
+  subdiv->topology_hash = topology_hash;
   return subdiv;
 }
 
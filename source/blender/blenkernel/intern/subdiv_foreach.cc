@@ -13,8 +13,9 @@
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
-#include "BLI_bitmap.h"
+#include "BLI_offset_indices.hh"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 
 #include "BKE_customdata.h"
 #include "BKE_key.h"
@@ -59,6 +60,9 @@ BLI_INLINE int ptex_face_resolution_get(const MPoly &poly, int resolution)
   return (poly.totloop == 4) ? (resolution) : ((resolution >> 1) + 1);
 }
 
+/* Value of the first corner of coarse geometry which isn't used by any polygon. */
+#define NO_CORNER INT_MAX
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -98,101 +102,42 @@ struct SubdivForeachTaskContext {
    * created for preceding base faces.
    */
   int *face_ptex_offset;
-  /* Bitmap indicating whether vertex was used already or not.
-   * - During patch evaluation indicates whether coarse vertex was already
-   *   evaluated and its position on limit is already known.
+  /* Indexed by coarse vertex index, the first coarse face corner which uses the vertex, or
+   * #NO_CORNER for loose vertices. Callbacks which are to be run once per shared geometry are
+   * only run for this corner, which gives the same result as a single threaded traversal.
    */
-  BLI_bitmap *coarse_vertices_used_map;
-  /* Bitmap indicating whether edge was used already or not. This includes:
-   * - During context initialization it indicates whether subdivided vertices
-   *   for corresponding edge were already calculated or not.
-   * - During patch evaluation it indicates whether vertices along this edge
-   *   were already evaluated.
+  int *coarse_vertex_first_corner;
+  /* Same as above, but for coarse edges. */
+  int *coarse_edge_first_corner;
+  /* Maps from coarse vertices to the face corners and faces using them. Only available when the
+   * callbacks which are run for every corner or edge are used.
    */
-  BLI_bitmap *coarse_edges_used_map;
+  const blender::bke::TopologyMap *coarse_vert_to_loop_map;
+  const blender::bke::TopologyMap *coarse_vert_to_poly_map;
 };
 
 /** \} */
 
-/* -------------------------------------------------------------------- */
-/** \name Threading helpers
- * \{ */
-
-static void *subdiv_foreach_tls_alloc(SubdivForeachTaskContext *ctx)
-{
-  const SubdivForeachContext *foreach_context = ctx->foreach_context;
-  void *tls = nullptr;
-  if (foreach_context->user_data_tls_size != 0) {
-    tls = MEM_mallocN(foreach_context->user_data_tls_size, "tls");
-    memcpy(tls, foreach_context->user_data_tls, foreach_context->user_data_tls_size);
-  }
-  return tls;
-}
-
-static void subdiv_foreach_tls_free(SubdivForeachTaskContext *ctx, void *tls)
-{
-  if (tls == nullptr) {
-    return;
-  }
-  if (ctx->foreach_context != nullptr) {
-    ctx->foreach_context->user_data_tls_free(tls);
-  }
-  MEM_freeN(tls);
-}
-
-/** \} */
-
 /* -------------------------------------------------------------------- */
 /** \name Initialization
  * \{ */
 
-/* NOTE: Expects edge map to be zeroed. */
+/* Calculate number of geometry in the result subdivision mesh. Expects the offsets to be
+ * initialized already, their last element is the number of geometry created by all polygons. */
 static void subdiv_foreach_ctx_count(SubdivForeachTaskContext *ctx)
 {
-  /* Reset counters. */
-  ctx->num_subdiv_vertices = 0;
-  ctx->num_subdiv_edges = 0;
-  ctx->num_subdiv_loops = 0;
-  ctx->num_subdiv_polygons = 0;
-  /* Static geometry counters. */
   const int resolution = ctx->settings->resolution;
-  const int no_quad_patch_resolution = ((resolution >> 1) + 1);
   const int num_subdiv_vertices_per_coarse_edge = resolution - 2;
-  const int num_inner_vertices_per_quad = (resolution - 2) * (resolution - 2);
-  const int num_inner_vertices_per_noquad_patch = (no_quad_patch_resolution - 2) *
-                                                  (no_quad_patch_resolution - 2);
   const Mesh *coarse_mesh = ctx->coarse_mesh;
-  ctx->num_subdiv_vertices = coarse_mesh->totvert;
+  const int coarse_polys_num = coarse_mesh->totpoly;
+  /* Vertices and edges created by coarse vertices and edges, including loose ones. */
+  ctx->num_subdiv_vertices = coarse_mesh->totvert +
+                             num_subdiv_vertices_per_coarse_edge * coarse_mesh->totedge;
   ctx->num_subdiv_edges = coarse_mesh->totedge * (num_subdiv_vertices_per_coarse_edge + 1);
-  /* Calculate extra vertices and edges created by non-loose geometry. */
-  for (int poly_index = 0; poly_index < coarse_mesh->totpoly; poly_index++) {
-    const MPoly &coarse_poly = ctx->coarse_polys[poly_index];
-    const int num_ptex_faces_per_poly = num_ptex_faces_per_poly_get(coarse_poly);
-    /* Inner vertices of polygon. */
-    if (num_ptex_faces_per_poly == 1) {
-      ctx->num_subdiv_vertices += num_inner_vertices_per_quad;
-      ctx->num_subdiv_edges += num_edges_per_ptex_face_get(resolution - 2) +
-                               4 * num_subdiv_vertices_per_coarse_edge;
-      ctx->num_subdiv_polygons += num_polys_per_ptex_get(resolution);
-    }
-    else {
-      ctx->num_subdiv_vertices += 1 + num_ptex_faces_per_poly * (no_quad_patch_resolution - 2) +
-                                  num_ptex_faces_per_poly * num_inner_vertices_per_noquad_patch;
-      ctx->num_subdiv_edges += num_ptex_faces_per_poly *
-                               (num_inner_edges_per_ptex_face_get(no_quad_patch_resolution - 1) +
-                                (no_quad_patch_resolution - 2) +
-                                num_subdiv_vertices_per_coarse_edge);
-      if (no_quad_patch_resolution >= 3) {
-        ctx->num_subdiv_edges += coarse_poly.totloop;
-      }
-      ctx->num_subdiv_polygons += num_ptex_faces_per_poly *
-                                  num_polys_per_ptex_get(no_quad_patch_resolution);
-    }
-  }
-
-  /* Add vertices used by outer edges on subdivided faces and loose edges. */
-  ctx->num_subdiv_vertices += num_subdiv_vertices_per_coarse_edge * coarse_mesh->totedge;
-
+  /* Extra vertices and edges created by non-loose geometry. */
+  ctx->num_subdiv_vertices += ctx->subdiv_vertex_offset[coarse_polys_num];
+  ctx->num_subdiv_edges += ctx->subdiv_edge_offset[coarse_polys_num];
+  ctx->num_subdiv_polygons = ctx->subdiv_polygon_offset[coarse_polys_num];
   ctx->num_subdiv_loops = ctx->num_subdiv_polygons * 4;
 }
 
@@ -215,58 +160,99 @@ static void subdiv_foreach_ctx_init_offsets(SubdivForeachTaskContext *ctx)
   ctx->edge_boundary_offset = 0;
   ctx->edge_inner_offset = ctx->edge_boundary_offset +
                            coarse_mesh->totedge * num_subdiv_edges_per_coarse_edge;
-  /* "Indexed" offsets. */
-  int vertex_offset = 0;
-  int edge_offset = 0;
-  int polygon_offset = 0;
-  for (int poly_index = 0; poly_index < coarse_mesh->totpoly; poly_index++) {
-    const MPoly &coarse_poly = ctx->coarse_polys[poly_index];
-    const int num_ptex_faces_per_poly = num_ptex_faces_per_poly_get(coarse_poly);
-    ctx->subdiv_vertex_offset[poly_index] = vertex_offset;
-    ctx->subdiv_edge_offset[poly_index] = edge_offset;
-    ctx->subdiv_polygon_offset[poly_index] = polygon_offset;
-    if (num_ptex_faces_per_poly == 1) {
-      vertex_offset += resolution_2_squared;
-      edge_offset += num_edges_per_ptex_face_get(resolution - 2) +
-                     4 * num_subdiv_vertices_per_coarse_edge;
-      polygon_offset += num_polys_per_ptex_get(resolution);
-    }
-    else {
-      vertex_offset += 1 + num_ptex_faces_per_poly * num_irregular_vertices_per_patch;
-      edge_offset += num_ptex_faces_per_poly *
-                     (num_inner_edges_per_ptex_face_get(no_quad_patch_resolution - 1) +
-                      (no_quad_patch_resolution - 2) + num_subdiv_vertices_per_coarse_edge);
-      if (no_quad_patch_resolution >= 3) {
-        edge_offset += coarse_poly.totloop;
-      }
-      polygon_offset += num_ptex_faces_per_poly * num_polys_per_ptex_get(no_quad_patch_resolution);
+  /* "Indexed" offsets. The amount of geometry created by every polygon is counted in parallel,
+   * and then accumulated to offsets. */
+  blender::threading::parallel_for(
+      ctx->coarse_polys.index_range(), 4096, [&](const blender::IndexRange range) {
+        for (const int poly_index : range) {
+          const MPoly &coarse_poly = ctx->coarse_polys[poly_index];
+          const int num_ptex_faces_per_poly = num_ptex_faces_per_poly_get(coarse_poly);
+          if (num_ptex_faces_per_poly == 1) {
+            ctx->subdiv_vertex_offset[poly_index] = resolution_2_squared;
+            ctx->subdiv_edge_offset[poly_index] = num_edges_per_ptex_face_get(resolution - 2) +
+                                                  4 * num_subdiv_vertices_per_coarse_edge;
+            ctx->subdiv_polygon_offset[poly_index] = num_polys_per_ptex_get(resolution);
+          }
+          else {
+            ctx->subdiv_vertex_offset[poly_index] = 1 + num_ptex_faces_per_poly *
+                                                            num_irregular_vertices_per_patch;
+            int num_edges = num_ptex_faces_per_poly *
+                            (num_inner_edges_per_ptex_face_get(no_quad_patch_resolution - 1) +
+                             (no_quad_patch_resolution - 2) +
+                             num_subdiv_vertices_per_coarse_edge);
+            if (no_quad_patch_resolution >= 3) {
+              num_edges += coarse_poly.totloop;
+            }
+            ctx->subdiv_edge_offset[poly_index] = num_edges;
+            ctx->subdiv_polygon_offset[poly_index] = num_ptex_faces_per_poly *
+                                                     num_polys_per_ptex_get(
+                                                         no_quad_patch_resolution);
+          }
+        }
+      });
+  const int offsets_num = coarse_mesh->totpoly + 1;
+  blender::offset_indices::accumulate_counts_to_offsets({ctx->subdiv_vertex_offset, offsets_num});
+  blender::offset_indices::accumulate_counts_to_offsets({ctx->subdiv_edge_offset, offsets_num});
+  blender::offset_indices::accumulate_counts_to_offsets(
+      {ctx->subdiv_polygon_offset, offsets_num});
+}
+
+/* Lower the value to the given corner index, if it is smaller. Safe to be used from threads. */
+static void first_corner_update(int *first_corner, const int corner)
+{
+  int old_corner = *first_corner;
+  while (corner < old_corner) {
+    const int prev_corner = atomic_cas_int32(first_corner, old_corner, corner);
+    if (prev_corner == old_corner) {
+      break;
     }
+    old_corner = prev_corner;
   }
 }
 
+static void subdiv_foreach_ctx_init_first_corners(SubdivForeachTaskContext *ctx)
+{
+  const Mesh *coarse_mesh = ctx->coarse_mesh;
+  std::fill_n(ctx->coarse_vertex_first_corner, coarse_mesh->totvert, NO_CORNER);
+  std::fill_n(ctx->coarse_edge_first_corner, coarse_mesh->totedge, NO_CORNER);
+  blender::threading::parallel_for(
+      ctx->coarse_corner_verts.index_range(), 4096, [&](const blender::IndexRange range) {
+        for (const int corner : range) {
+          first_corner_update(&ctx->coarse_vertex_first_corner[ctx->coarse_corner_verts[corner]],
+                              corner);
+          first_corner_update(&ctx->coarse_edge_first_corner[ctx->coarse_corner_edges[corner]],
+                              corner);
+        }
+      });
+}
+
 static void subdiv_foreach_ctx_init(Subdiv *subdiv, SubdivForeachTaskContext *ctx)
 {
   const Mesh *coarse_mesh = ctx->coarse_mesh;
   /* Allocate maps and offsets. */
-  ctx->coarse_vertices_used_map = BLI_BITMAP_NEW(coarse_mesh->totvert, "vertices used map");
-  ctx->coarse_edges_used_map = BLI_BITMAP_NEW(coarse_mesh->totedge, "edges used map");
+  ctx->coarse_vertex_first_corner = static_cast<int *>(MEM_malloc_arrayN(
+      coarse_mesh->totvert, sizeof(*ctx->coarse_vertex_first_corner), "vertex_first_corner"));
+  ctx->coarse_edge_first_corner = static_cast<int *>(MEM_malloc_arrayN(
+      coarse_mesh->totedge, sizeof(*ctx->coarse_edge_first_corner), "edge_first_corner"));
   ctx->subdiv_vertex_offset = static_cast<int *>(MEM_malloc_arrayN(
-      coarse_mesh->totpoly, sizeof(*ctx->subdiv_vertex_offset), "vertex_offset"));
+      coarse_mesh->totpoly + 1, sizeof(*ctx->subdiv_vertex_offset), "vertex_offset"));
   ctx->subdiv_edge_offset = static_cast<int *>(MEM_malloc_arrayN(
-      coarse_mesh->totpoly, sizeof(*ctx->subdiv_edge_offset), "subdiv_edge_offset"));
+      coarse_mesh->totpoly + 1, sizeof(*ctx->subdiv_edge_offset), "subdiv_edge_offset"));
   ctx->subdiv_polygon_offset = static_cast<int *>(MEM_malloc_arrayN(
-      coarse_mesh->totpoly, sizeof(*ctx->subdiv_polygon_offset), "subdiv_edge_offset"));
+      coarse_mesh->totpoly + 1, sizeof(*ctx->subdiv_polygon_offset), "subdiv_edge_offset"));
   /* Initialize all offsets. */
   subdiv_foreach_ctx_init_offsets(ctx);
   /* Calculate number of geometry in the result subdivision mesh. */
   subdiv_foreach_ctx_count(ctx);
+  /* Find which corners own the shared geometry, this also tags loose geometry. */
+  subdiv_foreach_ctx_init_first_corners(ctx);
   ctx->face_ptex_offset = BKE_subdiv_face_ptex_offset_get(subdiv);
 }
 
 static void subdiv_foreach_ctx_free(SubdivForeachTaskContext *ctx)
 {
-  MEM_freeN(ctx->coarse_vertices_used_map);
-  MEM_freeN(ctx->coarse_edges_used_map);
+  MEM_freeN(ctx->coarse_vertex_first_corner);
+  MEM_freeN(ctx->coarse_edge_first_corner);
   MEM_freeN(ctx->subdiv_vertex_offset);
   MEM_freeN(ctx->subdiv_edge_offset);
   MEM_freeN(ctx->subdiv_polygon_offset);
@@ -280,135 +266,111 @@ static void subdiv_foreach_ctx_free(SubdivForeachTaskContext *ctx)
 
 /* Traversal of corner vertices. They are coming from coarse vertices. */
 
-static void subdiv_foreach_corner_vertices_regular_do(
-    SubdivForeachTaskContext *ctx,
-    void *tls,
-    const MPoly *coarse_poly,
-    SubdivForeachVertexFromCornerCb vertex_corner,
-    bool check_usage)
+static void subdiv_foreach_corner_vertex_regular(SubdivForeachTaskContext *ctx,
+                                                 void *tls,
+                                                 const MPoly *coarse_poly,
+                                                 const int corner,
+                                                 SubdivForeachVertexFromCornerCb vertex_corner)
 {
   const float weights[4][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
   const int coarse_poly_index = coarse_poly - ctx->coarse_polys.data();
   const int ptex_face_index = ctx->face_ptex_offset[coarse_poly_index];
-  for (int corner = 0; corner < coarse_poly->totloop; corner++) {
-    const int coarse_vert = ctx->coarse_corner_verts[coarse_poly->loopstart + corner];
-    if (check_usage &&
-        BLI_BITMAP_TEST_AND_SET_ATOMIC(ctx->coarse_vertices_used_map, coarse_vert)) {
-      continue;
-    }
-    const int coarse_vertex_index = coarse_vert;
-    const int subdiv_vertex_index = ctx->vertices_corner_offset + coarse_vertex_index;
-    const float u = weights[corner][0];
-    const float v = weights[corner][1];
-    vertex_corner(ctx->foreach_context,
-                  tls,
-                  ptex_face_index,
-                  u,
-                  v,
-                  coarse_vertex_index,
-                  coarse_poly_index,
-                  0,
-                  subdiv_vertex_index);
-  }
-}
-
-static void subdiv_foreach_corner_vertices_regular(SubdivForeachTaskContext *ctx,
-                                                   void *tls,
-                                                   const MPoly *coarse_poly)
-{
-  subdiv_foreach_corner_vertices_regular_do(
-      ctx, tls, coarse_poly, ctx->foreach_context->vertex_corner, true);
+  const int coarse_vertex_index = ctx->coarse_corner_verts[coarse_poly->loopstart + corner];
+  const int subdiv_vertex_index = ctx->vertices_corner_offset + coarse_vertex_index;
+  const float u = weights[corner][0];
+  const float v = weights[corner][1];
+  vertex_corner(ctx->foreach_context,
+                tls,
+                ptex_face_index,
+                u,
+                v,
+                coarse_vertex_index,
+                coarse_poly_index,
+                0,
+                subdiv_vertex_index);
 }
 
-static void subdiv_foreach_corner_vertices_special_do(
-    SubdivForeachTaskContext *ctx,
-    void *tls,
-    const MPoly *coarse_poly,
-    SubdivForeachVertexFromCornerCb vertex_corner,
-    bool check_usage)
+static void subdiv_foreach_corner_vertex_special(SubdivForeachTaskContext *ctx,
+                                                 void *tls,
+                                                 const MPoly *coarse_poly,
+                                                 const int corner,
+                                                 SubdivForeachVertexFromCornerCb vertex_corner)
 {
   const int coarse_poly_index = coarse_poly - ctx->coarse_polys.data();
-  int ptex_face_index = ctx->face_ptex_offset[coarse_poly_index];
-  for (int corner = 0; corner < coarse_poly->totloop; corner++, ptex_face_index++) {
-    const int coarse_vert = ctx->coarse_corner_verts[coarse_poly->loopstart + corner];
-    if (check_usage &&
-        BLI_BITMAP_TEST_AND_SET_ATOMIC(ctx->coarse_vertices_used_map, coarse_vert)) {
-      continue;
-    }
-    const int coarse_vertex_index = coarse_vert;
-    const int subdiv_vertex_index = ctx->vertices_corner_offset + coarse_vertex_index;
-    vertex_corner(ctx->foreach_context,
-                  tls,
-                  ptex_face_index,
-                  0.0f,
-                  0.0f,
-                  coarse_vertex_index,
-                  coarse_poly_index,
-                  corner,
-                  subdiv_vertex_index);
-  }
-}
-
-static void subdiv_foreach_corner_vertices_special(SubdivForeachTaskContext *ctx,
-                                                   void *tls,
-                                                   const MPoly *coarse_poly)
-{
-  subdiv_foreach_corner_vertices_special_do(
-      ctx, tls, coarse_poly, ctx->foreach_context->vertex_corner, true);
+  const int ptex_face_index = ctx->face_ptex_offset[coarse_poly_index] + corner;
+  const int coarse_vertex_index = ctx->coarse_corner_verts[coarse_poly->loopstart + corner];
+  const int subdiv_vertex_index = ctx->vertices_corner_offset + coarse_vertex_index;
+  vertex_corner(ctx->foreach_context,
+                tls,
+                ptex_face_index,
+                0.0f,
+                0.0f,
+                coarse_vertex_index,
+                coarse_poly_index,
+                corner,
+                subdiv_vertex_index);
 }
 
-static void subdiv_foreach_corner_vertices(SubdivForeachTaskContext *ctx,
-                                           void *tls,
-                                           const MPoly *coarse_poly)
+static void subdiv_foreach_corner_vertex(SubdivForeachTaskContext *ctx,
+                                         void *tls,
+                                         const MPoly *coarse_poly,
+                                         const int corner,
+                                         SubdivForeachVertexFromCornerCb vertex_corner)
 {
   if (coarse_poly->totloop == 4) {
-    subdiv_foreach_corner_vertices_regular(ctx, tls, coarse_poly);
+    subdiv_foreach_corner_vertex_regular(ctx, tls, coarse_poly, corner, vertex_corner);
   }
   else {
-    subdiv_foreach_corner_vertices_special(ctx, tls, coarse_poly);
+    subdiv_foreach_corner_vertex_special(ctx, tls, coarse_poly, corner, vertex_corner);
   }
 }
 
-static void subdiv_foreach_every_corner_vertices_regular(SubdivForeachTaskContext *ctx,
-                                                         void *tls,
-                                                         const MPoly *coarse_poly)
-{
-  subdiv_foreach_corner_vertices_regular_do(
-      ctx, tls, coarse_poly, ctx->foreach_context->vertex_every_corner, false);
-}
-
-static void subdiv_foreach_every_corner_vertices_special(SubdivForeachTaskContext *ctx,
-                                                         void *tls,
-                                                         const MPoly *coarse_poly)
+/* Traverse corner vertices which are owned by the given polygon, see
+ * #SubdivForeachTaskContext::coarse_vertex_first_corner. */
+static void subdiv_foreach_corner_vertices(SubdivForeachTaskContext *ctx,
+                                           void *tls,
+                                           const MPoly *coarse_poly)
 {
-  subdiv_foreach_corner_vertices_special_do(
-      ctx, tls, coarse_poly, ctx->foreach_context->vertex_every_corner, false);
+  for (int corner = 0; corner < coarse_poly->totloop; corner++) {
+    const int coarse_loop = coarse_poly->loopstart + corner;
+    const int coarse_vert = ctx->coarse_corner_verts[coarse_loop];
+    if (ctx->coarse_vertex_first_corner[coarse_vert] != coarse_loop) {
+      continue;
+    }
+    subdiv_foreach_corner_vertex(
+        ctx, tls, coarse_poly, corner, ctx->foreach_context->vertex_corner);
+  }
 }
 
-static void subdiv_foreach_every_corner_vertices(SubdivForeachTaskContext *ctx, void *tls)
+/* Run the callback for every face corner of the coarse vertex. All the calls for one vertex happen
+ * from the same thread, in the order of the face corners, so callbacks are free to accumulate
+ * values in the subdivided vertex. */
+static void subdiv_foreach_every_corner_vertices_task(void *__restrict userdata,
+                                                      const int coarse_vertex_index,
+                                                      const TaskParallelTLS *__restrict tls)
 {
-  if (ctx->foreach_context->vertex_every_corner == nullptr) {
-    return;
-  }
-  const Mesh *coarse_mesh = ctx->coarse_mesh;
-  for (int poly_index = 0; poly_index < coarse_mesh->totpoly; poly_index++) {
-    const MPoly &coarse_poly = ctx->coarse_polys[poly_index];
-    if (coarse_poly.totloop == 4) {
-      subdiv_foreach_every_corner_vertices_regular(ctx, tls, &coarse_poly);
-    }
-    else {
-      subdiv_foreach_every_corner_vertices_special(ctx, tls, &coarse_poly);
-    }
+  SubdivForeachTaskContext *ctx = static_cast<SubdivForeachTaskContext *>(userdata);
+  const blender::Span<int> coarse_loops = (*ctx->coarse_vert_to_loop_map)[coarse_vertex_index];
+  const blender::Span<int> coarse_polys = (*ctx->coarse_vert_to_poly_map)[coarse_vertex_index];
+  for (const int i : coarse_loops.index_range()) {
+    const MPoly &coarse_poly = ctx->coarse_polys[coarse_polys[i]];
+    const int corner = coarse_loops[i] - coarse_poly.loopstart;
+    subdiv_foreach_corner_vertex(ctx,
+                                 tls->userdata_chunk,
+                                 &coarse_poly,
+                                 corner,
+                                 ctx->foreach_context->vertex_every_corner);
   }
 }
 
 /* Traverse of edge vertices. They are coming from coarse edges. */
 
-static void subdiv_foreach_edge_vertices_regular_do(SubdivForeachTaskContext *ctx,
-                                                    void *tls,
-                                                    const MPoly *coarse_poly,
-                                                    SubdivForeachVertexFromEdgeCb vertex_edge,
-                                                    bool check_usage)
+static void subdiv_foreach_edge_vertices_of_corner_regular(
+    SubdivForeachTaskContext *ctx,
+    void *tls,
+    const MPoly *coarse_poly,
+    const int corner,
+    SubdivForeachVertexFromEdgeCb vertex_edge)
 {
   const int resolution = ctx->settings->resolution;
   const int resolution_1 = resolution - 1;
@@ -416,61 +378,48 @@ static void subdiv_foreach_edge_vertices_regular_do(SubdivForeachTaskContext *ct
   const int num_subdiv_vertices_per_coarse_edge = resolution - 2;
   const int coarse_poly_index = coarse_poly - ctx->coarse_polys.data();
   const int ptex_face_index = ctx->face_ptex_offset[coarse_poly_index];
-  for (int corner = 0; corner < coarse_poly->totloop; corner++) {
-    const int coarse_vert = ctx->coarse_corner_verts[coarse_poly->loopstart + corner];
-    const int coarse_edge_index = ctx->coarse_corner_edges[coarse_poly->loopstart + corner];
-    if (check_usage &&
-        BLI_BITMAP_TEST_AND_SET_ATOMIC(ctx->coarse_edges_used_map, coarse_edge_index)) {
-      continue;
+  const int coarse_vert = ctx->coarse_corner_verts[coarse_poly->loopstart + corner];
+  const int coarse_edge_index = ctx->coarse_corner_edges[coarse_poly->loopstart + corner];
+  const MEdge *coarse_edge = &ctx->coarse_edges[coarse_edge_index];
+  const bool flip = (coarse_edge->v2 == coarse_vert);
+  int subdiv_vertex_index = ctx->vertices_edge_offset +
+                            coarse_edge_index * num_subdiv_vertices_per_coarse_edge;
+  for (int vertex_index = 0; vertex_index < num_subdiv_vertices_per_coarse_edge;
+       vertex_index++, subdiv_vertex_index++) {
+    float fac = (vertex_index + 1) * inv_resolution_1;
+    if (flip) {
+      fac = 1.0f - fac;
     }
-    const MEdge *coarse_edge = &ctx->coarse_edges[coarse_edge_index];
-    const bool flip = (coarse_edge->v2 == coarse_vert);
-    int subdiv_vertex_index = ctx->vertices_edge_offset +
-                              coarse_edge_index * num_subdiv_vertices_per_coarse_edge;
-    for (int vertex_index = 0; vertex_index < num_subdiv_vertices_per_coarse_edge;
-         vertex_index++, subdiv_vertex_index++) {
-      float fac = (vertex_index + 1) * inv_resolution_1;
-      if (flip) {
-        fac = 1.0f - fac;
-      }
-      if (corner >= 2) {
-        fac = 1.0f - fac;
-      }
-      float u, v;
-      if ((corner & 1) == 0) {
-        u = fac;
-        v = (corner == 2) ? 1.0f : 0.0f;
-      }
-      else {
-        u = (corner == 1) ? 1.0f : 0.0f;
-        v = fac;
-      }
-      vertex_edge(ctx->foreach_context,
-                  tls,
-                  ptex_face_index,
-                  u,
-                  v,
-                  coarse_edge_index,
-                  coarse_poly_index,
-                  0,
-                  subdiv_vertex_index);
+    if (corner >= 2) {
+      fac = 1.0f - fac;
+    }
+    float u, v;
+    if ((corner & 1) == 0) {
+      u = fac;
+      v = (corner == 2) ? 1.0f : 0.0f;
     }
+    else {
+      u = (corner == 1) ? 1.0f : 0.0f;
+      v = fac;
+    }
+    vertex_edge(ctx->foreach_context,
+                tls,
+                ptex_face_index,
+                u,
+                v,
+                coarse_edge_index,
+                coarse_poly_index,
+                0,
+                subdiv_vertex_index);
   }
 }
 
-static void subdiv_foreach_edge_vertices_regular(SubdivForeachTaskContext *ctx,
-                                                 void *tls,
-                                                 const MPoly *coarse_poly)
-{
-  subdiv_foreach_edge_vertices_regular_do(
-      ctx, tls, coarse_poly, ctx->foreach_context->vertex_edge, true);
-}
-
-static void subdiv_foreach_edge_vertices_special_do(SubdivForeachTaskContext *ctx,
-                                                    void *tls,
-                                                    const MPoly *coarse_poly,
-                                                    SubdivForeachVertexFromEdgeCb vertex_edge,
-                                                    bool check_usage)
+static void subdiv_foreach_edge_vertices_of_corner_special(
+    SubdivForeachTaskContext *ctx,
+    void *tls,
+    const MPoly *coarse_poly,
+    const int corner,
+    SubdivForeachVertexFromEdgeCb vertex_edge)
 {
   const int resolution = ctx->settings->resolution;
   const int num_subdiv_vertices_per_coarse_edge = resolution - 2;
@@ -478,104 +427,110 @@ static void subdiv_foreach_edge_vertices_special_do(SubdivForeachTaskContext *ct
   const float inv_ptex_resolution_1 = 1.0f / float(num_vertices_per_ptex_edge - 1);
   const int coarse_poly_index = coarse_poly - ctx->coarse_polys.data();
   const int ptex_face_start_index = ctx->face_ptex_offset[coarse_poly_index];
-  int ptex_face_index = ptex_face_start_index;
-  for (int corner = 0; corner < coarse_poly->totloop; corner++, ptex_face_index++) {
-    const int coarse_vert = ctx->coarse_corner_verts[coarse_poly->loopstart + corner];
-    const int coarse_edge_index = ctx->coarse_corner_edges[coarse_poly->loopstart + corner];
-    if (check_usage &&
-        BLI_BITMAP_TEST_AND_SET_ATOMIC(ctx->coarse_edges_used_map, coarse_edge_index)) {
-      continue;
-    }
-    const MEdge *coarse_edge = &ctx->coarse_edges[coarse_edge_index];
-    const bool flip = (coarse_edge->v2 == coarse_vert);
-    int subdiv_vertex_index = ctx->vertices_edge_offset +
-                              coarse_edge_index * num_subdiv_vertices_per_coarse_edge;
-    int vertex_delta = 1;
-    if (flip) {
-      subdiv_vertex_index += num_subdiv_vertices_per_coarse_edge - 1;
-      vertex_delta = -1;
-    }
-    for (int vertex_index = 1; vertex_index < num_vertices_per_ptex_edge;
-         vertex_index++, subdiv_vertex_index += vertex_delta) {
-      const float u = vertex_index * inv_ptex_resolution_1;
-      vertex_edge(ctx->foreach_context,
-                  tls,
-                  ptex_face_index,
-                  u,
-                  0.0f,
-                  coarse_edge_index,
-                  coarse_poly_index,
-                  corner,
-                  subdiv_vertex_index);
-    }
-    const int next_corner = (corner + 1) % coarse_poly->totloop;
-    const int next_ptex_face_index = ptex_face_start_index + next_corner;
-    for (int vertex_index = 1; vertex_index < num_vertices_per_ptex_edge - 1;
-         vertex_index++, subdiv_vertex_index += vertex_delta) {
-      const float v = 1.0f - vertex_index * inv_ptex_resolution_1;
-      vertex_edge(ctx->foreach_context,
-                  tls,
-                  next_ptex_face_index,
-                  0.0f,
-                  v,
-                  coarse_edge_index,
-                  coarse_poly_index,
-                  next_corner,
-                  subdiv_vertex_index);
-    }
+  const int ptex_face_index = ptex_face_start_index + corner;
+  const int coarse_vert = ctx->coarse_corner_verts[coarse_poly->loopstart + corner];
+  const int coarse_edge_index = ctx->coarse_corner_edges[coarse_poly->loopstart + corner];
+  const MEdge *coarse_edge = &ctx->coarse_edges[coarse_edge_index];
+  const bool flip = (coarse_edge->v2 == coarse_vert);
+  int subdiv_vertex_index = ctx->vertices_edge_offset +
+                            coarse_edge_index * num_subdiv_vertices_per_coarse_edge;
+  int vertex_delta = 1;
+  if (flip) {
+    subdiv_vertex_index += num_subdiv_vertices_per_coarse_edge - 1;
+    vertex_delta = -1;
+  }
+  for (int vertex_index = 1; vertex_index < num_vertices_per_ptex_edge;
+       vertex_index++, subdiv_vertex_index += vertex_delta) {
+    const float u = vertex_index * inv_ptex_resolution_1;
+    vertex_edge(ctx->foreach_context,
+                tls,
+                ptex_face_index,
+                u,
+                0.0f,
+                coarse_edge_index,
+                coarse_poly_index,
+                corner,
+                subdiv_vertex_index);
+  }
+  const int next_corner = (corner + 1) % coarse_poly->totloop;
+  const int next_ptex_face_index = ptex_face_start_index + next_corner;
+  for (int vertex_index = 1; vertex_index < num_vertices_per_ptex_edge - 1;
+       vertex_index++, subdiv_vertex_index += vertex_delta) {
+    const float v = 1.0f - vertex_index * inv_ptex_resolution_1;
+    vertex_edge(ctx->foreach_context,
+                tls,
+                next_ptex_face_index,
+                0.0f,
+                v,
+                coarse_edge_index,
+                coarse_poly_index,
+                next_corner,
+                subdiv_vertex_index);
   }
 }
 
-static void subdiv_foreach_edge_vertices_special(SubdivForeachTaskContext *ctx,
-                                                 void *tls,
-                                                 const MPoly *coarse_poly)
-{
-  subdiv_foreach_edge_vertices_special_do(
-      ctx, tls, coarse_poly, ctx->foreach_context->vertex_edge, true);
-}
-
-static void subdiv_foreach_edge_vertices(SubdivForeachTaskContext *ctx,
-                                         void *tls,
-                                         const MPoly *coarse_poly)
+static void subdiv_foreach_edge_vertices_of_corner(SubdivForeachTaskContext *ctx,
+                                                   void *tls,
+                                                   const MPoly *coarse_poly,
+                                                   const int corner,
+                                                   SubdivForeachVertexFromEdgeCb vertex_edge)
 {
   if (coarse_poly->totloop == 4) {
-    subdiv_foreach_edge_vertices_regular(ctx, tls, coarse_poly);
+    subdiv_foreach_edge_vertices_of_corner_regular(ctx, tls, coarse_poly, corner, vertex_edge);
   }
   else {
-    subdiv_foreach_edge_vertices_special(ctx, tls, coarse_poly);
+    subdiv_foreach_edge_vertices_of_corner_special(ctx, tls, coarse_poly, corner, vertex_edge);
   }
 }
 
-static void subdiv_foreach_every_edge_vertices_regular(SubdivForeachTaskContext *ctx,
-                                                       void *tls,
-                                                       const MPoly *coarse_poly)
-{
-  subdiv_foreach_edge_vertices_regular_do(
-      ctx, tls, coarse_poly, ctx->foreach_context->vertex_every_edge, false);
-}
-
-static void subdiv_foreach_every_edge_vertices_special(SubdivForeachTaskContext *ctx,
-                                                       void *tls,
-                                                       const MPoly *coarse_poly)
+/* Traverse edge vertices of edges which are owned by the given polygon, see
+ * #SubdivForeachTaskContext::coarse_edge_first_corner. */
+static void subdiv_foreach_edge_vertices(SubdivForeachTaskContext *ctx,
+                                         void *tls,
+                                         const MPoly *coarse_poly)
 {
-  subdiv_foreach_edge_vertices_special_do(
-      ctx, tls, coarse_poly, ctx->foreach_context->vertex_every_edge, false);
+  for (int corner = 0; corner < coarse_poly->totloop; corner++) {
+    const int coarse_loop = coarse_poly->loopstart + corner;
+    const int coarse_edge_index = ctx->coarse_corner_edges[coarse_loop];
+    if (ctx->coarse_edge_first_corner[coarse_edge_index] != coarse_loop) {
+      continue;
+    }
+    subdiv_foreach_edge_vertices_of_corner(
+        ctx, tls, coarse_poly, corner, ctx->foreach_context->vertex_edge);
+  }
 }
 
-static void subdiv_foreach_every_edge_vertices(SubdivForeachTaskContext *ctx, void *tls)
+/* Run the callback for every face corner which uses the coarse edge. Similar to the corner
+ * vertices, all calls for one edge happen from the same thread in the order of the face corners.
+ * The face corners are found from the corners of the edge's first vertex, since every face which
+ * uses the edge also uses the vertex, either at the same corner or at the next one. */
+static void subdiv_foreach_every_edge_vertices_task(void *__restrict userdata,
+                                                    const int coarse_edge_index,
+                                                    const TaskParallelTLS *__restrict tls)
 {
-  if (ctx->foreach_context->vertex_every_edge == nullptr) {
-    return;
-  }
-  const Mesh *coarse_mesh = ctx->coarse_mesh;
-  for (int poly_index = 0; poly_index < coarse_mesh->totpoly; poly_index++) {
-    const MPoly &coarse_poly = ctx->coarse_polys[poly_index];
-    if (coarse_poly.totloop == 4) {
-      subdiv_foreach_every_edge_vertices_regular(ctx, tls, &coarse_poly);
+  SubdivForeachTaskContext *ctx = static_cast<SubdivForeachTaskContext *>(userdata);
+  const MEdge &coarse_edge = ctx->coarse_edges[coarse_edge_index];
+  const blender::Span<int> coarse_loops = (*ctx->coarse_vert_to_loop_map)[coarse_edge.v1];
+  const blender::Span<int> coarse_polys = (*ctx->coarse_vert_to_poly_map)[coarse_edge.v1];
+  for (const int i : coarse_loops.index_range()) {
+    const MPoly &coarse_poly = ctx->coarse_polys[coarse_polys[i]];
+    const int corner = coarse_loops[i] - coarse_poly.loopstart;
+    const int corner_prev = (corner + coarse_poly.totloop - 1) % coarse_poly.totloop;
+    int edge_corner;
+    if (ctx->coarse_corner_edges[coarse_poly.loopstart + corner] == coarse_edge_index) {
+      edge_corner = corner;
+    }
+    else if (ctx->coarse_corner_edges[coarse_poly.loopstart + corner_prev] == coarse_edge_index) {
+      edge_corner = corner_prev;
     }
     else {
-      subdiv_foreach_every_edge_vertices_special(ctx, tls, &coarse_poly);
+      continue;
     }
+    subdiv_foreach_edge_vertices_of_corner(ctx,
+                                           tls->userdata_chunk,
+                                           &coarse_poly,
+                                           edge_corner,
+                                           ctx->foreach_context->vertex_every_edge);
   }
 }
 
@@ -956,7 +911,7 @@ static void subdiv_foreach_boundary_edges(SubdivForeachTaskContext *ctx,
   const int resolution = ctx->settings->resolution;
   const int num_subdiv_vertices_per_coarse_edge = resolution - 2;
   const int num_subdiv_edges_per_coarse_edge = resolution - 1;
-  const bool is_loose = !BLI_BITMAP_TEST_BOOL(ctx->coarse_edges_used_map, coarse_edge_index);
+  const bool is_loose = ctx->coarse_edge_first_corner[coarse_edge_index] == NO_CORNER;
 
   int subdiv_edge_index = ctx->edge_boundary_offset +
                           coarse_edge_index * num_subdiv_edges_per_coarse_edge;
@@ -1661,7 +1616,7 @@ static void subdiv_foreach_loose_vertices_task(void *__restrict userdata,
                                                const TaskParallelTLS *__restrict tls)
 {
   SubdivForeachTaskContext *ctx = static_cast<SubdivForeachTaskContext *>(userdata);
-  if (BLI_BITMAP_TEST_BOOL(ctx->coarse_vertices_used_map, coarse_vertex_index)) {
+  if (ctx->coarse_vertex_first_corner[coarse_vertex_index] != NO_CORNER) {
     /* Vertex is not loose, was handled when handling polygons. */
     return;
   }
@@ -1675,7 +1630,7 @@ static void subdiv_foreach_vertices_of_loose_edges_task(void *__restrict userdat
                                                         const TaskParallelTLS *__restrict tls)
 {
   SubdivForeachTaskContext *ctx = static_cast<SubdivForeachTaskContext *>(userdata);
-  if (BLI_BITMAP_TEST_BOOL(ctx->coarse_edges_used_map, coarse_edge_index)) {
+  if (ctx->coarse_edge_first_corner[coarse_edge_index] != NO_CORNER) {
     /* Vertex is not loose, was handled when handling polygons. */
     return;
   }
@@ -1714,54 +1669,42 @@ static void subdiv_foreach_vertices_of_loose_edges_task(void *__restrict userdat
 /** \name Subdivision process entry points
  * \{ */
 
-static void subdiv_foreach_single_geometry_vertices(SubdivForeachTaskContext *ctx, void *tls)
+static void subdiv_foreach_single_geometry_vertices_task(void *__restrict userdata,
+                                                        const int poly_index,
+                                                        const TaskParallelTLS *__restrict tls)
 {
-  if (ctx->foreach_context->vertex_corner == nullptr) {
-    return;
-  }
-  const Mesh *coarse_mesh = ctx->coarse_mesh;
-  for (int poly_index = 0; poly_index < coarse_mesh->totpoly; poly_index++) {
-    const MPoly &coarse_poly = ctx->coarse_polys[poly_index];
-    subdiv_foreach_corner_vertices(ctx, tls, &coarse_poly);
-    subdiv_foreach_edge_vertices(ctx, tls, &coarse_poly);
-  }
+  SubdivForeachTaskContext *ctx = static_cast<SubdivForeachTaskContext *>(userdata);
+  const MPoly &coarse_poly = ctx->coarse_polys[poly_index];
+  subdiv_foreach_corner_vertices(ctx, tls->userdata_chunk, &coarse_poly);
+  subdiv_foreach_edge_vertices(ctx, tls->userdata_chunk, &coarse_poly);
 }
 
-static void subdiv_foreach_mark_non_loose_geometry(SubdivForeachTaskContext *ctx)
+static void subdiv_foreach_shared_geometry_tasks(SubdivForeachTaskContext *ctx,
+                                                 const TaskParallelSettings *settings)
 {
+  const SubdivForeachContext *foreach_context = ctx->foreach_context;
   const Mesh *coarse_mesh = ctx->coarse_mesh;
-  for (int poly_index = 0; poly_index < coarse_mesh->totpoly; poly_index++) {
-    const MPoly &coarse_poly = ctx->coarse_polys[poly_index];
-    for (int corner = 0; corner < coarse_poly.totloop; corner++) {
-      BLI_BITMAP_ENABLE(ctx->coarse_vertices_used_map,
-                        ctx->coarse_corner_verts[coarse_poly.loopstart + corner]);
-      BLI_BITMAP_ENABLE(ctx->coarse_edges_used_map,
-                        ctx->coarse_corner_verts[coarse_poly.loopstart + corner]);
-    }
+  /* Passes to average displacement on the corner vertices and boundary edges. They are threaded
+   * over the coarse vertices and edges, so that the accumulation into a shared vertex is never
+   * done from multiple threads. */
+  if (foreach_context->vertex_every_corner != nullptr ||
+      foreach_context->vertex_every_edge != nullptr) {
+    ctx->coarse_vert_to_loop_map = &coarse_mesh->vert_to_loop_map();
+    ctx->coarse_vert_to_poly_map = &coarse_mesh->vert_to_poly_map();
   }
-}
-
-static void subdiv_foreach_single_thread_tasks(SubdivForeachTaskContext *ctx)
-{
-  /* NOTE: In theory, we can try to skip allocation of TLS here, but in
-   * practice if the callbacks used here are not specified then TLS will not
-   * be requested anyway. */
-  void *tls = subdiv_foreach_tls_alloc(ctx);
-  /* Passes to average displacement on the corner vertices
-   * and boundary edges. */
-  subdiv_foreach_every_corner_vertices(ctx, tls);
-  subdiv_foreach_every_edge_vertices(ctx, tls);
-  /* Run callbacks which are supposed to be run once per shared geometry. */
-  subdiv_foreach_single_geometry_vertices(ctx, tls);
-  subdiv_foreach_tls_free(ctx, tls);
-
-  const SubdivForeachContext *foreach_context = ctx->foreach_context;
-  const bool is_loose_geometry_tagged = (foreach_context->vertex_every_edge != nullptr &&
-                                         foreach_context->vertex_every_corner != nullptr);
-  const bool is_loose_geometry_tags_needed = (foreach_context->vertex_loose != nullptr ||
-                                              foreach_context->vertex_of_loose_edge != nullptr);
-  if (is_loose_geometry_tagged && is_loose_geometry_tags_needed) {
-    subdiv_foreach_mark_non_loose_geometry(ctx);
+  if (foreach_context->vertex_every_corner != nullptr) {
+    BLI_task_parallel_range(
+        0, coarse_mesh->totvert, ctx, subdiv_foreach_every_corner_vertices_task, settings);
+  }
+  if (foreach_context->vertex_every_edge != nullptr) {
+    BLI_task_parallel_range(
+        0, coarse_mesh->totedge, ctx, subdiv_foreach_every_edge_vertices_task, settings);
+  }
+  /* Run callbacks which are supposed to be run once per shared geometry. They have to run after
+   * the passes above, since they use the accumulated values. */
+  if (foreach_context->vertex_corner != nullptr) {
+    BLI_task_parallel_range(
+        0, coarse_mesh->totpoly, ctx, subdiv_foreach_single_geometry_vertices_task, settings);
   }
 }
 
@@ -1823,9 +1766,6 @@ bool BKE_subdiv_foreach_subdiv_geometry(Subdiv *subdiv,
       return false;
     }
   }
-  /* Run all the code which is not supposed to be run from threads. */
-  subdiv_foreach_single_thread_tasks(&ctx);
-  /* Threaded traversal of the rest of topology. */
   TaskParallelSettings parallel_range_settings;
   BLI_parallel_range_settings_defaults(&parallel_range_settings);
   parallel_range_settings.userdata_chunk = context->user_data_tls;
@@ -1834,12 +1774,14 @@ bool BKE_subdiv_foreach_subdiv_geometry(Subdiv *subdiv,
   if (context->user_data_tls_free != nullptr) {
     parallel_range_settings.func_free = subdiv_foreach_free;
   }
+  /* Traverse the geometry which is shared between coarse polygons. */
+  subdiv_foreach_shared_geometry_tasks(&ctx, &parallel_range_settings);
+  /* Threaded traversal of the rest of topology. */
 
   /* TODO(sergey): Possible optimization is to have a single pool and push all
    * the tasks into it.
-   * NOTE: Watch out for callbacks which needs to run for loose geometry as they
-   * currently are relying on the fact that face/grid callbacks will tag non-
-   * loose geometry. */
+   * NOTE: Loose geometry is tagged when initializing the context, so the loose
+   * geometry callbacks don't depend on other callbacks. */
 
   BLI_task_parallel_range(
       0, coarse_mesh->totpoly, &ctx, subdiv_foreach_task, &parallel_range_settings);
@@ -0,0 +1,425 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "testing/testing.h"
+
+#ifdef WITH_TBB
+#  include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <tuple>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_task.h"
+#include "BLI_vector.hh"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_foreach.hh"
+#include "BKE_subdiv_mesh.hh"
+
+namespace blender::bke::tests {
+
+enum class CallbackType {
+  TopologyInfo,
+  VertexEveryCorner,
+  VertexEveryEdge,
+  VertexCorner,
+  VertexEdge,
+  VertexInner,
+  VertexLoose,
+  VertexOfLooseEdge,
+  Edge,
+  Loop,
+  Poly,
+};
+
+/** Arguments of a single callback invocation. */
+struct CallbackRecord {
+  CallbackType type;
+  std::array<int, 7> indices = {};
+  float u = 0.0f;
+  float v = 0.0f;
+  /** Order of the call among the "every" callbacks for the same subdivision vertex. */
+  int sequence = 0;
+
+  friend bool operator<(const CallbackRecord &a, const CallbackRecord &b)
+  {
+    return std::tie(a.type, a.indices, a.u, a.v, a.sequence) <
+           std::tie(b.type, b.indices, b.u, b.v, b.sequence);
+  }
+
+  friend bool operator==(const CallbackRecord &a, const CallbackRecord &b)
+  {
+    return std::tie(a.type, a.indices, a.u, a.v, a.sequence) ==
+           std::tie(b.type, b.indices, b.u, b.v, b.sequence);
+  }
+};
+
+struct CallbackRecorder {
+  std::mutex mutex;
+  Vector<CallbackRecord> records;
+  /** Number of "every" callbacks which were already called for each subdivision vertex. */
+  Array<int> every_calls_num;
+
+  void add(const CallbackRecord &record)
+  {
+    std::scoped_lock lock(mutex);
+    records.append(record);
+  }
+
+  void add_every(CallbackRecord record, const int subdiv_vertex_index)
+  {
+    std::scoped_lock lock(mutex);
+    record.sequence = every_calls_num[subdiv_vertex_index]++;
+    records.append(record);
+  }
+};
+
+static CallbackRecorder &get_recorder(const SubdivForeachContext *context)
+{
+  return *static_cast<CallbackRecorder *>(context->user_data);
+}
+
+static bool record_topology_info(const SubdivForeachContext *context,
+                                 const int num_vertices,
+                                 const int num_edges,
+                                 const int num_loops,
+                                 const int num_polygons,
+                                 const int * /*subdiv_polygon_offset*/)
+{
+  CallbackRecorder &recorder = get_recorder(context);
+  recorder.every_calls_num.reinitialize(num_vertices);
+  recorder.every_calls_num.fill(0);
+  recorder.add({CallbackType::TopologyInfo, {num_vertices, num_edges, num_loops, num_polygons}});
+  return true;
+}
+
+static void record_vertex_every_corner(const SubdivForeachContext *context,
+                                       void * /*tls*/,
+                                       const int ptex_face_index,
+                                       const float u,
+                                       const float v,
+                                       const int coarse_vertex_index,
+                                       const int coarse_poly_index,
+                                       const int coarse_corner,
+                                       const int subdiv_vertex_index)
+{
+  get_recorder(context).add_every({CallbackType::VertexEveryCorner,
+                                   {ptex_face_index,
+                                    coarse_vertex_index,
+                                    coarse_poly_index,
+                                    coarse_corner,
+                                    subdiv_vertex_index},
+                                   u,
+                                   v},
+                                  subdiv_vertex_index);
+}
+
+static void record_vertex_every_edge(const SubdivForeachContext *context,
+                                     void * /*tls*/,
+                                     const int ptex_face_index,
+                                     const float u,
+                                     const float v,
+                                     const int coarse_edge_index,
+                                     const int coarse_poly_index,
+                                     const int coarse_corner,
+                                     const int subdiv_vertex_index)
+{
+  get_recorder(context).add_every({CallbackType::VertexEveryEdge,
+                                   {ptex_face_index,
+                                    coarse_edge_index,
+                                    coarse_poly_index,
+                                    coarse_corner,
+                                    subdiv_vertex_index},
+                                   u,
+                                   v},
+                                  subdiv_vertex_index);
+}
+
+static void record_vertex_corner(const SubdivForeachContext *context,
+                                 void * /*tls*/,
+                                 const int ptex_face_index,
+                                 const float u,
+                                 const float v,
+                                 const int coarse_vertex_index,
+                                 const int coarse_poly_index,
+                                 const int coarse_corner,
+                                 const int subdiv_vertex_index)
+{
+  get_recorder(context).add({CallbackType::VertexCorner,
+                             {ptex_face_index,
+                              coarse_vertex_index,
+                              coarse_poly_index,
+                              coarse_corner,
+                              subdiv_vertex_index},
+                             u,
+                             v});
+}
+
+static void record_vertex_edge(const SubdivForeachContext *context,
+                               void * /*tls*/,
+                               const int ptex_face_index,
+                               const float u,
+                               const float v,
+                               const int coarse_edge_index,
+                               const int coarse_poly_index,
+                               const int coarse_corner,
+                               const int subdiv_vertex_index)
+{
+  get_recorder(context).add({CallbackType::VertexEdge,
+                             {ptex_face_index,
+                              coarse_edge_index,
+                              coarse_poly_index,
+                              coarse_corner,
+                              subdiv_vertex_index},
+                             u,
+                             v});
+}
+
+static void record_vertex_inner(const SubdivForeachContext *context,
+                                void * /*tls*/,
+                                const int ptex_face_index,
+                                const float u,
+                                const float v,
+                                const int coarse_poly_index,
+                                const int coarse_corner,
+                                const int subdiv_vertex_index)
+{
+  get_recorder(context).add(
+      {CallbackType::VertexInner,
+       {ptex_face_index, coarse_poly_index, coarse_corner, subdiv_vertex_index},
+       u,
+       v});
+}
+
+static void record_vertex_loose(const SubdivForeachContext *context,
+                                void * /*tls*/,
+                                const int coarse_vertex_index,
+                                const int subdiv_vertex_index)
+{
+  get_recorder(context).add(
+      {CallbackType::VertexLoose, {coarse_vertex_index, subdiv_vertex_index}});
+}
+
+static void record_vertex_of_loose_edge(const SubdivForeachContext *context,
+                                        void * /*tls*/,
+                                        const int coarse_edge_index,
+                                        const float u,
+                                        const int subdiv_vertex_index)
+{
+  get_recorder(context).add(
+      {CallbackType::VertexOfLooseEdge, {coarse_edge_index, subdiv_vertex_index}, u});
+}
+
+static void record_edge(const SubdivForeachContext *context,
+                        void * /*tls*/,
+                        const int coarse_edge_index,
+                        const int subdiv_edge_index,
+                        const bool is_loose,
+                        const int subdiv_v1,
+                        const int subdiv_v2)
+{
+  get_recorder(context).add(
+      {CallbackType::Edge,
+       {coarse_edge_index, subdiv_edge_index, int(is_loose), subdiv_v1, subdiv_v2}});
+}
+
+static void record_loop(const SubdivForeachContext *context,
+                        void * /*tls*/,
+                        const int ptex_face_index,
+                        const float u,
+                        const float v,
+                        const int coarse_loop_index,
+                        const int coarse_poly_index,
+                        const int coarse_corner,
+                        const int subdiv_loop_index,
+                        const int subdiv_vertex_index,
+                        const int subdiv_edge_index)
+{
+  get_recorder(context).add({CallbackType::Loop,
+                             {ptex_face_index,
+                              coarse_loop_index,
+                              coarse_poly_index,
+                              coarse_corner,
+                              subdiv_loop_index,
+                              subdiv_vertex_index,
+                              subdiv_edge_index},
+                             u,
+                             v});
+}
+
+static void record_poly(const SubdivForeachContext *context,
+                        void * /*tls*/,
+                        const int coarse_poly_index,
+                        const int subdiv_poly_index,
+                        const int start_loop_index,
+                        const int num_loops)
+{
+  get_recorder(context).add(
+      {CallbackType::Poly, {coarse_poly_index, subdiv_poly_index, start_loop_index, num_loops}});
+}
+
+/**
+ * A mesh with copies of a quad, two triangles and a pentagon. In each copy the edge between the
+ * second and third vertex is used by three polygons, the 10th and 11th vertices are connected by a
+ * loose edge and the 12th vertex is loose. There are enough copies for the traversal to be split
+ * between threads.
+ */
+static constexpr int coarse_mesh_copies_num = 64;
+
+static Mesh *create_coarse_mesh()
+{
+  const Array<Array<int>> poly_verts = {{0, 1, 2, 3}, {1, 4, 2}, {2, 1, 5}, {3, 2, 6, 7, 8}};
+  const int verts_num = 12;
+  int corners_num = 0;
+  for (const Span<int> verts : poly_verts) {
+    corners_num += verts.size();
+  }
+  const int copies_num = coarse_mesh_copies_num;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num * copies_num,
+                                   copies_num,
+                                   corners_num * copies_num,
+                                   poly_verts.size() * copies_num);
+  MutableSpan<float3> positions = mesh->vert_positions_for_write();
+  for (const int i : positions.index_range()) {
+    positions[i] = float3(i % 4, i / 4, 0.0f);
+  }
+  MutableSpan<MEdge> edges = mesh->edges_for_write();
+  MutableSpan<MPoly> polys = mesh->polys_for_write();
+  MutableSpan<int> corner_verts = mesh->corner_verts_for_write();
+  int poly = 0;
+  int corner = 0;
+  for (const int copy : IndexRange(copies_num)) {
+    const int vert_offset = copy * verts_num;
+    edges[copy].v1 = vert_offset + 9;
+    edges[copy].v2 = vert_offset + 10;
+    for (const Span<int> verts : poly_verts) {
+      polys[poly].loopstart = corner;
+      polys[poly].totloop = verts.size();
+      for (const int vert : verts) {
+        corner_verts[corner++] = vert_offset + vert;
+      }
+      poly++;
+    }
+  }
+  BKE_mesh_calc_edges(mesh, true, false);
+  return mesh;
+}
+
+/** Create subdivision data with only the ptex offsets set, which is all the traversal needs. */
+static Subdiv *create_subdiv(const Mesh &coarse_mesh)
+{
+  Subdiv *subdiv = MEM_cnew<Subdiv>(__func__);
+  const Span<MPoly> polys = coarse_mesh.polys();
+  subdiv->cache_.face_ptex_offset = static_cast<int *>(
+      MEM_malloc_arrayN(polys.size() + 1, sizeof(int), __func__));
+  int ptex_offset = 0;
+  for (const int i : polys.index_range()) {
+    subdiv->cache_.face_ptex_offset[i] = ptex_offset;
+    ptex_offset += polys[i].totloop == 4 ? 1 : polys[i].totloop;
+  }
+  subdiv->cache_.face_ptex_offset[polys.size()] = ptex_offset;
+  return subdiv;
+}
+
+static Vector<CallbackRecord> record_traversal(Subdiv *subdiv,
+                                               const Mesh &coarse_mesh,
+                                               const SubdivToMeshSettings &settings,
+                                               const bool use_every_callbacks)
+{
+  CallbackRecorder recorder;
+  SubdivForeachContext context = {nullptr};
+  context.topology_info = record_topology_info;
+  if (use_every_callbacks) {
+    context.vertex_every_corner = record_vertex_every_corner;
+    context.vertex_every_edge = record_vertex_every_edge;
+  }
+  context.vertex_corner = record_vertex_corner;
+  context.vertex_edge = record_vertex_edge;
+  context.vertex_inner = record_vertex_inner;
+  context.vertex_loose = record_vertex_loose;
+  context.vertex_of_loose_edge = record_vertex_of_loose_edge;
+  context.edge = record_edge;
+  context.loop = record_loop;
+  context.poly = record_poly;
+  context.user_data = &recorder;
+  EXPECT_TRUE(BKE_subdiv_foreach_subdiv_geometry(subdiv, &context, &settings, &coarse_mesh));
+  std::sort(recorder.records.begin(), recorder.records.end());
+  return std::move(recorder.records);
+}
+
+static int64_t count_records(const Span<CallbackRecord> records, const CallbackType type)
+{
+  return std::count_if(records.begin(), records.end(), [&](const CallbackRecord &record) {
+    return record.type == type;
+  });
+}
+
+TEST(subdiv_foreach, ThreadedMatchesSerial)
+{
+  BKE_idtype_init();
+  BLI_task_scheduler_init();
+  Mesh *coarse_mesh = create_coarse_mesh();
+  Subdiv *subdiv = create_subdiv(*coarse_mesh);
+  const Span<MEdge> edges = coarse_mesh->edges();
+  int non_manifold_edge = -1;
+  for (const int i : edges.index_range()) {
+    if (std::min(edges[i].v1, edges[i].v2) == 1 && std::max(edges[i].v1, edges[i].v2) == 2) {
+      non_manifold_edge = i;
+      break;
+    }
+  }
+
+  for (const bool use_every_callbacks : {false, true}) {
+    for (const bool use_optimal_display : {false, true}) {
+      SubdivToMeshSettings settings;
+      /* Resolution of subdivision level 2, it's always odd. */
+      settings.resolution = 5;
+      settings.use_optimal_display = use_optimal_display;
+      const Vector<CallbackRecord> records = record_traversal(
+          subdiv, *coarse_mesh, settings, use_every_callbacks);
+
+      const int copies_num = coarse_mesh_copies_num;
+      /* The loose vertex and both vertices of the loose edge. */
+      EXPECT_EQ(count_records(records, CallbackType::VertexLoose), 3 * copies_num);
+      EXPECT_EQ(count_records(records, CallbackType::VertexOfLooseEdge),
+                settings.resolution * copies_num);
+      /* The quad is a single regular ptex, other polygons have a special ptex for each corner. */
+      EXPECT_EQ(count_records(records, CallbackType::Poly),
+                (4 * 4 + (3 + 3 + 5) * 2 * 2) * copies_num);
+      /* The edge used by three polygons in the first copy is only split into four edges once. */
+      EXPECT_EQ(std::count_if(records.begin(),
+                              records.end(),
+                              [&](const CallbackRecord &record) {
+                                return record.type == CallbackType::Edge &&
+                                       record.indices[0] == non_manifold_edge;
+                              }),
+                4);
+#ifdef WITH_TBB
+      tbb::task_arena arena(1);
+      arena.execute([&]() {
+        const Vector<CallbackRecord> records_serial = record_traversal(
+            subdiv, *coarse_mesh, settings, use_every_callbacks);
+        EXPECT_EQ(records.as_span(), records_serial.as_span());
+      });
+#endif
+    }
+  }
+
+  BKE_subdiv_free(subdiv);
+  BKE_id_free(nullptr, coarse_mesh);
+}
+
+}  // namespace blender::bke::tests
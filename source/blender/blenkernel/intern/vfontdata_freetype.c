@@ -28,6 +28,7 @@
 #include "BLI_utildefines.h"
 
 #include "BKE_curve.h"
+#include "BKE_packedFile.h"
 #include "BKE_vfontdata.h"
 
 #include "DNA_curve_types.h"
@@ -245,6 +246,7 @@ static VChar *objchr_to_ftvfontdata(FT_Library library, VFont *vfont, FT_ULong c
 
   /* Load the font to memory */
   if (vfont->temp_pf) {
+    BKE_packedfile_ensure_data(vfont->temp_pf);
     FT_Error err = FT_New_Memory_Face(
         library, vfont->temp_pf->data, vfont->temp_pf->size, 0, &face);
     if (err) {
@@ -265,6 +267,7 @@ static VChar *objchr_to_ftvfontdata(FT_Library library, VFont *vfont, FT_ULong c
 static FT_Face vfont_face_load_from_packed_file(FT_Library library, PackedFile *pf)
 {
   FT_Face face = NULL;
+  BKE_packedfile_ensure_data(pf);
   FT_New_Memory_Face(library, pf->data, pf->size, 0, &face);
   if (!face) {
     return NULL;
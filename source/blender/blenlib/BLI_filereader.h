@@ -52,11 +52,30 @@ typedef struct FileReader {
 FileReader *BLI_filereader_new_file(int filedes) ATTR_WARN_UNUSED_RESULT;
 /** Create #FileReader from raw file descriptor using memory-mapped IO. */
 FileReader *BLI_filereader_new_mmap(int filedes) ATTR_WARN_UNUSED_RESULT;
+/**
+ * Get the memory-mapped file of a #FileReader created with #BLI_filereader_new_mmap,
+ * NULL for all other readers. The mapping is still owned by the reader.
+ */
+struct BLI_mmap_file *BLI_filereader_mmap_file_get(FileReader *reader) ATTR_NONNULL();
 /** Create #FileReader from a region of memory. */
 FileReader *BLI_filereader_new_memory(const void *data, size_t len) ATTR_WARN_UNUSED_RESULT
     ATTR_NONNULL();
 /** Create #FileReader from applying `Zstd` decompression on an underlying file. */
 FileReader *BLI_filereader_new_zstd(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+/**
+ * Same as #BLI_filereader_new_zstd, but when the file contains a seek table and frames are read
+ * in order, upcoming frames are decompressed ahead of time in parallel on the task scheduler.
+ * Intended for large sequential reads, uses up to 64 MB of extra memory while reading
+ * sequentially. Random access only decompresses the frames that are read.
+ */
+FileReader *BLI_filereader_new_zstd_readahead(FileReader *base) ATTR_WARN_UNUSED_RESULT
+    ATTR_NONNULL();
+/**
+ * Stop decompressing ahead and free the buffers used for it, for readers created with
+ * #BLI_filereader_new_zstd_readahead once no more sequential reads are expected.
+ * Does nothing for other readers.
+ */
+void BLI_filereader_zstd_readahead_stop(FileReader *reader) ATTR_NONNULL();
 /** Create #FileReader from applying `Gzip` decompression on an underlying file. */
 FileReader *BLI_filereader_new_gzip(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <atomic>
+
+#include "BLI_assert.h"
+#include "BLI_utility_mixins.hh"
+
+namespace blender {
+
+/**
+ * #ImplicitSharingInfo is the core data structure for implicit sharing in Blender. Implicit
+ * sharing is a technique that avoids copying data when it is not necessary. This results in
+ * better memory usage and performance. Only read-only data can be shared.
+ *
+ * Typically, a data container (e.g. a custom data layer) holds a pointer to the shared data and
+ * to an #ImplicitSharingInfo that owns it. Copying the container only adds a user to the sharing
+ * info instead of copying the data. Before the data is modified, the container has to check
+ * whether it is the only user (#is_mutable). If not, it has to make its own copy of the data
+ * first (this is often called "copy-on-write").
+ *
+ * The sharing info is intrinsically reference counted. `std::shared_ptr` can't be used for that
+ * purpose here, because that is not available in C code. If possible, the #UserCounter wrapper
+ * should be used to avoid manual reference counting in C++ code.
+ */
+class ImplicitSharingInfo : NonCopyable, NonMovable {
+ private:
+  mutable std::atomic<int> users_;
+
+ public:
+  ImplicitSharingInfo(const int initial_users) : users_(initial_users) {}
+
+  virtual ~ImplicitSharingInfo()
+  {
+    BLI_assert(this->is_mutable());
+  }
+
+  /** True if there are other users that may read the data at the same time. */
+  bool is_shared() const
+  {
+    return users_.load(std::memory_order_relaxed) >= 2;
+  }
+
+  /** Whether the data can be modified by the caller, i.e. it is not shared with others. */
+  bool is_mutable() const
+  {
+    return !this->is_shared();
+  }
+
+  void user_add() const
+  {
+    users_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void user_remove() const
+  {
+    const int old_users = users_.fetch_sub(1, std::memory_order_acq_rel);
+    BLI_assert(old_users >= 1);
+    if (old_users == 1) {
+      const_cast<ImplicitSharingInfo *>(this)->delete_self_with_data();
+    }
+  }
+
+ private:
+  /** Has to free the #ImplicitSharingInfo and the referenced data. */
+  virtual void delete_self_with_data() = 0;
+};
+
+namespace implicit_sharing {
+
+/**
+ * Create an implicit sharing info that takes ownership of data allocated with `MEM_*` and frees
+ * it with #MEM_freeN when the last user is removed. The returned info has a single user.
+ */
+const ImplicitSharingInfo *info_for_mem_free(void *data);
+
+}  // namespace implicit_sharing
+
+}  // namespace blender
@@ -111,6 +111,17 @@ typedef void (*BVHTree_RayCastCallback)(void *userdata,
  */
 typedef bool (*BVHTree_OverlapCallback)(void *userdata, int index_a, int index_b, int thread);
 
+/** The maximum number of points of a leaf for #BVHTree_RefitLeafCallback. */
+#define BVH_REFIT_POINTS_MAX 4
+
+/**
+ * Callback to get the coordinates of a leaf when refitting a tree.
+ * The index is the one the leaf was inserted with, returns the number of points written to `r_co`.
+ */
+typedef int (*BVHTree_RefitLeafCallback)(void *userdata,
+                                         int index,
+                                         float r_co[BVH_REFIT_POINTS_MAX][3]);
+
 /**
  * Callback to range search query.
  */
@@ -156,6 +167,16 @@ void BLI_bvhtree_free(BVHTree *tree);
  */
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints);
 void BLI_bvhtree_balance(BVHTree *tree);
+/**
+ * Build a copy of the tree with 4-wide nodes, which speeds up #BLI_bvhtree_ray_cast_ex and
+ * #BLI_bvhtree_find_nearest_ex. It costs extra memory and build time, so only use it for trees
+ * which get many of these queries. Only AABB trees (axis 6) with 2 or 4 children per node are
+ * supported, the call does nothing for other trees.
+ *
+ * \note call after #BLI_bvhtree_balance(). The copy is kept up to date by
+ * #BLI_bvhtree_update_tree() and freed when balancing the tree again.
+ */
+void BLI_bvhtree_wide_nodes_ensure(BVHTree *tree);
 
 /**
  * Update: first update points/nodes, then call update_tree to refit the bounding volumes.
@@ -170,6 +191,12 @@ bool BLI_bvhtree_update_node(
  * too much, operations on the tree may become suboptimal.
  */
 void BLI_bvhtree_update_tree(BVHTree *tree);
+/**
+ * Update the bounding volumes of all leafs with the coordinates from the callback, then refit the
+ * branches with #BLI_bvhtree_update_tree(). This is much faster than building a new tree when
+ * only the coordinates changed. The callback is called from multiple threads.
+ */
+void BLI_bvhtree_refit(BVHTree *tree, BVHTree_RefitLeafCallback callback, void *userdata);
 
 /**
  * Use to check the total number of threads #BLI_bvhtree_overlap will use.
@@ -237,6 +264,22 @@ int BLI_bvhtree_find_nearest(const BVHTree *tree,
                              BVHTree_NearestPointCallback callback,
                              void *userdata);
 
+/**
+ * Find the nearest node for many coordinates at once, like calling #BLI_bvhtree_find_nearest_ex
+ * for each of them, running in parallel for larger batches.
+ *
+ * \param nearests: Array of \a points_num results, initialized by the caller the same way
+ * as the nearest passed to #BLI_bvhtree_find_nearest_ex.
+ * \param callback: Optional, must be thread-safe.
+ */
+void BLI_bvhtree_find_nearest_batch(const BVHTree *tree,
+                                    const float (*co)[3],
+                                    int points_num,
+                                    BVHTreeNearest *nearests,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag);
+
 /**
  * Find the first node nearby.
  * Favors speed over quality since it doesn't find the best target node.
@@ -288,6 +331,24 @@ void BLI_bvhtree_ray_cast_all(const BVHTree *tree,
                               BVHTree_RayCastCallback callback,
                               void *userdata);
 
+/**
+ * Ray-cast many rays at once, like calling #BLI_bvhtree_ray_cast_ex for each ray,
+ * running in parallel for larger batches.
+ *
+ * \param hits: Array of \a rays_num hits, initialized by the caller the same way
+ * as the hit passed to #BLI_bvhtree_ray_cast_ex.
+ * \param callback: Optional, must be thread-safe.
+ */
+void BLI_bvhtree_ray_cast_batch(const BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                int rays_num,
+                                float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag);
+
 float BLI_bvhtree_bb_raycast(const float bv[6],
                              const float light_start[3],
                              const float light_end[3],
@@ -57,6 +57,23 @@ void BLI_kdtree_nd_(range_search_cb)(
     bool (*search_cb)(void *user_data, int index, const float co[KD_DIMS], float dist_sq),
     void *user_data);
 
+/**
+ * Batched queries, running in parallel for larger batches.
+ * Callbacks must be thread-safe.
+ */
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        unsigned int co_len,
+                                        KDTreeNearest *r_nearest) ATTR_NONNULL(1, 4);
+void BLI_kdtree_nd_(range_search_batch_cb)(
+    const KDTree *tree,
+    const float (*co)[KD_DIMS],
+    unsigned int co_len,
+    float range,
+    bool (*search_cb)(
+        void *user_data, int co_index, int index, const float co[KD_DIMS], float dist_sq),
+    void *user_data);
+
 int BLI_kdtree_nd_(calc_duplicates_fast)(const KDTree *tree,
                                          float range,
                                          bool use_index_order,
@@ -105,6 +122,29 @@ inline void BLI_kdtree_nd_(range_search_cb_cpp)(const KDTree *tree,
       },
       const_cast<Fn *>(&fn));
 }
+
+template<typename Fn>
+inline void BLI_kdtree_nd_(range_search_batch_cb_cpp)(const KDTree *tree,
+                                                      const float (*co)[KD_DIMS],
+                                                      unsigned int co_len,
+                                                      float distance,
+                                                      const Fn &fn)
+{
+  BLI_kdtree_nd_(range_search_batch_cb)(
+      tree,
+      co,
+      co_len,
+      distance,
+      [](void *user_data,
+         const int co_index,
+         const int index,
+         const float *co,
+         const float dist_sq) {
+        const Fn &fn = *static_cast<const Fn *>(user_data);
+        return fn(co_index, index, co, dist_sq);
+      },
+      const_cast<Fn *>(&fn));
+}
 #endif
 
 #undef _BLI_CONCAT_AUX
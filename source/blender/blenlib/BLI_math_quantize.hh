@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Conversions between floats and compact fixed or half precision representations. They are
+ * used to store attributes that don't need full precision with less memory.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "BLI_math_vector.hh"
+#include "BLI_math_vector_types.hh"
+
+namespace blender::math {
+
+/* -------------------------------------------------------------------- */
+/** \name Half Precision Floats
+ *
+ * IEEE 754 binary16 values stored in a #uint16_t. Conversions round to nearest even, overflow
+ * to infinity and keep NaN. Based on the public domain code by Fabian Giesen.
+ * \{ */
+
+inline uint16_t float_to_half(const float value)
+{
+  union FP32 {
+    uint32_t u;
+    float f;
+  };
+  const FP32 f32_infinity = {255u << 23};
+  const FP32 f16_max = {(127u + 16u) << 23};
+  const FP32 denorm_magic = {((127u - 15u) + (23u - 10u) + 1u) << 23};
+
+  FP32 f;
+  f.f = value;
+  const uint32_t sign = f.u & 0x80000000u;
+  f.u ^= sign;
+
+  uint16_t result;
+  if (f.u >= f16_max.u) {
+    /* Overflow becomes infinity, NaN stays a (quiet) NaN. */
+    result = f.u > f32_infinity.u ? 0x7e00 : 0x7c00;
+  }
+  else if (f.u < (113u << 23)) {
+    /* The result is a denormal or zero. Let the floating point unit do the rounding. */
+    f.f += denorm_magic.f;
+    result = uint16_t(f.u - denorm_magic.u);
+  }
+  else {
+    const uint32_t mantissa_odd = (f.u >> 13) & 1u;
+    /* Rebias the exponent and round to nearest even. */
+    f.u += (uint32_t(15 - 127) << 23) + 0xfffu;
+    f.u += mantissa_odd;
+    result = uint16_t(f.u >> 13);
+  }
+  return result | uint16_t(sign >> 16);
+}
+
+inline float half_to_float(const uint16_t value)
+{
+  union FP32 {
+    uint32_t u;
+    float f;
+  };
+  const FP32 magic = {113u << 23};
+  const uint32_t shifted_exponent = 0x7c00u << 13;
+
+  FP32 result;
+  result.u = uint32_t(value & 0x7fffu) << 13;
+  const uint32_t exponent = shifted_exponent & result.u;
+  result.u += (127u - 15u) << 23;
+  if (exponent == shifted_exponent) {
+    /* Infinity or NaN. */
+    result.u += (128u - 16u) << 23;
+  }
+  else if (exponent == 0) {
+    /* Zero or denormal, renormalize. */
+    result.u += 1u << 23;
+    result.f -= magic.f;
+  }
+  result.u |= uint32_t(value & 0x8000u) << 16;
+  return result.f;
+}
+
+inline ushort3 float_to_half(const float3 &value)
+{
+  return {float_to_half(value.x), float_to_half(value.y), float_to_half(value.z)};
+}
+
+inline float3 half_to_float(const ushort3 &value)
+{
+  return {half_to_float(value.x), half_to_float(value.y), half_to_float(value.z)};
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Normalized Integers
+ *
+ * Values in the [0, 1] range stored with 16 bit precision. Values outside of the range are
+ * clamped.
+ * \{ */
+
+inline uint16_t float_to_unorm16(const float value)
+{
+  return uint16_t(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+inline float unorm16_to_float(const uint16_t value)
+{
+  return float(value) * (1.0f / 65535.0f);
+}
+
+inline ushort2 float_to_unorm16(const float2 &value)
+{
+  return {float_to_unorm16(value.x), float_to_unorm16(value.y)};
+}
+
+inline float2 unorm16_to_float(const ushort2 &value)
+{
+  return {unorm16_to_float(value.x), unorm16_to_float(value.y)};
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Octahedral Normals
+ *
+ * Unit vectors projected onto an octahedron that is unfolded into a square, stored as two
+ * signed normalized 16 bit integers. The angular error is below 0.005 degrees.
+ * \{ */
+
+namespace detail {
+inline float sign_not_zero(const float value)
+{
+  return value < 0.0f ? -1.0f : 1.0f;
+}
+}  // namespace detail
+
+/** The normal is expected to be normalized. A zero vector is encoded as the Z axis. */
+inline short2 normal_to_octahedral(const float3 &normal)
+{
+  const float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (sum == 0.0f) {
+    return {0, 0};
+  }
+  float2 projected = float2(normal.x, normal.y) / sum;
+  if (normal.z < 0.0f) {
+    projected = float2((1.0f - std::abs(projected.y)) * detail::sign_not_zero(projected.x),
+                       (1.0f - std::abs(projected.x)) * detail::sign_not_zero(projected.y));
+  }
+  return {int16_t(std::round(std::clamp(projected.x, -1.0f, 1.0f) * 32767.0f)),
+          int16_t(std::round(std::clamp(projected.y, -1.0f, 1.0f) * 32767.0f))};
+}
+
+inline float3 octahedral_to_normal(const short2 &value)
+{
+  const float2 projected(std::max(float(value.x) / 32767.0f, -1.0f),
+                         std::max(float(value.y) / 32767.0f, -1.0f));
+  float3 normal(projected.x,
+                projected.y,
+                1.0f - std::abs(projected.x) - std::abs(projected.y));
+  if (normal.z < 0.0f) {
+    normal.x = (1.0f - std::abs(projected.y)) * detail::sign_not_zero(projected.x);
+    normal.y = (1.0f - std::abs(projected.x)) * detail::sign_not_zero(projected.y);
+  }
+  return math::normalize(normal);
+}
+
+/** \} */
+
+}  // namespace blender::math
@@ -82,6 +82,41 @@ void *BLI_mempool_as_arrayN(BLI_mempool *pool,
 void BLI_mempool_set_memory_debug(void);
 #endif
 
+/**
+ * Thread caches, allowing multiple threads to allocate and free elements of the same pool.
+ *
+ * Each thread uses its own cache, which keeps a private list of free elements and only locks
+ * the pool to take or return a batch of elements. Elements may be freed through any cache
+ * of the pool, not only the one they were allocated from.
+ *
+ * \note While thread caches exist, the pool must not be accessed directly
+ * (allocating, freeing, iterating or querying its length), since elements owned by the caches
+ * and their counts are only merged back into the pool by #BLI_mempool_thread_cache_flush
+ * and #BLI_mempool_thread_cache_destroy.
+ */
+typedef struct BLI_mempool_thread_cache BLI_mempool_thread_cache;
+
+BLI_mempool_thread_cache *BLI_mempool_thread_cache_create(BLI_mempool *pool)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_RETURNS_NONNULL ATTR_NONNULL(1);
+void *BLI_mempool_thread_cache_alloc(BLI_mempool_thread_cache *cache)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_RETURNS_NONNULL ATTR_NONNULL(1);
+void *BLI_mempool_thread_cache_calloc(BLI_mempool_thread_cache *cache)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_RETURNS_NONNULL ATTR_NONNULL(1);
+/**
+ * Free an element which was allocated from any thread cache of the same pool,
+ * or from the pool itself before the thread caches were created.
+ */
+void BLI_mempool_thread_cache_free(BLI_mempool_thread_cache *cache, void *addr)
+    ATTR_NONNULL(1, 2);
+/**
+ * Return all free elements of the cache to the pool and update the pool's element count.
+ */
+void BLI_mempool_thread_cache_flush(BLI_mempool_thread_cache *cache) ATTR_NONNULL(1);
+/**
+ * Flush and free the cache, this must be done before using the pool directly again.
+ */
+void BLI_mempool_thread_cache_destroy(BLI_mempool_thread_cache *cache) ATTR_NONNULL(1);
+
 /**
  * Iteration stuff.
  * \note this may easy to produce bugs with.
@@ -58,6 +58,22 @@ template<typename T> class SharedCache {
     cache_->mutex.ensure([&]() { compute_cache(this->cache_->data); });
   }
 
+  /**
+   * Modify the cached data in place, for example to update only the part that changed. If the
+   * cache is shared with other objects, it is copied first so that they aren't affected.
+   * The cache must already be calculated.
+   */
+  void update(FunctionRef<void(T &data)> modify_cache)
+  {
+    BLI_assert(cache_->mutex.is_cached());
+    if (!cache_.unique()) {
+      std::shared_ptr<CacheData> new_cache = std::make_shared<CacheData>();
+      new_cache->mutex.ensure([&]() { new_cache->data = cache_->data; });
+      cache_ = std::move(new_cache);
+    }
+    modify_cache(cache_->data);
+  }
+
   /** Retrieve the cached data. */
   const T &data()
   {
@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Recording of the begin and end time of events on all threads into a file in the Chrome trace
+ * event format, which can be inspected with `chrome://tracing` or https://ui.perfetto.dev.
+ *
+ * Every thread records its events into its own ring buffer, so recording does not need any
+ * synchronization. When more events are recorded than fit into the buffer, the oldest events are
+ * dropped. When no trace session is running recording an event only costs an atomic load.
+ *
+ * Enabled with the `--debug-trace <filepath>` command line argument.
+ */
+
+#include "BLI_utildefines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Start recording events. The events are written to the file when the session ends.
+ */
+void BLI_trace_session_begin(const char *filepath);
+/**
+ * Stop recording events and write all recorded events to the file of the session.
+ * \note Must not be called while other threads still record events.
+ */
+void BLI_trace_session_end(void);
+
+bool BLI_trace_is_enabled(void);
+
+/**
+ * Begin an event on the current thread, ended by the next call of #BLI_trace_event_end on the same
+ * thread. Events can be nested.
+ *
+ * \param category: Group of the event, has to be a static string.
+ * \param name: Name of the event, is copied.
+ */
+void BLI_trace_event_begin(const char *category, const char *name);
+void BLI_trace_event_end(void);
+
+#ifdef __cplusplus
+}
+#endif
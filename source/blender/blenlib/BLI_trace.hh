@@ -0,0 +1,33 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ */
+
+#include "BLI_trace.h"
+
+namespace blender::trace {
+
+/** Record an event for the lifetime of the object, see #BLI_trace_event_begin. */
+class ScopedEvent {
+ public:
+  ScopedEvent(const char *category, const char *name)
+  {
+    BLI_trace_event_begin(category, name);
+  }
+
+  ~ScopedEvent()
+  {
+    BLI_trace_event_end();
+  }
+
+  ScopedEvent(const ScopedEvent &other) = delete;
+  ScopedEvent &operator=(const ScopedEvent &other) = delete;
+};
+
+}  // namespace blender::trace
+
+#define SCOPED_TRACE_EVENT(category, name) \
+  blender::trace::ScopedEvent scoped_trace_event(category, name)
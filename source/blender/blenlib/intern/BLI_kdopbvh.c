@@ -20,6 +20,9 @@
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
  *   #BLI_bvhtree_range_query
+ *
+ * AABB trees can also store a 4-wide copy of the tree for faster ray-cast and nearest queries,
+ * see #BVHWideNode.
  */
 
 #include "MEM_guardedalloc.h"
@@ -28,6 +31,7 @@
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_simd.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
@@ -60,6 +64,8 @@
 
 typedef uchar axis_t;
 
+struct BVHWideNode;
+
 typedef struct BVHNode {
   struct BVHNode **children;
   struct BVHNode *parent; /* some user defined traversed need that */
@@ -84,11 +90,12 @@ struct BVHTree {
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* KDOP type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quad-tree). */
+  struct BVHWideNode *wide_nodes; /* optional 4-wide copy of the branches, root first */
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 56) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 36),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -848,6 +855,182 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Wide BVH
+ *
+ * For AABB trees with 2 or 4 children per node, a copy of the branches is built where every node
+ * has up to #BVH_WIDE_WIDTH children, with the bounds of the children stored per axis.
+ * This way a single node test checks all children at once (using SSE when available),
+ * binary trees are collapsed to half their depth and traversal needs no recursion.
+ *
+ * The copy is only built on request with #BLI_bvhtree_wide_nodes_ensure, since it uses extra
+ * memory and build time which only pays off for trees that are queried often.
+ * Ray-cast and find-nearest queries use the wide nodes when they exist,
+ * other queries use the regular nodes which are kept unchanged.
+ * \{ */
+
+#define BVH_WIDE_WIDTH 4
+/**
+ * Every node visited pushes at most #BVH_WIDE_WIDTH - 1 more items than it pops,
+ * enough for balanced trees of up to 2^32 leafs (16 levels of wide nodes).
+ */
+#define BVH_WIDE_STACK_SIZE 64
+
+typedef struct BVHWideNode {
+  /** Bounds of the children per axis, unused children have inverted (empty) bounds. */
+  float bv_min[3][BVH_WIDE_WIDTH];
+  float bv_max[3][BVH_WIDE_WIDTH];
+  /** The collapsed regular nodes, used to refit the bounds and to access leafs. */
+  const BVHNode *children[BVH_WIDE_WIDTH];
+  /** Index of the wide node of each child in #BVHTree.wide_nodes, -1 for leafs. */
+  int children_wide[BVH_WIDE_WIDTH];
+  int node_num;
+} BVHWideNode;
+
+/** Either a wide node to traverse or a leaf to test, with the distance to its bounds. */
+typedef struct BVHWideStackItem {
+  const BVHWideNode *wide_node;
+  const BVHNode *leaf;
+  float dist;
+} BVHWideStackItem;
+
+static bool bvhtree_wide_supported(const BVHTree *tree)
+{
+  return (tree->axis == 6) && ELEM(tree->tree_type, 2, 4);
+}
+
+static float bvhtree_bv_surface_area(const float *bv)
+{
+  const float dx = bv[1] - bv[0];
+  const float dy = bv[3] - bv[2];
+  const float dz = bv[5] - bv[4];
+  return dx * dy + dy * dz + dz * dx;
+}
+
+static void bvhtree_wide_node_refit(BVHWideNode *wide_node)
+{
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    const BVHNode *child = wide_node->children[i];
+    for (int axis = 0; axis < 3; axis++) {
+      wide_node->bv_min[axis][i] = child ? child->bv[2 * axis] : FLT_MAX;
+      wide_node->bv_max[axis][i] = child ? child->bv[2 * axis + 1] : -FLT_MAX;
+    }
+  }
+}
+
+static int bvhtree_wide_build_recursive(BVHTree *tree, const BVHNode *node, int *r_wide_num)
+{
+  const int wide_index = (*r_wide_num)++;
+  BVHWideNode *wide_node = &tree->wide_nodes[wide_index];
+  const BVHNode *children[BVH_WIDE_WIDTH];
+  int children_num = 0;
+
+  BLI_assert(node->node_num != 0 && node->node_num <= BVH_WIDE_WIDTH);
+  for (int i = 0; i < node->node_num; i++) {
+    children[children_num++] = node->children[i];
+  }
+
+  /* Pull up the children of the largest branch while they fit,
+   * for binary trees this collapses two levels into one wide node. */
+  while (children_num < BVH_WIDE_WIDTH) {
+    int collapse_index = -1;
+    float collapse_area = -1.0f;
+    for (int i = 0; i < children_num; i++) {
+      const BVHNode *child = children[i];
+      if ((child->node_num != 0) && (children_num - 1 + child->node_num <= BVH_WIDE_WIDTH)) {
+        const float area = bvhtree_bv_surface_area(child->bv);
+        if (area > collapse_area) {
+          collapse_index = i;
+          collapse_area = area;
+        }
+      }
+    }
+    if (collapse_index == -1) {
+      break;
+    }
+    const BVHNode *child = children[collapse_index];
+    children[collapse_index] = child->children[0];
+    for (int i = 1; i < child->node_num; i++) {
+      children[children_num++] = child->children[i];
+    }
+  }
+
+  wide_node->node_num = children_num;
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    wide_node->children[i] = (i < children_num) ? children[i] : NULL;
+  }
+  bvhtree_wide_node_refit(wide_node);
+
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    wide_node->children_wide[i] = ((i < children_num) && (children[i]->node_num != 0)) ?
+                                      bvhtree_wide_build_recursive(tree, children[i], r_wide_num) :
+                                      -1;
+  }
+
+  return wide_index;
+}
+
+void BLI_bvhtree_wide_nodes_ensure(BVHTree *tree)
+{
+  if ((tree->wide_nodes != NULL) || !bvhtree_wide_supported(tree) || (tree->branch_num == 0)) {
+    return;
+  }
+  const BVHNode *root = tree->nodes[tree->leaf_num];
+  if ((tree->leaf_num == 0) || (root->node_num == 0)) {
+    return;
+  }
+
+  /* Every wide node replaces at least one branch. */
+  int wide_num = 0;
+  tree->wide_nodes = MEM_calloc_arrayN(
+      (size_t)tree->branch_num, sizeof(*tree->wide_nodes), "BVHWideNodes");
+  bvhtree_wide_build_recursive(tree, root, &wide_num);
+  BLI_assert(wide_num <= tree->branch_num);
+}
+
+/**
+ * Push the children of \a wide_node set in \a mask,
+ * ordered so the nearest child is popped first.
+ */
+static void bvhtree_wide_stack_push(BVHWideStackItem *stack,
+                                    int *stack_len,
+                                    const BVHWideNode *wide_nodes,
+                                    const BVHWideNode *wide_node,
+                                    const float dist[BVH_WIDE_WIDTH],
+                                    int mask)
+{
+  int order[BVH_WIDE_WIDTH];
+  int order_len = 0;
+
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    if (mask & (1 << i)) {
+      /* Insertion sort, farthest first. */
+      int j = order_len++;
+      for (; j > 0 && dist[order[j - 1]] < dist[i]; j--) {
+        order[j] = order[j - 1];
+      }
+      order[j] = i;
+    }
+  }
+
+  BLI_assert(*stack_len + order_len <= BVH_WIDE_STACK_SIZE);
+  for (int j = 0; j < order_len; j++) {
+    const int i = order[j];
+    BVHWideStackItem *item = &stack[(*stack_len)++];
+    if (wide_node->children_wide[i] == -1) {
+      item->wide_node = NULL;
+      item->leaf = wide_node->children[i];
+    }
+    else {
+      item->wide_node = &wide_nodes[wide_node->children_wide[i]];
+      item->leaf = NULL;
+    }
+    item->dist = dist[i];
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -927,6 +1110,7 @@ fail:
 void BLI_bvhtree_free(BVHTree *tree)
 {
   if (tree) {
+    MEM_SAFE_FREE(tree->wide_nodes);
     MEM_SAFE_FREE(tree->nodes);
     MEM_SAFE_FREE(tree->nodearray);
     MEM_SAFE_FREE(tree->nodebv);
@@ -943,6 +1127,9 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->branch_num == 0);
 
+  /* The wide nodes point to the branches which are rebuilt below. */
+  MEM_SAFE_FREE(tree->wide_nodes);
+
   /* Build the implicit tree */
   non_recursive_bvh_div_nodes(
       tree, tree->nodearray + (tree->leaf_num - 1), leafs_array, tree->leaf_num);
@@ -1019,19 +1206,97 @@ bool BLI_bvhtree_update_node(
   return true;
 }
 
+static void bvhtree_update_branches_task_cb(void *__restrict userdata,
+                                            const int j,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHTree *tree = userdata;
+  node_join(tree, &tree->nodearray[tree->leaf_num - 1 + j]);
+}
+
+static void bvhtree_wide_refit_task_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHTree *tree = userdata;
+  bvhtree_wide_node_refit(&tree->wide_nodes[i]);
+}
+
 void BLI_bvhtree_update_tree(BVHTree *tree)
 {
   /* Update bottom=>top
-   * TRICKY: the way we build the tree all the children have an index greater than the parent
-   * This allows us todo a bottom up update by starting on the bigger numbered branch. */
+   * TRICKY: the way we build the tree all the children have an index greater than the parent,
+   * and the branches are stored per depth level (see #non_recursive_bvh_div_nodes).
+   * This allows us to update all branches of a level in parallel, starting from the deepest. */
+  const int tree_type = tree->tree_type;
+  const int tree_offset = 2 - tree->tree_type;
+  const int branches_num = tree->branch_num;
+
+  /* Index of the first branch on every level, the implicit tree is at most 32 levels deep. */
+  int level_first[33];
+  int levels_num = 0;
+  for (int i = 1; i <= branches_num; i = i * tree_type + tree_offset) {
+    level_first[levels_num++] = i;
+  }
 
-  BVHNode **root = tree->nodes + tree->leaf_num;
-  BVHNode **index = tree->nodes + tree->leaf_num + tree->branch_num - 1;
+  for (int level = levels_num - 1; level >= 0; level--) {
+    const int i = level_first[level];
+    const int i_stop = min_ii(i * tree_type + tree_offset, branches_num + 1);
 
-  for (; index >= root; index--) {
-    node_join(tree, *index);
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (i_stop - i > KDOPBVH_THREAD_LEAF_THRESHOLD);
+    BLI_task_parallel_range(i, i_stop, tree, bvhtree_update_branches_task_cb, &settings);
+  }
+
+  if (tree->wide_nodes) {
+    /* Wide nodes only read the bounds of the branches and leafs, so their order doesn't matter.
+     * Unused wide nodes are zero initialized and have no children. */
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (branches_num > KDOPBVH_THREAD_LEAF_THRESHOLD);
+    BLI_task_parallel_range(0, branches_num, tree, bvhtree_wide_refit_task_cb, &settings);
   }
 }
+
+typedef struct BVHRefitData {
+  BVHTree *tree;
+  BVHTree_RefitLeafCallback callback;
+  void *userdata;
+} BVHRefitData;
+
+static void bvhtree_refit_leafs_task_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHRefitData *data = userdata;
+  BVHTree *tree = data->tree;
+  BVHNode *node = &tree->nodearray[i];
+  float co[BVH_REFIT_POINTS_MAX][3];
+  const int numpoints = data->callback(data->userdata, node->index, co);
+  BLI_assert(numpoints <= BVH_REFIT_POINTS_MAX);
+
+  create_kdop_hull(tree, node, &co[0][0], numpoints, 0);
+  bvhtree_node_inflate(tree, node, tree->epsilon);
+}
+
+void BLI_bvhtree_refit(BVHTree *tree, BVHTree_RefitLeafCallback callback, void *userdata)
+{
+  BVHRefitData data = {
+      .tree = tree,
+      .callback = callback,
+      .userdata = userdata,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (tree->leaf_num > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, tree->leaf_num, &data, bvhtree_refit_leafs_task_cb, &settings);
+
+  BLI_bvhtree_update_tree(tree);
+}
+
 int BLI_bvhtree_get_len(const BVHTree *tree)
 {
   return tree->leaf_num;
@@ -1527,7 +1792,9 @@ int *BLI_bvhtree_intersect_plane(const BVHTree *tree, float plane[4], uint *r_in
 
 /* Determines the nearest point of the given node BV.
  * Returns the squared distance to that point. */
-static float calc_nearest_point_squared(const float proj[3], BVHNode *node, float nearest[3])
+static float calc_nearest_point_squared(const float proj[3],
+                                        const BVHNode *node,
+                                        float nearest[3])
 {
   int i;
   const float *bv = node->bv;
@@ -1641,6 +1908,80 @@ static void heap_find_nearest_begin(BVHNearestData *data, BVHNode *root)
   }
 }
 
+/**
+ * Squared distances from \a proj to the bounds of the children of \a wide_node,
+ * \return a mask of the children closer than \a dist_max_sq.
+ */
+static int bvhtree_wide_nearest_test(const float proj[3],
+                                     const BVHWideNode *wide_node,
+                                     const float dist_max_sq,
+                                     float r_dist_sq[BVH_WIDE_WIDTH])
+{
+#ifdef BLI_HAVE_SSE2
+  __m128 dist_sq = _mm_setzero_ps();
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 co = _mm_set1_ps(proj[axis]);
+    const __m128 nearest = _mm_min_ps(_mm_max_ps(co, _mm_loadu_ps(wide_node->bv_min[axis])),
+                                      _mm_loadu_ps(wide_node->bv_max[axis]));
+    const __m128 delta = _mm_sub_ps(nearest, co);
+    dist_sq = _mm_add_ps(dist_sq, _mm_mul_ps(delta, delta));
+  }
+  _mm_storeu_ps(r_dist_sq, dist_sq);
+  const int mask = _mm_movemask_ps(_mm_cmplt_ps(dist_sq, _mm_set1_ps(dist_max_sq)));
+#else
+  int mask = 0;
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    float dist_sq = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      const float nearest = min_ff(max_ff(proj[axis], wide_node->bv_min[axis][i]),
+                                   wide_node->bv_max[axis][i]);
+      const float delta = nearest - proj[axis];
+      dist_sq += delta * delta;
+    }
+    r_dist_sq[i] = dist_sq;
+    if (dist_sq < dist_max_sq) {
+      mask |= 1 << i;
+    }
+  }
+#endif
+  return mask & ((1 << wide_node->node_num) - 1);
+}
+
+static void bvhtree_wide_find_nearest(BVHNearestData *data)
+{
+  const BVHWideNode *wide_nodes = data->tree->wide_nodes;
+  BVHWideStackItem stack[BVH_WIDE_STACK_SIZE];
+  int stack_len = 1;
+
+  stack[0].wide_node = &wide_nodes[0];
+  stack[0].leaf = NULL;
+  stack[0].dist = 0.0f;
+
+  while (stack_len != 0) {
+    const BVHWideStackItem item = stack[--stack_len];
+    if (item.dist >= data->nearest.dist_sq) {
+      continue;
+    }
+
+    if (item.leaf) {
+      if (data->callback) {
+        data->callback(data->userdata, item.leaf->index, data->co, &data->nearest);
+      }
+      else {
+        data->nearest.index = item.leaf->index;
+        data->nearest.dist_sq = calc_nearest_point_squared(
+            data->proj, item.leaf, data->nearest.co);
+      }
+      continue;
+    }
+
+    float dist_sq[BVH_WIDE_WIDTH];
+    const int mask = bvhtree_wide_nearest_test(
+        data->proj, item.wide_node, data->nearest.dist_sq, dist_sq);
+    bvhtree_wide_stack_push(stack, &stack_len, wide_nodes, item.wide_node, dist_sq, mask);
+  }
+}
+
 int BLI_bvhtree_find_nearest_ex(const BVHTree *tree,
                                 const float co[3],
                                 BVHTreeNearest *nearest,
@@ -1673,7 +2014,11 @@ int BLI_bvhtree_find_nearest_ex(const BVHTree *tree,
   }
 
   /* dfs search */
-  if (root) {
+  if (tree->wide_nodes) {
+    /* Visits children nearest first, like the optimal order. */
+    bvhtree_wide_find_nearest(&data);
+  }
+  else if (root) {
     if (flag & BVH_NEAREST_OPTIMAL_ORDER) {
       heap_find_nearest_begin(&data, root);
     }
@@ -1971,6 +2316,93 @@ static void bvhtree_ray_cast_data_precalc(BVHRayCastData *data, int flag)
 #endif
 }
 
+/**
+ * Distances along the ray to the bounds of the children of \a wide_node,
+ * matching #fast_ray_nearest_hit.
+ * \return a mask of the children hit closer than the current hit.
+ */
+static int bvhtree_wide_ray_test(const BVHRayCastData *data,
+                                 const BVHWideNode *wide_node,
+                                 float r_dist[BVH_WIDE_WIDTH])
+{
+  const float *bv_near[3], *bv_far[3];
+  for (int axis = 0; axis < 3; axis++) {
+    const bool negative = data->idot_axis[axis] < 0.0f;
+    bv_near[axis] = negative ? wide_node->bv_max[axis] : wide_node->bv_min[axis];
+    bv_far[axis] = negative ? wide_node->bv_min[axis] : wide_node->bv_max[axis];
+  }
+
+#ifdef BLI_HAVE_SSE2
+  __m128 t_near = _mm_set1_ps(-FLT_MAX);
+  __m128 t_far = _mm_set1_ps(FLT_MAX);
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 origin = _mm_set1_ps(data->ray.origin[axis]);
+    const __m128 idot = _mm_set1_ps(data->idot_axis[axis]);
+    t_near = _mm_max_ps(t_near,
+                        _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(bv_near[axis]), origin), idot));
+    t_far = _mm_min_ps(t_far, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(bv_far[axis]), origin), idot));
+  }
+  _mm_storeu_ps(r_dist, t_near);
+  const __m128 hit = _mm_and_ps(
+      _mm_and_ps(_mm_cmple_ps(t_near, t_far), _mm_cmpge_ps(t_far, _mm_setzero_ps())),
+      _mm_cmplt_ps(t_near, _mm_set1_ps(data->hit.dist)));
+  const int mask = _mm_movemask_ps(hit);
+#else
+  int mask = 0;
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    float t_near = -FLT_MAX, t_far = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+      t_near = max_ff(t_near,
+                      (bv_near[axis][i] - data->ray.origin[axis]) * data->idot_axis[axis]);
+      t_far = min_ff(t_far, (bv_far[axis][i] - data->ray.origin[axis]) * data->idot_axis[axis]);
+    }
+    r_dist[i] = t_near;
+    if ((t_near <= t_far) && (t_far >= 0.0f) && (t_near < data->hit.dist)) {
+      mask |= 1 << i;
+    }
+  }
+#endif
+  return mask & ((1 << wide_node->node_num) - 1);
+}
+
+/**
+ * Ray-cast using the wide nodes, only used for rays without a radius
+ * (like #fast_ray_nearest_hit).
+ */
+static void bvhtree_wide_raycast(BVHRayCastData *data)
+{
+  const BVHWideNode *wide_nodes = data->tree->wide_nodes;
+  BVHWideStackItem stack[BVH_WIDE_STACK_SIZE];
+  int stack_len = 1;
+
+  stack[0].wide_node = &wide_nodes[0];
+  stack[0].leaf = NULL;
+  stack[0].dist = -FLT_MAX;
+
+  while (stack_len != 0) {
+    const BVHWideStackItem item = stack[--stack_len];
+    if (item.dist >= data->hit.dist) {
+      continue;
+    }
+
+    if (item.leaf) {
+      if (data->callback) {
+        data->callback(data->userdata, item.leaf->index, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = item.leaf->index;
+        data->hit.dist = item.dist;
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, item.dist);
+      }
+      continue;
+    }
+
+    float dist[BVH_WIDE_WIDTH];
+    const int mask = bvhtree_wide_ray_test(data, item.wide_node, dist);
+    bvhtree_wide_stack_push(stack, &stack_len, wide_nodes, item.wide_node, dist, mask);
+  }
+}
+
 int BLI_bvhtree_ray_cast_ex(const BVHTree *tree,
                             const float co[3],
                             const float dir[3],
@@ -2004,7 +2436,10 @@ int BLI_bvhtree_ray_cast_ex(const BVHTree *tree,
     data.hit.dist = BVH_RAYCAST_DIST_MAX;
   }
 
-  if (root) {
+  if (tree->wide_nodes && (radius == 0.0f)) {
+    bvhtree_wide_raycast(&data);
+  }
+  else if (root) {
     dfs_raycast(&data, root);
     //      iterative_raycast(&data, root);
   }
@@ -2103,6 +2538,113 @@ void BLI_bvhtree_ray_cast_all(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_ray_cast_batch / BLI_bvhtree_find_nearest_batch
+ *
+ * Run many queries on the same tree in parallel.
+ * \{ */
+
+/* Queries are cheap, so only use threads for larger batches. */
+#define KDOPBVH_BATCH_QUERY_THRESHOLD 256
+
+typedef struct BVHRayCastBatchData {
+  const BVHTree *tree;
+  const float (*co)[3];
+  const float (*dir)[3];
+  float radius;
+  BVHTreeRayHit *hits;
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+  int flag;
+} BVHRayCastBatchData;
+
+static void bvhtree_ray_cast_batch_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRayCastBatchData *data = userdata;
+  BLI_bvhtree_ray_cast_ex(data->tree,
+                          data->co[i],
+                          data->dir[i],
+                          data->radius,
+                          &data->hits[i],
+                          data->callback,
+                          data->userdata,
+                          data->flag);
+}
+
+void BLI_bvhtree_ray_cast_batch(const BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                const int rays_num,
+                                const float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const int flag)
+{
+  BVHRayCastBatchData data = {
+      .tree = tree,
+      .co = co,
+      .dir = dir,
+      .radius = radius,
+      .hits = hits,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (rays_num > KDOPBVH_BATCH_QUERY_THRESHOLD);
+  settings.min_iter_per_thread = KDOPBVH_BATCH_QUERY_THRESHOLD;
+  BLI_task_parallel_range(0, rays_num, &data, bvhtree_ray_cast_batch_cb, &settings);
+}
+
+typedef struct BVHNearestBatchData {
+  const BVHTree *tree;
+  const float (*co)[3];
+  BVHTreeNearest *nearests;
+  BVHTree_NearestPointCallback callback;
+  void *userdata;
+  int flag;
+} BVHNearestBatchData;
+
+static void bvhtree_find_nearest_batch_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHNearestBatchData *data = userdata;
+  BLI_bvhtree_find_nearest_ex(
+      data->tree, data->co[i], &data->nearests[i], data->callback, data->userdata, data->flag);
+}
+
+void BLI_bvhtree_find_nearest_batch(const BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int points_num,
+                                    BVHTreeNearest *nearests,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    const int flag)
+{
+  BVHNearestBatchData data = {
+      .tree = tree,
+      .co = co,
+      .nearests = nearests,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (points_num > KDOPBVH_BATCH_QUERY_THRESHOLD);
+  settings.min_iter_per_thread = KDOPBVH_BATCH_QUERY_THRESHOLD;
+  BLI_task_parallel_range(0, points_num, &data, bvhtree_find_nearest_batch_cb, &settings);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
@@ -11,6 +11,7 @@
  * - Freeing chunks.
  * - Iterating over allocated chunks
  *   (optionally when using the #BLI_MEMPOOL_ALLOW_ITER flag).
+ * - Allocating and freeing from multiple threads through #BLI_mempool_thread_cache.
  */
 
 #include <stdlib.h>
@@ -22,6 +23,7 @@
 
 #include "BLI_mempool.h"         /* own include */
 #include "BLI_mempool_private.h" /* own include */
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -120,6 +122,24 @@ struct BLI_mempool {
   /** Number of elements allocated in total. */
   uint totalloc;
 #endif
+
+  /** Protects #BLI_mempool.chunks and #BLI_mempool.free when used from thread caches. */
+  SpinLock thread_cache_lock;
+  /** Number of #BLI_mempool_thread_cache that exist for this pool. */
+  uint thread_caches_num;
+};
+
+/**
+ * Per-thread front-end for a #BLI_mempool, owning a private list of free elements.
+ * Only refilling and returning a batch of elements needs to lock the pool.
+ */
+struct BLI_mempool_thread_cache {
+  BLI_mempool *pool;
+  /** Free elements owned by this cache, linked the same way as #BLI_mempool.free. */
+  BLI_freenode *free;
+  uint free_num;
+  /** Elements allocated minus elements freed since the last flush into #BLI_mempool.totused. */
+  int used_delta;
 };
 
 #define MEMPOOL_ELEM_SIZE_MIN (sizeof(void *) * 2)
@@ -178,15 +198,8 @@ static BLI_mempool_chunk *mempool_chunk_alloc(BLI_mempool *pool)
  * (used when building free chunks initially)
  * \return The last chunk,
  */
-static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
-                                       BLI_mempool_chunk *mpchunk,
-                                       BLI_freenode *last_tail)
+static void mempool_chunk_append(BLI_mempool *pool, BLI_mempool_chunk *mpchunk)
 {
-  const uint esize = pool->esize;
-  BLI_freenode *curnode = CHUNK_DATA(mpchunk);
-  uint j;
-
-  /* append */
   if (pool->chunk_tail) {
     pool->chunk_tail->next = mpchunk;
   }
@@ -197,10 +210,18 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
 
   mpchunk->next = NULL;
   pool->chunk_tail = mpchunk;
+}
 
-  if (UNLIKELY(pool->free == NULL)) {
-    pool->free = curnode;
-  }
+/**
+ * Link all elements of \a mpchunk into a single list of free elements.
+ *
+ * \return The last element of the list.
+ */
+static BLI_freenode *mempool_chunk_init_free(BLI_mempool *pool, BLI_mempool_chunk *mpchunk)
+{
+  const uint esize = pool->esize;
+  BLI_freenode *curnode = CHUNK_DATA(mpchunk);
+  uint j;
 
   /* loop through the allocated data, building the pointer structures */
   j = pool->pchunk;
@@ -223,6 +244,23 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
   curnode = NODE_STEP_PREV(curnode);
   curnode->next = NULL;
 
+  return curnode;
+}
+
+static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
+                                       BLI_mempool_chunk *mpchunk,
+                                       BLI_freenode *last_tail)
+{
+  BLI_freenode *curnode;
+
+  mempool_chunk_append(pool, mpchunk);
+
+  if (UNLIKELY(pool->free == NULL)) {
+    pool->free = CHUNK_DATA(mpchunk);
+  }
+
+  curnode = mempool_chunk_init_free(pool, mpchunk);
+
 #ifdef USE_TOTALLOC
   pool->totalloc += pool->pchunk;
 #endif
@@ -301,6 +339,9 @@ BLI_mempool *BLI_mempool_create(uint esize, uint elem_num, uint pchunk, uint fla
 #endif
   pool->totused = 0;
 
+  BLI_spin_init(&pool->thread_cache_lock);
+  pool->thread_caches_num = 0;
+
   if (elem_num) {
     /* Allocate the actual chunks. */
     for (i = 0; i < maxchunks; i++) {
@@ -656,6 +697,8 @@ void BLI_mempool_clear_ex(BLI_mempool *pool, const int totelem_reserve)
   BLI_mempool_chunk *chunks_temp;
   BLI_freenode *last_tail = NULL;
 
+  BLI_assert_msg(pool->thread_caches_num == 0, "Clearing a pool which has thread caches.");
+
 #ifdef WITH_MEM_VALGRIND
   VALGRIND_DESTROY_MEMPOOL(pool);
   VALGRIND_CREATE_MEMPOOL(pool, 0, false);
@@ -706,7 +749,10 @@ void BLI_mempool_clear(BLI_mempool *pool)
 
 void BLI_mempool_destroy(BLI_mempool *pool)
 {
+  BLI_assert_msg(pool->thread_caches_num == 0, "Destroying a pool which has thread caches.");
+
   mempool_chunk_free_all(pool->chunks);
+  BLI_spin_end(&pool->thread_cache_lock);
 
 #ifdef WITH_MEM_VALGRIND
   VALGRIND_DESTROY_MEMPOOL(pool);
@@ -715,6 +761,181 @@ void BLI_mempool_destroy(BLI_mempool *pool)
   MEM_freeN(pool);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Thread Cache
+ *
+ * Elements move between the pool and a cache in batches of one chunk worth of elements,
+ * so the pool lock is only taken once every #BLI_mempool.pchunk allocations or frees.
+ * \{ */
+
+BLI_mempool_thread_cache *BLI_mempool_thread_cache_create(BLI_mempool *pool)
+{
+  BLI_mempool_thread_cache *cache = MEM_mallocN(sizeof(*cache), __func__);
+  cache->pool = pool;
+  cache->free = NULL;
+  cache->free_num = 0;
+  cache->used_delta = 0;
+  atomic_add_and_fetch_u(&pool->thread_caches_num, 1);
+  return cache;
+}
+
+/**
+ * Return the first \a num free elements of the cache to the pool,
+ * also updating the pool's used element count.
+ */
+static void mempool_thread_cache_release(BLI_mempool_thread_cache *cache, uint num)
+{
+  BLI_mempool *pool = cache->pool;
+  BLI_freenode *head = cache->free;
+  BLI_freenode *tail = NULL;
+
+  BLI_assert(num <= cache->free_num);
+  if (num != 0) {
+    tail = head;
+    for (uint i = 1; i < num; i++) {
+      tail = tail->next;
+    }
+    cache->free = tail->next;
+    cache->free_num -= num;
+  }
+
+  BLI_spin_lock(&pool->thread_cache_lock);
+  if (tail) {
+    tail->next = pool->free;
+    pool->free = head;
+  }
+  pool->totused = (uint)((int)pool->totused + cache->used_delta);
+  BLI_spin_unlock(&pool->thread_cache_lock);
+
+  cache->used_delta = 0;
+}
+
+/**
+ * Take a batch of free elements from the pool, or allocate a new chunk when the pool has none.
+ */
+static void mempool_thread_cache_refill(BLI_mempool_thread_cache *cache)
+{
+  BLI_mempool *pool = cache->pool;
+  BLI_mempool_chunk *mpchunk;
+
+  BLI_assert(cache->free == NULL);
+
+  BLI_spin_lock(&pool->thread_cache_lock);
+  if (pool->free) {
+    BLI_freenode *head = pool->free;
+    BLI_freenode *tail = head;
+    uint num = 1;
+    while ((num < pool->pchunk) && tail->next) {
+      tail = tail->next;
+      num++;
+    }
+    pool->free = tail->next;
+    BLI_spin_unlock(&pool->thread_cache_lock);
+
+    tail->next = NULL;
+    cache->free = head;
+    cache->free_num = num;
+    return;
+  }
+  BLI_spin_unlock(&pool->thread_cache_lock);
+
+  /* The new chunk is only visible to this thread until it's appended,
+   * so building its free list doesn't need the lock. */
+  mpchunk = mempool_chunk_alloc(pool);
+  mempool_chunk_init_free(pool, mpchunk);
+
+  BLI_spin_lock(&pool->thread_cache_lock);
+  mempool_chunk_append(pool, mpchunk);
+#ifdef USE_TOTALLOC
+  pool->totalloc += pool->pchunk;
+#endif
+  BLI_spin_unlock(&pool->thread_cache_lock);
+
+  cache->free = CHUNK_DATA(mpchunk);
+  cache->free_num = pool->pchunk;
+}
+
+void *BLI_mempool_thread_cache_alloc(BLI_mempool_thread_cache *cache)
+{
+  BLI_freenode *free_pop;
+
+  if (UNLIKELY(cache->free == NULL)) {
+    mempool_thread_cache_refill(cache);
+  }
+
+  free_pop = cache->free;
+
+  if (cache->pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    free_pop->freeword = USEDWORD;
+  }
+
+  cache->free = free_pop->next;
+  cache->free_num--;
+  cache->used_delta++;
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_ALLOC(cache->pool, free_pop, cache->pool->esize);
+#endif
+
+  return (void *)free_pop;
+}
+
+void *BLI_mempool_thread_cache_calloc(BLI_mempool_thread_cache *cache)
+{
+  void *retval = BLI_mempool_thread_cache_alloc(cache);
+  memset(retval, 0, (size_t)cache->pool->esize);
+  return retval;
+}
+
+void BLI_mempool_thread_cache_free(BLI_mempool_thread_cache *cache, void *addr)
+{
+  BLI_mempool *pool = cache->pool;
+  BLI_freenode *newhead = addr;
+
+#ifndef NDEBUG
+  /* Enable for debugging. */
+  if (UNLIKELY(mempool_debug_memset)) {
+    memset(addr, 255, pool->esize);
+  }
+#endif
+
+  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+#ifndef NDEBUG
+    /* This will detect double free's. */
+    BLI_assert(newhead->freeword != FREEWORD);
+#endif
+    newhead->freeword = FREEWORD;
+  }
+
+  newhead->next = cache->free;
+  cache->free = newhead;
+  cache->free_num++;
+  cache->used_delta--;
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_FREE(pool, addr);
+#endif
+
+  /* Keep one batch for following allocations, return the rest. */
+  if (UNLIKELY(cache->free_num >= pool->pchunk * 2)) {
+    mempool_thread_cache_release(cache, pool->pchunk);
+  }
+}
+
+void BLI_mempool_thread_cache_flush(BLI_mempool_thread_cache *cache)
+{
+  mempool_thread_cache_release(cache, cache->free_num);
+}
+
+void BLI_mempool_thread_cache_destroy(BLI_mempool_thread_cache *cache)
+{
+  BLI_mempool_thread_cache_flush(cache);
+  atomic_sub_and_fetch_u(&cache->pool->thread_caches_num, 1);
+  MEM_freeN(cache);
+}
+
+/** \} */
+
 #ifndef NDEBUG
 void BLI_mempool_set_memory_debug(void)
 {
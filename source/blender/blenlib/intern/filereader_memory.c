@@ -127,3 +127,11 @@ FileReader *BLI_filereader_new_mmap(int filedes)
 
   return (FileReader *)mem;
 }
+
+BLI_mmap_file *BLI_filereader_mmap_file_get(FileReader *reader)
+{
+  if (reader->read != memory_read_mmap) {
+    return NULL;
+  }
+  return ((MemoryReader *)reader)->mmap;
+}
@@ -12,9 +12,47 @@
 #include "BLI_endian_switch.h"
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
+/* Number of frame batches the read-ahead reader keeps: the one the caller consumes, the next one
+ * which is being decompressed in the background and the previous one for short seeks back. */
+#define ZSTD_READAHEAD_BATCHES 3
+/* Number of frames that have to be read one after another before read-ahead starts. */
+#define ZSTD_READAHEAD_SEQUENTIAL_FRAMES 2
+/* Upper bound for the compressed and uncompressed buffers of all batches together. Batches get
+ * fewer frames than there are threads when frames are large. */
+#define ZSTD_READAHEAD_MAX_MEMORY (64 << 20)
+
+/** A single seekable frame, decompressed by its own task. */
+typedef struct ZstdFrameSlot {
+  ZSTD_DCtx *ctx;
+
+  const char *compressed_data;
+  size_t compressed_size;
+
+  char *uncompressed_data;
+  size_t uncompressed_size;
+  size_t uncompressed_alloc_size;
+
+  bool is_valid;
+} ZstdFrameSlot;
+
+/** A run of consecutive frames that are decompressed in parallel. */
+typedef struct ZstdFrameBatch {
+  /** Non-NULL while decompression tasks of this batch may still be running. */
+  TaskPool *pool;
+
+  ZstdFrameSlot *slots;
+  int first_frame;
+  int frames_num;
+
+  char *compressed_data;
+  size_t compressed_alloc_size;
+} ZstdFrameBatch;
+
 typedef struct {
   FileReader reader;
 
@@ -32,6 +70,17 @@ typedef struct {
     char *cached_content;
     int cached_frame;
   } seek;
+
+  /* Only used by the read-ahead reader, see #BLI_filereader_new_zstd_readahead. */
+  struct {
+    bool use;
+    /** Maximum number of frames per batch, at most the number of threads. */
+    int batch_size;
+    ZstdFrameBatch batches[ZSTD_READAHEAD_BATCHES];
+    /** Frame of the previous read and the number of frames read in order up to it. */
+    int last_frame;
+    int sequential_frames;
+  } readahead;
 } ZstdReader;
 
 static bool zstd_read_u32(FileReader *base, uint32_t *val)
@@ -191,6 +240,221 @@ static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
   return uncompressed_data;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Read-Ahead
+ *
+ * Frames written by `writefile.cc` are independent, so they can be decompressed concurrently.
+ * Once frames are read in order, the compressed data of a batch of upcoming frames is read
+ * serially (the base reader is not thread-safe), then every frame of the batch is decompressed by
+ * its own task. While the caller consumes a batch, the following one is already being
+ * decompressed. Random access only decompresses the requested frame with #zstd_ensure_cache, and
+ * frees the read-ahead buffers, since files that stay open to read data on demand (e.g. libraries)
+ * don't need them anymore.
+ * \{ */
+
+static void zstd_readahead_decompress_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  ZstdFrameSlot *slot = taskdata;
+
+  size_t res = ZSTD_decompressDCtx(slot->ctx,
+                                   slot->uncompressed_data,
+                                   slot->uncompressed_size,
+                                   slot->compressed_data,
+                                   slot->compressed_size);
+  slot->is_valid = !ZSTD_isError(res) && res == slot->uncompressed_size;
+}
+
+static void zstd_readahead_batch_wait(ZstdFrameBatch *batch)
+{
+  if (batch->pool == NULL) {
+    return;
+  }
+  BLI_task_pool_work_and_wait(batch->pool);
+  BLI_task_pool_free(batch->pool);
+  batch->pool = NULL;
+}
+
+/* Start decompressing the frames following (and including) `first_frame` into `batch`.
+ * The batch must not have any tasks running. */
+static void zstd_readahead_batch_schedule(ZstdReader *zstd, ZstdFrameBatch *batch, int first_frame)
+{
+  BLI_assert(batch->pool == NULL);
+
+  const int frames_num = min_ii(zstd->readahead.batch_size,
+                                zstd->seek.frames_num - first_frame);
+  batch->first_frame = first_frame;
+  batch->frames_num = max_ii(frames_num, 0);
+  if (batch->frames_num == 0) {
+    return;
+  }
+
+  /* Frames are stored back to back, so the whole batch can be read at once. */
+  const size_t compressed_start = zstd->seek.compressed_ofs[first_frame];
+  const size_t compressed_size = zstd->seek.compressed_ofs[first_frame + frames_num] -
+                                 compressed_start;
+  if (compressed_size > batch->compressed_alloc_size) {
+    MEM_SAFE_FREE(batch->compressed_data);
+    batch->compressed_data = MEM_mallocN(compressed_size, __func__);
+    batch->compressed_alloc_size = compressed_size;
+  }
+
+  const bool read_ok = zstd->base->seek(zstd->base, compressed_start, SEEK_SET) >= 0 &&
+                       zstd->base->read(zstd->base, batch->compressed_data, compressed_size) ==
+                           (ssize_t)compressed_size;
+
+  if (read_ok) {
+    batch->pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  }
+
+  for (int i = 0; i < frames_num; i++) {
+    const int frame = first_frame + i;
+    ZstdFrameSlot *slot = &batch->slots[i];
+
+    slot->is_valid = false;
+    if (!read_ok) {
+      continue;
+    }
+
+    slot->compressed_data = batch->compressed_data + (zstd->seek.compressed_ofs[frame] -
+                                                      compressed_start);
+    slot->compressed_size = zstd->seek.compressed_ofs[frame + 1] -
+                            zstd->seek.compressed_ofs[frame];
+    slot->uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+                              zstd->seek.uncompressed_ofs[frame];
+    if (slot->uncompressed_size > slot->uncompressed_alloc_size) {
+      MEM_SAFE_FREE(slot->uncompressed_data);
+      slot->uncompressed_data = MEM_mallocN(slot->uncompressed_size, __func__);
+      slot->uncompressed_alloc_size = slot->uncompressed_size;
+    }
+    if (slot->ctx == NULL) {
+      slot->ctx = ZSTD_createDCtx();
+    }
+
+    BLI_task_pool_push(batch->pool, zstd_readahead_decompress_task, slot, false, NULL);
+  }
+}
+
+static ZstdFrameBatch *zstd_readahead_find_batch(ZstdReader *zstd, int frame)
+{
+  for (int i = 0; i < ZSTD_READAHEAD_BATCHES; i++) {
+    ZstdFrameBatch *batch = &zstd->readahead.batches[i];
+    if (frame >= batch->first_frame && frame < batch->first_frame + batch->frames_num) {
+      return batch;
+    }
+  }
+  return NULL;
+}
+
+/* Find a batch to decompress other frames into, which is neither `current` nor the batch with the
+ * frames right before it. */
+static ZstdFrameBatch *zstd_readahead_batch_for_reuse(ZstdReader *zstd,
+                                                      const ZstdFrameBatch *current)
+{
+  ZstdFrameBatch *result = NULL;
+  for (int i = 0; i < ZSTD_READAHEAD_BATCHES; i++) {
+    ZstdFrameBatch *batch = &zstd->readahead.batches[i];
+    if (batch == current) {
+      continue;
+    }
+    if (batch->frames_num == 0) {
+      return batch;
+    }
+    if (current != NULL && batch->first_frame + batch->frames_num == current->first_frame) {
+      continue;
+    }
+    if (result == NULL || batch->first_frame < result->first_frame) {
+      result = batch;
+    }
+  }
+  BLI_assert(result != NULL);
+  return result;
+}
+
+/* Free the buffers of all batches, they are allocated again when read-ahead restarts. */
+static void zstd_readahead_release(ZstdReader *zstd)
+{
+  for (int i = 0; i < ZSTD_READAHEAD_BATCHES; i++) {
+    ZstdFrameBatch *batch = &zstd->readahead.batches[i];
+    if (batch->compressed_data == NULL) {
+      continue;
+    }
+    zstd_readahead_batch_wait(batch);
+    for (int j = 0; j < zstd->readahead.batch_size; j++) {
+      ZstdFrameSlot *slot = &batch->slots[j];
+      if (slot->ctx) {
+        ZSTD_freeDCtx(slot->ctx);
+        slot->ctx = NULL;
+      }
+      MEM_SAFE_FREE(slot->uncompressed_data);
+      slot->uncompressed_alloc_size = 0;
+    }
+    MEM_SAFE_FREE(batch->compressed_data);
+    batch->compressed_alloc_size = 0;
+    batch->frames_num = 0;
+  }
+}
+
+/* Read-ahead counterpart of #zstd_ensure_cache. */
+static const char *zstd_readahead_ensure_frame(ZstdReader *zstd, int frame)
+{
+  if (frame == zstd->readahead.last_frame + 1) {
+    zstd->readahead.sequential_frames++;
+  }
+  else if (frame != zstd->readahead.last_frame) {
+    zstd->readahead.sequential_frames = 1;
+  }
+  zstd->readahead.last_frame = frame;
+
+  ZstdFrameBatch *batch = zstd_readahead_find_batch(zstd, frame);
+  if (batch == NULL) {
+    if (zstd->readahead.sequential_frames < ZSTD_READAHEAD_SEQUENTIAL_FRAMES) {
+      zstd_readahead_release(zstd);
+      return zstd_ensure_cache(zstd, frame);
+    }
+    batch = zstd_readahead_batch_for_reuse(zstd, NULL);
+    zstd_readahead_batch_wait(batch);
+    zstd_readahead_batch_schedule(zstd, batch, frame);
+  }
+
+  /* Keep decompressing the frames that follow in the background. */
+  const int next_frame = batch->first_frame + batch->frames_num;
+  if (next_frame < zstd->seek.frames_num && zstd_readahead_find_batch(zstd, next_frame) == NULL) {
+    ZstdFrameBatch *next = zstd_readahead_batch_for_reuse(zstd, batch);
+    zstd_readahead_batch_wait(next);
+    zstd_readahead_batch_schedule(zstd, next, next_frame);
+  }
+
+  zstd_readahead_batch_wait(batch);
+
+  ZstdFrameSlot *slot = &batch->slots[frame - batch->first_frame];
+  return slot->is_valid ? slot->uncompressed_data : NULL;
+}
+
+static void zstd_readahead_free(ZstdReader *zstd)
+{
+  zstd_readahead_release(zstd);
+  for (int i = 0; i < ZSTD_READAHEAD_BATCHES; i++) {
+    MEM_freeN(zstd->readahead.batches[i].slots);
+  }
+}
+
+/* Number of frames per batch that keeps all batches within #ZSTD_READAHEAD_MAX_MEMORY. */
+static int zstd_readahead_batch_size(const ZstdReader *zstd, const int threads_num)
+{
+  size_t frame_size_max = 1;
+  for (int i = 0; i < zstd->seek.frames_num; i++) {
+    const size_t frame_size = (zstd->seek.compressed_ofs[i + 1] - zstd->seek.compressed_ofs[i]) +
+                              (zstd->seek.uncompressed_ofs[i + 1] -
+                               zstd->seek.uncompressed_ofs[i]);
+    frame_size_max = max_zz(frame_size_max, frame_size);
+  }
+  const size_t frames_max = ZSTD_READAHEAD_MAX_MEMORY /
+                            (frame_size_max * ZSTD_READAHEAD_BATCHES);
+  return (int)clamp_z(frames_max, 1, (size_t)threads_num);
+}
+
+/** \} */
+
 static ssize_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
 {
   ZstdReader *zstd = (ZstdReader *)reader;
@@ -203,7 +467,8 @@ static ssize_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
       break;
     }
 
-    const char *framedata = zstd_ensure_cache(zstd, frame);
+    const char *framedata = zstd->readahead.use ? zstd_readahead_ensure_frame(zstd, frame) :
+                                                  zstd_ensure_cache(zstd, frame);
     if (framedata == NULL) {
       /* Error while reading the frame, so return as much as we can. */
       break;
@@ -285,6 +550,9 @@ static void zstd_close(FileReader *reader)
     if (zstd->seek.cached_content) {
       MEM_freeN(zstd->seek.cached_content);
     }
+    if (zstd->readahead.use) {
+      zstd_readahead_free(zstd);
+    }
   }
   else {
     MEM_freeN((void *)zstd->in_buf.src);
@@ -294,7 +562,7 @@ static void zstd_close(FileReader *reader)
   MEM_freeN(zstd);
 }
 
-FileReader *BLI_filereader_new_zstd(FileReader *base)
+static FileReader *zstd_reader_create(FileReader *base, const bool use_readahead)
 {
   ZstdReader *zstd = MEM_callocN(sizeof(ZstdReader), __func__);
 
@@ -304,6 +572,18 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
   if (zstd_read_seek_table(zstd)) {
     zstd->reader.read = zstd_read_seekable;
     zstd->reader.seek = zstd_seek;
+
+    /* Read-ahead only pays off when there are several frames and threads to spread them on. */
+    const int threads_num = BLI_system_thread_count();
+    if (use_readahead && threads_num > 1 && zstd->seek.frames_num > 1) {
+      zstd->readahead.use = true;
+      zstd->readahead.batch_size = zstd_readahead_batch_size(zstd, threads_num);
+      zstd->readahead.last_frame = -2;
+      for (int i = 0; i < ZSTD_READAHEAD_BATCHES; i++) {
+        zstd->readahead.batches[i].slots = MEM_calloc_arrayN(
+            zstd->readahead.batch_size, sizeof(ZstdFrameSlot), __func__);
+      }
+    }
   }
   else {
     zstd->reader.read = zstd_read;
@@ -323,3 +603,25 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
 
   return (FileReader *)zstd;
 }
+
+FileReader *BLI_filereader_new_zstd(FileReader *base)
+{
+  return zstd_reader_create(base, false);
+}
+
+FileReader *BLI_filereader_new_zstd_readahead(FileReader *base)
+{
+  return zstd_reader_create(base, true);
+}
+
+void BLI_filereader_zstd_readahead_stop(FileReader *reader)
+{
+  if (reader->read != zstd_read_seekable) {
+    return;
+  }
+  ZstdReader *zstd = (ZstdReader *)reader;
+  if (zstd->readahead.use) {
+    zstd_readahead_free(zstd);
+    zstd->readahead.use = false;
+  }
+}
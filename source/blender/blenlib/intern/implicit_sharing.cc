@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_implicit_sharing.hh"
+
+namespace blender::implicit_sharing {
+
+class MEMFreeImplicitSharing : public ImplicitSharingInfo {
+ public:
+  void *data;
+
+  MEMFreeImplicitSharing(void *data) : ImplicitSharingInfo(1), data(data)
+  {
+    BLI_assert(data != nullptr);
+  }
+
+ private:
+  void delete_self_with_data() override
+  {
+    MEM_freeN(data);
+    MEM_delete(this);
+  }
+};
+
+const ImplicitSharingInfo *info_for_mem_free(void *data)
+{
+  return MEM_new<MEMFreeImplicitSharing>(__func__, data);
+}
+
+}  // namespace blender::implicit_sharing
@@ -8,6 +8,7 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_strict_flags.h"
 #include "BLI_utildefines.h"
 
@@ -50,6 +51,12 @@ struct KDTree {
  */
 #define KD_NODE_ROOT_IS_INIT ((uint)-2)
 
+/** Sub-trees with at least this many nodes are balanced in their own task. */
+#define KD_BALANCE_TASK_NODES_MIN 10000
+
+/** Batched queries use threads and sort the queries by locality from this many queries. */
+#define KD_BATCH_QUERIES_THREADED_MIN 1000
+
 /* -------------------------------------------------------------------- */
 /** \name Local Math API
  * \{ */
@@ -131,7 +138,24 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+/**
+ * The root of a balanced sub-tree is always its median node,
+ * so it's known before the sub-tree itself is balanced.
+ */
+BLI_INLINE uint kdtree_balance_root(const uint nodes_len, const uint ofs)
+{
+  return (nodes_len == 0) ? KD_NODE_UNSET : (nodes_len / 2) + ofs;
+}
+
+static void kdtree_balance_task_push(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs);
+
+/**
+ * \param pool: When not null, large sub-trees are balanced in tasks pushed to the pool,
+ * the caller has to wait for it to finish.
+ */
+static uint kdtree_balance(
+    KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs, TaskPool *pool)
 {
   KDTreeNode *node;
   float co;
@@ -180,13 +204,52 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   node = &nodes[median];
   node->d = axis;
   axis = (axis + 1) % KD_DIMS;
-  node->left = kdtree_balance(nodes, median, axis, ofs);
-  node->right = kdtree_balance(
-      nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+  if (pool && nodes_len >= KD_BALANCE_TASK_NODES_MIN) {
+    /* Both halves are independent, balance them in parallel. */
+    node->left = kdtree_balance_root(median, ofs);
+    node->right = kdtree_balance_root(nodes_len - (median + 1), (median + 1) + ofs);
+    kdtree_balance_task_push(pool, nodes, median, axis, ofs);
+    kdtree_balance_task_push(
+        pool, nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+  }
+  else {
+    node->left = kdtree_balance(nodes, median, axis, ofs, pool);
+    node->right = kdtree_balance(
+        nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs, pool);
+  }
 
   return median + ofs;
 }
 
+typedef struct KDTreeBalanceTaskData {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+} KDTreeBalanceTaskData;
+
+static void kdtree_balance_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTaskData *data = taskdata;
+  const uint root = kdtree_balance(data->nodes, data->nodes_len, data->axis, data->ofs, pool);
+  BLI_assert(root == kdtree_balance_root(data->nodes_len, data->ofs));
+  UNUSED_VARS_NDEBUG(root);
+}
+
+static void kdtree_balance_task_push(
+    TaskPool *pool, KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+{
+  if (nodes_len == 0) {
+    return;
+  }
+  KDTreeBalanceTaskData *data = MEM_mallocN(sizeof(*data), __func__);
+  data->nodes = nodes;
+  data->nodes_len = nodes_len;
+  data->axis = axis;
+  data->ofs = ofs;
+  BLI_task_pool_push(pool, kdtree_balance_task_run, data, true, NULL);
+}
+
 void BLI_kdtree_nd_(balance)(KDTree *tree)
 {
   if (tree->root != KD_NODE_ROOT_IS_INIT) {
@@ -196,7 +259,15 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len >= KD_BALANCE_TASK_NODES_MIN) {
+    TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0, pool);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0, NULL);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -792,6 +863,210 @@ finally:
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Queries
+ *
+ * Run many queries in parallel. Queries are first ordered along a Z-order curve,
+ * so each thread handles queries that are close to each other and visit the same nodes.
+ * \{ */
+
+/** Bits per axis of the Z-order keys, using 48 bits in total. */
+#define KD_ZORDER_AXIS_BITS (48 / KD_DIMS)
+
+typedef struct KDTreeQueryOrder {
+  uint64_t key;
+  uint index;
+} KDTreeQueryOrder;
+
+static uint64_t kdtree_zorder_key(const float co[KD_DIMS],
+                                  const float min[KD_DIMS],
+                                  const float scale[KD_DIMS])
+{
+  uint64_t key = 0;
+  for (uint j = 0; j < KD_DIMS; j++) {
+    const uint64_t quantized = (uint64_t)((co[j] - min[j]) * scale[j]);
+    for (uint bit = 0; bit < KD_ZORDER_AXIS_BITS; bit++) {
+      key |= ((quantized >> bit) & 1) << (bit * KD_DIMS + j);
+    }
+  }
+  return key;
+}
+
+/**
+ * \return the query indices sorted along a Z-order curve through their bounds.
+ */
+static uint *kdtree_query_order(const float (*co)[KD_DIMS], const uint co_len)
+{
+  float min[KD_DIMS], max[KD_DIMS], scale[KD_DIMS];
+  for (uint j = 0; j < KD_DIMS; j++) {
+    min[j] = FLT_MAX;
+    max[j] = -FLT_MAX;
+  }
+  for (uint i = 0; i < co_len; i++) {
+    for (uint j = 0; j < KD_DIMS; j++) {
+      min[j] = min_ff(min[j], co[i][j]);
+      max[j] = max_ff(max[j], co[i][j]);
+    }
+  }
+  for (uint j = 0; j < KD_DIMS; j++) {
+    const float size = max[j] - min[j];
+    scale[j] = (size > 0.0f) ? (float)((1ull << KD_ZORDER_AXIS_BITS) - 1) / size : 0.0f;
+  }
+
+  KDTreeQueryOrder *order = MEM_malloc_arrayN(co_len, sizeof(*order), __func__);
+  KDTreeQueryOrder *order_tmp = MEM_malloc_arrayN(co_len, sizeof(*order_tmp), __func__);
+  uint *counts = MEM_malloc_arrayN(1 << 16, sizeof(*counts), __func__);
+  for (uint i = 0; i < co_len; i++) {
+    order[i].key = kdtree_zorder_key(co[i], min, scale);
+    order[i].index = i;
+  }
+
+  /* Radix sort, 16 bits at a time. */
+  for (uint shift = 0; shift < 48; shift += 16) {
+    memset(counts, 0, sizeof(*counts) << 16);
+    for (uint i = 0; i < co_len; i++) {
+      counts[(order[i].key >> shift) & 0xffff]++;
+    }
+    uint offset = 0;
+    for (uint i = 0; i < (1 << 16); i++) {
+      const uint count = counts[i];
+      counts[i] = offset;
+      offset += count;
+    }
+    for (uint i = 0; i < co_len; i++) {
+      order_tmp[counts[(order[i].key >> shift) & 0xffff]++] = order[i];
+    }
+    SWAP(KDTreeQueryOrder *, order, order_tmp);
+  }
+
+  uint *indices = MEM_malloc_arrayN(co_len, sizeof(*indices), __func__);
+  for (uint i = 0; i < co_len; i++) {
+    indices[i] = order[i].index;
+  }
+
+  MEM_freeN(order);
+  MEM_freeN(order_tmp);
+  MEM_freeN(counts);
+  return indices;
+}
+
+typedef struct KDTreeBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+  /** Order to run the queries in, may be null. */
+  const uint *order;
+
+  KDTreeNearest *r_nearest;
+
+  float range;
+  bool (*search_cb)(
+      void *user_data, int co_index, int index, const float co[KD_DIMS], float dist_sq);
+  void *user_data;
+} KDTreeBatchData;
+
+static void kdtree_batch_run(KDTreeBatchData *data,
+                             const uint co_len,
+                             TaskParallelRangeFunc func)
+{
+  const bool use_threading = co_len >= KD_BATCH_QUERIES_THREADED_MIN;
+  data->order = use_threading ? kdtree_query_order(data->co, co_len) : NULL;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = use_threading;
+  settings.min_iter_per_thread = KD_BATCH_QUERIES_THREADED_MIN;
+  BLI_task_parallel_range(0, (int)co_len, data, func, &settings);
+
+  if (data->order) {
+    MEM_freeN((void *)data->order);
+  }
+}
+
+static void kdtree_find_nearest_batch_cb(void *__restrict userdata,
+                                         const int iter,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeBatchData *data = userdata;
+  const uint i = data->order ? data->order[iter] : (uint)iter;
+  if (BLI_kdtree_nd_(find_nearest)(data->tree, data->co[i], &data->r_nearest[i]) == -1) {
+    data->r_nearest[i].index = -1;
+  }
+}
+
+/**
+ * Find the nearest point for every coordinate in \a co, a batched #BLI_kdtree_3d_find_nearest.
+ *
+ * \param r_nearest: An array of \a co_len results,
+ * the index is -1 for queries without a result (when the tree is empty).
+ */
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const uint co_len,
+                                        KDTreeNearest *r_nearest)
+{
+  KDTreeBatchData data = {
+      .tree = tree,
+      .co = co,
+      .r_nearest = r_nearest,
+  };
+  kdtree_batch_run(&data, co_len, kdtree_find_nearest_batch_cb);
+}
+
+typedef struct KDTreeBatchRangeSearchData {
+  const KDTreeBatchData *batch;
+  int co_index;
+} KDTreeBatchRangeSearchData;
+
+static bool kdtree_range_search_batch_search_cb(void *user_data,
+                                                const int index,
+                                                const float co[KD_DIMS],
+                                                const float dist_sq)
+{
+  const KDTreeBatchRangeSearchData *data = user_data;
+  return data->batch->search_cb(data->batch->user_data, data->co_index, index, co, dist_sq);
+}
+
+static void kdtree_range_search_batch_cb(void *__restrict userdata,
+                                         const int iter,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeBatchData *data = userdata;
+  const uint i = data->order ? data->order[iter] : (uint)iter;
+  KDTreeBatchRangeSearchData search_data = {data, (int)i};
+  BLI_kdtree_nd_(range_search_cb)(
+      data->tree, data->co[i], data->range, kdtree_range_search_batch_search_cb, &search_data);
+}
+
+/**
+ * A batched #BLI_kdtree_3d_range_search_cb, running \a search_cb for every node in \a range
+ * of each coordinate in \a co.
+ *
+ * \param search_cb: Called with the index of the query coordinate in \a co and the found node,
+ * from multiple threads at once. A false return value stops the search for that coordinate.
+ */
+void BLI_kdtree_nd_(range_search_batch_cb)(
+    const KDTree *tree,
+    const float (*co)[KD_DIMS],
+    const uint co_len,
+    float range,
+    bool (*search_cb)(
+        void *user_data, int co_index, int index, const float co[KD_DIMS], float dist_sq),
+    void *user_data)
+{
+  KDTreeBatchData data = {
+      .tree = tree,
+      .co = co,
+      .range = range,
+      .search_cb = search_cb,
+      .user_data = user_data,
+  };
+  kdtree_batch_run(&data, co_len, kdtree_range_search_batch_cb);
+}
+
+#undef KD_ZORDER_AXIS_BITS
+
+/** \} */
+
 /**
  * Use when we want to loop over nodes ordered by index.
  * Requires indices to be aligned with nodes.
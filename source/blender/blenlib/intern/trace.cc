@@ -0,0 +1,217 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_trace.h"
+#include "BLI_vector.hh"
+
+namespace blender::trace {
+
+using Clock = std::chrono::steady_clock;
+
+/* Number of finished events kept per thread, older events are overwritten by newer ones. */
+static constexpr int64_t EVENTS_PER_THREAD = 1 << 16;
+/* Events which are nested deeper are not recorded. */
+static constexpr int MAX_EVENT_DEPTH = 32;
+static constexpr int MAX_EVENT_NAME = 64;
+
+struct Event {
+  char name[MAX_EVENT_NAME];
+  const char *category;
+  int64_t start_ns;
+  int64_t duration_ns;
+};
+
+struct ThreadEvents {
+  int thread_id;
+  bool is_main_thread;
+  /* Ring buffer of finished events, #events_num is the number of events recorded in total. */
+  Array<Event> events{EVENTS_PER_THREAD, NoInitialization()};
+  int64_t events_num = 0;
+  /* Events which began but did not end yet. */
+  Event open_events[MAX_EVENT_DEPTH];
+  int depth = 0;
+};
+
+struct Session {
+  std::string filepath;
+  Clock::time_point start_time;
+  std::mutex mutex;
+  Vector<std::unique_ptr<ThreadEvents>> threads;
+};
+
+static std::atomic<bool> is_enabled = false;
+static Session *session = nullptr;
+/* Is incremented for every session, so threads don't use buffers of a previous session. */
+static std::atomic<int> session_counter = 0;
+
+static thread_local ThreadEvents *thread_events = nullptr;
+static thread_local int thread_events_session = -1;
+
+static ThreadEvents &thread_events_ensure()
+{
+  const int current_session = session_counter.load(std::memory_order_relaxed);
+  if (thread_events == nullptr || thread_events_session != current_session) {
+    std::lock_guard lock{session->mutex};
+    std::unique_ptr<ThreadEvents> events = std::make_unique<ThreadEvents>();
+    events->thread_id = int(session->threads.size()) + 1;
+    events->is_main_thread = BLI_thread_is_main();
+    thread_events = events.get();
+    thread_events_session = current_session;
+    session->threads.append(std::move(events));
+  }
+  return *thread_events;
+}
+
+static int64_t session_time_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                              session->start_time)
+      .count();
+}
+
+static void write_json_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (const char *c = str; *c; c++) {
+    if (ELEM(*c, '"', '\\')) {
+      fputc('\\', file);
+      fputc(*c, file);
+    }
+    else if (uchar(*c) < 0x20) {
+      fprintf(file, "\\u%04x", uint(*c));
+    }
+    else {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+static bool write_trace_file(const Session &session)
+{
+  FILE *file = BLI_fopen(session.filepath.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+
+  fputs("{\"traceEvents\":[\n", file);
+  bool is_first = true;
+  for (const std::unique_ptr<ThreadEvents> &thread : session.threads) {
+    fprintf(file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+            "\"args\":{\"name\":\"%s %d\"}}",
+            is_first ? "" : ",\n",
+            thread->thread_id,
+            thread->is_main_thread ? "Main" : "Worker",
+            thread->thread_id);
+    is_first = false;
+
+    const int64_t first_event = std::max<int64_t>(0, thread->events_num - EVENTS_PER_THREAD);
+    for (int64_t i = first_event; i < thread->events_num; i++) {
+      const Event &event = thread->events[i % EVENTS_PER_THREAD];
+      fputs(",\n{\"name\":", file);
+      write_json_string(file, event.name);
+      fputs(",\"cat\":", file);
+      write_json_string(file, event.category);
+      /* Time stamps are in microseconds. */
+      fprintf(file,
+              ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+              thread->thread_id,
+              double(event.start_ns) / 1000.0,
+              double(event.duration_ns) / 1000.0);
+    }
+  }
+  fputs("\n]}\n", file);
+
+  return fclose(file) == 0;
+}
+
+}  // namespace blender::trace
+
+using namespace blender::trace;
+
+void BLI_trace_session_begin(const char *filepath)
+{
+  BLI_assert(session == nullptr);
+  if (session != nullptr) {
+    BLI_trace_session_end();
+  }
+  session = new Session();
+  session->filepath = filepath;
+  session->start_time = Clock::now();
+  session_counter.fetch_add(1);
+  is_enabled.store(true);
+}
+
+void BLI_trace_session_end(void)
+{
+  if (session == nullptr) {
+    return;
+  }
+  is_enabled.store(false);
+
+  if (write_trace_file(*session)) {
+    printf("Saved trace to '%s'\n", session->filepath.c_str());
+  }
+  else {
+    fprintf(stderr, "Error: could not write trace to '%s'\n", session->filepath.c_str());
+  }
+
+  delete session;
+  session = nullptr;
+}
+
+bool BLI_trace_is_enabled(void)
+{
+  return is_enabled.load(std::memory_order_relaxed);
+}
+
+void BLI_trace_event_begin(const char *category, const char *name)
+{
+  if (!BLI_trace_is_enabled()) {
+    return;
+  }
+  ThreadEvents &events = thread_events_ensure();
+  if (events.depth < MAX_EVENT_DEPTH) {
+    Event &event = events.open_events[events.depth];
+    BLI_strncpy(event.name, name, sizeof(event.name));
+    event.category = category;
+    event.start_ns = session_time_ns();
+  }
+  events.depth++;
+}
+
+void BLI_trace_event_end(void)
+{
+  if (!BLI_trace_is_enabled()) {
+    return;
+  }
+  ThreadEvents &events = thread_events_ensure();
+  if (events.depth == 0) {
+    /* The session started after the event began. */
+    return;
+  }
+  events.depth--;
+  if (events.depth >= MAX_EVENT_DEPTH) {
+    return;
+  }
+  Event &event = events.events[events.events_num % EVENTS_PER_THREAD];
+  event = events.open_events[events.depth];
+  event.duration_ns = session_time_ns() - event.start_ns;
+  events.events_num++;
+}
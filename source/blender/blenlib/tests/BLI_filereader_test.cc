@@ -0,0 +1,142 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "BLI_filereader.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include "BLI_filereader_test_utils.hh"
+
+namespace blender::tests {
+
+/* Compressible but not trivial data. */
+static Vector<char> make_test_data(const int64_t size)
+{
+  RandomNumberGenerator rng(42);
+  Vector<char> data(size);
+  for (const int64_t i : data.index_range()) {
+    data[i] = char((i / 64) % 7 + rng.get_int32(4));
+  }
+  return data;
+}
+
+static void test_read_sequential(const bool use_readahead)
+{
+  const Vector<char> data = make_test_data(5 * 1024 * 1024 + 123);
+  const Vector<char> compressed = zstd_compress_seekable(data, 256 * 1024);
+
+  FileReader *mem = BLI_filereader_new_memory(compressed.data(), compressed.size());
+  FileReader *file = use_readahead ? BLI_filereader_new_zstd_readahead(mem) :
+                                     BLI_filereader_new_zstd(mem);
+  ASSERT_NE(file, nullptr);
+  EXPECT_NE(file->seek, nullptr);
+
+  /* Read in odd sized pieces so reads cross frame boundaries. */
+  Vector<char> result(data.size());
+  int64_t offset = 0;
+  while (offset < result.size()) {
+    const int64_t size = std::min<int64_t>(100003, result.size() - offset);
+    ASSERT_EQ(file->read(file, result.data() + offset, size), size);
+    offset += size;
+  }
+  char extra;
+  EXPECT_EQ(file->read(file, &extra, 1), 0);
+  EXPECT_EQ(memcmp(result.data(), data.data(), data.size()), 0);
+
+  file->close(file);
+}
+
+TEST(filereader, zstd_read_sequential)
+{
+  test_read_sequential(false);
+}
+
+TEST(filereader, zstd_readahead_read_sequential)
+{
+  test_read_sequential(true);
+}
+
+TEST(filereader, zstd_readahead_seek)
+{
+  const Vector<char> data = make_test_data(3 * 1024 * 1024);
+  const Vector<char> compressed = zstd_compress_seekable(data, 64 * 1024);
+
+  FileReader *mem = BLI_filereader_new_memory(compressed.data(), compressed.size());
+  FileReader *file = BLI_filereader_new_zstd_readahead(mem);
+  ASSERT_NE(file, nullptr);
+
+  /* Jump back and forth, random access only decompresses the frames that are read. */
+  const int64_t offsets[] = {2 * 1024 * 1024, 1000, 1024 * 1024 - 10, 3 * 1024 * 1024 - 500, 0};
+  char buffer[4096];
+  for (const int64_t offset : offsets) {
+    const int64_t size = std::min<int64_t>(sizeof(buffer), data.size() - offset);
+    ASSERT_EQ(file->seek(file, offset, SEEK_SET), offset);
+    ASSERT_EQ(file->read(file, buffer, size), size);
+    EXPECT_EQ(memcmp(buffer, data.data() + offset, size), 0);
+  }
+
+  file->close(file);
+}
+
+TEST(filereader, zstd_readahead_seek_back_and_resume)
+{
+  const Vector<char> data = make_test_data(4 * 1024 * 1024);
+  const Vector<char> compressed = zstd_compress_seekable(data, 32 * 1024);
+
+  FileReader *mem = BLI_filereader_new_memory(compressed.data(), compressed.size());
+  FileReader *file = BLI_filereader_new_zstd_readahead(mem);
+  ASSERT_NE(file, nullptr);
+
+  /* Read sequentially, seek back a little (into already decompressed frames), then continue
+   * reading in order from somewhere else. */
+  const std::pair<int64_t, int64_t> reads[] = {{0, 1024 * 1024},
+                                               {1024 * 1024 - 100000, 300000},
+                                               {1200000, 1000},
+                                               {3 * 1024 * 1024 + 7, 1024 * 1024 - 7},
+                                               {64 * 1024, 512 * 1024}};
+  Vector<char> buffer(1024 * 1024);
+  for (const std::pair<int64_t, int64_t> &read : reads) {
+    ASSERT_EQ(file->seek(file, read.first, SEEK_SET), read.first);
+    /* Read in pieces smaller than a frame, like reading block headers. */
+    int64_t offset = 0;
+    while (offset < read.second) {
+      const int64_t size = std::min<int64_t>(10007, read.second - offset);
+      ASSERT_EQ(file->read(file, buffer.data() + offset, size), size);
+      offset += size;
+    }
+    EXPECT_EQ(memcmp(buffer.data(), data.data() + read.first, read.second), 0);
+  }
+
+  file->close(file);
+}
+
+TEST(filereader, zstd_readahead_stop)
+{
+  const Vector<char> data = make_test_data(2 * 1024 * 1024);
+  const Vector<char> compressed = zstd_compress_seekable(data, 64 * 1024);
+
+  FileReader *mem = BLI_filereader_new_memory(compressed.data(), compressed.size());
+  FileReader *file = BLI_filereader_new_zstd_readahead(mem);
+  ASSERT_NE(file, nullptr);
+
+  /* Reading continues without read-ahead once it's stopped in the middle of a sequential read. */
+  Vector<char> result(data.size());
+  const int64_t half = data.size() / 2;
+  ASSERT_EQ(file->read(file, result.data(), half), half);
+  BLI_filereader_zstd_readahead_stop(file);
+  ASSERT_EQ(file->read(file, result.data() + half, data.size() - half), data.size() - half);
+  EXPECT_EQ(memcmp(result.data(), data.data(), data.size()), 0);
+
+  /* Stopping again or stopping other readers does nothing. */
+  BLI_filereader_zstd_readahead_stop(file);
+  file->close(file);
+
+  FileReader *other = BLI_filereader_new_memory(data.data(), data.size());
+  BLI_filereader_zstd_readahead_stop(other);
+  other->close(other);
+}
+
+}  // namespace blender::tests
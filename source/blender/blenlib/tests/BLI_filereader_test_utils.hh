@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#pragma once
+
+#include <algorithm>
+#include <zstd.h>
+
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+inline void zstd_append_u32_le(Vector<char> &buffer, const uint32_t value)
+{
+  for (int i = 0; i < 4; i++) {
+    buffer.append(char((value >> (i * 8)) & 0xFF));
+  }
+}
+
+/**
+ * Compress `data` into independent frames of `frame_size` bytes followed by a seek table,
+ * matching the layout written by `writefile.cc`.
+ */
+inline Vector<char> zstd_compress_seekable(const Span<char> data, const int64_t frame_size)
+{
+  Vector<char> result;
+  Vector<std::pair<uint32_t, uint32_t>> frames;
+  Vector<char> compressed(ZSTD_compressBound(size_t(frame_size)));
+  for (int64_t start = 0; start < data.size(); start += frame_size) {
+    const Span<char> chunk = data.slice(start, std::min(frame_size, data.size() - start));
+    const size_t compressed_size = ZSTD_compress(
+        compressed.data(), compressed.size(), chunk.data(), chunk.size(), 3);
+    result.extend(compressed.as_span().take_front(compressed_size));
+    frames.append({uint32_t(compressed_size), uint32_t(chunk.size())});
+  }
+
+  zstd_append_u32_le(result, 0x184D2A5E);
+  zstd_append_u32_le(result, uint32_t(frames.size() * 8 + 9));
+  for (const std::pair<uint32_t, uint32_t> &frame : frames) {
+    zstd_append_u32_le(result, frame.first);
+    zstd_append_u32_le(result, frame.second);
+  }
+  zstd_append_u32_le(result, uint32_t(frames.size()));
+  result.append(0);
+  zstd_append_u32_le(result, 0x8F92EAB1);
+  return result;
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_implicit_sharing.hh"
+#include "BLI_user_counter.hh"
+
+namespace blender::tests {
+
+class ImplicitlySharedData {
+ public:
+  int *data = nullptr;
+  const ImplicitSharingInfo *sharing_info = nullptr;
+
+  ImplicitlySharedData(const int value)
+  {
+    data = static_cast<int *>(MEM_mallocN(sizeof(int), __func__));
+    *data = value;
+    sharing_info = implicit_sharing::info_for_mem_free(data);
+  }
+
+  ImplicitlySharedData(const ImplicitlySharedData &other)
+      : data(other.data), sharing_info(other.sharing_info)
+  {
+    sharing_info->user_add();
+  }
+
+  ~ImplicitlySharedData()
+  {
+    sharing_info->user_remove();
+  }
+
+  int *data_for_write()
+  {
+    if (sharing_info->is_mutable()) {
+      return data;
+    }
+    int *new_data = static_cast<int *>(MEM_dupallocN(data));
+    sharing_info->user_remove();
+    data = new_data;
+    sharing_info = implicit_sharing::info_for_mem_free(data);
+    return data;
+  }
+};
+
+TEST(implicit_sharing, CopyOnWrite)
+{
+  ImplicitlySharedData a(5);
+  EXPECT_TRUE(a.sharing_info->is_mutable());
+
+  ImplicitlySharedData b = a;
+  EXPECT_EQ(a.data, b.data);
+  EXPECT_TRUE(a.sharing_info->is_shared());
+  EXPECT_FALSE(b.sharing_info->is_mutable());
+
+  *b.data_for_write() = 10;
+  EXPECT_NE(a.data, b.data);
+  EXPECT_EQ(*a.data, 5);
+  EXPECT_EQ(*b.data, 10);
+  EXPECT_TRUE(a.sharing_info->is_mutable());
+  EXPECT_TRUE(b.sharing_info->is_mutable());
+
+  /* Writing to data with a single user doesn't copy it. */
+  const int *a_data = a.data;
+  *a.data_for_write() = 6;
+  EXPECT_EQ(a.data, a_data);
+}
+
+TEST(implicit_sharing, FreeLastUser)
+{
+  ImplicitlySharedData a(1);
+  {
+    ImplicitlySharedData b = a;
+    ImplicitlySharedData c = b;
+    EXPECT_TRUE(a.sharing_info->is_shared());
+  }
+  /* The data stays valid as long as there is a user. */
+  EXPECT_TRUE(a.sharing_info->is_mutable());
+  EXPECT_EQ(*a.data, 1);
+}
+
+TEST(implicit_sharing, UserCounter)
+{
+  int *data = static_cast<int *>(MEM_mallocN(sizeof(int), __func__));
+  UserCounter<const ImplicitSharingInfo> a{implicit_sharing::info_for_mem_free(data)};
+  {
+    UserCounter<const ImplicitSharingInfo> b = a;
+    EXPECT_TRUE(a->is_shared());
+  }
+  EXPECT_TRUE(a->is_mutable());
+}
+
+}  // namespace blender::tests
@@ -132,3 +132,235 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/* -------------------------------------------------------------------- */
+/* Wide Tree Tests */
+
+static void box_corners(const float center[3], const float size, float r_corners[8][3])
+{
+  for (int i = 0; i < 8; i++) {
+    r_corners[i][0] = center[0] + ((i & 1) ? size : -size);
+    r_corners[i][1] = center[1] + ((i & 2) ? size : -size);
+    r_corners[i][2] = center[2] + ((i & 4) ? size : -size);
+  }
+}
+
+static void boxes_tree_insert(BVHTree *tree, const float (*centers)[3], int boxes_len, float offset)
+{
+  for (int i = 0; i < boxes_len; i++) {
+    float center[3], corners[8][3];
+    copy_v3_v3(center, centers[i]);
+    add_v3_fl(center, offset);
+    box_corners(center, 0.01f + (i % 7) * 0.005f, corners);
+    BLI_bvhtree_insert(tree, i, corners[0], 8);
+  }
+}
+
+static void boxes_tree_update(BVHTree *tree, const float (*centers)[3], int boxes_len, float offset)
+{
+  for (int i = 0; i < boxes_len; i++) {
+    float center[3], corners[8][3];
+    copy_v3_v3(center, centers[i]);
+    add_v3_fl(center, offset);
+    box_corners(center, 0.01f + (i % 7) * 0.005f, corners);
+    BLI_bvhtree_update_node(tree, i, corners[0], nullptr, 8);
+  }
+  BLI_bvhtree_update_tree(tree);
+}
+
+/**
+ * Compare queries on a tree using wide nodes with the same queries on a tree that doesn't.
+ * Without callbacks the result is the distance to the nearest leaf bounds, which has to match.
+ */
+static void wide_tree_compare(BVHTree *tree, BVHTree *tree_ref, struct RNG *rng, int queries_len)
+{
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  BVHTreeNearest *nearests = (BVHTreeNearest *)MEM_mallocN(sizeof(BVHTreeNearest) * queries_len,
+                                                           __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(BVHTreeRayHit) * queries_len,
+                                                     __func__);
+
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3_round(co[i], 3, rng, 1000, 1.5f);
+    BLI_rng_get_float_unit_v3(rng, dir[i]);
+  }
+
+  for (int i = 0; i < queries_len; i++) {
+    BVHTreeNearest nearest, nearest_ref;
+    nearest.index = nearest_ref.index = -1;
+    nearest.dist_sq = nearest_ref.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, co[i], &nearest, nullptr, nullptr);
+    BLI_bvhtree_find_nearest(tree_ref, co[i], &nearest_ref, nullptr, nullptr);
+    EXPECT_NE(nearest.index, -1);
+    EXPECT_FLOAT_EQ(nearest.dist_sq, nearest_ref.dist_sq);
+
+    BVHTreeRayHit hit, hit_ref;
+    hit.index = hit_ref.index = -1;
+    hit.dist = hit_ref.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, co[i], dir[i], 0.0f, &hit, nullptr, nullptr);
+    BLI_bvhtree_ray_cast(tree_ref, co[i], dir[i], 0.0f, &hit_ref, nullptr, nullptr);
+    EXPECT_EQ(hit.index == -1, hit_ref.index == -1);
+    EXPECT_FLOAT_EQ(hit.dist, hit_ref.dist);
+
+    nearests[i] = nearest;
+    nearests[i].index = -1;
+    nearests[i].dist_sq = FLT_MAX;
+    hits[i] = hit;
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  /* Batched queries give the same results. */
+  BLI_bvhtree_find_nearest_batch(tree, co, queries_len, nearests, nullptr, nullptr, 0);
+  BLI_bvhtree_ray_cast_batch(
+      tree, co, dir, queries_len, 0.0f, hits, nullptr, nullptr, BVH_RAYCAST_DEFAULT);
+  for (int i = 0; i < queries_len; i++) {
+    BVHTreeNearest nearest;
+    nearest.index = -1;
+    nearest.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, co[i], &nearest, nullptr, nullptr);
+    EXPECT_EQ(nearests[i].index, nearest.index);
+    EXPECT_EQ(nearests[i].dist_sq, nearest.dist_sq);
+
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, co[i], dir[i], 0.0f, &hit, nullptr, nullptr);
+    EXPECT_EQ(hits[i].index, hit.index);
+    EXPECT_EQ(hits[i].dist, hit.dist);
+  }
+
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(nearests);
+  MEM_freeN(hits);
+}
+
+static void wide_tree_test(int boxes_len, char tree_type, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*centers)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * boxes_len, __func__);
+  for (int i = 0; i < boxes_len; i++) {
+    rng_v3_round(centers[i], 3, rng, 1000, 1.0f);
+  }
+
+  /* Only AABB trees with 2 or 4 children per node support wide nodes. */
+  BVHTree *tree = BLI_bvhtree_new(boxes_len, 0.0f, tree_type, 6);
+  BVHTree *tree_ref = BLI_bvhtree_new(boxes_len, 0.0f, 8, 6);
+  boxes_tree_insert(tree, centers, boxes_len, 0.0f);
+  boxes_tree_insert(tree_ref, centers, boxes_len, 0.0f);
+  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance(tree_ref);
+  BLI_bvhtree_wide_nodes_ensure(tree);
+
+  wide_tree_compare(tree, tree_ref, rng, 1000);
+
+  /* Refitting the tree updates the wide nodes too. */
+  boxes_tree_update(tree, centers, boxes_len, 0.25f);
+  boxes_tree_update(tree_ref, centers, boxes_len, 0.25f);
+  wide_tree_compare(tree, tree_ref, rng, 1000);
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_ref);
+  MEM_freeN(centers);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, WideTree2_1)
+{
+  wide_tree_test(1, 2, 1234);
+}
+TEST(kdopbvh, WideTree2_5)
+{
+  wide_tree_test(5, 2, 123);
+}
+TEST(kdopbvh, WideTree2_10000)
+{
+  wide_tree_test(10000, 2, 12);
+}
+TEST(kdopbvh, WideTree4_1)
+{
+  wide_tree_test(1, 4, 1234);
+}
+TEST(kdopbvh, WideTree4_7)
+{
+  wide_tree_test(7, 4, 123);
+}
+TEST(kdopbvh, WideTree4_10000)
+{
+  wide_tree_test(10000, 4, 12);
+}
+
+/* -------------------------------------------------------------------- */
+/* Refit Tests */
+
+struct RefitBoxesData {
+  const float (*centers)[3];
+  float offset;
+};
+
+static int refit_boxes_leaf_cb(void *userdata, int index, float r_co[BVH_REFIT_POINTS_MAX][3])
+{
+  const RefitBoxesData *data = static_cast<const RefitBoxesData *>(userdata);
+  float center[3], corners[8][3];
+  copy_v3_v3(center, data->centers[index]);
+  add_v3_fl(center, data->offset);
+  box_corners(center, 0.01f + (index % 7) * 0.005f, corners);
+  /* Opposite corners are enough to define the box. */
+  copy_v3_v3(r_co[0], corners[0]);
+  copy_v3_v3(r_co[1], corners[7]);
+  return 2;
+}
+
+/**
+ * A refit tree should give the same results as a tree that was built with the new coordinates.
+ */
+static void refit_tree_test(int boxes_len, char tree_type, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*centers)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * boxes_len, __func__);
+  for (int i = 0; i < boxes_len; i++) {
+    rng_v3_round(centers[i], 3, rng, 1000, 1.0f);
+  }
+
+  BVHTree *tree = BLI_bvhtree_new(boxes_len, 0.0f, tree_type, 6);
+  boxes_tree_insert(tree, centers, boxes_len, 0.0f);
+  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_wide_nodes_ensure(tree);
+
+  /* Move the boxes differently, so that the tree isn't just translated. */
+  for (int i = 0; i < boxes_len; i++) {
+    mul_v3_fl(centers[i], 0.5f + (i % 3) * 0.25f);
+  }
+  RefitBoxesData data = {centers, 0.1f};
+  BLI_bvhtree_refit(tree, refit_boxes_leaf_cb, &data);
+
+  BVHTree *tree_ref = BLI_bvhtree_new(boxes_len, 0.0f, tree_type, 6);
+  boxes_tree_insert(tree_ref, centers, boxes_len, 0.1f);
+  BLI_bvhtree_balance(tree_ref);
+
+  wide_tree_compare(tree, tree_ref, rng, 1000);
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_ref);
+  MEM_freeN(centers);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, Refit2_1)
+{
+  refit_tree_test(1, 2, 1234);
+}
+TEST(kdopbvh, Refit2_10000)
+{
+  refit_tree_test(10000, 2, 12);
+}
+TEST(kdopbvh, Refit4_10000)
+{
+  refit_tree_test(10000, 4, 12);
+}
+TEST(kdopbvh, Refit8_10000)
+{
+  refit_tree_test(10000, 8, 12);
+}
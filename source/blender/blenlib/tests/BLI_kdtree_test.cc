@@ -2,13 +2,86 @@
 
 #include "testing/testing.h"
 
+#include "BLI_array.hh"
 #include "BLI_kdtree.h"
+#include "BLI_math_vector.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_rand.h"
 
 #include <cmath>
 
 /* -------------------------------------------------------------------- */
 /* Tests */
 
+static float find_nearest_dist_brute_force(const float (*points)[3],
+                                           const int points_len,
+                                           const float co[3])
+{
+  float nearest_dist_sq = FLT_MAX;
+  for (int i = 0; i < points_len; i++) {
+    nearest_dist_sq = min_ff(nearest_dist_sq, len_squared_v3v3(points[i], co));
+  }
+  return sqrtf(nearest_dist_sq);
+}
+
+static void random_points(float (*points)[3], const int points_len, RNG *rng)
+{
+  for (int i = 0; i < points_len; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i]);
+    mul_v3_fl(points[i], BLI_rng_get_float(rng));
+  }
+}
+
+/** Build a tree large enough to be balanced in parallel and compare queries to brute force. */
+static void batch_test(const int points_len, const int queries_len)
+{
+  RNG *rng = BLI_rng_new(points_len);
+  blender::Array<blender::float3> points(points_len);
+  blender::Array<blender::float3> queries(queries_len);
+  const float(*points_co)[3] = reinterpret_cast<const float(*)[3]>(points.data());
+  const float(*queries_co)[3] = reinterpret_cast<const float(*)[3]>(queries.data());
+  random_points(reinterpret_cast<float(*)[3]>(points.data()), points_len, rng);
+  random_points(reinterpret_cast<float(*)[3]>(queries.data()), queries_len, rng);
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(points_len);
+  for (int i = 0; i < points_len; i++) {
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+
+  blender::Array<KDTreeNearest_3d> nearests(queries_len);
+  BLI_kdtree_3d_find_nearest_batch(tree, queries_co, queries_len, nearests.data());
+  for (int i = 0; i < queries_len; i++) {
+    EXPECT_FLOAT_EQ(nearests[i].dist,
+                    find_nearest_dist_brute_force(points_co, points_len, queries[i]));
+    EXPECT_EQ(blender::float3(nearests[i].co), points[nearests[i].index]);
+  }
+
+  /* Every query is only handled by one thread, so counting per query doesn't need atomics. */
+  const float range = 0.1f;
+  blender::Array<int> found_num(queries_len, 0);
+  BLI_kdtree_3d_range_search_batch_cb_cpp(
+      tree,
+      queries_co,
+      queries_len,
+      range,
+      [&](const int co_index, const int index, const float * /*co*/, const float dist_sq) {
+        EXPECT_LE(dist_sq, range * range);
+        EXPECT_FLOAT_EQ(dist_sq, len_squared_v3v3(queries[co_index], points[index]));
+        found_num[co_index]++;
+        return true;
+      });
+  for (int i = 0; i < queries_len; i++) {
+    KDTreeNearest_3d *found = nullptr;
+    const int found_num_expected = BLI_kdtree_3d_range_search(tree, queries[i], &found, range);
+    EXPECT_EQ(found_num[i], found_num_expected);
+    MEM_SAFE_FREE(found);
+  }
+
+  BLI_kdtree_3d_free(tree);
+  BLI_rng_free(rng);
+}
+
 static void standard_test()
 {
   for (int tree_size = 30; tree_size < 500; tree_size++) {
@@ -61,3 +134,24 @@ TEST(kdtree, Deduplicate)
 {
   deduplicate_test();
 }
+
+TEST(kdtree, Batch)
+{
+  batch_test(100, 10);
+}
+
+TEST(kdtree, BatchThreaded)
+{
+  batch_test(50000, 2000);
+}
+
+TEST(kdtree, BatchEmpty)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(0);
+  BLI_kdtree_3d_balance(tree);
+  const float co[1][3] = {{0.0f, 0.0f, 0.0f}};
+  KDTreeNearest_3d nearest;
+  BLI_kdtree_3d_find_nearest_batch(tree, co, 1, &nearest);
+  EXPECT_EQ(nearest.index, -1);
+  BLI_kdtree_3d_free(tree);
+}
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <limits>
+
+#include "BLI_math_quantize.hh"
+#include "BLI_math_vector.hh"
+
+namespace blender::tests {
+
+TEST(math_quantize, HalfExactValues)
+{
+  EXPECT_EQ(math::float_to_half(0.0f), 0x0000);
+  EXPECT_EQ(math::float_to_half(-0.0f), 0x8000);
+  EXPECT_EQ(math::float_to_half(1.0f), 0x3c00);
+  EXPECT_EQ(math::float_to_half(-2.0f), 0xc000);
+  EXPECT_EQ(math::float_to_half(65504.0f), 0x7bff);
+  /* Smallest denormal. */
+  EXPECT_EQ(math::float_to_half(5.9604645e-8f), 0x0001);
+
+  EXPECT_EQ(math::half_to_float(0x3c00), 1.0f);
+  EXPECT_EQ(math::half_to_float(0xc000), -2.0f);
+  EXPECT_EQ(math::half_to_float(0x7bff), 65504.0f);
+  EXPECT_EQ(math::half_to_float(0x0001), 5.9604645e-8f);
+}
+
+TEST(math_quantize, HalfSpecialValues)
+{
+  EXPECT_EQ(math::float_to_half(1e6f), 0x7c00);
+  EXPECT_EQ(math::float_to_half(-1e6f), 0xfc00);
+  EXPECT_EQ(math::float_to_half(std::numeric_limits<float>::infinity()), 0x7c00);
+  EXPECT_TRUE(std::isnan(math::half_to_float(
+      math::float_to_half(std::numeric_limits<float>::quiet_NaN()))));
+  EXPECT_TRUE(std::isinf(math::half_to_float(0x7c00)));
+}
+
+TEST(math_quantize, HalfRoundTrip)
+{
+  /* Every finite half value converts back to itself. */
+  for (uint32_t i = 0; i < 0x10000; i++) {
+    const uint16_t half = uint16_t(i);
+    if ((half & 0x7c00) == 0x7c00) {
+      continue;
+    }
+    EXPECT_EQ(math::float_to_half(math::half_to_float(half)), half);
+  }
+  /* Round to nearest even: 1 + 2^-11 is exactly between two half values. */
+  EXPECT_EQ(math::float_to_half(1.0f + 1.0f / 2048.0f), 0x3c00);
+  EXPECT_EQ(math::float_to_half(1.0f + 3.0f / 2048.0f), 0x3c02);
+
+  const float3 value(0.1f, -12.345f, 1000.0f);
+  const float3 result = math::half_to_float(math::float_to_half(value));
+  EXPECT_V3_NEAR(result, value, 0.5f);
+  EXPECT_NEAR(result.x, value.x, 1e-4f);
+}
+
+TEST(math_quantize, Unorm16)
+{
+  EXPECT_EQ(math::float_to_unorm16(0.0f), 0);
+  EXPECT_EQ(math::float_to_unorm16(1.0f), 65535);
+  EXPECT_EQ(math::float_to_unorm16(-0.5f), 0);
+  EXPECT_EQ(math::float_to_unorm16(2.0f), 65535);
+  EXPECT_EQ(math::unorm16_to_float(0), 0.0f);
+  EXPECT_EQ(math::unorm16_to_float(65535), 1.0f);
+
+  const float2 uv(0.25f, 0.7f);
+  EXPECT_V2_NEAR(math::unorm16_to_float(math::float_to_unorm16(uv)), uv, 1.0f / 65535.0f);
+}
+
+TEST(math_quantize, OctahedralNormal)
+{
+  const float3 axes[] = {
+      {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+  for (const float3 &axis : axes) {
+    EXPECT_V3_NEAR(math::octahedral_to_normal(math::normal_to_octahedral(axis)), axis, 1e-6f);
+  }
+
+  for (int i = 0; i < 1000; i++) {
+    const float3 normal = math::normalize(
+        float3(std::sin(i * 0.1f), std::cos(i * 0.37f), std::sin(i * 0.73f + 1.0f)));
+    const float3 result = math::octahedral_to_normal(math::normal_to_octahedral(normal));
+    EXPECT_NEAR(math::length(result), 1.0f, 1e-6f);
+    /* Distance between unit vectors is about the angle in radians. */
+    EXPECT_LT(math::distance(result, normal), 8.7e-5f);
+  }
+
+  EXPECT_V3_NEAR(math::octahedral_to_normal(math::normal_to_octahedral(float3(0.0f))),
+                 float3(0.0f, 0.0f, 1.0f),
+                 0.0f);
+}
+
+}  // namespace blender::tests
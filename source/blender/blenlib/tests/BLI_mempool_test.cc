@@ -0,0 +1,154 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_mempool.h"
+#include "BLI_set.hh"
+#include "BLI_task.hh"
+
+namespace blender::tests {
+
+using ThreadCaches = threading::EnumerableThreadSpecific<BLI_mempool_thread_cache *>;
+
+static void thread_caches_destroy(ThreadCaches &caches)
+{
+  for (BLI_mempool_thread_cache *cache : caches) {
+    BLI_mempool_thread_cache_destroy(cache);
+  }
+}
+
+TEST(mempool, ThreadCacheAllocFree)
+{
+  BLI_mempool *pool = BLI_mempool_create(sizeof(int), 0, 64, BLI_MEMPOOL_ALLOW_ITER);
+  BLI_mempool_thread_cache *cache = BLI_mempool_thread_cache_create(pool);
+
+  Array<int *> elems(1000);
+  for (const int i : elems.index_range()) {
+    elems[i] = static_cast<int *>(BLI_mempool_thread_cache_alloc(cache));
+    *elems[i] = i;
+  }
+  BLI_mempool_thread_cache_flush(cache);
+  EXPECT_EQ(BLI_mempool_len(pool), 1000);
+
+  /* Free every other element, the rest must still be found when iterating. */
+  for (const int i : elems.index_range()) {
+    if (i % 2) {
+      BLI_mempool_thread_cache_free(cache, elems[i]);
+    }
+  }
+  BLI_mempool_thread_cache_destroy(cache);
+  EXPECT_EQ(BLI_mempool_len(pool), 500);
+
+  BLI_mempool_iter iter;
+  BLI_mempool_iternew(pool, &iter);
+  int count = 0;
+  while (int *elem = static_cast<int *>(BLI_mempool_iterstep(&iter))) {
+    EXPECT_EQ(*elem % 2, 0);
+    count++;
+  }
+  EXPECT_EQ(count, 500);
+
+  /* Elements returned by the cache are reused by the pool itself. */
+  Set<int *> freed_elems;
+  for (const int i : elems.index_range()) {
+    if (i % 2) {
+      freed_elems.add(elems[i]);
+    }
+  }
+  for (int i = 0; i < 500; i++) {
+    int *elem = static_cast<int *>(BLI_mempool_alloc(pool));
+    EXPECT_TRUE(freed_elems.remove(elem));
+    *elem = 0;
+  }
+  EXPECT_EQ(BLI_mempool_len(pool), 1000);
+
+  BLI_mempool_destroy(pool);
+}
+
+TEST(mempool, ThreadCacheFreeFromOtherCache)
+{
+  BLI_mempool *pool = BLI_mempool_create(sizeof(int), 0, 32, BLI_MEMPOOL_NOP);
+  BLI_mempool_thread_cache *cache_a = BLI_mempool_thread_cache_create(pool);
+  BLI_mempool_thread_cache *cache_b = BLI_mempool_thread_cache_create(pool);
+
+  Array<void *> elems(10000);
+  for (void *&elem : elems) {
+    elem = BLI_mempool_thread_cache_alloc(cache_a);
+  }
+  /* Freeing into another cache returns batches to the pool, only keeping a few. */
+  for (void *elem : elems) {
+    BLI_mempool_thread_cache_free(cache_b, elem);
+  }
+  BLI_mempool_thread_cache_flush(cache_a);
+  BLI_mempool_thread_cache_flush(cache_b);
+  EXPECT_EQ(BLI_mempool_len(pool), 0);
+
+  Set<void *> elems_set;
+  for (int i = 0; i < 5000; i++) {
+    EXPECT_TRUE(elems_set.add(BLI_mempool_thread_cache_alloc(cache_b)));
+  }
+
+  BLI_mempool_thread_cache_destroy(cache_a);
+  BLI_mempool_thread_cache_destroy(cache_b);
+  EXPECT_EQ(BLI_mempool_len(pool), 5000);
+  BLI_mempool_destroy(pool);
+}
+
+TEST(mempool, ThreadCacheParallel)
+{
+  const int elems_num = 100000;
+  BLI_mempool *pool = BLI_mempool_create(sizeof(int), 0, 512, BLI_MEMPOOL_ALLOW_ITER);
+
+  Array<int *> elems(elems_num);
+  {
+    ThreadCaches caches([&]() { return BLI_mempool_thread_cache_create(pool); });
+    threading::parallel_for(elems.index_range(), 256, [&](const IndexRange range) {
+      BLI_mempool_thread_cache *cache = caches.local();
+      for (const int i : range) {
+        elems[i] = static_cast<int *>(BLI_mempool_thread_cache_alloc(cache));
+        *elems[i] = i;
+      }
+    });
+    thread_caches_destroy(caches);
+  }
+  EXPECT_EQ(BLI_mempool_len(pool), elems_num);
+
+  /* Each element is only handed out once. */
+  Set<int *> elems_set(elems);
+  EXPECT_EQ(elems_set.size(), elems_num);
+  for (const int i : elems.index_range()) {
+    EXPECT_EQ(*elems[i], i);
+  }
+
+  /* Free and allocate concurrently, freeing elements allocated by other threads. */
+  {
+    ThreadCaches caches([&]() { return BLI_mempool_thread_cache_create(pool); });
+    threading::parallel_for(elems.index_range(), 256, [&](const IndexRange range) {
+      BLI_mempool_thread_cache *cache = caches.local();
+      for (const int i : range) {
+        BLI_mempool_thread_cache_free(cache, elems[i]);
+        if (i % 4 == 0) {
+          elems[i] = static_cast<int *>(BLI_mempool_thread_cache_alloc(cache));
+          *elems[i] = i;
+        }
+      }
+    });
+    thread_caches_destroy(caches);
+  }
+  EXPECT_EQ(BLI_mempool_len(pool), elems_num / 4);
+
+  BLI_mempool_iter iter;
+  BLI_mempool_iternew(pool, &iter);
+  int count = 0;
+  while (int *elem = static_cast<int *>(BLI_mempool_iterstep(&iter))) {
+    EXPECT_EQ(*elem % 4, 0);
+    count++;
+  }
+  EXPECT_EQ(count, elems_num / 4);
+
+  BLI_mempool_destroy(pool);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <string>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_task.hh"
+#include "BLI_tempfile.h"
+#include "BLI_trace.hh"
+
+namespace blender::tests {
+
+TEST(trace, WriteSession)
+{
+  char temp_dir[FILE_MAX];
+  BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+  char filepath[FILE_MAX];
+  BLI_path_join(filepath, sizeof(filepath), temp_dir, "blender_test_trace.json");
+
+  /* Not recorded, there is no session yet. */
+  {
+    SCOPED_TRACE_EVENT("test", "Before Session");
+  }
+
+  BLI_trace_session_begin(filepath);
+  EXPECT_TRUE(BLI_trace_is_enabled());
+  {
+    SCOPED_TRACE_EVENT("test", "Outer \"Event\"");
+    threading::parallel_for(IndexRange(1000), 10, [&](const IndexRange /*range*/) {
+      SCOPED_TRACE_EVENT("test", "Inner Event");
+    });
+  }
+  BLI_trace_session_end();
+  EXPECT_FALSE(BLI_trace_is_enabled());
+
+  size_t size;
+  char *data = static_cast<char *>(BLI_file_read_text_as_mem(filepath, 1, &size));
+  ASSERT_NE(data, nullptr);
+  data[size] = '\0';
+  const std::string trace = data;
+  MEM_freeN(data);
+  BLI_delete(filepath, false, false);
+
+  EXPECT_EQ(trace.find("{\"traceEvents\":["), 0);
+  EXPECT_EQ(trace.find("Before Session"), std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"Outer \\\"Event\\\"\",\"cat\":\"test\",\"ph\":\"X\""),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"Inner Event\""), std::string::npos);
+  EXPECT_NE(trace.find("\"thread_name\""), std::string::npos);
+}
+
+}  // namespace blender::tests
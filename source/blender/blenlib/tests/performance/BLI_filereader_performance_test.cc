@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_filereader.h"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include "PIL_time.h"
+
+#include "BLI_filereader_test_utils.hh"
+
+/* Same frame size as `writefile.cc`. */
+#define ZSTD_CHUNK_SIZE (1 << 20)
+#define ZSTD_TEST_DATA_SIZE (int64_t(256) << 20)
+#define ZSTD_READ_SIZE 4096
+
+namespace blender::tests {
+
+/* Read the whole stream in small pieces, like `readfile.cc` reading #BHead blocks. */
+static double zstd_read_all(const Span<char> compressed, const bool use_readahead)
+{
+  char buffer[ZSTD_READ_SIZE];
+  const double time_start = PIL_check_seconds_timer();
+
+  FileReader *mem = BLI_filereader_new_memory(compressed.data(), compressed.size());
+  FileReader *file = use_readahead ? BLI_filereader_new_zstd_readahead(mem) :
+                                     BLI_filereader_new_zstd(mem);
+  int64_t total = 0;
+  ssize_t len;
+  while ((len = file->read(file, buffer, sizeof(buffer))) > 0) {
+    total += len;
+  }
+  file->close(file);
+
+  const double time = PIL_check_seconds_timer() - time_start;
+  EXPECT_EQ(total, ZSTD_TEST_DATA_SIZE);
+  return time;
+}
+
+TEST(filereader, zstd_readahead_performance)
+{
+  RandomNumberGenerator rng(0);
+  Vector<char> data(ZSTD_TEST_DATA_SIZE);
+  for (const int64_t i : data.index_range()) {
+    data[i] = char((i / 32) % 13 + rng.get_int32(8));
+  }
+  const Vector<char> compressed = zstd_compress_seekable(data, ZSTD_CHUNK_SIZE);
+
+  const double time_serial = zstd_read_all(compressed, false);
+  const double time_readahead = zstd_read_all(compressed, true);
+
+  printf("Reading %d MB (%d MB compressed):\n", int(ZSTD_TEST_DATA_SIZE >> 20),
+         int(compressed.size() >> 20));
+  printf("\tSerial decompression: %.3f s\n", time_serial);
+  printf("\tRead-ahead decompression: %.3f s (x%.2f)\n",
+         time_readahead,
+         time_serial / time_readahead);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_rand.h"
+
+#include "PIL_time_utildefines.h"
+
+namespace blender::tests {
+
+static Array<float3> random_points(const int points_num, const uint seed)
+{
+  RNG *rng = BLI_rng_new(seed);
+  Array<float3> points(points_num);
+  for (float3 &co : points) {
+    BLI_rng_get_float_unit_v3(rng, co);
+  }
+  BLI_rng_free(rng);
+  return points;
+}
+
+static KDTree_3d *kdtree_build(const Span<float3> points)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(uint(points.size()));
+  for (const int i : points.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  TIMEIT_START(balance);
+  BLI_kdtree_3d_balance(tree);
+  TIMEIT_END(balance);
+  return tree;
+}
+
+static void kdtree_find_nearest(const int points_num, const int queries_num)
+{
+  const Array<float3> points = random_points(points_num, 0);
+  const Array<float3> queries = random_points(queries_num, 1);
+  KDTree_3d *tree = kdtree_build(points);
+
+  Array<KDTreeNearest_3d> nearest(queries_num);
+  TIMEIT_START(find_nearest_loop);
+  for (const int i : queries.index_range()) {
+    BLI_kdtree_3d_find_nearest(tree, queries[i], &nearest[i]);
+  }
+  TIMEIT_END(find_nearest_loop);
+
+  TIMEIT_START(find_nearest_batch);
+  BLI_kdtree_3d_find_nearest_batch(tree,
+                                   reinterpret_cast<const float(*)[3]>(queries.data()),
+                                   uint(queries_num),
+                                   nearest.data());
+  TIMEIT_END(find_nearest_batch);
+
+  BLI_kdtree_3d_free(tree);
+}
+
+static void kdtree_range_search(const int points_num, const int queries_num, const float range)
+{
+  const Array<float3> points = random_points(points_num, 0);
+  const Array<float3> queries = random_points(queries_num, 1);
+  KDTree_3d *tree = kdtree_build(points);
+
+  Array<int> found_num(queries_num, 0);
+  TIMEIT_START(range_search_loop);
+  for (const int i : queries.index_range()) {
+    BLI_kdtree_3d_range_search_cb_cpp(
+        tree, queries[i], range, [&](const int /*index*/, const float * /*co*/, float /*d*/) {
+          found_num[i]++;
+          return true;
+        });
+  }
+  TIMEIT_END(range_search_loop);
+
+  found_num.fill(0);
+  TIMEIT_START(range_search_batch);
+  BLI_kdtree_3d_range_search_batch_cb_cpp(
+      tree,
+      reinterpret_cast<const float(*)[3]>(queries.data()),
+      uint(queries_num),
+      range,
+      [&](const int co_index, const int /*index*/, const float * /*co*/, float /*d*/) {
+        found_num[co_index]++;
+        return true;
+      });
+  TIMEIT_END(range_search_batch);
+
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, FindNearest1M)
+{
+  kdtree_find_nearest(1000000, 1000000);
+}
+
+TEST(kdtree, RangeSearch1M)
+{
+  kdtree_range_search(1000000, 100000, 0.02f);
+}
+
+}  // namespace blender::tests
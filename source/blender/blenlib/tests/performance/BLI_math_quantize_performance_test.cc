@@ -0,0 +1,98 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_quantize.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.h"
+#include "BLI_task.hh"
+#include "BLI_virtual_array.hh"
+
+#include "PIL_time_utildefines.h"
+
+namespace blender::tests {
+
+static float3 get_half3(const ushort3 &value)
+{
+  return math::half_to_float(value);
+}
+static void set_half3(ushort3 &value, float3 new_value)
+{
+  value = math::float_to_half(new_value);
+}
+
+static Array<float3> random_points(const int points_num)
+{
+  RNG *rng = BLI_rng_new(0);
+  Array<float3> points(points_num);
+  for (float3 &co : points) {
+    BLI_rng_get_float_unit_v3(rng, co);
+  }
+  BLI_rng_free(rng);
+  return points;
+}
+
+/** Similar to the "Set Position" node: read, offset and write every value. */
+static void offset_values(VMutableArray<float3> &values, const float3 &offset)
+{
+  threading::parallel_for(values.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      values.set(i, values.get(i) + offset);
+    }
+  });
+}
+
+/** Similar to the "Geometry Proximity" node: only read the values. */
+static void distances_to_point(const VArray<float3> &values,
+                               const float3 &point,
+                               MutableSpan<float> r_distances)
+{
+  threading::parallel_for(values.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      r_distances[i] = math::distance(values.get(i), point);
+    }
+  });
+}
+
+static void quantize_attribute_workloads(const int values_num)
+{
+  Array<float3> values_float = random_points(values_num);
+  Array<ushort3> values_half(values_num);
+  for (const int i : values_float.index_range()) {
+    values_half[i] = math::float_to_half(values_float[i]);
+  }
+  Array<float> distances(values_num);
+
+  VMutableArray<float3> varray_float = VMutableArray<float3>::ForSpan(values_float);
+  VMutableArray<float3> varray_half =
+      VMutableArray<float3>::ForDerivedSpan<ushort3, get_half3, set_half3>(values_half);
+
+  TIMEIT_START(set_position_float3);
+  offset_values(varray_float, float3(0.1f));
+  TIMEIT_END(set_position_float3);
+
+  TIMEIT_START(set_position_half3);
+  offset_values(varray_half, float3(0.1f));
+  TIMEIT_END(set_position_half3);
+
+  TIMEIT_START(proximity_float3);
+  distances_to_point(varray_float, float3(0.5f), distances);
+  TIMEIT_END(proximity_float3);
+
+  TIMEIT_START(proximity_half3);
+  distances_to_point(varray_half, float3(0.5f), distances);
+  TIMEIT_END(proximity_half3);
+}
+
+TEST(math_quantize, AttributeWorkloads_1M)
+{
+  quantize_attribute_workloads(1000000);
+}
+
+TEST(math_quantize, AttributeWorkloads_10M)
+{
+  quantize_attribute_workloads(10000000);
+}
+
+}  // namespace blender::tests
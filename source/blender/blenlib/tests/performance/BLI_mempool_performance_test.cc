@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <mutex>
+
+#include "BLI_array.hh"
+#include "BLI_enumerable_thread_specific.hh"
+#include "BLI_mempool.h"
+#include "BLI_task.hh"
+
+#include "PIL_time_utildefines.h"
+
+namespace blender::tests {
+
+/* Roughly the size of a #BMVert. */
+#define ELEM_SIZE 64
+
+static void mempool_alloc_free_single_thread(const int elems_num)
+{
+  BLI_mempool *pool = BLI_mempool_create(ELEM_SIZE, 0, 512, BLI_MEMPOOL_ALLOW_ITER);
+  Array<void *> elems(elems_num);
+
+  TIMEIT_START(single_thread_alloc);
+  for (const int i : elems.index_range()) {
+    elems[i] = BLI_mempool_calloc(pool);
+  }
+  TIMEIT_END(single_thread_alloc);
+
+  TIMEIT_START(single_thread_free);
+  for (void *elem : elems) {
+    BLI_mempool_free(pool, elem);
+  }
+  TIMEIT_END(single_thread_free);
+
+  BLI_mempool_destroy(pool);
+}
+
+static void mempool_alloc_free_mutex(const int elems_num)
+{
+  BLI_mempool *pool = BLI_mempool_create(ELEM_SIZE, 0, 512, BLI_MEMPOOL_ALLOW_ITER);
+  Array<void *> elems(elems_num);
+  std::mutex mutex;
+
+  TIMEIT_START(mutex_alloc);
+  threading::parallel_for(elems.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      void *elem;
+      {
+        std::lock_guard lock{mutex};
+        elem = BLI_mempool_alloc(pool);
+      }
+      memset(elem, 0, ELEM_SIZE);
+      elems[i] = elem;
+    }
+  });
+  TIMEIT_END(mutex_alloc);
+
+  TIMEIT_START(mutex_free);
+  threading::parallel_for(elems.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      std::lock_guard lock{mutex};
+      BLI_mempool_free(pool, elems[i]);
+    }
+  });
+  TIMEIT_END(mutex_free);
+
+  BLI_mempool_destroy(pool);
+}
+
+static void mempool_alloc_free_thread_cache(const int elems_num)
+{
+  using ThreadCaches = threading::EnumerableThreadSpecific<BLI_mempool_thread_cache *>;
+
+  BLI_mempool *pool = BLI_mempool_create(ELEM_SIZE, 0, 512, BLI_MEMPOOL_ALLOW_ITER);
+  Array<void *> elems(elems_num);
+
+  {
+    TIMEIT_START(thread_cache_alloc);
+    ThreadCaches caches([&]() { return BLI_mempool_thread_cache_create(pool); });
+    threading::parallel_for(elems.index_range(), 1024, [&](const IndexRange range) {
+      BLI_mempool_thread_cache *cache = caches.local();
+      for (const int i : range) {
+        elems[i] = BLI_mempool_thread_cache_calloc(cache);
+      }
+    });
+    for (BLI_mempool_thread_cache *cache : caches) {
+      BLI_mempool_thread_cache_destroy(cache);
+    }
+    TIMEIT_END(thread_cache_alloc);
+  }
+
+  {
+    TIMEIT_START(thread_cache_free);
+    ThreadCaches caches([&]() { return BLI_mempool_thread_cache_create(pool); });
+    threading::parallel_for(elems.index_range(), 1024, [&](const IndexRange range) {
+      BLI_mempool_thread_cache *cache = caches.local();
+      for (const int i : range) {
+        BLI_mempool_thread_cache_free(cache, elems[i]);
+      }
+    });
+    for (BLI_mempool_thread_cache *cache : caches) {
+      BLI_mempool_thread_cache_destroy(cache);
+    }
+    TIMEIT_END(thread_cache_free);
+  }
+
+  BLI_mempool_destroy(pool);
+}
+
+TEST(mempool, SingleThread1M)
+{
+  mempool_alloc_free_single_thread(1000000);
+}
+
+TEST(mempool, Mutex1M)
+{
+  mempool_alloc_free_mutex(1000000);
+}
+
+TEST(mempool, ThreadCache1M)
+{
+  mempool_alloc_free_thread_cache(1000000);
+}
+
+TEST(mempool, SingleThread10M)
+{
+  mempool_alloc_free_single_thread(10000000);
+}
+
+TEST(mempool, Mutex10M)
+{
+  mempool_alloc_free_mutex(10000000);
+}
+
+TEST(mempool, ThreadCache10M)
+{
+  mempool_alloc_free_thread_cache(10000000);
+}
+
+}  // namespace blender::tests
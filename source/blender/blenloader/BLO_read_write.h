@@ -40,6 +40,7 @@ typedef struct BlendExpander BlendExpander;
 typedef struct BlendLibReader BlendLibReader;
 typedef struct BlendWriter BlendWriter;
 
+struct BLODeferredData;
 struct BlendFileReadReport;
 struct Main;
 
@@ -172,6 +173,12 @@ void BLO_write_pointer_array(BlendWriter *writer, uint num, const void *data_ptr
  * Write a null terminated string.
  */
 void BLO_write_string(BlendWriter *writer, const char *data_ptr);
+/**
+ * Write the location of deferred data instead of the data itself, read it with
+ * #BLO_read_deferred_data_address. Undo steps keep a user of the deferred data,
+ * see #BLO_memfile_has_deferred_data.
+ */
+void BLO_write_deferred_data(BlendWriter *writer, struct BLODeferredData *deferred);
 
 /* Misc. */
 
@@ -238,6 +245,57 @@ void BLO_read_pointer_array(BlendDataReader *reader, void **ptr_p);
 
 /* Misc. */
 
+/**
+ * Location of a memory buffer in a .blend file whose reading was deferred,
+ * see #BLO_READ_DEFER_PACKED_DATA.
+ *
+ * Shared by all owners of the same location (e.g. a packed file and the undo steps storing it),
+ * see #BLO_deferred_data_user_add and #BLO_deferred_data_free.
+ */
+typedef struct BLODeferredData {
+  struct BLODeferredData *next, *prev;
+  char filepath[1024]; /* FILE_MAX */
+  int64_t offset;
+  int64_t size;
+  /** Used to detect that the file was modified since it was loaded. */
+  int64_t file_size;
+  int64_t file_mtime;
+
+  /** Runtime, not written to files. */
+  int users;
+  char _pad[4];
+  /** A copy of the data, read before the file is overwritten, see #BLO_deferred_data_preserve. */
+  void *data;
+} BLODeferredData;
+
+/**
+ * When reading of the memory buffer at `old_address` was deferred, return where it is stored in
+ * the file instead of reading it. Returns NULL when the buffer has to be read as usual with
+ * #BLO_read_packed_address. The result is owned by the caller and freed with
+ * #BLO_deferred_data_free.
+ */
+BLODeferredData *BLO_read_data_defer(BlendDataReader *reader, const void *old_address);
+/**
+ * Read a memory buffer whose reading was deferred with #BLO_read_data_defer.
+ * \param r_data: Buffer of `deferred->size` bytes.
+ * \return False when the data could not be read, e.g. because the file was modified.
+ */
+bool BLO_read_deferred_data(const BLODeferredData *deferred, void *r_data);
+/**
+ * Read deferred data written with #BLO_write_deferred_data. When the same location is still
+ * referenced, e.g. by the undo step being read, the existing #BLODeferredData is shared.
+ */
+void BLO_read_deferred_data_address(BlendDataReader *reader, BLODeferredData **deferred_p);
+
+void BLO_deferred_data_user_add(BLODeferredData *deferred);
+/** Remove a user, freeing the deferred data once it has none left. */
+void BLO_deferred_data_free(BLODeferredData *deferred);
+/**
+ * Read all deferred data that is still referenced from `filepath`, so that it stays available
+ * once the file is overwritten.
+ */
+void BLO_deferred_data_preserve(const char *filepath);
+
 int BLO_read_fileversion_get(BlendDataReader *reader);
 bool BLO_read_requires_endian_switch(BlendDataReader *reader);
 bool BLO_read_data_is_undo(BlendDataReader *reader);
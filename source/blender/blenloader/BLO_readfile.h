@@ -66,7 +66,7 @@ typedef struct BlendFileData {
 } BlendFileData;
 
 struct BlendFileReadParams {
-  uint skip_flags : 3; /* #eBLOReadSkip */
+  uint skip_flags : 4; /* #eBLOReadSkip */
   uint is_startup : 1;
 
   /** Whether we are reading the memfile for an undo or a redo. */
@@ -121,8 +121,14 @@ typedef enum eBLOReadSkip {
   BLO_READ_SKIP_DATA = (1 << 1),
   /** Do not attempt to re-use IDs from old bmain for unchanged ones in case of undo. */
   BLO_READ_SKIP_UNDO_OLD_MAIN = (1 << 2),
+  /**
+   * Do not read the content of packed files while loading, only remember where it is stored in
+   * the file. It is read on first access instead, see #BKE_packedfile_ensure_data.
+   * Only supported for uncompressed and `Zstd` compressed files read from disk.
+   */
+  BLO_READ_DEFER_PACKED_DATA = (1 << 3),
 } eBLOReadSkip;
-ENUM_OPERATORS(eBLOReadSkip, BLO_READ_SKIP_UNDO_OLD_MAIN)
+ENUM_OPERATORS(eBLOReadSkip, BLO_READ_DEFER_PACKED_DATA)
 #define BLO_READ_SKIP_ALL (BLO_READ_SKIP_USERDEF | BLO_READ_SKIP_DATA)
 
 /**
@@ -15,10 +15,17 @@ struct Scene;
 
 typedef struct {
   void *next, *prev;
+  /**
+   * Shared with all chunks that have the same content, in any undo step,
+   * see #BLO_memfile_chunk_store_stats.
+   */
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** Hash of the content of `buf`, used to find identical buffers. */
+  uint hash;
+  /** When true, this chunk is identical to the chunk at the same position in the previous step,
+   * and shares its memory. */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -31,7 +38,13 @@ typedef struct {
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Size of the chunk buffers that were added to memory for this memfile. */
   size_t size;
+  /**
+   * #LinkData of the #BLODeferredData written instead of packed data that wasn't loaded yet,
+   * each one with a user, see #BLO_write_deferred_data.
+   */
+  ListBase deferred_data;
 } MemFile;
 
 typedef struct MemFileWriteData {
@@ -92,6 +105,22 @@ extern void BLO_memfile_merge(MemFile *first, MemFile *second);
  */
 extern void BLO_memfile_clear_future(MemFile *memfile);
 
+/**
+ * Memory usage of the chunk buffers of all memfiles.
+ */
+typedef struct MemFileChunkStoreStats {
+  /** Number of distinct buffers in memory. */
+  size_t buffers_num;
+  /** Size of the distinct buffers, i.e. the memory actually used. */
+  size_t buffers_size;
+  /** Number of chunks using these buffers, in all memfiles. */
+  size_t chunks_num;
+  /** Size of all chunks, i.e. the memory that would be used without any sharing. */
+  size_t chunks_size;
+} MemFileChunkStoreStats;
+
+extern void BLO_memfile_chunk_store_stats(MemFileChunkStoreStats *r_stats);
+
 /* Utilities. */
 
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
@@ -103,6 +132,42 @@ extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
  * \return success.
  */
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filepath);
+/**
+ * Whether the memfile references packed data that wasn't loaded instead of storing it. A file
+ * written with #BLO_memfile_write_file then depends on the file that data was loaded from.
+ */
+extern bool BLO_memfile_has_deferred_data(const MemFile *memfile);
+
+/**
+ * Add chunks sharing the memory of all chunks of `memfile_src` to `memfile_dst`,
+ * e.g. to keep the state of a memfile written with #BLO_memfile_write_file.
+ */
+extern void BLO_memfile_share(MemFile *memfile_dst, const MemFile *memfile_src);
+/**
+ * Size of the data #BLO_memfile_write_file_delta would write.
+ *
+ * \param r_full_size: The size of the file written by #BLO_memfile_write_file (optional).
+ */
+extern size_t BLO_memfile_delta_size(const MemFile *memfile,
+                                     const MemFile *base_memfile,
+                                     size_t *r_full_size);
+/**
+ * Save a delta file containing only the chunks of `memfile` that are not in `base_memfile`,
+ * which must be the memfile a file was written from with #BLO_memfile_write_file.
+ *
+ * \return success.
+ */
+extern bool BLO_memfile_write_file_delta(const MemFile *memfile,
+                                         const MemFile *base_memfile,
+                                         const char *filepath);
+/**
+ * Replace a file written by #BLO_memfile_write_file with the result of applying a delta file to
+ * it. The file is left unchanged when the delta file doesn't match it, which is checked with the
+ * size and a hash of the base file stored in the delta file.
+ *
+ * \return success.
+ */
+extern bool BLO_memfile_delta_apply(const char *filepath_base, const char *filepath_delta);
 
 FileReader *BLO_memfile_new_filereader(MemFile *memfile, int undo_direction);
 
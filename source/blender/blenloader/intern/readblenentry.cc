@@ -404,6 +404,9 @@ BlendFileData *BLO_read_from_file(const char *filepath,
   fd = blo_filedata_from_file(filepath, reports);
   if (fd) {
     fd->skip_flags = skip_flags;
+    if (skip_flags & BLO_READ_DEFER_PACKED_DATA) {
+      blo_deferred_data_init(fd, filepath);
+    }
     bfd = blo_read_file_internal(fd, filepath);
     blo_filedata_free(fd);
   }
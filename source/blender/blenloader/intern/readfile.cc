@@ -13,6 +13,7 @@
 #include <cstdlib> /* for atoi. */
 #include <ctime>   /* for gmtime. */
 #include <fcntl.h> /* for open flags (O_BINARY, O_RDONLY). */
+#include <mutex>
 
 #include "BLI_utildefines.h"
 #ifndef WIN32
@@ -46,6 +47,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
@@ -55,7 +57,10 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "PIL_time.h"
 
@@ -790,6 +795,11 @@ static BHeadN *get_bhead(FileData *fd)
     }
   }
 
+  if (fd && (fd->is_eof || (new_bhead && new_bhead->bhead.code == ENDB))) {
+    /* The whole file was scanned, only delayed data is read on demand from now on. */
+    BLI_filereader_zstd_readahead_stop(fd->file);
+  }
+
   /* We've read a new block. Now add it to the list
    * of blocks.
    */
@@ -860,6 +870,15 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+
+  if (fd->mmap_file) {
+    /* Copy from the mapping without moving the reading position back and forth. This is the
+     * same single copy that reading through the #FileReader does, the data isn't referenced from
+     * the mapping since loaded data is owned by (and freed with) the guarded allocator. */
+    return BLI_mmap_read(
+        fd->mmap_file, buf, size_t(new_bhead->file_offset), size_t(new_bhead->bhead.len));
+  }
+
   off64_t offset_backup = fd->file->offset;
   if (UNLIKELY(fd->file->seek(fd->file, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -1133,7 +1152,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
     }
   }
   else if (BLI_file_magic_is_zstd(header)) {
-    file = BLI_filereader_new_zstd(rawfile);
+    /* Files are read mostly sequentially, decompress upcoming frames in parallel. */
+    file = BLI_filereader_new_zstd_readahead(rawfile);
     if (file != nullptr) {
       rawfile = nullptr; /* The `Zstd` #FileReader takes ownership of `rawfile`. */
     }
@@ -1150,6 +1170,7 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   FileData *fd = filedata_new(reports);
   fd->file = file;
+  fd->mmap_file = BLI_filereader_mmap_file_get(file);
 
   return fd;
 }
@@ -1277,6 +1298,9 @@ void blo_filedata_free(FileData *fd)
     if (fd->datamap) {
       oldnewmap_free(fd->datamap);
     }
+    if (fd->deferred_datamap) {
+      MEM_delete(fd->deferred_datamap);
+    }
     if (fd->globmap) {
       oldnewmap_free(fd->globmap);
     }
@@ -1338,6 +1362,193 @@ BlendThumbnail *BLO_thumbnail_from_file(const char *filepath)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Deferred Data
+ *
+ * With #BLO_READ_DEFER_PACKED_DATA, large data-blocks of IDs that can own packed files are not
+ * read into the data-map together with the rest of the ID. They are read as soon as their
+ * address is looked up, unless the reading code of the ID takes their location with
+ * #BLO_read_data_defer to read them later. Those which are never looked up are never read.
+ * \{ */
+
+/** Smaller data-blocks are not worth deferring. */
+#define DEFERRED_DATA_MIN_SIZE (1 << 16)
+
+struct DeferredDataMap {
+  /** Old address to #BHead, for the data-blocks of the ID currently being read. */
+  blender::Map<const void *, BHead *> map;
+
+  char filepath[FILE_MAX];
+  int64_t file_size;
+  int64_t file_mtime;
+};
+
+void blo_deferred_data_init(FileData *fd, const char *filepath)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  /* Deferred data is read by seeking in the file later on,
+   * which isn't supported for `Gzip` compressed files. */
+  if (fd->file->seek == nullptr || (fd->flags & FD_FLAGS_IS_MEMFILE)) {
+    return;
+  }
+  BLI_stat_t st;
+  if (BLI_stat(filepath, &st) == -1) {
+    return;
+  }
+  fd->deferred_datamap = MEM_new<DeferredDataMap>(__func__);
+  STRNCPY(fd->deferred_datamap->filepath, filepath);
+  fd->deferred_datamap->file_size = int64_t(st.st_size);
+  fd->deferred_datamap->file_mtime = int64_t(st.st_mtime);
+#else
+  UNUSED_VARS(fd, filepath);
+#endif
+}
+
+static bool deferred_data_id_type_supported(const short id_code)
+{
+  /* ID types that can own packed files. */
+  return ELEM(id_code, ID_IM, ID_VF, ID_SO, ID_VO, ID_LI);
+}
+
+/**
+ * Defer reading of a data-block of the ID being read.
+ * \return False when the data-block has to be read immediately.
+ */
+static bool deferred_data_add(FileData *fd, BHead *bhead)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  if (bhead->len < DEFERRED_DATA_MIN_SIZE || BHEADN_FROM_BHEAD(bhead)->has_data) {
+    return false;
+  }
+  /* Only raw data which needs no conversion at all, which is how packed files are stored. */
+  if (bhead->SDNAnr != 0 || fd->compflags[0] != SDNA_CMP_EQUAL) {
+    return false;
+  }
+  fd->deferred_datamap->map.add_overwrite(bhead->old, bhead);
+  return true;
+#else
+  UNUSED_VARS(fd, bhead);
+  return false;
+#endif
+}
+
+/** Read a deferred data-block into the data-map, when `adr` is one. */
+static void deferred_data_read(FileData *fd, const void *adr)
+{
+  BHead *bhead = fd->deferred_datamap->map.pop_default(adr, nullptr);
+  if (bhead == nullptr) {
+    return;
+  }
+  void *data = read_struct(fd, bhead, "deferred data");
+  if (data) {
+    oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+  }
+}
+
+static void deferred_data_clear(FileData *fd)
+{
+  if (fd->deferred_datamap) {
+    fd->deferred_datamap->map.clear();
+  }
+}
+
+/**
+ * All deferred data that still has users, so that the same location is shared by all its owners
+ * and can be preserved before its file is overwritten.
+ */
+static ListBase deferred_data_registry = {nullptr, nullptr};
+static std::mutex deferred_data_registry_mutex;
+
+static bool deferred_data_location_equals(const BLODeferredData *a, const BLODeferredData *b)
+{
+  return a->offset == b->offset && a->size == b->size && a->file_size == b->file_size &&
+         a->file_mtime == b->file_mtime && STREQ(a->filepath, b->filepath);
+}
+
+/**
+ * Add a user to the registered deferred data with the same location, freeing `deferred`,
+ * or register `deferred` with a single user.
+ */
+static BLODeferredData *deferred_data_register(BLODeferredData *deferred)
+{
+  std::scoped_lock lock(deferred_data_registry_mutex);
+  LISTBASE_FOREACH (BLODeferredData *, registered, &deferred_data_registry) {
+    if (deferred_data_location_equals(registered, deferred)) {
+      registered->users++;
+      MEM_freeN(deferred);
+      return registered;
+    }
+  }
+  deferred->users = 1;
+  deferred->data = nullptr;
+  BLI_addtail(&deferred_data_registry, deferred);
+  return deferred;
+}
+
+static bool deferred_data_read_from_file(const BLODeferredData *deferred, void *r_data)
+{
+  BLI_stat_t st;
+  if (BLI_stat(deferred->filepath, &st) == -1 || int64_t(st.st_size) != deferred->file_size ||
+      int64_t(st.st_mtime) != deferred->file_mtime) {
+    CLOG_ERROR(&LOG,
+               "Unable to read deferred data, '%s' was modified or removed since it was loaded",
+               deferred->filepath);
+    return false;
+  }
+
+  FileData *fd = blo_filedata_from_file_minimal(deferred->filepath);
+  if (fd == nullptr) {
+    return false;
+  }
+  const bool success = fd->file->seek != nullptr &&
+                       fd->file->seek(fd->file, deferred->offset, SEEK_SET) == deferred->offset &&
+                       fd->file->read(fd->file, r_data, size_t(deferred->size)) == deferred->size;
+  blo_filedata_free(fd);
+
+  if (!success) {
+    CLOG_ERROR(&LOG, "Unable to read deferred data from '%s'", deferred->filepath);
+  }
+  return success;
+}
+
+void BLO_deferred_data_user_add(BLODeferredData *deferred)
+{
+  std::scoped_lock lock(deferred_data_registry_mutex);
+  BLI_assert(deferred->users > 0);
+  deferred->users++;
+}
+
+void BLO_deferred_data_free(BLODeferredData *deferred)
+{
+  std::scoped_lock lock(deferred_data_registry_mutex);
+  BLI_assert(deferred->users > 0);
+  if (--deferred->users > 0) {
+    return;
+  }
+  BLI_remlink(&deferred_data_registry, deferred);
+  MEM_SAFE_FREE(deferred->data);
+  MEM_freeN(deferred);
+}
+
+void BLO_deferred_data_preserve(const char *filepath)
+{
+  std::scoped_lock lock(deferred_data_registry_mutex);
+  LISTBASE_FOREACH (BLODeferredData *, deferred, &deferred_data_registry) {
+    if (deferred->data != nullptr || BLI_path_cmp(deferred->filepath, filepath) != 0) {
+      continue;
+    }
+    void *data = MEM_mallocN(size_t(deferred->size), __func__);
+    if (deferred_data_read_from_file(deferred, data)) {
+      deferred->data = data;
+    }
+    else {
+      MEM_freeN(data);
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Old/New Pointer Map
  * \{ */
@@ -1345,12 +1556,18 @@ BlendThumbnail *BLO_thumbnail_from_file(const char *filepath)
 /* Only direct data-blocks. */
 static void *newdataadr(FileData *fd, const void *adr)
 {
+  if (fd->deferred_datamap) {
+    deferred_data_read(fd, adr);
+  }
   return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* Only direct data-blocks. */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
+  if (fd->deferred_datamap) {
+    deferred_data_read(fd, adr);
+  }
   return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
 }
 
@@ -1366,7 +1583,7 @@ static void *newpackedadr(FileData *fd, const void *adr)
     return oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
   }
 
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return newdataadr(fd, adr);
 }
 
 /* only lib data */
@@ -2965,6 +3182,8 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
+  const bool use_deferred = fd->deferred_datamap && deferred_data_id_type_supported(bhead->code);
+
   bhead = blo_bhead_next(fd, bhead);
 
   while (bhead && bhead->code == DATA) {
@@ -2988,6 +3207,11 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
     }
 #endif
 
+    if (use_deferred && deferred_data_add(fd, bhead)) {
+      bhead = blo_bhead_next(fd, bhead);
+      continue;
+    }
+
     void *data = read_struct(fd, bhead, allocname);
     if (data) {
       oldnewmap_insert(fd->datamap, bhead->old, data, 0);
@@ -3353,6 +3577,7 @@ static BHead *read_libblock(FileData *fd,
   bhead = read_data_into_datamap(fd, bhead, allocname);
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
   oldnewmap_clear(fd->datamap);
+  deferred_data_clear(fd);
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -4814,10 +5039,54 @@ static void read_library_clear_weak_links(FileData *basefd, ListBase *mainlist,
   }
 }
 
+/**
+ * Open the file of a library and parse its header, DNA and block headers.
+ *
+ * This only accesses `mainptr->curlib` and the returned file data,
+ * so it can be called for multiple libraries in parallel.
+ */
+static FileData *read_library_file_open(Main *mainptr, BlendFileReadReport *reports)
+{
+  FileData *fd;
+
+  if (mainptr->curlib->packedfile) {
+    PackedFile *pf = mainptr->curlib->packedfile;
+
+    BKE_packedfile_ensure_data(pf);
+    fd = blo_filedata_from_memory(pf->data, pf->size, reports);
+
+    /* Needed for library_append and read_libraries. */
+    if (fd) {
+      BLI_strncpy(fd->relabase, mainptr->curlib->filepath_abs, sizeof(fd->relabase));
+    }
+  }
+  else {
+    fd = blo_filedata_from_file(mainptr->curlib->filepath_abs, reports);
+  }
+
+#ifdef USE_GHASH_BHEAD
+  if (fd) {
+    read_file_bhead_idname_map_create(fd);
+  }
+#endif
+
+  return fd;
+}
+
+/** A library file opened ahead of time by #read_libraries_open_files. */
+struct LibraryOpenResult {
+  FileData *fd;
+  /** Reports from opening the file, added to the base reports once the library is handled. */
+  ReportList reports;
+};
+
+using LibraryOpenResults = blender::Map<Main *, LibraryOpenResult *>;
+
 static FileData *read_library_file_data(FileData *basefd,
                                         ListBase *mainlist,
                                         Main *mainl,
-                                        Main *mainptr)
+                                        Main *mainptr,
+                                        LibraryOpenResults &opened_files)
 {
   FileData *fd = mainptr->curlib->filedata;
 
@@ -4827,28 +5096,31 @@ static FileData *read_library_file_data(FileData *basefd,
   }
 
   if (mainptr->curlib->packedfile) {
-    /* Read packed file. */
-    PackedFile *pf = mainptr->curlib->packedfile;
-
     BLO_reportf_wrap(basefd->reports,
                      RPT_INFO,
                      TIP_("Read packed library:  '%s', parent '%s'"),
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_memory(pf->data, pf->size, basefd->reports);
-
-    /* Needed for library_append and read_libraries. */
-    BLI_strncpy(fd->relabase, mainptr->curlib->filepath_abs, sizeof(fd->relabase));
   }
   else {
-    /* Read file on disk. */
     BLO_reportf_wrap(basefd->reports,
                      RPT_INFO,
                      TIP_("Read library:  '%s', '%s', parent '%s'"),
                      mainptr->curlib->filepath_abs,
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_file(mainptr->curlib->filepath_abs, basefd->reports);
+  }
+
+  if (LibraryOpenResult *opened = opened_files.pop_default(mainptr, nullptr)) {
+    fd = opened->fd;
+    LISTBASE_FOREACH (Report *, report, &opened->reports.list) {
+      BKE_report(basefd->reports->reports, eReportType(report->type), report->message);
+    }
+    BKE_reports_clear(&opened->reports);
+    MEM_delete(opened);
+  }
+  else {
+    fd = read_library_file_open(mainptr, basefd->reports);
   }
 
   if (fd) {
@@ -4871,9 +5143,6 @@ static FileData *read_library_file_data(FileData *basefd,
 
     /* subversion */
     read_file_version(fd, mainptr);
-#ifdef USE_GHASH_BHEAD
-    read_file_bhead_idname_map_create(fd);
-#endif
   }
   else {
     mainptr->curlib->filedata = nullptr;
@@ -4892,6 +5161,73 @@ static FileData *read_library_file_data(FileData *basefd,
   return fd;
 }
 
+/**
+ * Maximum number of library files opened at once by #read_libraries_open_files. Each open file
+ * holds its decompression buffers and block headers until its linked data-blocks are read.
+ */
+#define LIBRARY_OPEN_PARALLEL_MAX 8
+
+/**
+ * Open the files of the libraries starting at `mainptr_first` that have linked data-blocks to
+ * read but are not open yet, up to #LIBRARY_OPEN_PARALLEL_MAX of them.
+ *
+ * Reading and decompressing the files and parsing their block headers is independent for each
+ * library, so it is done in parallel. Everything that modifies shared data (reports, the main
+ * list, pointer maps) is left to #read_library_file_data, which picks up the opened files in the
+ * same order as when opening them one after another.
+ */
+static void read_libraries_open_files(Main *mainptr_first, LibraryOpenResults &opened_files)
+{
+  blender::Vector<Main *, LIBRARY_OPEN_PARALLEL_MAX> mains_to_open;
+  for (Main *mainptr = mainptr_first;
+       mainptr && mains_to_open.size() < LIBRARY_OPEN_PARALLEL_MAX;
+       mainptr = mainptr->next) {
+    if (mainptr->curlib->filedata == nullptr && !opened_files.contains(mainptr) &&
+        has_linked_ids_to_read(mainptr)) {
+      mains_to_open.append(mainptr);
+    }
+  }
+
+  if (mains_to_open.size() < 2) {
+    /* Nothing to gain, let #read_library_file_data open the file. */
+    return;
+  }
+
+  blender::Array<LibraryOpenResult *> results(mains_to_open.size());
+  blender::threading::parallel_for(
+      mains_to_open.index_range(), 1, [&](const blender::IndexRange range) {
+        for (const int i : range) {
+          LibraryOpenResult *result = MEM_new<LibraryOpenResult>(__func__);
+          BKE_reports_init(&result->reports, RPT_STORE);
+
+          BlendFileReadReport bf_reports{};
+          bf_reports.reports = &result->reports;
+          result->fd = read_library_file_open(mains_to_open[i], &bf_reports);
+          if (result->fd) {
+            /* Set again by #read_library_file_data, avoid a dangling pointer in the meantime. */
+            result->fd->reports = nullptr;
+          }
+          results[i] = result;
+        }
+      });
+
+  for (const int i : mains_to_open.index_range()) {
+    opened_files.add_new(mains_to_open[i], results[i]);
+  }
+}
+
+static void read_libraries_open_files_free(LibraryOpenResults &opened_files)
+{
+  for (LibraryOpenResult *opened : opened_files.values()) {
+    if (opened->fd) {
+      blo_filedata_free(opened->fd);
+    }
+    BKE_reports_clear(&opened->reports);
+    MEM_delete(opened);
+  }
+  opened_files.clear();
+}
+
 static void read_libraries(FileData *basefd, ListBase *mainlist)
 {
   Main *mainl = static_cast<Main *>(mainlist->first);
@@ -4907,6 +5243,8 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
    * with actual data-blocks. We loop over library mains multiple times in
    * case a library needs to link additional data-blocks from another library
    * that had been read previously. */
+  LibraryOpenResults opened_files;
+
   while (do_it) {
     do_it = false;
 
@@ -4921,8 +5259,13 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
                   mainptr->curlib->id.name,
                   mainptr->curlib->filepath);
 
+        if (mainptr->curlib->filedata == nullptr && !opened_files.contains(mainptr)) {
+          /* Open this library and the following ones at once, instead of one by one. */
+          read_libraries_open_files(mainptr, opened_files);
+        }
+
         /* Open file if it has not been done yet. */
-        FileData *fd = read_library_file_data(basefd, mainlist, mainl, mainptr);
+        FileData *fd = read_library_file_data(basefd, mainlist, mainl, mainptr, opened_files);
 
         if (fd) {
           do_it = true;
@@ -4943,6 +5286,10 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
     }
   }
 
+  /* All opened files are expected to be used, but don't leak them otherwise. */
+  BLI_assert(opened_files.is_empty());
+  read_libraries_open_files_free(opened_files);
+
   for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
     /* Drop weak links for which no data-block was found.
      * Since this can remap pointers in `libmap` of all libraries, it needs to be performed in its
@@ -5005,6 +5352,57 @@ void *BLO_read_get_new_packed_address(BlendDataReader *reader, const void *old_a
   return newpackedadr(reader->fd, old_address);
 }
 
+BLODeferredData *BLO_read_data_defer(BlendDataReader *reader, const void *old_address)
+{
+  FileData *fd = reader->fd;
+  if (fd->deferred_datamap == nullptr || old_address == nullptr) {
+    return nullptr;
+  }
+  BHead *bhead = fd->deferred_datamap->map.pop_default(old_address, nullptr);
+  if (bhead == nullptr) {
+    return nullptr;
+  }
+
+  BLODeferredData *deferred = MEM_cnew<BLODeferredData>(__func__);
+  STRNCPY(deferred->filepath, fd->deferred_datamap->filepath);
+  deferred->offset = int64_t(BHEADN_FROM_BHEAD(bhead)->file_offset);
+  deferred->size = int64_t(bhead->len);
+  deferred->file_size = fd->deferred_datamap->file_size;
+  deferred->file_mtime = fd->deferred_datamap->file_mtime;
+  return deferred_data_register(deferred);
+}
+
+bool BLO_read_deferred_data(const BLODeferredData *deferred, void *r_data)
+{
+  /* Set once with the lock held and never changed while there are users. */
+  const void *data;
+  {
+    std::scoped_lock lock(deferred_data_registry_mutex);
+    data = deferred->data;
+  }
+  if (data != nullptr) {
+    memcpy(r_data, data, size_t(deferred->size));
+    return true;
+  }
+  return deferred_data_read_from_file(deferred, r_data);
+}
+
+void BLO_read_deferred_data_address(BlendDataReader *reader, BLODeferredData **deferred_p)
+{
+  BLO_read_data_address(reader, deferred_p);
+  BLODeferredData *deferred = *deferred_p;
+  if (deferred == nullptr) {
+    return;
+  }
+  if (BLO_read_requires_endian_switch(reader)) {
+    /* Only written for undo and auto-save, which are never read on another platform. */
+    MEM_freeN(deferred);
+    *deferred_p = nullptr;
+    return;
+  }
+  *deferred_p = deferred_data_register(deferred);
+}
+
 ID *BLO_read_get_new_id_address(BlendLibReader *reader, Library *lib, ID *id)
 {
   return static_cast<ID *>(newlibadr(reader->fd, lib, id));
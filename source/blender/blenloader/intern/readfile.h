@@ -24,6 +24,7 @@ extern "C" {
 #endif
 
 struct BLOCacheStorage;
+struct DeferredDataMap;
 struct IDNameLib_Map;
 struct Key;
 struct MemFile;
@@ -57,6 +58,11 @@ typedef struct FileData {
   bool is_eof;
 
   FileReader *file;
+  /**
+   * Set when `file` is an uncompressed file read through memory-mapped IO (owned by `file`).
+   * Used to read delayed #BHead data without seeking, see #blo_bhead_read_data.
+   */
+  struct BLI_mmap_file *mmap_file;
 
   /** Whether we are undoing (< 0) or redoing (> 0), used to choose which 'unchanged' flag to use
    * to detect unchanged data from memfile. */
@@ -97,6 +103,8 @@ typedef struct FileData {
   struct OldNewMap *libmap;
   struct OldNewMap *packedmap;
   struct BLOCacheStorage *cache_storage;
+  /** Only set when reading with #BLO_READ_DEFER_PACKED_DATA. */
+  struct DeferredDataMap *deferred_datamap;
 
   struct BHeadSort *bheadmap;
   int tot_bheadmap;
@@ -152,6 +160,12 @@ void blo_make_old_idmap_from_main(FileData *fd, struct Main *bmain);
 
 BHead *blo_read_asset_data_block(FileData *fd, BHead *bhead, struct AssetMetaData **r_asset_data);
 
+/**
+ * Enable #BLO_READ_DEFER_PACKED_DATA for a file opened from `filepath`,
+ * does nothing when the file does not support it.
+ */
+void blo_deferred_data_init(FileData *fd, const char *filepath);
+
 void blo_cache_storage_init(FileData *fd, struct Main *bmain);
 void blo_cache_storage_old_bmain_clear(FileData *fd, struct Main *bmain_old);
 void blo_cache_storage_end(FileData *fd);
@@ -23,9 +23,16 @@
 
 #include "DNA_listBase.h"
 
+#include <mutex>
+
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_map.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 
+#include "BLO_read_write.h"
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
 
@@ -36,6 +43,122 @@
 /* keep last */
 #include "BLI_strict_flags.h"
 
+/* -------------------------------------------------------------------- */
+/** \name Chunk Store
+ *
+ * Chunk buffers are stored once for each distinct content, and shared by all chunks with that
+ * content, in all memfiles. Chunks identical to the chunk at the same position in the previous
+ * step simply share its buffer. Other chunks are hashed when their memfile is finalized and
+ * looked up in the store, so data that moved around or came back after some steps is found too.
+ * \{ */
+
+struct MemFileChunkKey {
+  const char *buf;
+  size_t size;
+  uint hash_value;
+
+  uint64_t hash() const
+  {
+    return hash_value;
+  }
+
+  friend bool operator==(const MemFileChunkKey &a, const MemFileChunkKey &b)
+  {
+    return a.hash_value == b.hash_value && a.size == b.size &&
+           (a.buf == b.buf || memcmp(a.buf, b.buf, a.size) == 0);
+  }
+};
+
+struct MemFileChunkStore {
+  /** Number of chunks using each stored buffer, the keys point to the stored buffers. */
+  blender::Map<MemFileChunkKey, int64_t> users;
+  MemFileChunkStoreStats stats;
+};
+
+/** Allocated while any memfile exists, to not keep memory around after the undo stack is freed. */
+static MemFileChunkStore *g_chunk_store = nullptr;
+static std::mutex g_chunk_store_mutex;
+
+static MemFileChunkKey chunk_store_key(const MemFileChunk *chunk)
+{
+  return {chunk->buf, chunk->size, chunk->hash};
+}
+
+/**
+ * Add a new chunk to the store, using the stored buffer instead if it has the same content.
+ * \return True if the buffer of the chunk is now stored, false if it was freed.
+ */
+static bool chunk_store_add(MemFileChunk *chunk)
+{
+  std::scoped_lock lock(g_chunk_store_mutex);
+  if (g_chunk_store == nullptr) {
+    g_chunk_store = MEM_new<MemFileChunkStore>(__func__);
+  }
+  MemFileChunkStoreStats &stats = g_chunk_store->stats;
+  stats.chunks_num++;
+  stats.chunks_size += chunk->size;
+
+  const MemFileChunkKey key = chunk_store_key(chunk);
+  if (const MemFileChunkKey *stored_key = g_chunk_store->users.lookup_key_ptr(key)) {
+    g_chunk_store->users.lookup(*stored_key)++;
+    MEM_freeN((void *)chunk->buf);
+    chunk->buf = stored_key->buf;
+    return false;
+  }
+
+  g_chunk_store->users.add_new(key, 1);
+  stats.buffers_num++;
+  stats.buffers_size += chunk->size;
+  return true;
+}
+
+/** Add a user to the stored buffer of a chunk. */
+static void chunk_store_add_user(const MemFileChunk *chunk)
+{
+  std::scoped_lock lock(g_chunk_store_mutex);
+  BLI_assert(g_chunk_store != nullptr);
+  MemFileChunkStoreStats &stats = g_chunk_store->stats;
+  stats.chunks_num++;
+  stats.chunks_size += chunk->size;
+  g_chunk_store->users.lookup(chunk_store_key(chunk))++;
+}
+
+/** Remove a user from the stored buffer of a chunk, freeing the buffer when it has none left. */
+static void chunk_store_remove_user(const MemFileChunk *chunk)
+{
+  std::scoped_lock lock(g_chunk_store_mutex);
+  BLI_assert(g_chunk_store != nullptr);
+  MemFileChunkStoreStats &stats = g_chunk_store->stats;
+  stats.chunks_num--;
+  stats.chunks_size -= chunk->size;
+
+  const MemFileChunkKey key = chunk_store_key(chunk);
+  int64_t &users = g_chunk_store->users.lookup(key);
+  if (--users == 0) {
+    g_chunk_store->users.remove(key);
+    stats.buffers_num--;
+    stats.buffers_size -= chunk->size;
+    MEM_freeN((void *)chunk->buf);
+  }
+
+  if (g_chunk_store->users.is_empty()) {
+    MEM_delete(g_chunk_store);
+    g_chunk_store = nullptr;
+  }
+}
+
+void BLO_memfile_chunk_store_stats(MemFileChunkStoreStats *r_stats)
+{
+  std::scoped_lock lock(g_chunk_store_mutex);
+  if (g_chunk_store == nullptr) {
+    memset(r_stats, 0, sizeof(*r_stats));
+    return;
+  }
+  *r_stats = g_chunk_store->stats;
+}
+
+/** \} */
+
 /* **************** support for memory-write, for undo buffers *************** */
 
 void BLO_memfile_free(MemFile *memfile)
@@ -43,49 +166,22 @@ void BLO_memfile_free(MemFile *memfile)
   MemFileChunk *chunk;
 
   while ((chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks)))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    chunk_store_remove_user(chunk);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
+
+  LinkData *link;
+  while ((link = static_cast<LinkData *>(BLI_pophead(&memfile->deferred_data)))) {
+    BLO_deferred_data_free(static_cast<BLODeferredData *>(link->data));
+    MEM_freeN(link);
+  }
 }
 
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  for (MemFileChunk *sc = static_cast<MemFileChunk *>(second->chunks.first); sc != nullptr;
-       sc = static_cast<MemFileChunk *>(sc->next)) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
-    }
-  }
-
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = static_cast<MemFileChunk *>(first->chunks.first); fc != nullptr;
-       fc = static_cast<MemFileChunk *>(fc->next)) {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = static_cast<MemFileChunk *>(
-          BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf));
-      if (sc != nullptr) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
-    }
-  }
-
-  BLI_ghash_free(buffer_to_second_memchunk, nullptr, nullptr);
-
+  /* Chunk buffers still used by the second memfile are kept alive by the chunk store. */
+  UNUSED_VARS(second);
   BLO_memfile_free(first);
 }
 
@@ -134,9 +230,32 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
 {
+  using namespace blender;
+
   if (mem_data->id_session_uuid_mapping != nullptr) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, nullptr, nullptr);
   }
+
+  /* Chunks that differ from the previous step, their content may still be stored already. */
+  MemFile *memfile = mem_data->written_memfile;
+  Vector<MemFileChunk *> new_chunks;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (!chunk->is_identical) {
+      new_chunks.append(chunk);
+    }
+  }
+
+  threading::parallel_for(new_chunks.index_range(), 16, [&](const IndexRange range) {
+    for (MemFileChunk *chunk : new_chunks.as_span().slice(range)) {
+      chunk->hash = BLI_hash_mm2(reinterpret_cast<const uchar *>(chunk->buf), chunk->size, 0);
+    }
+  });
+
+  for (MemFileChunk *chunk : new_chunks) {
+    if (!chunk_store_add(chunk)) {
+      memfile->size -= chunk->size;
+    }
+  }
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
@@ -148,6 +267,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
       MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk"));
   curchunk->size = size;
   curchunk->buf = nullptr;
+  curchunk->hash = 0;
   curchunk->is_identical = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
@@ -162,14 +282,16 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
+        curchunk->hash = compchunk->hash;
         curchunk->is_identical = true;
+        chunk_store_add_user(curchunk);
         compchunk->is_identical_future = true;
       }
     }
     *compchunk_step = static_cast<MemFileChunk *>(compchunk->next);
   }
 
-  /* not equal... */
+  /* Not equal, the buffer is added to the chunk store in #BLO_memfile_write_finalize. */
   if (curchunk->buf == nullptr) {
     char *buf_new = static_cast<char *>(MEM_mallocN(size, "Chunk buffer"));
     memcpy(buf_new, buf, size);
@@ -199,18 +321,18 @@ struct Main *BLO_memfile_main_get(struct MemFile *memfile,
   return bmain_undo;
 }
 
-bool BLO_memfile_write_file(struct MemFile *memfile, const char *filepath)
+/**
+ * Open a file for writing memfile data, returns -1 on failure.
+ */
+static int memfile_file_open_for_write(const char *filepath)
 {
-  MemFileChunk *chunk;
-  int file, oflags;
-
   /* NOTE: This is currently used for autosave and 'quit.blend',
    * where _not_ following symlinks is OK,
    * however if this is ever executed explicitly by the user,
    * we may want to allow writing to symlinks.
    */
 
-  oflags = O_BINARY | O_WRONLY | O_CREAT | O_TRUNC;
+  int oflags = O_BINARY | O_WRONLY | O_CREAT | O_TRUNC;
 #ifdef O_NOFOLLOW
   /* use O_NOFOLLOW to avoid writing to a symlink - use 'O_EXCL' (CVE-2008-1103) */
   oflags |= O_NOFOLLOW;
@@ -220,24 +342,38 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filepath)
 #    warning "Symbolic links will be followed on undo save, possibly causing CVE-2008-1103"
 #  endif
 #endif
-  file = BLI_open(filepath, oflags, 0666);
+  const int file = BLI_open(filepath, oflags, 0666);
 
   if (file == -1) {
     fprintf(stderr,
             "Unable to save '%s': %s\n",
             filepath,
             errno ? strerror(errno) : "Unknown error opening file");
-    return false;
   }
+  return file;
+}
 
-  for (chunk = static_cast<MemFileChunk *>(memfile->chunks.first); chunk;
-       chunk = static_cast<MemFileChunk *>(chunk->next)) {
+static bool memfile_file_write(int file, const void *buf, size_t size)
+{
 #ifdef _WIN32
-    if (size_t(write(file, chunk->buf, uint(chunk->size))) != chunk->size)
+  return size_t(write(file, buf, uint(size))) == size;
 #else
-    if (size_t(write(file, chunk->buf, chunk->size)) != chunk->size)
+  return size_t(write(file, buf, size)) == size;
 #endif
-    {
+}
+
+bool BLO_memfile_write_file(struct MemFile *memfile, const char *filepath)
+{
+  MemFileChunk *chunk;
+
+  const int file = memfile_file_open_for_write(filepath);
+  if (file == -1) {
+    return false;
+  }
+
+  for (chunk = static_cast<MemFileChunk *>(memfile->chunks.first); chunk;
+       chunk = static_cast<MemFileChunk *>(chunk->next)) {
+    if (!memfile_file_write(file, chunk->buf, chunk->size)) {
       break;
     }
   }
@@ -254,6 +390,11 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filepath)
   return true;
 }
 
+bool BLO_memfile_has_deferred_data(const MemFile *memfile)
+{
+  return !BLI_listbase_is_empty(&memfile->deferred_data);
+}
+
 static ssize_t undo_read(FileReader *reader, void *buffer, size_t size)
 {
   UndoReader *undo = (UndoReader *)reader;
@@ -347,3 +488,225 @@ FileReader *BLO_memfile_new_filereader(MemFile *memfile, int undo_direction)
 
   return (FileReader *)undo;
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Delta Files
+ *
+ * A delta file stores a memfile relative to a base file written by #BLO_memfile_write_file.
+ * Chunks that are also part of the memfile of the base file are stored as a reference to their
+ * location in the base file, only the data of other chunks is written.
+ * \{ */
+
+#define MEMFILE_DELTA_MAGIC "BLENDDLT"
+/** #MemFileDeltaRecord.base_offset of records that are followed by their data. */
+#define MEMFILE_DELTA_NEW_DATA UINT64_MAX
+
+struct MemFileDeltaHeader {
+  char magic[8];
+  /**
+   * Size and hash of the base file contents, to detect that it doesn't match the delta file
+   * anymore, e.g. because it was saved again with the same size.
+   */
+  uint64_t base_size;
+  uint32_t base_hash;
+  uint32_t _pad;
+};
+
+struct MemFileDeltaRecord {
+  uint64_t base_offset;
+  uint64_t size;
+};
+
+/** Offset in the base file of every chunk buffer of the base memfile. */
+static blender::Map<const char *, uint64_t> memfile_delta_base_offsets(const MemFile *base_memfile,
+                                                                       uint64_t *r_base_size)
+{
+  blender::Map<const char *, uint64_t> offsets;
+  uint64_t offset = 0;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &base_memfile->chunks) {
+    offsets.add(chunk->buf, offset);
+    offset += chunk->size;
+  }
+  *r_base_size = offset;
+  return offsets;
+}
+
+/** Hash of the file contents, the same as the hash of the memfile the file was written from. */
+static uint32_t memfile_delta_base_hash(const MemFile *base_memfile)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &base_memfile->chunks) {
+    BLI_hash_mm2a_add(&mm2, reinterpret_cast<const uchar *>(chunk->buf), chunk->size);
+  }
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+static uint32_t memfile_delta_file_hash(const char *data, const size_t size)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add(&mm2, reinterpret_cast<const uchar *>(data), size);
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+void BLO_memfile_share(MemFile *memfile_dst, const MemFile *memfile_src)
+{
+  LISTBASE_FOREACH (const MemFileChunk *, chunk_src, &memfile_src->chunks) {
+    MemFileChunk *chunk = static_cast<MemFileChunk *>(MEM_dupallocN(chunk_src));
+    chunk->is_identical = true;
+    chunk_store_add_user(chunk);
+    BLI_addtail(&memfile_dst->chunks, chunk);
+  }
+  LISTBASE_FOREACH (const LinkData *, link, &memfile_src->deferred_data) {
+    BLODeferredData *deferred = static_cast<BLODeferredData *>(link->data);
+    BLO_deferred_data_user_add(deferred);
+    BLI_addtail(&memfile_dst->deferred_data, BLI_genericNodeN(deferred));
+  }
+}
+
+size_t BLO_memfile_delta_size(const MemFile *memfile,
+                              const MemFile *base_memfile,
+                              size_t *r_full_size)
+{
+  uint64_t base_size;
+  const blender::Map<const char *, uint64_t> base_offsets = memfile_delta_base_offsets(
+      base_memfile, &base_size);
+
+  size_t delta_size = 0;
+  size_t full_size = 0;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    if (!base_offsets.contains(chunk->buf)) {
+      delta_size += chunk->size;
+    }
+    full_size += chunk->size;
+  }
+  if (r_full_size) {
+    *r_full_size = full_size;
+  }
+  return delta_size;
+}
+
+bool BLO_memfile_write_file_delta(const MemFile *memfile,
+                                  const MemFile *base_memfile,
+                                  const char *filepath)
+{
+  MemFileDeltaHeader header;
+  memcpy(header.magic, MEMFILE_DELTA_MAGIC, sizeof(header.magic));
+  const blender::Map<const char *, uint64_t> base_offsets = memfile_delta_base_offsets(
+      base_memfile, &header.base_size);
+  header.base_hash = memfile_delta_base_hash(base_memfile);
+  header._pad = 0;
+
+  const int file = memfile_file_open_for_write(filepath);
+  if (file == -1) {
+    return false;
+  }
+  bool success = memfile_file_write(file, &header, sizeof(header));
+
+  /* Consecutive chunks of the base file are merged into a single record. */
+  MemFileDeltaRecord base_record = {0, 0};
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+    if (!success) {
+      break;
+    }
+    const uint64_t *base_offset = base_offsets.lookup_ptr(chunk->buf);
+    if (base_offset && base_record.size != 0 &&
+        base_record.base_offset + base_record.size == *base_offset)
+    {
+      base_record.size += chunk->size;
+      continue;
+    }
+    if (base_record.size != 0) {
+      success = memfile_file_write(file, &base_record, sizeof(base_record));
+      base_record.size = 0;
+    }
+    if (base_offset) {
+      base_record = {*base_offset, chunk->size};
+    }
+    else {
+      const MemFileDeltaRecord record = {MEMFILE_DELTA_NEW_DATA, chunk->size};
+      success = success && memfile_file_write(file, &record, sizeof(record)) &&
+                memfile_file_write(file, chunk->buf, chunk->size);
+    }
+  }
+  if (success && base_record.size != 0) {
+    success = memfile_file_write(file, &base_record, sizeof(base_record));
+  }
+
+  close(file);
+
+  if (!success) {
+    fprintf(stderr,
+            "Unable to save '%s': %s\n",
+            filepath,
+            errno ? strerror(errno) : "Unknown error writing file");
+  }
+  return success;
+}
+
+bool BLO_memfile_delta_apply(const char *filepath_base, const char *filepath_delta)
+{
+  size_t base_size, delta_size;
+  char *base = static_cast<char *>(BLI_file_read_binary_as_mem(filepath_base, 0, &base_size));
+  char *delta = static_cast<char *>(BLI_file_read_binary_as_mem(filepath_delta, 0, &delta_size));
+
+  bool success = base != nullptr && delta != nullptr;
+
+  MemFileDeltaHeader header;
+  if (success) {
+    success = delta_size >= sizeof(header);
+  }
+  if (success) {
+    memcpy(&header, delta, sizeof(header));
+    success = memcmp(header.magic, MEMFILE_DELTA_MAGIC, sizeof(header.magic)) == 0 &&
+              header.base_size == base_size &&
+              header.base_hash == memfile_delta_file_hash(base, base_size);
+  }
+
+  /* Write the result next to the base file first, so it stays intact in case of failure. */
+  char filepath_result[FILE_MAX];
+  BLI_snprintf(filepath_result, sizeof(filepath_result), "%s@", filepath_base);
+  const int file = success ? memfile_file_open_for_write(filepath_result) : -1;
+  success = success && file != -1;
+
+  size_t delta_offset = sizeof(header);
+  while (success && delta_offset < delta_size) {
+    MemFileDeltaRecord record;
+    if (delta_offset + sizeof(record) > delta_size) {
+      success = false;
+      break;
+    }
+    memcpy(&record, delta + delta_offset, sizeof(record));
+    delta_offset += sizeof(record);
+
+    if (record.base_offset == MEMFILE_DELTA_NEW_DATA) {
+      success = record.size <= delta_size - delta_offset &&
+                memfile_file_write(file, delta + delta_offset, size_t(record.size));
+      delta_offset += size_t(record.size);
+    }
+    else {
+      success = record.base_offset <= base_size && record.size <= base_size - record.base_offset &&
+                memfile_file_write(file, base + record.base_offset, size_t(record.size));
+    }
+  }
+
+  if (file != -1) {
+    close(file);
+  }
+  MEM_SAFE_FREE(base);
+  MEM_SAFE_FREE(delta);
+
+  if (success) {
+    success = BLI_rename(filepath_result, filepath_base) == 0;
+  }
+  else {
+    fprintf(stderr, "Unable to apply '%s' to '%s'\n", filepath_delta, filepath_base);
+    if (file != -1) {
+      BLI_delete(filepath_result, false, false);
+    }
+  }
+  return success;
+}
+
+/** \} */
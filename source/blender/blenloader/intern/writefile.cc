@@ -91,7 +91,10 @@
 #include "BLI_linklist.h"
 #include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_system.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_vector.hh"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
 #include "BKE_blender_version.h"
@@ -394,6 +397,20 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 /** \name Write Data Type & Functions
  * \{ */
 
+/**
+ * Data written by a single ID, stored to be passed on to the final #WriteData later.
+ * Used to write IDs in parallel, see #write_ids_parallel.
+ */
+struct WriteRecord {
+  /** All written bytes. */
+  blender::Vector<uchar> data;
+  /**
+   * Size of each #mywrite call, these are replayed in the same order,
+   * so the buffering and compression of the output is unaffected.
+   */
+  blender::Vector<size_t> sizes;
+};
+
 struct WriteData {
   const SDNA *sdna;
 
@@ -428,6 +445,9 @@ struct WriteData {
    * Will be nullptr for UNDO.
    */
   WriteWrap *ww;
+
+  /** When set, all writes are stored here instead, see #WriteRecord. */
+  WriteRecord *record;
 };
 
 struct BlendWriter {
@@ -457,6 +477,19 @@ static WriteData *writedata_new(WriteWrap *ww)
   return wd;
 }
 
+/**
+ * Create write data that stores everything that is written in `record`,
+ * used to write data in a thread while `wd` is being written to.
+ */
+static WriteData *writedata_new_for_record(const WriteData *wd, WriteRecord *record)
+{
+  BLI_assert(!wd->use_memfile);
+  WriteData *wd_record = static_cast<WriteData *>(MEM_callocN(sizeof(*wd_record), __func__));
+  wd_record->sdna = wd->sdna;
+  wd_record->record = record;
+  return wd_record;
+}
+
 static void writedata_do_write(WriteData *wd, const void *mem, size_t memlen)
 {
   if ((wd == nullptr) || wd->error || (mem == nullptr) || memlen < 1) {
@@ -525,6 +558,12 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
     return;
   }
 
+  if (wd->record != nullptr) {
+    wd->record->data.extend(static_cast<const uchar *>(adr), int64_t(len));
+    wd->record->sizes.append(len);
+    return;
+  }
+
 #ifdef USE_WRITE_DATA_LEN
   wd->write_len += len;
 #endif
@@ -563,6 +602,18 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
   }
 }
 
+/**
+ * Write data stored by #writedata_new_for_record.
+ */
+static void mywrite_record(WriteData *wd, const WriteRecord *record)
+{
+  const uchar *data = record->data.data();
+  for (const size_t size : record->sizes) {
+    mywrite(wd, data, size);
+    data += size;
+  }
+}
+
 /**
  * BeGiN initializer for mywrite
  * \param ww: File write wrapper.
@@ -721,6 +772,34 @@ static void writedata(WriteData *wd, int filecode, size_t len, const void *adr)
   mywrite(wd, adr, len);
 }
 
+/**
+ * Like #writedata, but writes `data` while storing `adr` as its address, which has to match
+ * the pointer written in the struct that references the data.
+ */
+static void writedata_at_address(WriteData *wd,
+                                 int filecode,
+                                 size_t len,
+                                 const void *adr,
+                                 const void *data)
+{
+  BHead bh;
+
+  if (adr == nullptr || data == nullptr || len == 0) {
+    return;
+  }
+
+  BLI_assert(len % 4 == 0 && len <= INT_MAX);
+
+  bh.code = filecode;
+  bh.old = adr;
+  bh.nr = 1;
+  bh.SDNAnr = 0;
+  bh.len = int(len);
+
+  mywrite(wd, &bh, sizeof(BHead));
+  mywrite(wd, data, len);
+}
+
 /* use this to force writing of lists in same order as reading (using link_list) */
 static void writelist_nr(WriteData *wd, int filecode, const int struct_nr, const ListBase *lb)
 {
@@ -1112,6 +1191,158 @@ static int write_id_direct_linked_data_process_cb(LibraryIDLinkCallbackData *cb_
   return IDWALK_RET_NOP;
 }
 
+/**
+ * IDs that are only written for undo steps.
+ */
+static bool write_id_skip(const WriteData *wd, const ID *id)
+{
+  if (wd->use_memfile) {
+    return false;
+  }
+  /* We only write unused IDs in undo case.
+   * NOTE: All Scenes, WindowManagers and WorkSpaces should always be written to disk, so
+   * their user-count should never be zero currently. */
+  if (id->us == 0) {
+    BLI_assert(!ELEM(GS(id->name), ID_SCE, ID_WM, ID_WS));
+    return true;
+  }
+  if ((id->tag & LIB_TAG_RUNTIME) != 0) {
+    /* Runtime IDs are never written to .blend files, and they should not influence
+     * (in)direct status of linked IDs they may use. */
+    return true;
+  }
+  return false;
+}
+
+static bool write_id_is_override(const Main *bmain,
+                                 const ID *id,
+                                 const OverrideLibraryStorage *override_storage)
+{
+  return !ELEM(override_storage, nullptr, bmain) && ID_IS_OVERRIDE_LIBRARY_REAL(id);
+}
+
+#define ID_BUFFER_STATIC_SIZE 8192
+
+/**
+ * Write a single ID, `id_buffer` is used for a temporary copy of the ID struct
+ * and must be large enough for the ID type.
+ */
+static void write_id(WriteData *wd, ID *id, const IDTypeInfo *id_type, void *id_buffer)
+{
+  BlendWriter writer = {wd};
+
+  memcpy(id_buffer, id, id_type->struct_size);
+
+  /* Clear runtime data to reduce false detection of changed data in undo/redo context. */
+  if (wd->use_memfile) {
+    ((ID *)id_buffer)->tag &= LIB_TAG_KEEP_ON_UNDO;
+  }
+  else {
+    ((ID *)id_buffer)->tag = 0;
+  }
+  ((ID *)id_buffer)->us = 0;
+  ((ID *)id_buffer)->icon_id = 0;
+  /* Those listbase data change every time we add/remove an ID, and also often when
+   * renaming one (due to re-sorting). This avoids generating a lot of false 'is changed'
+   * detections between undo steps. */
+  ((ID *)id_buffer)->prev = nullptr;
+  ((ID *)id_buffer)->next = nullptr;
+  /* Those runtime pointers should never be set during writing stage, but just in case clear
+   * them too. */
+  ((ID *)id_buffer)->orig_id = nullptr;
+  ((ID *)id_buffer)->newid = nullptr;
+  /* Even though in theory we could be able to preserve this python instance across undo even
+   * when we need to re-read the ID into its original address, this is currently cleared in
+   * #direct_link_id_common in `readfile.c` anyway, */
+  ((ID *)id_buffer)->py_instance = nullptr;
+
+  if (id_type->blend_write != nullptr) {
+    id_type->blend_write(&writer, (ID *)id_buffer, id);
+  }
+}
+
+/**
+ * Whether the IDs of this type can be written in parallel by #write_ids_parallel.
+ */
+static bool write_ids_parallel_supported(const WriteData *wd, const IDTypeInfo *id_type)
+{
+  if (wd->use_memfile) {
+    /* Undo steps rely on writing IDs one by one to share unchanged memory chunks. */
+    return false;
+  }
+  if (ELEM(id_type->id_code, ID_WM, ID_SCR, ID_WS, ID_SCE)) {
+    /* These are few and cheap to write,
+     * while their writing code updates UI and view-layer data shared with other IDs. */
+    return false;
+  }
+  return BLI_system_thread_count() > 1;
+}
+
+/**
+ * Write all IDs of a list, serializing them in parallel in batches.
+ *
+ * Each ID of a batch is written to its own #WriteRecord, which are then written out in the order
+ * of the list. The resulting file is the same as when writing the IDs one after another. Only
+ * addresses of temporary buffers created while writing can differ, which are never stable anyway.
+ */
+static void write_ids_parallel(WriteData *wd,
+                               Main *bmain,
+                               ListBase *lb,
+                               const IDTypeInfo *id_type,
+                               OverrideLibraryStorage *override_storage)
+{
+  using namespace blender;
+
+  Vector<ID *> ids;
+  LISTBASE_FOREACH (ID *, id, lb) {
+    BLI_assert(
+        (id->tag & (LIB_TAG_NO_MAIN | LIB_TAG_NO_USER_REFCOUNT | LIB_TAG_NOT_ALLOCATED)) == 0);
+    if (write_id_skip(wd, id)) {
+      continue;
+    }
+    /* This modifies the linked IDs, so it is done here rather than in parallel below. */
+    BKE_library_foreach_ID_link(
+        bmain, id, write_id_direct_linked_data_process_cb, nullptr, IDWALK_READONLY);
+    ids.append(id);
+  }
+
+  /* Limit the number of IDs whose data is kept in memory at the same time. */
+  const int64_t batch_size = BLI_system_thread_count();
+
+  for (int64_t batch_start = 0; batch_start < ids.size(); batch_start += batch_size) {
+    const Span<ID *> batch_ids = ids.as_span().slice(
+        batch_start, std::min(batch_size, ids.size() - batch_start));
+    Array<WriteRecord> records(batch_ids.size());
+
+    threading::parallel_for(batch_ids.index_range(), 1, [&](const IndexRange range) {
+      Vector<char, ID_BUFFER_STATIC_SIZE> id_buffer(id_type->struct_size);
+      for (const int64_t i : range) {
+        ID *id = batch_ids[i];
+        if (write_id_is_override(bmain, id, override_storage)) {
+          /* Written below, storing override operations modifies the ID. */
+          continue;
+        }
+        WriteData *wd_record = writedata_new_for_record(wd, &records[i]);
+        write_id(wd_record, id, id_type, id_buffer.data());
+        writedata_free(wd_record);
+      }
+    });
+
+    for (const int64_t i : batch_ids.index_range()) {
+      ID *id = batch_ids[i];
+      if (write_id_is_override(bmain, id, override_storage)) {
+        Vector<char, ID_BUFFER_STATIC_SIZE> id_buffer(id_type->struct_size);
+        BKE_lib_override_library_operations_store_start(bmain, override_storage, id);
+        write_id(wd, id, id_type, id_buffer.data());
+        BKE_lib_override_library_operations_store_end(override_storage, id);
+      }
+      else {
+        mywrite_record(wd, &records[i]);
+      }
+    }
+  }
+}
+
 /* if MemFile * there's filesave to memory */
 static bool write_file_handle(Main *mainvar,
                               WriteWrap *ww,
@@ -1183,7 +1414,6 @@ static bool write_file_handle(Main *mainvar,
                                                  nullptr :
                                                  BKE_lib_override_library_operations_store_init();
 
-#define ID_BUFFER_STATIC_SIZE 8192
   /* This outer loop allows to save first data-blocks from real mainvar,
    * then the temp ones from override process,
    * if needed, without duplicating whole code. */
@@ -1198,9 +1428,15 @@ static bool write_file_handle(Main *mainvar,
         continue; /* Libraries are handled separately below. */
       }
 
+      const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
+      if (write_ids_parallel_supported(wd, id_type)) {
+        write_ids_parallel(wd, bmain, lbarray[a], id_type, override_storage);
+        mywrite_flush(wd);
+        continue;
+      }
+
       char id_buffer_static[ID_BUFFER_STATIC_SIZE];
       void *id_buffer = id_buffer_static;
-      const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
       const size_t idtype_struct_size = id_type->struct_size;
       if (idtype_struct_size > ID_BUFFER_STATIC_SIZE) {
         CLOG_ERROR(&LOG,
@@ -1218,22 +1454,11 @@ static bool write_file_handle(Main *mainvar,
         BLI_assert(
             (id->tag & (LIB_TAG_NO_MAIN | LIB_TAG_NO_USER_REFCOUNT | LIB_TAG_NOT_ALLOCATED)) == 0);
 
-        /* We only write unused IDs in undo case.
-         * NOTE: All Scenes, WindowManagers and WorkSpaces should always be written to disk, so
-         * their user-count should never be zero currently. */
-        if (id->us == 0 && !wd->use_memfile) {
-          BLI_assert(!ELEM(GS(id->name), ID_SCE, ID_WM, ID_WS));
-          continue;
-        }
-
-        if ((id->tag & LIB_TAG_RUNTIME) != 0 && !wd->use_memfile) {
-          /* Runtime IDs are never written to .blend files, and they should not influence
-           * (in)direct status of linked IDs they may use. */
+        if (write_id_skip(wd, id)) {
           continue;
         }
 
-        const bool do_override = !ELEM(override_storage, nullptr, bmain) &&
-                                 ID_IS_OVERRIDE_LIBRARY_REAL(id);
+        const bool do_override = write_id_is_override(bmain, id, override_storage);
 
         /* If not writing undo data, properly set directly linked IDs as `LIB_TAG_EXTERN`. */
         if (!wd->use_memfile) {
@@ -1269,34 +1494,7 @@ static bool write_file_handle(Main *mainvar,
 
         mywrite_id_begin(wd, id);
 
-        memcpy(id_buffer, id, idtype_struct_size);
-
-        /* Clear runtime data to reduce false detection of changed data in undo/redo context. */
-        if (wd->use_memfile) {
-          ((ID *)id_buffer)->tag &= LIB_TAG_KEEP_ON_UNDO;
-        }
-        else {
-          ((ID *)id_buffer)->tag = 0;
-        }
-        ((ID *)id_buffer)->us = 0;
-        ((ID *)id_buffer)->icon_id = 0;
-        /* Those listbase data change every time we add/remove an ID, and also often when
-         * renaming one (due to re-sorting). This avoids generating a lot of false 'is changed'
-         * detections between undo steps. */
-        ((ID *)id_buffer)->prev = nullptr;
-        ((ID *)id_buffer)->next = nullptr;
-        /* Those runtime pointers should never be set during writing stage, but just in case clear
-         * them too. */
-        ((ID *)id_buffer)->orig_id = nullptr;
-        ((ID *)id_buffer)->newid = nullptr;
-        /* Even though in theory we could be able to preserve this python instance across undo even
-         * when we need to re-read the ID into its original address, this is currently cleared in
-         * #direct_link_id_common in `readfile.c` anyway, */
-        ((ID *)id_buffer)->py_instance = nullptr;
-
-        if (id_type->blend_write != nullptr) {
-          id_type->blend_write(&writer, (ID *)id_buffer, id);
-        }
+        write_id(wd, id, id_type, id_buffer);
 
         if (do_override) {
           BKE_lib_override_library_operations_store_end(override_storage, id);
@@ -1535,6 +1733,9 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* file save to temporary file was successful */
+  /* Packed data that wasn't loaded from the file yet must stay available when it's replaced. */
+  BLO_deferred_data_preserve(filepath);
+
   /* now do reverse file history (move .blend1 -> .blend2, .blend -> .blend1) */
   if (use_save_versions) {
     const bool err_hist = do_history(filepath, reports);
@@ -1691,6 +1892,23 @@ void BLO_write_string(BlendWriter *writer, const char *data_ptr)
   }
 }
 
+void BLO_write_deferred_data(BlendWriter *writer, BLODeferredData *deferred)
+{
+  WriteData *wd = writer->wd;
+  /* Runtime data is cleared, so unchanged undo steps are still identical. */
+  BLODeferredData deferred_write = *deferred;
+  deferred_write.next = deferred_write.prev = nullptr;
+  deferred_write.users = 0;
+  deferred_write.data = nullptr;
+  writedata_at_address(wd, DATA, sizeof(deferred_write), deferred, &deferred_write);
+
+  if (wd->use_memfile) {
+    /* The undo step needs the data to still be available when it's loaded. */
+    BLO_deferred_data_user_add(deferred);
+    BLI_addtail(&wd->mem.written_memfile->deferred_data, BLI_genericNodeN(deferred));
+  }
+}
+
 bool BLO_write_is_undo(BlendWriter *writer)
 {
   return writer->wd->use_memfile;
@@ -2,6 +2,30 @@
  * Copyright 2019 Blender Foundation. */
 #include "blendfile_loading_base_test.h"
 
+#include <algorithm>
+
+#include "BLI_fileops.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_path_util.h"
+#include "BLI_tempfile.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_attribute_compression.hh"
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_packedFile.h"
+
+#include "BLO_readfile.h"
+#include "BLO_undofile.h"
+#include "BLO_writefile.h"
+
+#include "DNA_image_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_packedFile_types.h"
+
 class BlendfileLoadingTest : public BlendfileLoadingBaseTest {
 };
 
@@ -14,3 +38,122 @@ TEST_F(BlendfileLoadingTest, CanaryTest)
   depsgraph_create(DAG_EVAL_RENDER);
   EXPECT_NE(nullptr, this->depsgraph);
 }
+
+TEST_F(BlendfileLoadingTest, CompressedAttributeRoundtrip)
+{
+  using namespace blender;
+  char temp_dir[FILE_MAX], filepath[FILE_MAX];
+  BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+  BLI_path_join(filepath, sizeof(filepath), temp_dir, "compressed_attribute_test.blend");
+
+  Main *bmain = BKE_main_new();
+  Mesh *mesh = BKE_mesh_add(bmain, "Mesh");
+  mesh->totvert = 3;
+  CustomData_add_layer_named(&mesh->vdata, CD_PROP_FLOAT3, CD_SET_DEFAULT, 3, "position");
+  float3 *offsets = static_cast<float3 *>(
+      CustomData_add_layer_named(&mesh->vdata, CD_PROP_FLOAT3, CD_SET_DEFAULT, 3, "offset"));
+  offsets[1] = float3(1.0f, 2.0f, 3.0f);
+  ASSERT_TRUE(bke::compress_attribute(mesh->vdata, "offset", CD_PROP_FLOAT3_HALF, 3));
+
+  const BlendFileWriteParams params{};
+  ASSERT_TRUE(BLO_write_file(bmain, filepath, 0, &params, nullptr));
+  BKE_main_free(bmain);
+
+  BlendFileReadReport reports = {nullptr};
+  bfile = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, &reports);
+  BLI_delete(filepath, false, false);
+  ASSERT_NE(bfile, nullptr);
+
+  const Mesh *mesh_read = static_cast<const Mesh *>(bfile->main->meshes.first);
+  ASSERT_NE(mesh_read, nullptr);
+  const void *data = CustomData_get_layer_named(
+      &mesh_read->vdata, CD_PROP_FLOAT3_HALF, "offset");
+  ASSERT_NE(data, nullptr);
+  const VArray<float3> values = bke::compressed_layer_to_varray(CD_PROP_FLOAT3_HALF, data, 3)
+                                    .typed<float3>();
+  EXPECT_EQ(values[0], float3(0.0f));
+  EXPECT_EQ(values[1], float3(1.0f, 2.0f, 3.0f));
+}
+
+/** Check that the first image in `bmain` has a packed file with all bytes set to `value`. */
+static void expect_image_packed_data(Main *bmain, const int size, const char value)
+{
+  const Image *image = static_cast<const Image *>(bmain->images.first);
+  ASSERT_NE(image, nullptr);
+  const ImagePackedFile *imapf = static_cast<const ImagePackedFile *>(image->packedfiles.first);
+  ASSERT_NE(imapf, nullptr);
+  ASSERT_NE(imapf->packedfile, nullptr);
+  PackedFile *pf = imapf->packedfile;
+  ASSERT_EQ(pf->size, size);
+  EXPECT_TRUE(BKE_packedfile_ensure_data(pf));
+  const char *data = static_cast<const char *>(pf->data);
+  EXPECT_TRUE(std::all_of(data, data + size, [&](const char c) { return c == value; }));
+}
+
+TEST_F(BlendfileLoadingTest, DeferredPackedDataUndoAfterSaveOver)
+{
+  char temp_dir[FILE_MAX], filepath[FILE_MAX], filepath_autosave[FILE_MAX];
+  BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+  BLI_path_join(filepath, sizeof(filepath), temp_dir, "deferred_packed_data_test.blend");
+  BLI_path_join(
+      filepath_autosave, sizeof(filepath_autosave), temp_dir, "packed_data_autosave.blend");
+
+  /* Large enough for the reading to be deferred. */
+  const int size = 1 << 20;
+  Main *bmain = BKE_main_new();
+  Image *image = static_cast<Image *>(BKE_id_new(bmain, ID_IM, "Image"));
+  void *data = MEM_mallocN(size, __func__);
+  memset(data, 7, size);
+  ImagePackedFile *imapf = MEM_cnew<ImagePackedFile>(__func__);
+  imapf->packedfile = BKE_packedfile_new_from_memory(data, size);
+  BLI_addtail(&image->packedfiles, imapf);
+
+  const BlendFileWriteParams params{};
+  ASSERT_TRUE(BLO_write_file(bmain, filepath, 0, &params, nullptr));
+  BKE_main_free(bmain);
+
+  BlendFileReadReport reports = {nullptr};
+  bfile = BLO_read_from_file(filepath, BLO_READ_DEFER_PACKED_DATA, &reports);
+  ASSERT_NE(bfile, nullptr);
+
+  /* Store an undo step, then save over the file the packed data was deferred from.
+   * Neither of them has to load the data. */
+  const PackedFile *pf = static_cast<ImagePackedFile *>(
+                             static_cast<Image *>(bfile->main->images.first)->packedfiles.first)
+                             ->packedfile;
+  MemFile memfile = {{nullptr}};
+  ASSERT_TRUE(BLO_write_file_mem(bfile->main, nullptr, &memfile, 0));
+  EXPECT_TRUE(BLO_memfile_has_deferred_data(&memfile));
+  BKE_id_new(bfile->main, ID_IM, "Other");
+  ASSERT_TRUE(BLO_write_file(bfile->main, filepath, 0, &params, nullptr));
+  EXPECT_EQ(pf->data, nullptr);
+
+  /* Undo. */
+  BlendFileReadParams read_params{};
+  read_params.skip_flags = BLO_READ_SKIP_UNDO_OLD_MAIN;
+  Main *oldmain = BKE_main_new();
+  BlendFileData *bfile_undo = BLO_read_from_memfile(
+      oldmain, filepath, &memfile, &read_params, nullptr);
+  BKE_main_free(oldmain);
+  ASSERT_NE(bfile_undo, nullptr);
+  expect_image_packed_data(bfile_undo->main, size, 7);
+  BLO_blendfiledata_free(bfile_undo);
+
+  /* Recover an auto-save written from the undo step. */
+  ASSERT_TRUE(BLO_memfile_write_file(&memfile, filepath_autosave));
+  BlendFileData *bfile_autosave = BLO_read_from_file(
+      filepath_autosave, BLO_READ_SKIP_NONE, &reports);
+  ASSERT_NE(bfile_autosave, nullptr);
+  expect_image_packed_data(bfile_autosave->main, size, 7);
+  BLO_blendfiledata_free(bfile_autosave);
+
+  /* The saved file contains the data as well. */
+  BlendFileData *bfile_saved = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, &reports);
+  ASSERT_NE(bfile_saved, nullptr);
+  expect_image_packed_data(bfile_saved->main, size, 7);
+  BLO_blendfiledata_free(bfile_saved);
+
+  BLO_memfile_free(&memfile);
+  BLI_delete(filepath, false, false);
+  BLI_delete(filepath_autosave, false, false);
+}
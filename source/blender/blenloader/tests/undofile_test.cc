@@ -0,0 +1,144 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <string>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_span.hh"
+#include "BLI_tempfile.h"
+
+#include "BLO_undofile.h"
+
+namespace blender::blenloader::tests {
+
+static void memfile_write(MemFile *memfile, MemFile *reference, Span<std::string> chunks)
+{
+  MemFileWriteData mem_data = {nullptr};
+  BLO_memfile_write_init(&mem_data, memfile, reference);
+  for (const std::string &chunk : chunks) {
+    BLO_memfile_chunk_add(&mem_data, chunk.data(), chunk.size());
+  }
+  BLO_memfile_write_finalize(&mem_data);
+}
+
+static MemFileChunk *memfile_chunk(MemFile *memfile, const int index)
+{
+  return static_cast<MemFileChunk *>(BLI_findlink(&memfile->chunks, index));
+}
+
+TEST(undofile, ChunkStoreShareIdentical)
+{
+  const std::string a(1000, 'a');
+  const std::string b(2000, 'b');
+  const std::string c(4000, 'c');
+
+  MemFile memfile_1 = {{nullptr}};
+  memfile_write(&memfile_1, nullptr, {a, b, a});
+  /* The same data within one memfile is only stored once. */
+  EXPECT_EQ(memfile_1.size, a.size() + b.size());
+  EXPECT_EQ(memfile_chunk(&memfile_1, 0)->buf, memfile_chunk(&memfile_1, 2)->buf);
+
+  /* Reordered data is still shared with the previous step. */
+  MemFile memfile_2 = {{nullptr}};
+  memfile_write(&memfile_2, &memfile_1, {b, c, a});
+  EXPECT_EQ(memfile_2.size, c.size());
+  EXPECT_EQ(memfile_chunk(&memfile_2, 0)->buf, memfile_chunk(&memfile_1, 1)->buf);
+  EXPECT_EQ(memfile_chunk(&memfile_2, 2)->buf, memfile_chunk(&memfile_1, 2)->buf);
+  /* Only chunks at the same position are considered unchanged for undo. */
+  EXPECT_FALSE(memfile_chunk(&memfile_2, 0)->is_identical);
+  EXPECT_TRUE(memfile_chunk(&memfile_2, 2)->is_identical);
+
+  MemFileChunkStoreStats stats;
+  BLO_memfile_chunk_store_stats(&stats);
+  EXPECT_EQ(stats.buffers_num, 3);
+  EXPECT_EQ(stats.buffers_size, a.size() + b.size() + c.size());
+  EXPECT_EQ(stats.chunks_num, 6);
+  EXPECT_EQ(stats.chunks_size, 3 * a.size() + 2 * b.size() + c.size());
+
+  /* Buffers used by later steps stay valid when freeing earlier ones. */
+  BLO_memfile_merge(&memfile_1, &memfile_2);
+  EXPECT_EQ(std::string(memfile_chunk(&memfile_2, 0)->buf, b.size()), b);
+  EXPECT_EQ(std::string(memfile_chunk(&memfile_2, 2)->buf, a.size()), a);
+
+  BLO_memfile_chunk_store_stats(&stats);
+  EXPECT_EQ(stats.buffers_num, 3);
+  EXPECT_EQ(stats.chunks_num, 3);
+
+  BLO_memfile_free(&memfile_2);
+  BLO_memfile_chunk_store_stats(&stats);
+  EXPECT_EQ(stats.buffers_num, 0);
+  EXPECT_EQ(stats.buffers_size, 0);
+  EXPECT_EQ(stats.chunks_num, 0);
+}
+
+static std::string file_read(const char *filepath)
+{
+  size_t size;
+  char *data = static_cast<char *>(BLI_file_read_binary_as_mem(filepath, 0, &size));
+  std::string result(data, size);
+  MEM_freeN(data);
+  return result;
+}
+
+TEST(undofile, DeltaFile)
+{
+  const std::string a(1000, 'a');
+  const std::string b(2000, 'b');
+  const std::string c(4000, 'c');
+
+  char temp_dir[FILE_MAX];
+  BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+  char filepath_base[FILE_MAX], filepath_delta[FILE_MAX], filepath_full[FILE_MAX];
+  char filepath_other[FILE_MAX];
+  BLI_path_join(filepath_base, sizeof(filepath_base), temp_dir, "undofile_test_base.blend");
+  BLI_path_join(filepath_other, sizeof(filepath_other), temp_dir, "undofile_test_other.blend");
+  BLI_path_join(filepath_delta, sizeof(filepath_delta), temp_dir, "undofile_test.delta");
+  BLI_path_join(filepath_full, sizeof(filepath_full), temp_dir, "undofile_test_full.blend");
+
+  MemFile memfile_1 = {{nullptr}};
+  memfile_write(&memfile_1, nullptr, {a, b, c});
+  ASSERT_TRUE(BLO_memfile_write_file(&memfile_1, filepath_base));
+
+  MemFile memfile_base = {{nullptr}};
+  BLO_memfile_share(&memfile_base, &memfile_1);
+  BLO_memfile_free(&memfile_1);
+
+  MemFile memfile_2 = {{nullptr}};
+  memfile_write(&memfile_2, &memfile_base, {a, b, std::string(100, 'd'), c, a});
+  size_t full_size;
+  EXPECT_EQ(BLO_memfile_delta_size(&memfile_2, &memfile_base, &full_size), 100);
+  EXPECT_EQ(full_size, 2 * a.size() + b.size() + c.size() + 100);
+
+  ASSERT_TRUE(BLO_memfile_write_file_delta(&memfile_2, &memfile_base, filepath_delta));
+  ASSERT_TRUE(BLO_memfile_write_file(&memfile_2, filepath_full));
+
+  /* A different base file with the same size is detected by its contents. */
+  MemFile memfile_other = {{nullptr}};
+  memfile_write(&memfile_other, nullptr, {a, b, std::string(c.size(), 'e')});
+  ASSERT_TRUE(BLO_memfile_write_file(&memfile_other, filepath_other));
+  const std::string other_contents = file_read(filepath_other);
+  EXPECT_FALSE(BLO_memfile_delta_apply(filepath_other, filepath_delta));
+  EXPECT_EQ(file_read(filepath_other), other_contents);
+  BLO_memfile_free(&memfile_other);
+
+  EXPECT_TRUE(BLO_memfile_delta_apply(filepath_base, filepath_delta));
+  EXPECT_EQ(file_read(filepath_base), file_read(filepath_full));
+
+  /* The delta doesn't match the base file anymore. */
+  EXPECT_FALSE(BLO_memfile_delta_apply(filepath_base, filepath_delta));
+  EXPECT_EQ(file_read(filepath_base), file_read(filepath_full));
+
+  BLO_memfile_free(&memfile_base);
+  BLO_memfile_free(&memfile_2);
+  BLI_delete(filepath_base, false, false);
+  BLI_delete(filepath_delta, false, false);
+  BLI_delete(filepath_full, false, false);
+  BLI_delete(filepath_other, false, false);
+}
+
+}  // namespace blender::blenloader::tests
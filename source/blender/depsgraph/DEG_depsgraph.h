@@ -187,6 +187,30 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float frame);
  */
 void DEG_evaluate_on_refresh(Depsgraph *graph);
 
+typedef void (*DEG_FrameEvaluatedFn)(Depsgraph *graph, float frame, void *user_data);
+
+/**
+ * Evaluate a sequence of frames with multiple dependency graphs at the same time, for exporters
+ * and baking which step through frames without user interaction.
+ *
+ * The frames are evaluated in batches of one frame per graph, so memory usage is bounded by the
+ * number of graphs. After every batch `frame_fn` is called on the calling thread for each frame of
+ * the batch, in the order of `frames`, with the graph which is evaluated for that frame. Evaluated
+ * data must not be accessed after `frame_fn` returns, since the graph is used for other frames.
+ *
+ * The graphs are expected to be built the same way, to not be active, and to not be evaluated
+ * by anything else meanwhile.
+ *
+ * \note Simulations depend on the evaluation of the previous frame and should not be evaluated
+ * this way.
+ */
+void DEG_evaluate_frames_parallel(Depsgraph **graphs,
+                                  int graphs_num,
+                                  const float *frames,
+                                  int frames_num,
+                                  DEG_FrameEvaluatedFn frame_fn,
+                                  void *user_data);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
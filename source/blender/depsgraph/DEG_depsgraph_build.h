@@ -70,6 +70,17 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /** Tag all relations in the database for update. */
 void DEG_relations_tag_update(struct Main *bmain);
 
+/**
+ * Tag relations for update in the graphs that contain the given ID, when only the relations of
+ * that ID changed (e.g. a modifier or constraint was added to an object or got a new target).
+ * Graphs that don't contain the ID can't depend on its relations and aren't rebuilt.
+ *
+ * \note This only avoids work when there are multiple graphs, e.g. for other view layers or
+ * scenes. Graphs that contain the ID are still rebuilt entirely, like with
+ * #DEG_relations_tag_update, there is no incremental rebuild of the relations of a single ID.
+ */
+void DEG_id_tag_relations_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /**
@@ -42,6 +42,13 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+/**
+ * Fraction of the available thread time which was spent evaluating operations during the last
+ * evaluation of the graph. Low values mean that the graph does not have enough independent
+ * operations to keep all threads busy.
+ */
+float DEG_debug_evaluation_occupancy_get(const struct Depsgraph *graph);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
@@ -157,6 +157,9 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
   deg_graph_flush_visibility_flags(graph);
   deg_graph_remove_unused_noops(graph);
 
+  /* Operation nodes are re-created, so their critical paths are to be calculated again. */
+  graph->critical_path_update_countdown = 0;
+
   /* Re-tag IDs for update if it was tagged before the relations
    * update tag. */
   for (IDNode *id_node : graph->id_nodes) {
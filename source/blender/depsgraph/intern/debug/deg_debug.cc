@@ -19,7 +19,10 @@
 namespace blender::deg {
 
 DepsgraphDebug::DepsgraphDebug()
-    : flags(G.debug), is_ever_evaluated(false), graph_evaluation_start_time_(0)
+    : flags(G.debug),
+      is_ever_evaluated(false),
+      evaluation_occupancy(0.0f),
+      graph_evaluation_start_time_(0)
 {
 }
 
@@ -52,6 +55,7 @@ void DepsgraphDebug::end_graph_evaluation()
   const double graph_eval_end_time = PIL_check_seconds_timer();
   printf("Depsgraph updated in %f seconds.\n", graph_eval_end_time - graph_evaluation_start_time_);
   printf("Depsgraph evaluation FPS: %f\n", 1.0f / fps_samples_.get_averaged());
+  printf("Depsgraph thread occupancy: %.1f%%\n", evaluation_occupancy * 100.0f);
 
   is_ever_evaluated = true;
 }
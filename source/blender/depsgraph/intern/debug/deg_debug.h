@@ -36,6 +36,10 @@ class DepsgraphDebug {
    * This is NOT an indication that depsgraph is at its evaluated state. */
   bool is_ever_evaluated;
 
+  /* Fraction of the available thread time which was spent evaluating operations during the last
+   * graph evaluation. */
+  float evaluation_occupancy;
+
  protected:
   /* Maximum number of counters used to calculate frame rate of depsgraph update. */
   static const constexpr int MAX_FPS_COUNTERS = 64;
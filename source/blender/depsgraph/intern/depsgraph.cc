@@ -50,6 +50,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       need_update_nodes_visibility(true),
       need_tag_id_on_graph_visibility_update(true),
       need_tag_id_on_graph_visibility_time_update(false),
+      critical_path_update_countdown(0),
       bmain(bmain),
       scene(scene),
       view_layer(view_layer),
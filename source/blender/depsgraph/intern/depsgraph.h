@@ -108,6 +108,10 @@ struct Depsgraph {
   /* Indicates type of IDs present in the depsgraph. */
   char id_type_exist[INDEX_ID_MAX];
 
+  /* Number of evaluations left until the critical path times of operations are updated from their
+   * averaged evaluation times. Is reset when relations are rebuilt. */
+  int critical_path_update_countdown;
+
   /* Quick-Access Temp Data ............. */
 
   /* Nodes which have been tagged as "directly modified". */
@@ -23,6 +23,7 @@
 #include "DNA_simulation_types.h"
 
 #include "BKE_collection.h"
+#include "BKE_global.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
 
@@ -305,3 +306,39 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  /* Only whole graphs are skipped, a graph containing the ID is rebuilt from scratch the same way
+   * as for #DEG_relations_tag_update. Building the nodes and relations of a single ID in place is
+   * not reliable, because the builders have side effects on other IDs (custom data masks, special
+   * evaluation flags, copy-on-write and driver relations, visibility). */
+#ifndef NDEBUG
+  blender::Vector<deg::Depsgraph *> skipped_graphs;
+#endif
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    /* A graph that starts to depend on the ID gets that dependency from another ID whose relations
+     * change, which tags the graph for update already. */
+    if (depsgraph->find_id_node(id) != nullptr) {
+      DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
+    }
+#ifndef NDEBUG
+    else if (depsgraph->is_active && !depsgraph->need_update_relations) {
+      skipped_graphs.append(depsgraph);
+    }
+#endif
+  }
+#ifndef NDEBUG
+  /* Check that skipping the graphs is correct by comparing them with a full rebuild. This is done
+   * after the loop above, since building the temporary graphs changes the registry. */
+  if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+    for (deg::Depsgraph *depsgraph : skipped_graphs) {
+      DEG_debug_graph_relations_validate(reinterpret_cast<Depsgraph *>(depsgraph),
+                                         bmain,
+                                         depsgraph->scene,
+                                         depsgraph->view_layer);
+    }
+  }
+#endif
+}
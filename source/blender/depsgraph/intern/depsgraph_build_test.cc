@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "BKE_collection.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "intern/depsgraph.h"
+
+namespace blender::deg::tests {
+
+class DepsgraphBuildTest : public BlendfileLoadingBaseTest {
+};
+
+static ::Depsgraph *scene_with_object_graph_new(Main *bmain, const char *name, Object **r_object)
+{
+  Scene *scene = BKE_scene_add(bmain, name);
+  ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+  *r_object = BKE_object_add_only_object(bmain, OB_EMPTY, name);
+  BKE_collection_object_add(bmain, scene->master_collection, *r_object);
+  BKE_view_layer_synced_ensure(scene, view_layer);
+
+  ::Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+  DEG_graph_build_from_view_layer(graph);
+  return graph;
+}
+
+static bool graph_needs_relations_update(::Depsgraph *graph)
+{
+  return reinterpret_cast<const Depsgraph *>(graph)->need_update_relations;
+}
+
+TEST_F(DepsgraphBuildTest, IDTagRelationsUpdateSkipsUnrelatedGraphs)
+{
+  Main *bmain = BKE_main_new();
+  Object *object_a;
+  Object *object_b;
+  ::Depsgraph *graph_a = scene_with_object_graph_new(bmain, "A", &object_a);
+  ::Depsgraph *graph_b = scene_with_object_graph_new(bmain, "B", &object_b);
+  ASSERT_FALSE(graph_needs_relations_update(graph_a));
+  ASSERT_FALSE(graph_needs_relations_update(graph_b));
+
+  /* Only the graph that contains the object is rebuilt. */
+  DEG_id_tag_relations_update(bmain, &object_a->id);
+  EXPECT_TRUE(graph_needs_relations_update(graph_a));
+  EXPECT_FALSE(graph_needs_relations_update(graph_b));
+
+  DEG_graph_relations_update(graph_a);
+  EXPECT_FALSE(graph_needs_relations_update(graph_a));
+
+  /* Tagging all relations still affects every graph. */
+  DEG_relations_tag_update(bmain);
+  EXPECT_TRUE(graph_needs_relations_update(graph_a));
+  EXPECT_TRUE(graph_needs_relations_update(graph_b));
+
+  DEG_graph_free(graph_a);
+  DEG_graph_free(graph_b);
+  BKE_main_free(bmain);
+}
+
+}  // namespace blender::deg::tests
@@ -223,6 +223,12 @@ void DEG_stats_simple(const Depsgraph *graph,
   }
 }
 
+float DEG_debug_evaluation_occupancy_get(const Depsgraph *graph)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  return deg_graph->debug.evaluation_occupancy;
+}
+
 static deg::string depsgraph_name_for_logging(struct Depsgraph *depsgraph)
 {
   const char *name = DEG_debug_name_get(depsgraph);
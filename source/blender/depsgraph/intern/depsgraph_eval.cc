@@ -7,9 +7,12 @@
  * Evaluation engine entry-points for Depsgraph Engine.
  */
 
+#include <algorithm>
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_listbase.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "BKE_scene.h"
@@ -20,6 +23,10 @@
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
 
+#ifdef WITH_PYTHON
+#  include "BPY_extern.h"
+#endif
+
 #include "intern/eval/deg_eval.h"
 #include "intern/eval/deg_eval_flush.h"
 
@@ -78,3 +85,43 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float frame)
   deg_graph->ctime = BKE_scene_frame_to_ctime(scene, frame);
   deg_flush_updates_and_refresh(deg_graph);
 }
+
+void DEG_evaluate_frames_parallel(Depsgraph **graphs,
+                                  const int graphs_num,
+                                  const float *frames,
+                                  const int frames_num,
+                                  DEG_FrameEvaluatedFn frame_fn,
+                                  void *user_data)
+{
+  BLI_assert(graphs_num > 0);
+#ifndef NDEBUG
+  for (const int i : blender::IndexRange(graphs_num)) {
+    BLI_assert(!DEG_is_active(graphs[i]));
+  }
+#endif
+
+  for (int batch_start = 0; batch_start < frames_num; batch_start += graphs_num) {
+    const int batch_size = std::min(graphs_num, frames_num - batch_start);
+
+#ifdef WITH_PYTHON
+    /* Release the GIL so that Python drivers can be evaluated by the other threads, while this
+     * thread waits for them. */
+    BPy_BEGIN_ALLOW_THREADS;
+#endif
+
+    blender::threading::parallel_for(
+        blender::IndexRange(batch_size), 1, [&](const blender::IndexRange range) {
+          for (const int i : range) {
+            DEG_evaluate_on_framechange(graphs[i], frames[batch_start + i]);
+          }
+        });
+
+#ifdef WITH_PYTHON
+    BPy_END_ALLOW_THREADS;
+#endif
+
+    for (const int i : blender::IndexRange(batch_size)) {
+      frame_fn(graphs[i], frames[batch_start + i], user_data);
+    }
+  }
+}
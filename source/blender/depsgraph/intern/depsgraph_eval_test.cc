@@ -0,0 +1,127 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_vector.hh"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_collection.h"
+#include "BKE_fcurve.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+namespace blender::deg::tests {
+
+class DepsgraphEvalTest : public BlendfileLoadingBaseTest {
+};
+
+/** Animate the X location of the object linearly, so that it's the same as the frame number. */
+static void object_animate_location_x(Main *bmain, Object *object)
+{
+  FCurve *fcu = BKE_fcurve_create();
+  fcu->rna_path = BLI_strdup("location");
+  fcu->array_index = 0;
+  fcu->totvert = 2;
+  fcu->bezt = MEM_cnew_array<BezTriple>(2, __func__);
+  const float keys[2] = {0.0f, 100.0f};
+  for (const int i : IndexRange(2)) {
+    BezTriple &bezt = fcu->bezt[i];
+    for (const int j : IndexRange(3)) {
+      bezt.vec[j][0] = keys[i];
+      bezt.vec[j][1] = keys[i];
+    }
+    bezt.ipo = BEZT_IPO_LIN;
+  }
+  BKE_fcurve_handles_recalc(fcu);
+
+  bAction *action = BKE_action_add(bmain, "Action");
+  BLI_addtail(&action->curves, fcu);
+  AnimData *adt = BKE_animdata_ensure_id(&object->id);
+  adt->action = action;
+  id_us_plus(&action->id);
+}
+
+struct EvaluatedFrame {
+  Depsgraph *graph;
+  float frame;
+  float ctime;
+  float location_x;
+};
+
+struct FramesEvaluatedData {
+  Object *object;
+  Vector<EvaluatedFrame> frames;
+};
+
+static void frame_evaluated_fn(Depsgraph *graph, const float frame, void *user_data)
+{
+  FramesEvaluatedData &data = *static_cast<FramesEvaluatedData *>(user_data);
+  const Object *object_eval = DEG_get_evaluated_object(graph, data.object);
+  data.frames.append({graph, frame, DEG_get_ctime(graph), object_eval->loc[0]});
+}
+
+TEST_F(DepsgraphEvalTest, EvaluateFramesParallel)
+{
+  Main *bmain = BKE_main_new();
+  Scene *scene = BKE_scene_add(bmain, "Scene");
+  ViewLayer *view_layer = BKE_view_layer_default_view(scene);
+  Object *object = BKE_object_add_only_object(bmain, OB_EMPTY, "Empty");
+  BKE_collection_object_add(bmain, scene->master_collection, object);
+  BKE_view_layer_synced_ensure(scene, view_layer);
+  object_animate_location_x(bmain, object);
+
+  Vector<Depsgraph *> graphs;
+  for ([[maybe_unused]] const int i : IndexRange(3)) {
+    Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+    DEG_graph_build_from_view_layer(graph);
+    graphs.append(graph);
+  }
+
+  /* More frames than graphs, not in order, and with a last batch that doesn't use every graph. */
+  const Vector<float> frames = {4.0f, 2.0f, 7.0f, 1.0f, 5.0f, 3.0f, 6.0f, 8.0f};
+  FramesEvaluatedData data;
+  data.object = object;
+  DEG_evaluate_frames_parallel(graphs.data(),
+                               int(graphs.size()),
+                               frames.data(),
+                               int(frames.size()),
+                               frame_evaluated_fn,
+                               &data);
+
+  ASSERT_EQ(data.frames.size(), frames.size());
+  for (const int i : frames.index_range()) {
+    const EvaluatedFrame &evaluated = data.frames[i];
+    EXPECT_EQ(evaluated.frame, frames[i]);
+    EXPECT_EQ(evaluated.graph, graphs[i % graphs.size()]);
+    EXPECT_FLOAT_EQ(evaluated.ctime, frames[i]);
+    EXPECT_FLOAT_EQ(evaluated.location_x, frames[i]);
+  }
+
+  for (Depsgraph *graph : graphs) {
+    DEG_graph_free(graph);
+  }
+  BKE_main_free(bmain);
+}
+
+}  // namespace blender::deg::tests
@@ -9,13 +9,17 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_function_ref.hh"
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
+#include "BLI_trace.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -83,23 +87,44 @@ struct DepsgraphEvalState {
   EvaluationStage stage;
   bool need_update_pending_parents = true;
   bool need_single_thread_pass = false;
+  /* Accumulated evaluation time of all operations, in nanoseconds. */
+  uint64_t operations_time_ns = 0;
 };
 
-void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
+/* Number of evaluations between updates of the critical path times of operations. */
+constexpr int CRITICAL_PATH_UPDATE_INTERVAL = 16;
+
+void evaluate_node(DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
+  const bool do_trace = BLI_trace_is_enabled();
+  if (do_trace) {
+    BLI_trace_event_begin("depsgraph", operation_node->full_identifier().c_str());
+  }
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double eval_time = PIL_check_seconds_timer() - start_time;
+  if (do_trace) {
+    BLI_trace_event_end();
+  }
   if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    operation_node->stats.current_time += eval_time;
+  }
+
+  /* Exponential moving average, so that the cost of an operation follows changes in the scene
+   * within a few evaluations. */
+  if (operation_node->average_eval_time == 0.0f) {
+    operation_node->average_eval_time = float(eval_time);
   }
   else {
-    operation_node->evaluate(depsgraph);
+    operation_node->average_eval_time = 0.8f * operation_node->average_eval_time +
+                                        0.2f * float(eval_time);
   }
+  atomic_add_and_fetch_uint64(&state->operations_time_ns, uint64_t(eval_time * 1e9));
 
   /* Clear the flag early on, allowing partial updates without re-evaluating the same node multiple
    * times.
@@ -117,10 +142,20 @@ void deg_task_run_func(TaskPool *pool, void *taskdata)
   OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
   evaluate_node(state, operation_node);
 
-  /* Schedule children. */
-  schedule_children(state, operation_node, [&](OperationNode *node) {
+  /* Schedule children. The task scheduler runs the task which was pushed last on this thread
+   * first, while other threads steal the oldest tasks. So push the child with the longest critical
+   * path last, to continue evaluating the critical path without delay. */
+  Vector<OperationNode *, 16> ready_children;
+  schedule_children(
+      state, operation_node, [&](OperationNode *node) { ready_children.append(node); });
+  std::sort(ready_children.begin(),
+            ready_children.end(),
+            [](const OperationNode *a, const OperationNode *b) {
+              return a->critical_path_time < b->critical_path_time;
+            });
+  for (OperationNode *node : ready_children) {
     BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-  });
+  }
 }
 
 bool check_operation_node_visible(const DepsgraphEvalState *state, OperationNode *op_node)
@@ -286,8 +321,20 @@ void schedule_node(DepsgraphEvalState *state,
 void schedule_graph(DepsgraphEvalState *state,
                     const FunctionRef<void(OperationNode *node)> schedule_fn)
 {
+  /* Start the operations with the longest critical path first, so that the threads which become
+   * idle later on can pick up the short independent operations. */
+  Vector<OperationNode *> ready_nodes;
   for (OperationNode *node : state->graph->operations) {
-    schedule_node(state, node, false, schedule_fn);
+    schedule_node(
+        state, node, false, [&](OperationNode *ready_node) { ready_nodes.append(ready_node); });
+  }
+  std::stable_sort(ready_nodes.begin(),
+                   ready_nodes.end(),
+                   [](const OperationNode *a, const OperationNode *b) {
+                     return a->critical_path_time > b->critical_path_time;
+                   });
+  for (OperationNode *node : ready_nodes) {
+    schedule_fn(node);
   }
 }
 
@@ -367,6 +414,54 @@ void depsgraph_ensure_view_layer(Depsgraph *graph)
   deg_update_copy_on_write_datablock(graph, scene_id_node);
 }
 
+/* Calculate the critical path time of all operations: their own averaged evaluation time plus the
+ * longest critical path time of the operations depending on them. Operations are visited in the
+ * reverse topological order, using the pending links counter which is re-calculated before the
+ * next evaluation anyway. Cyclic relations are ignored, same as in scheduling. */
+void update_critical_path_times(Depsgraph *graph)
+{
+  Vector<OperationNode *> stack;
+  for (OperationNode *op_node : graph->operations) {
+    op_node->critical_path_time = 0.0f;
+    op_node->num_links_pending = 0;
+    for (Relation *rel : op_node->outlinks) {
+      if (rel->to->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        ++op_node->num_links_pending;
+      }
+    }
+    if (op_node->num_links_pending == 0) {
+      stack.append(op_node);
+    }
+  }
+
+  while (!stack.is_empty()) {
+    OperationNode *op_node = stack.pop_last();
+    /* At this point the critical path time is the longest one of the children. */
+    op_node->critical_path_time += op_node->average_eval_time;
+    for (Relation *rel : op_node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *op_from = (OperationNode *)rel->from;
+      op_from->critical_path_time = std::max(op_from->critical_path_time,
+                                             op_node->critical_path_time);
+      BLI_assert(op_from->num_links_pending > 0);
+      if (--op_from->num_links_pending == 0) {
+        stack.append(op_from);
+      }
+    }
+  }
+}
+
+void update_critical_path_times_if_needed(Depsgraph *graph)
+{
+  if (--graph->critical_path_update_countdown > 0) {
+    return;
+  }
+  update_critical_path_times(graph);
+  graph->critical_path_update_countdown = CRITICAL_PATH_UPDATE_INTERVAL;
+}
+
 TaskPool *deg_evaluate_task_pool_create(DepsgraphEvalState *state)
 {
   if (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) {
@@ -420,6 +515,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
    *
    * - Single-threaded pass of all remaining operations. */
 
+  const double evaluation_start_time = PIL_check_seconds_timer();
+
   TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
 
   evaluate_graph_threaded_stage(&state, task_pool, EvaluationStage::COPY_ON_WRITE);
@@ -447,6 +544,19 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
 
   evaluate_graph_single_threaded_if_needed(&state);
 
+  /* Share of the available thread time spent in operations, to see how well the graph is able to
+   * use the threads. */
+  const double evaluation_time = PIL_check_seconds_timer() - evaluation_start_time;
+  const int num_threads = (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) ?
+                              1 :
+                              BLI_task_scheduler_num_threads();
+  graph->debug.evaluation_occupancy = (evaluation_time > 0.0) ?
+                                          float(state.operations_time_ns * 1e-9 /
+                                                (evaluation_time * num_threads)) :
+                                          0.0f;
+
+  update_critical_path_times_if_needed(graph);
+
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
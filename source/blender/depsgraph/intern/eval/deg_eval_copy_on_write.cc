@@ -31,6 +31,7 @@
 #include "BKE_idprop.h"
 #include "BKE_layer.h"
 #include "BKE_lib_id.h"
+#include "BKE_mesh.h"
 #include "BKE_scene.h"
 
 #include "DEG_depsgraph.h"
@@ -897,6 +898,16 @@ ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode
       BKE_gpencil_update_on_write((bGPdata *)id_orig, (bGPdata *)id_cow);
       return id_cow;
     }
+    /* When only the geometry of a mesh changed, update the geometry in the copy and keep the rest
+     * of it (materials, custom properties, run-time data of other areas) as it is. Shading is
+     * accumulated from the batch cache update which follows geometry changes. */
+    const uint geometry_recalc = ID_RECALC_GEOMETRY | ID_RECALC_COPY_ON_WRITE | ID_RECALC_SHADING;
+    if (id_type == ID_ME && (id_cow->recalc & ID_RECALC_GEOMETRY) &&
+        (id_cow->recalc & ~geometry_recalc) == 0 &&
+        BKE_mesh_can_avoid_full_copy_on_write((const Mesh *)id_orig, (const Mesh *)id_cow)) {
+      BKE_mesh_update_geometry_on_write((const Mesh *)id_orig, (Mesh *)id_cow);
+      return id_cow;
+    }
   }
 
   RuntimeBackup backup(depsgraph);
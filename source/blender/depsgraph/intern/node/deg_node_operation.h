@@ -271,6 +271,12 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Evaluation time of this operation in seconds, averaged over the previous evaluations. */
+  float average_eval_time;
+  /* Averaged evaluation time of the longest chain of dependent operations starting with this one.
+   * Operations with a longer chain are started first when several are ready for evaluation. */
+  float critical_path_time;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -18,6 +18,7 @@
 #include "BLI_array.hh"
 #include "BLI_math_bits.h"
 #include "BLI_task.h"
+#include "BLI_trace.hh"
 #include "BLI_vector.hh"
 
 #include "BKE_editmesh.h"
@@ -201,6 +202,7 @@ BLI_INLINE void extract_init(const MeshRenderData *mr,
   uint32_t data_offset = 0;
   for (ExtractorRunData &run_data : extractors) {
     const MeshExtract *extractor = run_data.extractor;
+    SCOPED_TRACE_EVENT("draw", extractor->name);
     run_data.buffer = mesh_extract_buffer_get(extractor, mbuflist);
     run_data.data_offset = data_offset;
     extractor->init(mr, cache, run_data.buffer, POINTER_OFFSET(data_stack, data_offset));
@@ -216,6 +218,7 @@ BLI_INLINE void extract_finish(const MeshRenderData *mr,
   for (const ExtractorRunData &run_data : extractors) {
     const MeshExtract *extractor = run_data.extractor;
     if (extractor->finish) {
+      SCOPED_TRACE_EVENT("draw", extractor->name);
       extractor->finish(
           mr, cache, run_data.buffer, POINTER_OFFSET(data_stack, run_data.data_offset));
     }
@@ -422,6 +425,11 @@ static void extract_task_range_run(void *__restrict taskdata)
   ExtractTaskData *data = (ExtractTaskData *)taskdata;
   const eMRIterType iter_type = data->iter_type;
   const bool is_mesh = data->mr->extract_type != MR_EXTRACT_BMESH;
+  /* Extractors that can't be threaded run in their own task, the others share the element loops
+   * of one task. The initialization and finishing of every extractor are recorded separately. */
+  SCOPED_TRACE_EVENT("draw",
+                     data->extractors->size() == 1 ? data->extractors->first().extractor->name :
+                                                     "Extract Mesh Buffers");
 
   size_t userdata_chunk_size = data->extractors->data_size_total();
   void *userdata_chunk = MEM_callocN(userdata_chunk_size, __func__);
@@ -521,6 +529,7 @@ static void mesh_extract_render_data_node_exec(void *__restrict task_data)
   MeshRenderData *mr = update_task_data->mr;
   const eMRIterType iter_type = update_task_data->iter_type;
   const eMRDataType data_flag = update_task_data->data_flag;
+  SCOPED_TRACE_EVENT("draw", "Update Mesh Render Data");
 
   mesh_render_data_update_normals(mr, data_flag);
   mesh_render_data_update_looptris(mr, iter_type, data_flag);
@@ -869,6 +878,7 @@ void mesh_buffer_cache_create_requested_subdiv(MeshBatchCache *cache,
     const MeshExtract *extractor = run_data.extractor;
     void *buffer = mesh_extract_buffer_get(extractor, mbuflist);
     void *data = POINTER_OFFSET(data_stack, data_offset);
+    SCOPED_TRACE_EVENT("draw", extractor->name);
 
     extractor->init_subdiv(subdiv_cache, mr, cache, buffer, data);
 
@@ -306,6 +306,8 @@ using ExtractFinishSubdivFn = void(const DRWSubdivCache *subdiv_cache,
                                    void *data);
 
 struct MeshExtract {
+  /** Identifies the extractor in traces, see #SCOPED_TRACE_EVENT. */
+  const char *name;
   /** Executed on main thread and return user data for iteration functions. */
   ExtractInitFn *init;
   /** Executed on one (or more if use_threading) worker thread(s). */
@@ -145,6 +145,7 @@ static void extract_edituv_tris_finish_subdiv(const struct DRWSubdivCache * /*su
 constexpr MeshExtract create_extractor_edituv_tris()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edituv_tris";
   extractor.init = extract_edituv_tris_init;
   extractor.iter_looptri_bm = extract_edituv_tris_iter_looptri_bm;
   extractor.iter_looptri_mesh = extract_edituv_tris_iter_looptri_mesh;
@@ -330,6 +331,7 @@ static void extract_edituv_lines_finish_subdiv(const struct DRWSubdivCache * /*s
 constexpr MeshExtract create_extractor_edituv_lines()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edituv_lines";
   extractor.init = extract_edituv_lines_init;
   extractor.iter_poly_bm = extract_edituv_lines_iter_poly_bm;
   extractor.iter_poly_mesh = extract_edituv_lines_iter_poly_mesh;
@@ -486,6 +488,7 @@ static void extract_edituv_points_finish_subdiv(const struct DRWSubdivCache * /*
 constexpr MeshExtract create_extractor_edituv_points()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edituv_points";
   extractor.init = extract_edituv_points_init;
   extractor.iter_poly_bm = extract_edituv_points_iter_poly_bm;
   extractor.iter_poly_mesh = extract_edituv_points_iter_poly_mesh;
@@ -584,6 +587,7 @@ static void extract_edituv_fdots_finish(const MeshRenderData * /*mr*/,
 constexpr MeshExtract create_extractor_edituv_fdots()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edituv_fdots";
   extractor.init = extract_edituv_fdots_init;
   extractor.iter_poly_bm = extract_edituv_fdots_iter_poly_bm;
   extractor.iter_poly_mesh = extract_edituv_fdots_iter_poly_mesh;
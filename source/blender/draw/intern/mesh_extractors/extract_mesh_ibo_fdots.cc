@@ -81,6 +81,7 @@ static void extract_fdots_finish(const MeshRenderData * /*mr*/,
 constexpr MeshExtract create_extractor_fdots()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "fdots";
   extractor.init = extract_fdots_init;
   extractor.iter_poly_bm = extract_fdots_iter_poly_bm;
   extractor.iter_poly_mesh = extract_fdots_iter_poly_mesh;
@@ -241,6 +241,7 @@ static void extract_lines_loose_geom_subdiv(const DRWSubdivCache *subdiv_cache,
 constexpr MeshExtract create_extractor_lines()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "lines";
   extractor.init = extract_lines_init;
   extractor.iter_poly_bm = extract_lines_iter_poly_bm;
   extractor.iter_poly_mesh = extract_lines_iter_poly_mesh;
@@ -302,6 +303,7 @@ static void extract_lines_with_lines_loose_finish_subdiv(const struct DRWSubdivC
 constexpr MeshExtract create_extractor_lines_with_lines_loose()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "lines_with_lines_loose";
   extractor.init = extract_lines_init;
   extractor.iter_poly_bm = extract_lines_iter_poly_bm;
   extractor.iter_poly_mesh = extract_lines_iter_poly_mesh;
@@ -349,6 +351,7 @@ static void extract_lines_loose_only_init_subdiv(const DRWSubdivCache * /*subdiv
 constexpr MeshExtract create_extractor_lines_loose_only()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "lines_loose_only";
   extractor.init = extract_lines_loose_only_init;
   extractor.init_subdiv = extract_lines_loose_only_init_subdiv;
   extractor.data_type = MR_DATA_LOOSE_GEOM;
@@ -235,6 +235,7 @@ static void extract_lines_adjacency_finish_subdiv(const DRWSubdivCache * /*subdi
 constexpr MeshExtract create_extractor_lines_adjacency()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "lines_adjacency";
   extractor.init = extract_lines_adjacency_init;
   extractor.iter_looptri_bm = extract_lines_adjacency_iter_looptri_bm;
   extractor.iter_looptri_mesh = extract_lines_adjacency_iter_looptri_mesh;
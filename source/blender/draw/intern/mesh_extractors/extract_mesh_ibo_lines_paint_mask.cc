@@ -160,6 +160,7 @@ static void extract_lines_paint_mask_finish_subdiv(const struct DRWSubdivCache *
 constexpr MeshExtract create_extractor_lines_paint_mask()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "lines_paint_mask";
   extractor.init = extract_lines_paint_mask_init;
   extractor.iter_poly_mesh = extract_lines_paint_mask_iter_poly_mesh;
   extractor.finish = extract_lines_paint_mask_finish;
@@ -292,6 +292,7 @@ static void extract_points_finish_subdiv(const DRWSubdivCache * /*subdiv_cache*/
 constexpr MeshExtract create_extractor_points()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "points";
   extractor.init = extract_points_init;
   extractor.iter_poly_bm = extract_points_iter_poly_bm;
   extractor.iter_poly_mesh = extract_points_iter_poly_mesh;
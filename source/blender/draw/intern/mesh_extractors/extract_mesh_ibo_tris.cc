@@ -138,6 +138,7 @@ static void extract_tris_init_subdiv(const DRWSubdivCache *subdiv_cache,
 constexpr MeshExtract create_extractor_tris()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "tris";
   extractor.init = extract_tris_init;
   extractor.init_subdiv = extract_tris_init_subdiv;
   extractor.iter_poly_bm = extract_tris_iter_poly_bm;
@@ -226,6 +227,7 @@ static void extract_tris_single_mat_finish(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_tris_single_mat()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "tris_single_mat";
   extractor.init = extract_tris_single_mat_init;
   extractor.init_subdiv = extract_tris_init_subdiv;
   extractor.iter_looptri_bm = extract_tris_single_mat_iter_looptri_bm;
@@ -405,6 +405,7 @@ template<int Index>
 constexpr MeshExtract create_extractor_attr(ExtractInitFn fn, ExtractInitSubdivFn subdiv_fn)
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "attr";
   extractor.init = fn;
   extractor.init_subdiv = subdiv_fn;
   extractor.data_type = MR_DATA_NONE;
@@ -440,6 +441,7 @@ static void extract_mesh_attr_viewer_init(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_attr_viewer()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "attr_viewer";
   extractor.init = extract_mesh_attr_viewer_init;
   extractor.data_type = MR_DATA_NONE;
   extractor.data_size = 0;
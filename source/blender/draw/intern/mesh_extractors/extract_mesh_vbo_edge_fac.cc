@@ -276,6 +276,7 @@ static void extract_edge_fac_loose_geom_subdiv(const DRWSubdivCache *subdiv_cach
 constexpr MeshExtract create_extractor_edge_fac()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edge_fac";
   extractor.init = extract_edge_fac_init;
   extractor.iter_poly_bm = extract_edge_fac_iter_poly_bm;
   extractor.iter_poly_mesh = extract_edge_fac_iter_poly_mesh;
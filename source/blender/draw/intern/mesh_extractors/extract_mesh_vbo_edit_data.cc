@@ -342,6 +342,7 @@ static void extract_edit_data_loose_geom_subdiv(const DRWSubdivCache *subdiv_cac
 constexpr MeshExtract create_extractor_edit_data()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edit_data";
   extractor.init = extract_edit_data_init;
   extractor.iter_poly_bm = extract_edit_data_iter_poly_bm;
   extractor.iter_poly_mesh = extract_edit_data_iter_poly_mesh;
@@ -278,6 +278,7 @@ static void extract_edituv_stretch_angle_init_subdiv(const DRWSubdivCache *subdi
 constexpr MeshExtract create_extractor_edituv_edituv_stretch_angle()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edituv_stretch_angle";
   extractor.init = extract_edituv_stretch_angle_init;
   extractor.iter_poly_bm = extract_edituv_stretch_angle_iter_poly_bm;
   extractor.iter_poly_mesh = extract_edituv_stretch_angle_iter_poly_mesh;
@@ -163,6 +163,7 @@ static void extract_edituv_stretch_area_init_subdiv(const DRWSubdivCache *subdiv
 constexpr MeshExtract create_extractor_edituv_stretch_area()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edituv_stretch_area";
   extractor.init = extract_edituv_stretch_area_init;
   extractor.finish = extract_edituv_stretch_area_finish;
   extractor.init_subdiv = extract_edituv_stretch_area_init_subdiv;
@@ -67,6 +67,7 @@ static void extract_fdots_edituv_data_iter_poly_mesh(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_fdots_edituv_data()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "fdots_edituv_data";
   extractor.init = extract_fdots_edituv_data_init;
   extractor.iter_poly_bm = extract_fdots_edituv_data_iter_poly_bm;
   extractor.iter_poly_mesh = extract_fdots_edituv_data_iter_poly_mesh;
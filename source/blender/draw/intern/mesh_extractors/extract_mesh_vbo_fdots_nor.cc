@@ -83,6 +83,7 @@ static void extract_fdots_nor_finish(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_fdots_nor()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "fdots_nor";
   extractor.init = extract_fdots_nor_init;
   extractor.finish = extract_fdots_nor_finish;
   extractor.data_type = MR_DATA_LOOP_NOR;
@@ -163,6 +164,7 @@ static void extract_fdots_nor_hq_finish(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_fdots_nor_hq()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "fdots_nor_hq";
   extractor.init = extract_fdots_nor_hq_init;
   extractor.finish = extract_fdots_nor_hq_finish;
   extractor.data_type = MR_DATA_LOOP_NOR;
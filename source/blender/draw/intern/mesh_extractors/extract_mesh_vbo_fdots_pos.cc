@@ -121,6 +121,7 @@ static void extract_fdots_init_subdiv(const DRWSubdivCache *subdiv_cache,
 constexpr MeshExtract create_extractor_fdots_pos()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "fdots_pos";
   extractor.init = extract_fdots_pos_init;
   extractor.init_subdiv = extract_fdots_init_subdiv;
   extractor.iter_poly_bm = extract_fdots_pos_iter_poly_bm;
@@ -94,6 +94,7 @@ static void extract_fdots_uv_iter_poly_mesh(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_fdots_uv()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "fdots_uv";
   extractor.init = extract_fdots_uv_init;
   extractor.iter_poly_bm = extract_fdots_uv_iter_poly_bm;
   extractor.iter_poly_mesh = extract_fdots_uv_iter_poly_mesh;
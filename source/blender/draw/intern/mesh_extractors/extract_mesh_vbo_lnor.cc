@@ -120,6 +120,7 @@ static void extract_lnor_init_subdiv(const DRWSubdivCache *subdiv_cache,
 constexpr MeshExtract create_extractor_lnor()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "lnor";
   extractor.init = extract_lnor_init;
   extractor.init_subdiv = extract_lnor_init_subdiv;
   extractor.iter_poly_bm = extract_lnor_iter_poly_bm;
@@ -221,6 +222,7 @@ static void extract_lnor_hq_iter_poly_mesh(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_lnor_hq()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "lnor_hq";
   extractor.init = extract_lnor_hq_init;
   extractor.init_subdiv = extract_lnor_init_subdiv;
   extractor.iter_poly_bm = extract_lnor_hq_iter_poly_bm;
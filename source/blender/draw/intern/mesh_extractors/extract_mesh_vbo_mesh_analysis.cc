@@ -621,6 +621,7 @@ static void extract_analysis_iter_finish_mesh(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_mesh_analysis()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "mesh_analysis";
   extractor.init = extract_mesh_analysis_init;
   extractor.finish = extract_analysis_iter_finish_mesh;
   /* This is not needed for all visualization types.
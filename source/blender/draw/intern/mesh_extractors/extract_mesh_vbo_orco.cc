@@ -79,6 +79,7 @@ static void extract_orco_iter_poly_mesh(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_orco()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "orco";
   extractor.init = extract_orco_init;
   extractor.iter_poly_bm = extract_orco_iter_poly_bm;
   extractor.iter_poly_mesh = extract_orco_iter_poly_mesh;
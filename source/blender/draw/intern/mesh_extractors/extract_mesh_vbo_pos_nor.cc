@@ -368,6 +368,7 @@ static void extract_pos_nor_loose_geom_subdiv(const DRWSubdivCache *subdiv_cache
 constexpr MeshExtract create_extractor_pos_nor()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "pos_nor";
   extractor.init = extract_pos_nor_init;
   extractor.iter_poly_bm = extract_pos_nor_iter_poly_bm;
   extractor.iter_poly_mesh = extract_pos_nor_iter_poly_mesh;
@@ -561,6 +562,7 @@ static void extract_pos_nor_hq_finish(const MeshRenderData * /*mr*/,
 constexpr MeshExtract create_extractor_pos_nor_hq()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "pos_nor_hq";
   extractor.init = extract_pos_nor_hq_init;
   extractor.init_subdiv = extract_pos_nor_init_subdiv;
   extractor.iter_poly_bm = extract_pos_nor_hq_iter_poly_bm;
@@ -315,6 +315,7 @@ static void extract_poly_idx_init_subdiv(const DRWSubdivCache *subdiv_cache,
 constexpr MeshExtract create_extractor_poly_idx()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "poly_idx";
   extractor.init = extract_select_idx_init;
   extractor.iter_poly_bm = extract_poly_idx_iter_poly_bm;
   extractor.iter_poly_mesh = extract_poly_idx_iter_poly_mesh;
@@ -329,6 +330,7 @@ constexpr MeshExtract create_extractor_poly_idx()
 constexpr MeshExtract create_extractor_edge_idx()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "edge_idx";
   extractor.init = extract_select_idx_init;
   extractor.iter_poly_bm = extract_edge_idx_iter_poly_bm;
   extractor.iter_poly_mesh = extract_edge_idx_iter_poly_mesh;
@@ -346,6 +348,7 @@ constexpr MeshExtract create_extractor_edge_idx()
 constexpr MeshExtract create_extractor_vert_idx()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "vert_idx";
   extractor.init = extract_select_idx_init;
   extractor.iter_poly_bm = extract_vert_idx_iter_poly_bm;
   extractor.iter_poly_mesh = extract_vert_idx_iter_poly_mesh;
@@ -394,6 +397,7 @@ static void extract_fdot_idx_iter_poly_mesh(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_fdot_idx()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "fdot_idx";
   extractor.init = extract_fdot_idx_init;
   extractor.iter_poly_bm = extract_fdot_idx_iter_poly_bm;
   extractor.iter_poly_mesh = extract_fdot_idx_iter_poly_mesh;
@@ -60,6 +60,7 @@ static void extract_skin_roots_init(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_skin_roots()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "skin_roots";
   extractor.init = extract_skin_roots_init;
   extractor.data_type = MR_DATA_NONE;
   extractor.data_size = 0;
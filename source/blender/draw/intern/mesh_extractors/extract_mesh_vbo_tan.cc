@@ -332,6 +332,7 @@ static void extract_tan_init_subdiv(const DRWSubdivCache *subdiv_cache,
 constexpr MeshExtract create_extractor_tan()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "tan";
   extractor.init = extract_tan_init;
   extractor.init_subdiv = extract_tan_init_subdiv;
   extractor.data_type = MR_DATA_POLY_NOR | MR_DATA_TAN_LOOP_NOR | MR_DATA_LOOPTRI;
@@ -359,6 +360,7 @@ static void extract_tan_hq_init(const MeshRenderData *mr,
 constexpr MeshExtract create_extractor_tan_hq()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "tan_hq";
   extractor.init = extract_tan_hq_init;
   extractor.data_type = MR_DATA_POLY_NOR | MR_DATA_TAN_LOOP_NOR | MR_DATA_LOOPTRI;
   extractor.data_size = 0;
@@ -156,6 +156,7 @@ static void extract_uv_init_subdiv(const DRWSubdivCache *subdiv_cache,
 constexpr MeshExtract create_extractor_uv()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "uv";
   extractor.init = extract_uv_init;
   extractor.init_subdiv = extract_uv_init_subdiv;
   extractor.data_type = MR_DATA_NONE;
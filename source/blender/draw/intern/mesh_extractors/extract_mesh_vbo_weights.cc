@@ -194,6 +194,7 @@ static void extract_weights_init_subdiv(const DRWSubdivCache *subdiv_cache,
 constexpr MeshExtract create_extractor_weights()
 {
   MeshExtract extractor = {nullptr};
+  extractor.name = "weights";
   extractor.init = extract_weights_init;
   extractor.init_subdiv = extract_weights_init_subdiv;
   extractor.iter_poly_bm = extract_weights_iter_poly_bm;
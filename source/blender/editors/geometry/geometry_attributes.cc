@@ -683,6 +683,94 @@ void GEOMETRY_OT_attribute_convert(wmOperatorType *ot)
       ot->srna, "data_type", rna_enum_attribute_type_items, CD_PROP_FLOAT, "Data Type", "");
 }
 
+static bool geometry_attribute_compress_poll(bContext *C)
+{
+  if (!geometry_attributes_poll(C)) {
+    return false;
+  }
+  if (CTX_data_edit_object(C) != nullptr) {
+    CTX_wm_operator_poll_msg_set(C, "Operation is not allowed in edit mode");
+    return false;
+  }
+  return true;
+}
+
+static int geometry_attribute_compress_exec(bContext *C, wmOperator *op)
+{
+  Object *ob = ED_object_context(C);
+  ID *id = static_cast<ID *>(ob->data);
+  const CustomDataLayer *layer = BKE_id_attributes_active_get(id);
+  if (layer == nullptr) {
+    BKE_report(op->reports, RPT_ERROR, "No active attribute");
+    return OPERATOR_CANCELLED;
+  }
+
+  const std::string name = layer->name;
+  if (!BKE_id_attribute_compress(
+          id, name.c_str(), eCustomDataType(RNA_enum_get(op->ptr, "type")), op->reports)) {
+    return OPERATOR_CANCELLED;
+  }
+
+  /* Compressed attributes are not part of the attribute list. */
+  int *active_index = BKE_id_attributes_active_index_p(id);
+  if (*active_index > 0) {
+    *active_index -= 1;
+  }
+
+  DEG_id_tag_update(id, ID_RECALC_GEOMETRY);
+  WM_main_add_notifier(NC_GEOM | ND_DATA, id);
+  return OPERATOR_FINISHED;
+}
+
+void GEOMETRY_OT_attribute_compress(wmOperatorType *ot)
+{
+  ot->name = "Compress Attribute";
+  ot->description =
+      "Store the active attribute with reduced precision to save memory. Compressed attributes "
+      "are hidden from the attribute list";
+  ot->idname = "GEOMETRY_OT_attribute_compress";
+
+  ot->invoke = WM_menu_invoke;
+  ot->exec = geometry_attribute_compress_exec;
+  ot->poll = geometry_attribute_compress_poll;
+
+  ot->flag = OPTYPE_REGISTER | OPTYPE_UNDO;
+
+  ot->prop = RNA_def_enum(ot->srna,
+                          "type",
+                          rna_enum_attribute_compressed_type_items,
+                          CD_PROP_FLOAT3_HALF,
+                          "Type",
+                          "How to store the attribute");
+}
+
+static int geometry_attribute_decompress_all_exec(bContext *C, wmOperator *op)
+{
+  Object *ob = ED_object_context(C);
+  ID *id = static_cast<ID *>(ob->data);
+  const int decompressed_num = BKE_id_attributes_decompress_all(id);
+  if (decompressed_num == 0) {
+    BKE_report(op->reports, RPT_INFO, "No compressed attributes");
+    return OPERATOR_CANCELLED;
+  }
+
+  DEG_id_tag_update(id, ID_RECALC_GEOMETRY);
+  WM_main_add_notifier(NC_GEOM | ND_DATA, id);
+  return OPERATOR_FINISHED;
+}
+
+void GEOMETRY_OT_attribute_decompress_all(wmOperatorType *ot)
+{
+  ot->name = "Decompress Attributes";
+  ot->description = "Store all compressed attributes with full precision again";
+  ot->idname = "GEOMETRY_OT_attribute_decompress_all";
+
+  ot->exec = geometry_attribute_decompress_all_exec;
+  ot->poll = geometry_attribute_compress_poll;
+
+  ot->flag = OPTYPE_REGISTER | OPTYPE_UNDO;
+}
+
 }  // namespace blender::ed::geometry
 
 bool ED_geometry_attribute_convert(Mesh *mesh,
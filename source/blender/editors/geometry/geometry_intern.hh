@@ -20,5 +20,7 @@ void GEOMETRY_OT_color_attribute_render_set(struct wmOperatorType *ot);
 void GEOMETRY_OT_color_attribute_duplicate(struct wmOperatorType *ot);
 void GEOMETRY_OT_attribute_convert(struct wmOperatorType *ot);
 void GEOMETRY_OT_color_attribute_convert(struct wmOperatorType *ot);
+void GEOMETRY_OT_attribute_compress(struct wmOperatorType *ot);
+void GEOMETRY_OT_attribute_decompress_all(struct wmOperatorType *ot);
 
 }  // namespace blender::ed::geometry
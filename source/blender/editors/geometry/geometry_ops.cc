@@ -25,4 +25,6 @@ void ED_operatortypes_geometry(void)
   WM_operatortype_append(GEOMETRY_OT_color_attribute_duplicate);
   WM_operatortype_append(GEOMETRY_OT_attribute_convert);
   WM_operatortype_append(GEOMETRY_OT_color_attribute_convert);
+  WM_operatortype_append(GEOMETRY_OT_attribute_compress);
+  WM_operatortype_append(GEOMETRY_OT_attribute_decompress_all);
 }
@@ -78,6 +78,7 @@ static int wm_obj_export_exec(bContext *C, wmOperator *op)
   export_params.export_animation = RNA_boolean_get(op->ptr, "export_animation");
   export_params.start_frame = RNA_int_get(op->ptr, "start_frame");
   export_params.end_frame = RNA_int_get(op->ptr, "end_frame");
+  export_params.export_frames_parallel = RNA_boolean_get(op->ptr, "export_frames_parallel");
 
   export_params.forward_axis = RNA_enum_get(op->ptr, "forward_axis");
   export_params.up_axis = RNA_enum_get(op->ptr, "up_axis");
@@ -173,6 +174,7 @@ static void ui_obj_export_settings(uiLayout *layout, PointerRNA *imfptr)
   uiLayoutSetEnabled(sub, export_animation);
   uiItemR(sub, imfptr, "start_frame", 0, IFACE_("Frame Start"), ICON_NONE);
   uiItemR(sub, imfptr, "end_frame", 0, IFACE_("End"), ICON_NONE);
+  uiItemR(sub, imfptr, "export_frames_parallel", 0, NULL, ICON_NONE);
 }
 
 static void wm_obj_export_draw(bContext *UNUSED(C), wmOperator *op)
@@ -269,6 +271,12 @@ void WM_OT_obj_export(struct wmOperatorType *ot)
               "The last frame to be exported",
               INT_MIN,
               INT_MAX);
+  RNA_def_boolean(ot->srna,
+                  "export_frames_parallel",
+                  false,
+                  "Evaluate Frames in Parallel",
+                  "Evaluate multiple frames at the same time, which uses more memory. Not "
+                  "supported for simulations, since they depend on the previous frame");
   /* Object transform options. */
   prop = RNA_def_enum(
       ot->srna, "forward_axis", io_transform_axis, IO_AXIS_NEGATIVE_Z, "Forward Axis", "");
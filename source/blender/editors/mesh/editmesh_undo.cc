@@ -16,6 +16,7 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_array_utils.h"
+#include "BLI_implicit_sharing.hh"
 #include "BLI_listbase.h"
 #include "BLI_task.hh"
 
@@ -251,6 +252,11 @@ static void um_arraystore_cd_compact(CustomData *cdata,
 
     CustomDataLayer *layer = &cdata->layers[layer_start];
     for (int i = 0; i < layer_len; i++, layer++) {
+      if (layer_type_is_dynamic) {
+        /* The array store takes over the elements' allocations, so they can't be shared. */
+        CustomData_ensure_data_is_mutable(layer, int(data_len));
+      }
+
       if (create) {
         if (layer->data) {
           BArrayState *state_reference = (bcd_reference_current &&
@@ -270,10 +276,18 @@ static void um_arraystore_cd_compact(CustomData *cdata,
         }
       }
 
-      if (layer->data) {
-        MEM_freeN(layer->data);
+      if (layer->data == nullptr) {
+        continue;
+      }
+      if (layer->sharing_info != nullptr && layer->sharing_info->is_shared()) {
+        /* Other users keep the data, there is no need to copy it only to free it. */
+        layer->sharing_info->user_remove();
+        layer->sharing_info = nullptr;
         layer->data = nullptr;
       }
+      else {
+        MEM_freeN(CustomData_layer_steal_data(layer, int(data_len)));
+      }
     }
 
     if (create) {
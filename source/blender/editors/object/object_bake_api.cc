@@ -1135,6 +1135,10 @@ static bool bake_targets_output_vertex_colors(BakeTargets *targets, Object *ob)
                                                                      me->active_color_attribute);
   BLI_assert(active_color_layer != nullptr);
   const eAttrDomain domain = BKE_id_attribute_domain(&me->id, active_color_layer);
+  if (em == nullptr) {
+    CustomData_ensure_data_is_mutable(active_color_layer,
+                                      BKE_id_attribute_data_length(&me->id, active_color_layer));
+  }
 
   const int channels_num = targets->channels_num;
   const bool is_noncolor = targets->is_noncolor;
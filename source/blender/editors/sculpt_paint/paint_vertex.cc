@@ -1240,28 +1240,16 @@ static void vertex_paint_init_session_data(const ToolSettings *ts, Object *ob)
   }
 
   Mesh *me = (Mesh *)ob->data;
-  const Span<MPoly> polys = me->polys();
-  const Span<int> corner_verts = me->corner_verts();
 
   if (gmap->vert_to_loop == nullptr) {
     gmap->vert_map_mem = nullptr;
     gmap->vert_to_loop = nullptr;
     gmap->poly_map_mem = nullptr;
     gmap->vert_to_poly = nullptr;
-    BKE_mesh_vert_loop_map_create(&gmap->vert_to_loop,
-                                  &gmap->vert_map_mem,
-                                  polys.data(),
-                                  corner_verts.data(),
-                                  me->totvert,
-                                  me->totpoly,
-                                  me->totloop);
-    BKE_mesh_vert_poly_map_create(&gmap->vert_to_poly,
-                                  &gmap->poly_map_mem,
-                                  polys.data(),
-                                  corner_verts.data(),
-                                  me->totvert,
-                                  me->totpoly,
-                                  me->totloop);
+    blender::bke::mesh_topology::topology_map_to_elem_map(
+        me->vert_to_loop_map(), &gmap->vert_to_loop, &gmap->vert_map_mem);
+    blender::bke::mesh_topology::topology_map_to_elem_map(
+        me->vert_to_poly_map(), &gmap->vert_to_poly, &gmap->poly_map_mem);
   }
 
   /* Create average brush arrays */
@@ -31,6 +31,11 @@ struct OBJExportParams {
   int start_frame;
   /** The last frame to be exported. */
   int end_frame;
+  /**
+   * Evaluate multiple frames at the same time with separate dependency graphs. Uses more memory,
+   * and simulations are not evaluated correctly, since frames don't follow each other.
+   */
+  bool export_frames_parallel;
 
   /* Geometry Transform options. */
   eIOAxis forward_axis;
@@ -4,6 +4,7 @@
  * \ingroup obj
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <exception>
 #include <memory>
@@ -11,9 +12,11 @@
 #include "BKE_scene.h"
 
 #include "BLI_path_util.h"
+#include "BLI_task.h"
 #include "BLI_task.hh"
 #include "BLI_vector.hh"
 
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 
 #include "DNA_scene_types.h"
@@ -310,9 +313,73 @@ bool append_frame_to_filename(const char *filepath, const int frame, char *r_fil
   return BLI_path_extension_replace(r_filepath_with_frames, FILE_MAX, ".obj");
 }
 
+static void export_frame_evaluated(Depsgraph *depsgraph, const float frame, void *user_data)
+{
+  const OBJExportParams &export_params = *static_cast<const OBJExportParams *>(user_data);
+  char filepath_with_frames[FILE_MAX];
+  append_frame_to_filename(export_params.filepath, int(frame), filepath_with_frames);
+  fprintf(stderr, "Writing to %s\n", filepath_with_frames);
+  export_frame(depsgraph, export_params, filepath_with_frames);
+}
+
+/**
+ * Export the frames of the animation with a dependency graph per thread, see
+ * #DEG_evaluate_frames_parallel. The files are still written one after another.
+ */
+static void export_frames_parallel(bContext *C, const OBJExportParams &export_params)
+{
+  Vector<float> frames;
+  for (int frame = export_params.start_frame; frame <= export_params.end_frame; frame++) {
+    char filepath_with_frames[FILE_MAX];
+    if (!append_frame_to_filename(export_params.filepath, frame, filepath_with_frames)) {
+      fprintf(stderr, "Error: File Path too long.\n%s\n", filepath_with_frames);
+      return;
+    }
+    frames.append(float(frame));
+  }
+  if (frames.is_empty()) {
+    return;
+  }
+
+  Main *bmain = CTX_data_main(C);
+  Scene *scene = CTX_data_scene(C);
+  ViewLayer *view_layer = CTX_data_view_layer(C);
+
+  /* Every graph stores an evaluated copy of the scene, limit the memory usage. */
+  const int graphs_num = std::min({BLI_task_scheduler_num_threads(), int(frames.size()), 8});
+  Vector<Depsgraph *> graphs;
+  for ([[maybe_unused]] const int i : IndexRange(graphs_num)) {
+    Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, export_params.export_eval_mode);
+    if (export_params.export_eval_mode == DAG_EVAL_RENDER) {
+      DEG_graph_build_for_all_objects(graph);
+    }
+    else {
+      DEG_graph_build_from_view_layer(graph);
+    }
+    graphs.append(graph);
+  }
+
+  DEG_evaluate_frames_parallel(graphs.data(),
+                               graphs_num,
+                               frames.data(),
+                               int(frames.size()),
+                               export_frame_evaluated,
+                               const_cast<OBJExportParams *>(&export_params));
+
+  for (Depsgraph *graph : graphs) {
+    DEG_graph_free(graph);
+  }
+}
+
 void exporter_main(bContext *C, const OBJExportParams &export_params)
 {
   ED_object_mode_set(C, OB_MODE_OBJECT);
+
+  if (export_params.export_animation && export_params.export_frames_parallel) {
+    export_frames_parallel(C, export_params);
+    return;
+  }
+
   OBJDepsgraph obj_depsgraph(C, export_params.export_eval_mode);
   Scene *scene = DEG_get_input_scene(obj_depsgraph.get());
   const char *filepath = export_params.filepath;
@@ -16,6 +16,7 @@ struct OBJExportParamsDefault {
     params.export_animation = false;
     params.start_frame = 0;
     params.end_frame = 1;
+    params.export_frames_parallel = false;
 
     params.forward_axis = IO_AXIS_NEGATIVE_Z;
     params.up_axis = IO_AXIS_Y;
@@ -643,6 +643,13 @@ typedef struct FCurve {
   float color[3];
 
   float prev_norm_factor, prev_offset;
+
+  /**
+   * Runtime: index of the keyframe that ended the keyframe segment evaluated last. Playback
+   * usually evaluates the same or the next segment again, which avoids searching the keyframes.
+   */
+  int eval_segment_hint;
+  char _pad2[4];
 } FCurve;
 
 /* user-editable flags/settings */
@@ -17,11 +17,16 @@ extern "C" {
 
 /** Workaround to forward-declare C++ type in C header. */
 #ifdef __cplusplus
+namespace blender {
+class ImplicitSharingInfo;
+}  // namespace blender
+using ImplicitSharingInfoHandle = blender::ImplicitSharingInfo;
 namespace blender::bke {
 class AnonymousAttributeID;
 }  // namespace blender::bke
 using AnonymousAttributeIDHandle = blender::bke::AnonymousAttributeID;
 #else
+typedef struct ImplicitSharingInfoHandle ImplicitSharingInfoHandle;
 typedef struct AnonymousAttributeIDHandle AnonymousAttributeIDHandle;
 #endif
 
@@ -53,6 +58,15 @@ typedef struct CustomDataLayer {
    * attribute was created.
    */
   const AnonymousAttributeIDHandle *anonymous_id;
+  /**
+   * Run-time data that allows sharing `data` with other layers (e.g. between original and
+   * evaluated meshes). Data allocated by the layer gets a sharing info, which frees the data
+   * together with its last user. It's null when there is no data, when the data is only
+   * referenced (see #CD_FLAG_NOFREE), or when an array was assigned to the layer directly, which
+   * the layer then owns exclusively. Shared data must not be modified, see
+   * #CustomData_get_layer_for_write.
+   */
+  const ImplicitSharingInfoHandle *sharing_info;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 68
@@ -76,8 +90,7 @@ typedef struct CustomData {
    * MUST be >= CD_NUMTYPES, but we can't use a define here.
    * Correct size is ensured in CustomData_update_typemap assert().
    */
-  int typemap[52];
-  char _pad[4];
+  int typemap[55];
   /** Number of layers, size of layers array. */
   int totlayer, maxlayer;
   /** In editmode, total size of all data layers. */
@@ -163,7 +176,14 @@ typedef enum eCustomDataType {
 
   CD_HAIRLENGTH = 51,
 
-  CD_NUMTYPES = 52,
+  /* Compressed storage of #CD_PROP_FLOAT2 attributes in the [0, 1] range with 16 bit integers. */
+  CD_PROP_FLOAT2_UNORM16 = 52,
+  /* Compressed storage of normalized #CD_PROP_FLOAT3 attributes as octahedral coordinates. */
+  CD_PROP_NORMAL_OCT = 53,
+  /* Compressed storage of #CD_PROP_FLOAT3 attributes with half floats. */
+  CD_PROP_FLOAT3_HALF = 54,
+
+  CD_NUMTYPES = 55,
 } eCustomDataType;
 
 /* Bits for eCustomDataMask */
@@ -214,6 +234,9 @@ typedef enum eCustomDataType {
 #define CD_MASK_PROP_INT8 (1ULL << CD_PROP_INT8)
 
 #define CD_MASK_HAIRLENGTH (1ULL << CD_HAIRLENGTH)
+#define CD_MASK_PROP_FLOAT3_HALF (1ULL << CD_PROP_FLOAT3_HALF)
+#define CD_MASK_PROP_FLOAT2_UNORM16 (1ULL << CD_PROP_FLOAT2_UNORM16)
+#define CD_MASK_PROP_NORMAL_OCT (1ULL << CD_PROP_NORMAL_OCT)
 
 /** Multi-resolution loop data. */
 #define CD_MASK_MULTIRES_GRIDS (CD_MASK_MDISPS | CD_GRID_PAINT_MASK)
@@ -227,6 +250,13 @@ typedef enum eCustomDataType {
    CD_MASK_PROP_COLOR | CD_MASK_PROP_STRING | CD_MASK_PROP_BYTE_COLOR | CD_MASK_PROP_BOOL | \
    CD_MASK_PROP_INT8)
 
+/**
+ * Generic attributes stored with reduced precision. They are only accessible with the attribute
+ * API, which decodes them to the attribute type they store.
+ */
+#define CD_MASK_PROP_COMPRESSED \
+  (CD_MASK_PROP_FLOAT3_HALF | CD_MASK_PROP_FLOAT2_UNORM16 | CD_MASK_PROP_NORMAL_OCT)
+
 /* All color attributes */
 #define CD_MASK_COLOR_ALL (CD_MASK_PROP_COLOR | CD_MASK_PROP_BYTE_COLOR)
 
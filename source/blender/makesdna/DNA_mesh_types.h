@@ -27,6 +27,7 @@ struct MeshRuntime;
 class AttributeAccessor;
 class MutableAttributeAccessor;
 struct LooseEdgeCache;
+struct TopologyMap;
 }  // namespace bke
 }  // namespace blender
 using MeshRuntimeHandle = blender::bke::MeshRuntime;
@@ -294,6 +295,16 @@ typedef struct Mesh {
    */
   void loose_edges_tag_none() const;
 
+  /**
+   * Cached map from every vertex to the indices of the edges that use it, calculated lazily and
+   * shared between meshes with the same topology.
+   */
+  const blender::bke::TopologyMap &vert_to_edge_map() const;
+  /** Cached map from every vertex to the indices of the polygons that use it. */
+  const blender::bke::TopologyMap &vert_to_poly_map() const;
+  /** Cached map from every vertex to the indices of the face corners that use it. */
+  const blender::bke::TopologyMap &vert_to_loop_map() const;
+
   /**
    * Normal direction of polygons, defined by positions and the winding direction of face corners.
    */
@@ -15,6 +15,11 @@ typedef struct PackedFile {
   int size;
   int seek;
   void *data;
+  /**
+   * Runtime, set while `data` is not read from the .blend file yet,
+   * see #BKE_packedfile_ensure_data. Never written to disk.
+   */
+  struct BLODeferredData *deferred_data;
 } PackedFile;
 
 #ifdef __cplusplus
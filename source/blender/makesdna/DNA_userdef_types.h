@@ -672,7 +672,8 @@ typedef struct UserDef_Experimental {
   char use_sculpt_texture_paint;
   char enable_workbench_next;
   char use_new_volume_nodes;
-  char _pad[6];
+  char use_autosave_delta;
+  char _pad[5];
   /** `makesdna` does not allow empty structs. */
 } UserDef_Experimental;
 
@@ -42,6 +42,25 @@ const EnumPropertyItem rna_enum_attribute_type_items[] = {
     {0, NULL, 0, NULL, NULL},
 };
 
+const EnumPropertyItem rna_enum_attribute_compressed_type_items[] = {
+    {CD_PROP_FLOAT3_HALF,
+     "FLOAT_VECTOR_HALF",
+     0,
+     "Half Float Vector",
+     "3D vector with 16-bit floating-point values, for values up to 65504"},
+    {CD_PROP_FLOAT2_UNORM16,
+     "FLOAT2_UNORM16",
+     0,
+     "16-Bit 2D Vector",
+     "2D vector with values from 0 to 1, stored as 16-bit integers"},
+    {CD_PROP_NORMAL_OCT,
+     "NORMAL_OCTAHEDRAL",
+     0,
+     "Octahedral Normal",
+     "3D vector with unit length, stored as two 16-bit integers"},
+    {0, NULL, 0, NULL, NULL},
+};
+
 const EnumPropertyItem rna_enum_color_attribute_type_items[] = {
     {CD_PROP_COLOR, "FLOAT_COLOR", 0, "Color", "RGBA color 32-bit floating-point values"},
     {CD_PROP_BYTE_COLOR,
@@ -298,6 +317,8 @@ static void rna_Attribute_data_begin(CollectionPropertyIterator *iter, PointerRN
       break;
   }
 
+  /* The data may be modified through the iterator. */
+  CustomData_ensure_data_is_mutable(layer, length);
   rna_iterator_array_begin(iter, layer->data, struct_size, length, 0, NULL);
 }
 
@@ -420,6 +441,25 @@ static void rna_AttributeGroup_remove(ID *id, ReportList *reports, PointerRNA *a
   WM_main_add_notifier(NC_GEOM | ND_DATA, id);
 }
 
+static void rna_AttributeGroup_compress(ID *id,
+                                        ReportList *reports,
+                                        const char *name,
+                                        const int type)
+{
+  if (BKE_id_attribute_compress(id, name, type, reports)) {
+    DEG_id_tag_update(id, ID_RECALC_GEOMETRY);
+    WM_main_add_notifier(NC_GEOM | ND_DATA, id);
+  }
+}
+
+static void rna_AttributeGroup_decompress(ID *id, ReportList *reports, const char *name)
+{
+  if (BKE_id_attribute_decompress(id, name, reports)) {
+    DEG_id_tag_update(id, ID_RECALC_GEOMETRY);
+    WM_main_add_notifier(NC_GEOM | ND_DATA, id);
+  }
+}
+
 static int rna_Attributes_layer_skip(CollectionPropertyIterator *UNUSED(iter), void *data)
 {
   CustomDataLayer *layer = (CustomDataLayer *)data;
@@ -1143,6 +1183,29 @@ static void rna_def_attribute_group(BlenderRNA *brna)
   RNA_def_parameter_flags(parm, PROP_NEVER_NULL, PARM_REQUIRED | PARM_RNAPTR);
   RNA_def_parameter_clear_flags(parm, PROP_THICK_WRAP, 0);
 
+  func = RNA_def_function(srna, "compress", "rna_AttributeGroup_compress");
+  RNA_def_function_ui_description(
+      func,
+      "Store an attribute with reduced precision to save memory. Compressed attributes are not "
+      "part of the attribute collection, but are still used by the geometry");
+  RNA_def_function_flag(func, FUNC_USE_REPORTS);
+  parm = RNA_def_string(func, "name", NULL, 0, "Name", "Name of geometry attribute");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+  parm = RNA_def_enum(func,
+                      "type",
+                      rna_enum_attribute_compressed_type_items,
+                      CD_PROP_FLOAT3_HALF,
+                      "Type",
+                      "Compressed attribute type");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
+  func = RNA_def_function(srna, "decompress", "rna_AttributeGroup_decompress");
+  RNA_def_function_ui_description(func,
+                                  "Store a compressed attribute with full precision again");
+  RNA_def_function_flag(func, FUNC_USE_REPORTS);
+  parm = RNA_def_string(func, "name", NULL, 0, "Name", "Name of compressed geometry attribute");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
   /* Active */
   prop = RNA_def_property(srna, "active", PROP_POINTER, PROP_NONE);
   RNA_def_property_struct_type(prop, "Attribute");
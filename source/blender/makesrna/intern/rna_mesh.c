@@ -131,6 +131,19 @@ static CustomData *rna_mesh_ldata(const PointerRNA *ptr)
 /** \name Generic CustomData Layer Functions
  * \{ */
 
+/**
+ * Begin iterating over the data of a layer. The data may be modified through the iterator, so it
+ * must not be shared with other meshes.
+ */
+static void rna_cd_layer_data_begin(CollectionPropertyIterator *iter,
+                                    CustomDataLayer *layer,
+                                    const int struct_size,
+                                    const int length)
+{
+  CustomData_ensure_data_is_mutable(layer, length);
+  rna_iterator_array_begin(iter, layer->data, struct_size, length, 0, NULL);
+}
+
 static void rna_cd_layer_name_set(CustomData *cdata, CustomDataLayer *cdl, const char *value)
 {
   BLI_strncpy_utf8(cdl->name, value, sizeof(cdl->name));
@@ -1042,8 +1055,7 @@ static void rna_MeshUVLoopLayer_data_begin(CollectionPropertyIterator *iter, Poi
 {
   Mesh *mesh = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(
-      iter, layer->data, sizeof(float[2]), (mesh->edit_mesh) ? 0 : mesh->totloop, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(float[2]), (mesh->edit_mesh) ? 0 : mesh->totloop);
 }
 
 static int rna_MeshUVLoopLayer_data_length(PointerRNA *ptr)
@@ -1146,8 +1158,7 @@ static void rna_MeshUVLoopLayer_uv_begin(CollectionPropertyIterator *iter, Point
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
 
-  rna_iterator_array_begin(
-      iter, layer->data, sizeof(float[2]), (me->edit_mesh) ? 0 : me->totloop, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(float[2]), (me->edit_mesh) ? 0 : me->totloop);
 }
 
 int rna_MeshUVLoopLayer_uv_lookup_int(PointerRNA *ptr, int index, PointerRNA *r_ptr)
@@ -1157,6 +1168,7 @@ int rna_MeshUVLoopLayer_uv_lookup_int(PointerRNA *ptr, int index, PointerRNA *r_
     return 0;
   }
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  CustomData_ensure_data_is_mutable(layer, mesh->totloop);
 
   r_ptr->owner_id = &mesh->id;
   r_ptr->type = &RNA_Float2AttributeValue;
@@ -1252,8 +1264,7 @@ static void rna_MeshLoopColorLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(
-      iter, layer->data, sizeof(MLoopCol), (me->edit_mesh) ? 0 : me->totloop, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MLoopCol), (me->edit_mesh) ? 0 : me->totloop);
 }
 
 static int rna_MeshLoopColorLayer_data_length(PointerRNA *ptr)
@@ -1355,8 +1366,7 @@ static void rna_MeshVertColorLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(
-      iter, layer->data, sizeof(MPropCol), (me->edit_mesh) ? 0 : me->totvert, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MPropCol), (me->edit_mesh) ? 0 : me->totvert);
 }
 
 static int rna_MeshVertColorLayer_data_length(PointerRNA *ptr)
@@ -1494,7 +1504,7 @@ static void rna_MeshSkinVertexLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MVertSkin), me->totvert, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MVertSkin), me->totvert);
 }
 
 static int rna_MeshSkinVertexLayer_data_length(PointerRNA *ptr)
@@ -1517,7 +1527,7 @@ static void rna_MeshVertexCreaseLayer_data_begin(CollectionPropertyIterator *ite
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(float), me->totvert, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(float), me->totvert);
 }
 
 static int rna_MeshVertexCreaseLayer_data_length(PointerRNA *ptr)
@@ -1542,7 +1552,7 @@ static void rna_MeshEdgeCreaseLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(float), me->totedge, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(float), me->totedge);
 }
 
 static int rna_MeshEdgeCreaseLayer_data_length(PointerRNA *ptr)
@@ -1573,8 +1583,7 @@ static void rna_MeshPaintMaskLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(
-      iter, layer->data, sizeof(MFloatProperty), (me->edit_mesh) ? 0 : me->totvert, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MFloatProperty), (me->edit_mesh) ? 0 : me->totvert);
 }
 
 static int rna_MeshPaintMaskLayer_data_length(PointerRNA *ptr)
@@ -1603,8 +1612,7 @@ static void rna_MeshFaceMapLayer_data_begin(CollectionPropertyIterator *iter, Po
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(
-      iter, layer->data, sizeof(int), (me->edit_mesh) ? 0 : me->totpoly, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(int), (me->edit_mesh) ? 0 : me->totpoly);
 }
 
 static int rna_MeshFaceMapLayer_data_length(PointerRNA *ptr)
@@ -2267,14 +2275,14 @@ static void rna_MeshVertexFloatPropertyLayer_data_begin(CollectionPropertyIterat
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MFloatProperty), me->totvert, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MFloatProperty), me->totvert);
 }
 static void rna_MeshPolygonFloatPropertyLayer_data_begin(CollectionPropertyIterator *iter,
                                                          PointerRNA *ptr)
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MFloatProperty), me->totpoly, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MFloatProperty), me->totpoly);
 }
 
 static int rna_MeshVertexFloatPropertyLayer_data_length(PointerRNA *ptr)
@@ -2318,14 +2326,14 @@ static void rna_MeshVertexIntPropertyLayer_data_begin(CollectionPropertyIterator
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MIntProperty), me->totvert, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MIntProperty), me->totvert);
 }
 static void rna_MeshPolygonIntPropertyLayer_data_begin(CollectionPropertyIterator *iter,
                                                        PointerRNA *ptr)
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MIntProperty), me->totpoly, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MIntProperty), me->totpoly);
 }
 
 static int rna_MeshVertexIntPropertyLayer_data_length(PointerRNA *ptr)
@@ -2369,14 +2377,14 @@ static void rna_MeshVertexStringPropertyLayer_data_begin(CollectionPropertyItera
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MStringProperty), me->totvert, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MStringProperty), me->totvert);
 }
 static void rna_MeshPolygonStringPropertyLayer_data_begin(CollectionPropertyIterator *iter,
                                                           PointerRNA *ptr)
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
-  rna_iterator_array_begin(iter, layer->data, sizeof(MStringProperty), me->totpoly, 0, NULL);
+  rna_cd_layer_data_begin(iter, layer, sizeof(MStringProperty), me->totpoly);
 }
 
 static int rna_MeshVertexStringPropertyLayer_data_length(PointerRNA *ptr)
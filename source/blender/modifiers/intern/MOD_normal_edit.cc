@@ -330,7 +330,9 @@ static void normalEditModifier_do_radial(NormalEditModifierData *enmd,
                                              &mesh->ldata,
                                              polys,
                                              BKE_mesh_poly_normals_for_write(mesh))) {
-    mesh->runtime->vert_normals_dirty = true;
+    /* Flipping changes the vertices of the face corners, so the triangulation and the vertex to
+     * face corner map (which may be shared with the input mesh) are invalid too. */
+    BKE_mesh_tag_topology_changed(mesh);
   }
   const bool *sharp_faces = static_cast<const bool *>(
       CustomData_get_layer_named(&mesh->pdata, CD_PROP_BOOL, "sharp_face"));
@@ -440,7 +442,9 @@ static void normalEditModifier_do_directional(NormalEditModifierData *enmd,
                                              &mesh->ldata,
                                              polys,
                                              BKE_mesh_poly_normals_for_write(mesh))) {
-    mesh->runtime->vert_normals_dirty = true;
+    /* Flipping changes the vertices of the face corners, so the triangulation and the vertex to
+     * face corner map (which may be shared with the input mesh) are invalid too. */
+    BKE_mesh_tag_topology_changed(mesh);
   }
   const bool *sharp_faces = static_cast<const bool *>(
       CustomData_get_layer_named(&mesh->pdata, CD_PROP_BOOL, "sharp_face"));
@@ -44,6 +44,8 @@ static void mesh_flip_faces(Mesh &mesh, const Field<bool> &selection_field)
       }
     }
   });
+  /* The vertex to corner map and the triangulation reference the reordered corners. */
+  BKE_mesh_tag_topology_changed(&mesh);
 
   MutableAttributeAccessor attributes = mesh.attributes_for_write();
   attributes.for_all(
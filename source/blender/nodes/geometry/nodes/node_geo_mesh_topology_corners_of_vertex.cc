@@ -61,8 +61,7 @@ class CornersOfVertInput final : public bke::MeshFieldInput {
   {
     const IndexRange vert_range(mesh.totvert);
     const Span<int> corner_verts = mesh.corner_verts();
-    Array<Vector<int>> vert_to_loop_map = bke::mesh_topology::build_vert_to_loop_map(corner_verts,
-                                                                                     mesh.totvert);
+    const bke::TopologyMap &vert_to_loop_map = mesh.vert_to_loop_map();
 
     const bke::MeshFieldContext context{mesh, domain};
     fn::FieldEvaluator evaluator{context, &mask};
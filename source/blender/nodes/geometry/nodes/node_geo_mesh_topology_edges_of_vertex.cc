@@ -60,9 +60,7 @@ class EdgesOfVertInput final : public bke::MeshFieldInput {
                                  const IndexMask mask) const final
   {
     const IndexRange vert_range(mesh.totvert);
-    const Span<MEdge> edges = mesh.edges();
-    const Array<Vector<int>> vert_to_edge_map = bke::mesh_topology::build_vert_to_edge_map(
-        edges, mesh.totvert);
+    const bke::TopologyMap &vert_to_edge_map = mesh.vert_to_edge_map();
 
     const bke::MeshFieldContext context{mesh, domain};
     fn::FieldEvaluator evaluator{context, &mask};
@@ -23,6 +23,35 @@ static void node_declare(NodeDeclarationBuilder &b)
   b.add_output<decl::Geometry>(N_("Geometry")).propagate_all();
 }
 
+static void set_positions(MutableSpan<float3> out_positions,
+                          const VArray<float3> &in_positions,
+                          const VArray<float3> &in_offsets,
+                          const IndexMask selection,
+                          const bool positions_are_original)
+{
+  const int grain_size = 10000;
+  if (positions_are_original) {
+    devirtualize_varray(in_offsets, [&](const auto in_offsets) {
+      threading::parallel_for(selection.index_range(), grain_size, [&](const IndexRange range) {
+        for (const int i : selection.slice(range)) {
+          out_positions[i] += in_offsets[i];
+        }
+      });
+    });
+  }
+  else {
+    devirtualize_varray2(
+        in_positions, in_offsets, [&](const auto in_positions, const auto in_offsets) {
+          threading::parallel_for(
+              selection.index_range(), grain_size, [&](const IndexRange range) {
+                for (const int i : selection.slice(range)) {
+                  out_positions[i] = in_positions[i] + in_offsets[i];
+                }
+              });
+        });
+  }
+}
+
 static void set_computed_position_and_offset(GeometryComponent &component,
                                              const VArray<float3> &in_positions,
                                              const VArray<float3> &in_offsets,
@@ -48,6 +77,18 @@ static void set_computed_position_and_offset(GeometryComponent &component,
   const int grain_size = 10000;
 
   switch (component.type()) {
+    case GEO_COMPONENT_TYPE_MESH: {
+      Mesh &mesh = *static_cast<MeshComponent &>(component).get_for_write();
+      set_positions(mesh.vert_positions_for_write(),
+                    in_positions,
+                    in_offsets,
+                    selection,
+                    positions_are_original);
+      /* Update the cached normals and triangulation around the moved vertices instead of
+       * recalculating them for the whole mesh. */
+      bke::mesh::tag_positions_changed_partial(mesh, selection);
+      break;
+    }
     case GEO_COMPONENT_TYPE_CURVE: {
       if (attributes.contains("handle_right") && attributes.contains("handle_left")) {
         CurveComponent &curve_component = static_cast<CurveComponent &>(component);
@@ -88,27 +129,8 @@ static void set_computed_position_and_offset(GeometryComponent &component,
     default: {
       AttributeWriter<float3> positions = attributes.lookup_for_write<float3>("position");
       MutableVArraySpan<float3> out_positions_span = positions.varray;
-      if (positions_are_original) {
-        devirtualize_varray(in_offsets, [&](const auto in_offsets) {
-          threading::parallel_for(
-              selection.index_range(), grain_size, [&](const IndexRange range) {
-                for (const int i : selection.slice(range)) {
-                  out_positions_span[i] += in_offsets[i];
-                }
-              });
-        });
-      }
-      else {
-        devirtualize_varray2(
-            in_positions, in_offsets, [&](const auto in_positions, const auto in_offsets) {
-              threading::parallel_for(
-                  selection.index_range(), grain_size, [&](const IndexRange range) {
-                    for (const int i : selection.slice(range)) {
-                      out_positions_span[i] = in_positions[i] + in_offsets[i];
-                    }
-                  });
-            });
-      }
+      set_positions(
+          out_positions_span, in_positions, in_offsets, selection, positions_are_original);
       out_positions_span.save();
       positions.finish();
       break;
@@ -21,6 +21,7 @@
 #include "BLI_hash.h"
 #include "BLI_lazy_threading.hh"
 #include "BLI_map.hh"
+#include "BLI_trace.hh"
 
 #include "DNA_ID.h"
 
@@ -167,7 +168,10 @@ class LazyFunctionForGeometryNode : public LazyFunction {
                                  lf_input_for_attribute_propagation_to_output_};
 
     geo_eval_log::TimePoint start_time = geo_eval_log::Clock::now();
-    node_.typeinfo->geometry_node_execute(geo_params);
+    {
+      SCOPED_TRACE_EVENT("geometry_nodes", node_.name);
+      node_.typeinfo->geometry_node_execute(geo_params);
+    }
     geo_eval_log::TimePoint end_time = geo_eval_log::Clock::now();
 
     if (geo_eval_log::GeoModifierLog *modifier_log = user_data->modifier_data->eval_log) {
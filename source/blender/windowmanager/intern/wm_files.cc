@@ -970,6 +970,9 @@ bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
      * risk, because the excluded path list is also loaded. Further it's just confusing
      * if a user loads a file and various preferences change. */
     params.skip_flags = BLO_READ_SKIP_USERDEF;
+    if (G.fileflags & G_FILE_DEFER_PACKED_DATA) {
+      params.skip_flags |= BLO_READ_DEFER_PACKED_DATA;
+    }
 
     BlendFileReadReport bf_reports{};
     bf_reports.reports = reports;
@@ -2010,6 +2013,69 @@ static void wm_autosave_location(char filepath[FILE_MAX])
   BLI_path_join(filepath, FILE_MAX, tempdir_base, filename);
 }
 
+/** Delta auto-saves are written next to the auto-save file they are based on. */
+static void wm_autosave_delta_location(const char *filepath, char filepath_delta[FILE_MAX])
+{
+  BLI_snprintf(filepath_delta, FILE_MAX, "%s.delta", filepath);
+}
+
+/**
+ * The undo memfile of the last full auto-save,
+ * delta auto-saves only store what changed compared to it.
+ */
+static MemFile *wm_autosave_base_memfile = nullptr;
+static char wm_autosave_base_filepath[FILE_MAX] = "";
+
+static void wm_autosave_base_free()
+{
+  if (wm_autosave_base_memfile) {
+    BLO_memfile_free(wm_autosave_base_memfile);
+    MEM_freeN(wm_autosave_base_memfile);
+    wm_autosave_base_memfile = nullptr;
+  }
+  wm_autosave_base_filepath[0] = '\0';
+}
+
+static void wm_autosave_write_memfile(MemFile *memfile, const char *filepath)
+{
+  char filepath_delta[FILE_MAX];
+  wm_autosave_delta_location(filepath, filepath_delta);
+
+  if (!USER_EXPERIMENTAL_TEST(&U, use_autosave_delta)) {
+    wm_autosave_base_free();
+    if (BLI_exists(filepath_delta)) {
+      BLI_delete(filepath_delta, false, false);
+    }
+    BLO_memfile_write_file(memfile, filepath);
+    return;
+  }
+
+  if (wm_autosave_base_memfile && STREQ(wm_autosave_base_filepath, filepath) &&
+      BLI_exists(filepath))
+  {
+    size_t full_size;
+    const size_t delta_size = BLO_memfile_delta_size(
+        memfile, wm_autosave_base_memfile, &full_size);
+    /* Once most of the data changed, a new full save is barely slower and keeps deltas small. */
+    if (delta_size < full_size / 2) {
+      if (BLO_memfile_write_file_delta(memfile, wm_autosave_base_memfile, filepath_delta)) {
+        return;
+      }
+    }
+  }
+
+  /* Remove the old delta first, it must never be applied to a different base file. */
+  wm_autosave_base_free();
+  if (BLI_exists(filepath_delta)) {
+    BLI_delete(filepath_delta, false, false);
+  }
+  if (BLO_memfile_write_file(memfile, filepath)) {
+    wm_autosave_base_memfile = MEM_cnew<MemFile>(__func__);
+    BLO_memfile_share(wm_autosave_base_memfile, memfile);
+    STRNCPY(wm_autosave_base_filepath, filepath);
+  }
+}
+
 static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
 {
   char filepath[FILE_MAX];
@@ -2019,11 +2085,13 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
   /* Fast save of last undo-buffer, now with UI. */
   const bool use_memfile = (U.uiflag & USER_GLOBALUNDO) != 0;
   MemFile *memfile = use_memfile ? ED_undosys_stack_memfile_get_active(wm->undo_stack) : nullptr;
-  if (memfile != nullptr) {
-    BLO_memfile_write_file(memfile, filepath);
+  /* Undo steps don't store packed data that wasn't loaded yet,
+   * the auto-save must not depend on the file it's loaded from. */
+  if (memfile != nullptr && !BLO_memfile_has_deferred_data(memfile)) {
+    wm_autosave_write_memfile(memfile, filepath);
   }
   else {
-    if (use_memfile) {
+    if (use_memfile && memfile == nullptr) {
       /* This is very unlikely, alert developers of this unexpected case. */
       CLOG_WARN(&LOG, "undo-data not found for writing, fallback to regular file write!");
     }
@@ -2031,6 +2099,13 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
     /* Save as regular blend file with recovery information. */
     const int fileflags = (G.fileflags & ~G_FILE_COMPRESS) | G_FILE_RECOVER_WRITE;
 
+    char filepath_delta[FILE_MAX];
+    wm_autosave_delta_location(filepath, filepath_delta);
+    wm_autosave_base_free();
+    if (BLI_exists(filepath_delta)) {
+      BLI_delete(filepath_delta, false, false);
+    }
+
     ED_editors_flush_edits(bmain);
 
     /* Error reporting into console. */
@@ -2096,6 +2171,17 @@ void wm_autosave_delete(void)
 
   wm_autosave_location(filepath);
 
+  char filepath_delta[FILE_MAX];
+  wm_autosave_delta_location(filepath, filepath_delta);
+  if (BLI_exists(filepath_delta)) {
+    if ((U.uiflag & USER_GLOBALUNDO) == 0) {
+      /* The file is kept, so it needs to be complete. */
+      BLO_memfile_delta_apply(filepath, filepath_delta);
+    }
+    BLI_delete(filepath_delta, false, false);
+  }
+  wm_autosave_base_free();
+
   if (BLI_exists(filepath)) {
     char str[FILE_MAX];
     BLI_path_join(str, sizeof(str), BKE_tempdir_base(), BLENDER_QUIT_FILE);
@@ -2765,7 +2851,11 @@ static int wm_open_mainfile__open(bContext *C, wmOperator *op)
 
   SET_FLAG_FROM_TEST(G.fileflags, !RNA_boolean_get(op->ptr, "load_ui"), G_FILE_NO_UI);
   SET_FLAG_FROM_TEST(G.f, RNA_boolean_get(op->ptr, "use_scripts"), G_FLAG_SCRIPT_AUTOEXEC);
+  SET_FLAG_FROM_TEST(G.fileflags,
+                     RNA_boolean_get(op->ptr, "use_deferred_packed_data"),
+                     G_FILE_DEFER_PACKED_DATA);
   success = wm_file_read_opwrap(C, filepath, op->reports);
+  G.fileflags &= ~G_FILE_DEFER_PACKED_DATA;
 
   /* for file open also popup for warnings, not only errors */
   BKE_report_print_level_set(op->reports, RPT_WARNING);
@@ -2897,6 +2987,8 @@ static void wm_open_mainfile_ui(bContext * /*C*/, wmOperator *op)
   }
 
   uiItemR(col, op->ptr, "use_scripts", 0, autoexec_text, ICON_NONE);
+
+  uiItemR(layout, op->ptr, "use_deferred_packed_data", 0, nullptr, ICON_NONE);
 }
 
 static void wm_open_mainfile_def_property_use_scripts(wmOperatorType *ot)
@@ -2939,6 +3031,13 @@ void WM_OT_open_mainfile(wmOperatorType *ot)
       ot->srna, "display_file_selector", true, "Display File Selector", "");
   RNA_def_property_flag(prop, PROP_SKIP_SAVE);
 
+  /* Avoids loading large packed files that are never used. */
+  RNA_def_boolean(ot->srna,
+                  "use_deferred_packed_data",
+                  false,
+                  "Deferred Packed Data",
+                  "Only read the contents of packed files when they are first accessed");
+
   create_operator_state(ot, OPEN_MAINFILE_STATE_DISCARD_CHANGES);
 }
 
@@ -3066,6 +3165,23 @@ static int wm_recover_auto_save_exec(bContext *C, wmOperator *op)
   wm_open_init_use_scripts(op, true);
   SET_FLAG_FROM_TEST(G.f, RNA_boolean_get(op->ptr, "use_scripts"), G_FLAG_SCRIPT_AUTOEXEC);
 
+  /* Merge the changes of a delta auto-save into the file, when there is one. */
+  char filepath_delta[FILE_MAX];
+  wm_autosave_delta_location(filepath, filepath_delta);
+  if (BLI_exists(filepath_delta)) {
+    if (!BLO_memfile_delta_apply(filepath, filepath_delta)) {
+      BKE_reportf(op->reports,
+                  RPT_WARNING,
+                  "Unable to apply delta auto-save \"%s\", recovering the last full auto-save",
+                  filepath_delta);
+    }
+    BLI_delete(filepath_delta, false, false);
+    if (STREQ(filepath, wm_autosave_base_filepath)) {
+      /* The file changed, it can't be used as base for delta auto-saves anymore. */
+      wm_autosave_base_free();
+    }
+  }
+
   G.fileflags |= G_FILE_RECOVER_READ;
 
   success = wm_file_read_opwrap(C, filepath, op->reports);
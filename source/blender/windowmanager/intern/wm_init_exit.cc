@@ -31,6 +31,7 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_timer.h"
+#include "BLI_trace.h"
 #include "BLI_utildefines.h"
 
 #include "BLO_undofile.h"
@@ -453,8 +454,11 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
         has_edited = ED_editors_flush_edits(bmain);
 
+        /* Undo steps don't store packed data that wasn't loaded yet. */
+        const bool use_main = has_edited || BLO_memfile_has_deferred_data(undo_memfile);
+
         BlendFileWriteParams blend_file_write_params{};
-        if ((has_edited &&
+        if ((use_main &&
              BLO_write_file(bmain, filepath, fileflags, &blend_file_write_params, nullptr)) ||
             BLO_memfile_write_file(undo_memfile, filepath)) {
           printf("Saved session recovery to \"%s\"\n", filepath);
@@ -498,6 +502,9 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   BLI_timer_free();
 
+  /* Write the trace of `--debug-trace` while no evaluation can run anymore. */
+  BLI_trace_session_end();
+
   WM_paneltype_clear();
 
   BKE_addon_pref_type_free();
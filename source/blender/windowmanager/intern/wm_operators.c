@@ -65,6 +65,8 @@
 
 #include "BLF_api.h"
 
+#include "BLO_undofile.h"
+
 #include "GPU_immediate.h"
 #include "GPU_immediate_util.h"
 #include "GPU_matrix.h"
@@ -3421,6 +3423,14 @@ static void WM_OT_redraw_timer(wmOperatorType *ot)
 static int memory_statistics_exec(bContext *UNUSED(C), wmOperator *UNUSED(op))
 {
   MEM_printmemlist_stats();
+
+  MemFileChunkStoreStats undo_stats;
+  BLO_memfile_chunk_store_stats(&undo_stats);
+  printf("\nglobal undo memory: %.3f MB in %zu buffers, shared by %zu chunks of %.3f MB\n",
+         (double)undo_stats.buffers_size / (double)(1024 * 1024),
+         undo_stats.buffers_num,
+         undo_stats.chunks_num,
+         (double)undo_stats.chunks_size / (double)(1024 * 1024));
   return OPERATOR_FINISHED;
 }
 
@@ -27,6 +27,7 @@
 #  include "BLI_string_utf8.h"
 #  include "BLI_system.h"
 #  include "BLI_threads.h"
+#  include "BLI_trace.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_blender_version.h"
@@ -592,6 +593,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 
   printf("\n");
   BLI_args_print_arg_doc(ba, "--debug-fpe");
+  BLI_args_print_arg_doc(ba, "--debug-trace");
   BLI_args_print_arg_doc(ba, "--debug-exit-on-error");
   BLI_args_print_arg_doc(ba, "--disable-crash-handler");
   BLI_args_print_arg_doc(ba, "--disable-abort-handler");
@@ -1179,6 +1181,20 @@ static int arg_handle_debug_fpe_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_debug_trace_set_doc[] =
+    "<filepath>\n"
+    "\tRecord the evaluation timeline of dependency graph, modifiers, geometry nodes and draw\n"
+    "\tcaches on all threads, written to the file in the Chrome trace format on exit.";
+static int arg_handle_debug_trace_set(int argc, const char **argv, void *UNUSED(data))
+{
+  if (argc > 1) {
+    BLI_trace_session_begin(argv[1]);
+    return 1;
+  }
+  fprintf(stderr, "\nError: '--debug-trace' no args given.\n");
+  return 0;
+}
+
 static const char arg_handle_app_template_doc[] =
     "<template>\n"
     "\tSet the application template (matching the directory name), use 'default' for none.";
@@ -2229,6 +2245,7 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_args_add(ba, NULL, "--debug-io", CB(arg_handle_debug_mode_io), NULL);
 
   BLI_args_add(ba, NULL, "--debug-fpe", CB(arg_handle_debug_fpe_set), NULL);
+  BLI_args_add(ba, NULL, "--debug-trace", CB(arg_handle_debug_trace_set), NULL);
 
 #  ifdef WITH_LIBMV
   BLI_args_add(ba, NULL, "--debug-libmv", CB(arg_handle_debug_mode_libmv), NULL);
@@ -5,17 +5,19 @@ import os
 import pathlib
 
 
-def _run(filepath):
+def _run(args):
     import bpy
     import time
 
+    filepath, use_deferred_packed_data = args
+
     # Load once to ensure it's cached by OS
     bpy.ops.wm.open_mainfile(filepath=filepath)
     bpy.ops.wm.read_homefile()
 
     # Measure loading the second time
     start_time = time.time()
-    bpy.ops.wm.open_mainfile(filepath=filepath)
+    bpy.ops.wm.open_mainfile(filepath=filepath, use_deferred_packed_data=use_deferred_packed_data)
     elapsed_time = time.time() - start_time
 
     result = {'time': elapsed_time}
@@ -23,20 +25,25 @@ def _run(filepath):
 
 
 class BlendLoadTest(api.Test):
-    def __init__(self, filepath):
+    def __init__(self, filepath, use_deferred_packed_data=False):
         self.filepath = filepath
+        self.use_deferred_packed_data = use_deferred_packed_data
 
     def name(self):
+        if self.use_deferred_packed_data:
+            return self.filepath.stem + "_deferred_packed"
         return self.filepath.stem
 
     def category(self):
         return "blend_load"
 
     def run(self, env, device_id):
-        result, _ = env.run_in_blender(_run, str(self.filepath))
+        result, _ = env.run_in_blender(_run, (str(self.filepath), self.use_deferred_packed_data))
         return result
 
 
 def generate(env):
     filepaths = env.find_blend_files('*/*')
-    return [BlendLoadTest(filepath) for filepath in filepaths]
+    tests = [BlendLoadTest(filepath) for filepath in filepaths]
+    tests += [BlendLoadTest(filepath, use_deferred_packed_data=True) for filepath in filepaths]
+    return tests
@@ -0,0 +1,67 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+import os
+
+
+def _run(args):
+    import bpy
+    import os
+    import tempfile
+    import time
+
+    filepath_save = os.path.join(tempfile.gettempdir(), "blend_save_test.blend")
+
+    # Evaluate once first, so saving doesn't include any lazy initialization.
+    bpy.context.view_layer.update()
+
+    test_time_start = time.time()
+    measured_times = []
+
+    min_measurements = 3
+    max_measurements = 20
+    timeout = 10
+
+    while True:
+        start_time = time.time()
+        bpy.ops.wm.save_as_mainfile(filepath=filepath_save, copy=True, compress=args['compress'])
+        elapsed_time = time.time() - start_time
+        measured_times.append(elapsed_time)
+
+        if len(measured_times) >= min_measurements and test_time_start + timeout < time.time():
+            break
+        if len(measured_times) >= max_measurements:
+            break
+
+    os.remove(filepath_save)
+
+    average_time = sum(measured_times) / len(measured_times)
+    result = {'time': average_time}
+    return result
+
+
+class BlendSaveTest(api.Test):
+    def __init__(self, filepath, compress):
+        self.filepath = filepath
+        self.compress = compress
+
+    def name(self):
+        if self.compress:
+            return self.filepath.stem + "_compressed"
+        return self.filepath.stem
+
+    def category(self):
+        return "blend_save"
+
+    def run(self, env, device_id):
+        args = {'compress': self.compress}
+        result, _ = env.run_in_blender(_run, args, [self.filepath])
+        return result
+
+
+def generate(env):
+    # Files with heavy meshes and geometry node setups are the interesting cases.
+    filepaths = env.find_blend_files('*/*')
+    tests = [BlendSaveTest(filepath, False) for filepath in filepaths]
+    tests += [BlendSaveTest(filepath, True) for filepath in filepaths]
+    return tests
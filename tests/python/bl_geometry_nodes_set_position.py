@@ -0,0 +1,90 @@
+# SPDX-License-Identifier: Apache-2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_geometry_nodes_set_position.py -- --verbose
+import bpy
+import unittest
+
+from mathutils import Vector, geometry
+
+
+def set_position_tree_new(name, source_node_idname, source_socket):
+    """
+    Create a node group that runs the geometry from a primitive node through a Set Position node
+    with an offset of one along Z. Curves are converted to a mesh, so the result can be inspected.
+    """
+    tree = bpy.data.node_groups.new(name, 'GeometryNodeTree')
+    tree.outputs.new('NodeSocketGeometry', "Geometry")
+    nodes = tree.nodes
+    links = tree.links
+
+    source = nodes.new(source_node_idname)
+    set_position = nodes.new('GeometryNodeSetPosition')
+    set_position.inputs["Offset"].default_value = (0.0, 0.0, 1.0)
+    links.new(source.outputs[source_socket], set_position.inputs["Geometry"])
+
+    result = set_position.outputs["Geometry"]
+    if source_socket == "Curve":
+        curve_to_mesh = nodes.new('GeometryNodeCurveToMesh')
+        links.new(result, curve_to_mesh.inputs["Curve"])
+        result = curve_to_mesh.outputs["Mesh"]
+
+    group_output = nodes.new('NodeGroupOutput')
+    links.new(result, group_output.inputs["Geometry"])
+    return tree, set_position
+
+
+def evaluated_mesh_get(tree):
+    mesh = bpy.data.meshes.new("Mesh")
+    ob = bpy.data.objects.new("Object", mesh)
+    bpy.context.scene.collection.objects.link(ob)
+    modifier = ob.modifiers.new("Nodes", 'NODES')
+    modifier.node_group = tree
+
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    ob_eval = ob.evaluated_get(depsgraph)
+    return ob_eval.to_mesh()
+
+
+class SetPositionTest(unittest.TestCase):
+
+    def setUp(self):
+        bpy.ops.wm.read_homefile(use_factory_startup=True, use_empty=True)
+
+    def test_poly_curve(self):
+        # Curves without Bezier handles use the generic attribute path.
+        tree, _set_position = set_position_tree_new(
+            "Poly Curve", 'GeometryNodeCurvePrimitiveLine', "Curve")
+        mesh = evaluated_mesh_get(tree)
+        self.assertEqual(len(mesh.vertices), 2)
+        self.assertEqual(mesh.vertices[0].co, Vector((0.0, 0.0, 1.0)))
+        self.assertEqual(mesh.vertices[1].co, Vector((0.0, 0.0, 2.0)))
+
+    def test_mesh_selection(self):
+        tree, set_position = set_position_tree_new("Mesh", 'GeometryNodeMeshGrid', "Mesh")
+        grid = next(node for node in tree.nodes if node.bl_idname == 'GeometryNodeMeshGrid')
+        grid.inputs["Vertices X"].default_value = 10
+        grid.inputs["Vertices Y"].default_value = 10
+
+        # Only move the first two vertices.
+        index = tree.nodes.new('GeometryNodeInputIndex')
+        compare = tree.nodes.new('FunctionNodeCompare')
+        compare.data_type = 'FLOAT'
+        compare.operation = 'LESS_THAN'
+        compare.inputs[1].default_value = 1.5
+        tree.links.new(index.outputs["Index"], compare.inputs[0])
+        tree.links.new(compare.outputs["Result"], set_position.inputs["Selection"])
+
+        mesh = evaluated_mesh_get(tree)
+        for vert in mesh.vertices:
+            self.assertEqual(vert.co.z, 1.0 if vert.index < 2 else 0.0)
+        # Normals must match the new positions.
+        for poly in mesh.polygons:
+            positions = [mesh.vertices[i].co for i in poly.vertices]
+            expected = geometry.normal(positions)
+            self.assertAlmostEqual((poly.normal - expected).length, 0.0, places=5)
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()